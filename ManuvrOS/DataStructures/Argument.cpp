@@ -39,6 +39,85 @@ This class represents our type-abstraction layer. It is the means by which
 *
 * Static members and initializers should be located here.
 *******************************************************************************/
+uint8_t*  Argument::_pool_slab    = nullptr;
+uint16_t* Argument::_pool_links   = nullptr;
+uint32_t  Argument::_pool_head    = 0x0000FFFF;   // Empty.
+uint32_t  Argument::_pool_count   = 0;
+uint32_t  Argument::_pool_in_use  = 0;
+uint32_t  Argument::_pool_hits    = 0;
+uint32_t  Argument::_pool_misses  = 0;
+
+#define ARGUMENT_POOL_NIL   0xFFFF
+
+/**
+* Hands the class a slab to allocate from. The owner (the Kernel) must keep it
+*   alive for as long as any Argument might be in it. Until this is called,
+*   every Argument comes from the heap.
+*
+* @param  slab   Memory for count slots of ARGUMENT_POOL_SLOT_SIZE bytes, 8-byte aligned.
+* @param  links  Memory for count free-list links.
+* @param  count  How many slots there are. At most 65535.
+*/
+void Argument::setPool(uint8_t* slab, uint16_t* links, unsigned int count) {
+  if ((nullptr == slab) || (nullptr == links) || (0 == count) || (count >= ARGUMENT_POOL_NIL)) {
+    return;
+  }
+  for (unsigned int i = 0; i < count; i++) {
+    links[i] = (i + 1 < count) ? (uint16_t) (i + 1) : ARGUMENT_POOL_NIL;
+  }
+  _pool_links = links;
+  _pool_count = count;
+  _pool_slab  = slab;
+  __atomic_store_n(&_pool_head, 0, __ATOMIC_RELEASE);
+}
+
+
+/**
+* Takes a slot from the slab if we can, and falls back to the heap if we can't.
+* The free-list is a lock-free stack, since Arguments are made on every thread.
+*   The head carries a tag that changes on every operation, so that a slot
+*   that is taken and returned between our load and our swap can't fool us.
+* Subclasses don't fit the slot layout, and always come from the heap.
+*/
+void* Argument::operator new(size_t sz) {
+  if ((sizeof(Argument) == sz) && (nullptr != _pool_slab)) {
+    uint32_t head = __atomic_load_n(&_pool_head, __ATOMIC_ACQUIRE);
+    while (ARGUMENT_POOL_NIL != (head & 0xFFFF)) {
+      uint16_t idx = (uint16_t) (head & 0xFFFF);
+      uint32_t nu  = ((head + 0x00010000) & 0xFFFF0000) | __atomic_load_n(&_pool_links[idx], __ATOMIC_RELAXED);
+      if (__atomic_compare_exchange_n(&_pool_head, &head, nu, true, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+        __atomic_fetch_add(&_pool_hits, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&_pool_in_use, 1, __ATOMIC_RELAXED);
+        return (void*) (_pool_slab + (idx * ARGUMENT_POOL_SLOT_SIZE));
+      }
+    }
+  }
+  __atomic_fetch_add(&_pool_misses, 1, __ATOMIC_RELAXED);
+  return malloc(sz);
+}
+
+
+/**
+* Returns the memory to the slab if it came from there, or the heap otherwise.
+*/
+void Argument::operator delete(void* p) {
+  uintptr_t addr = (uintptr_t) p;
+  uintptr_t base = (uintptr_t) _pool_slab;
+  if ((nullptr != _pool_slab) && (addr >= base) && (addr < base + (_pool_count * ARGUMENT_POOL_SLOT_SIZE))) {
+    uint16_t idx  = (uint16_t) ((addr - base) / ARGUMENT_POOL_SLOT_SIZE);
+    uint32_t head = __atomic_load_n(&_pool_head, __ATOMIC_RELAXED);
+    uint32_t nu;
+    do {
+      __atomic_store_n(&_pool_links[idx], (uint16_t) (head & 0xFFFF), __ATOMIC_RELAXED);
+      nu = ((head + 0x00010000) & 0xFFFF0000) | idx;
+    } while (!__atomic_compare_exchange_n(&_pool_head, &head, nu, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_fetch_sub(&_pool_in_use, 1, __ATOMIC_RELAXED);
+  }
+  else {
+    free(p);
+  }
+}
+
 #if defined(MANUVR_CBOR)
 
 int8_t Argument::encodeToCBOR(Argument* src, StringBuilder* out) {
@@ -233,6 +312,26 @@ Argument::~Argument() {
 }
 
 
+/**
+* Arguments that came from the slab have a little room after them. Small values
+*   can be copied there rather than malloc()'d. Such values must not be marked
+*   for reaping, and are only good for as long as the Argument lives.
+*
+* @param  l  How many bytes are needed.
+* @return A pointer to the space, or nullptr if there isn't enough (or any).
+*/
+void* Argument::inlineValue(size_t l) {
+  uintptr_t addr = (uintptr_t) this;
+  uintptr_t base = (uintptr_t) _pool_slab;
+  if ((l <= ARGUMENT_POOL_INLINE_BYTES) && (nullptr != _pool_slab)) {
+    if ((addr >= base) && (addr < base + (_pool_count * ARGUMENT_POOL_SLOT_SIZE))) {
+      return (void*) (addr + sizeof(Argument));
+    }
+  }
+  return nullptr;
+}
+
+
 void Argument::wipe() {
   if (nullptr != _next) {
     Argument* a = _next;
@@ -103,6 +103,19 @@ class Argument {
 
     ~Argument();
 
+    /*
+    * Arguments are carved from a fixed slab when one has been provided, and come
+    *   from the heap otherwise. This is transparent to new and delete.
+    */
+    static void* operator new(size_t);
+    static void  operator delete(void*);
+    static void  setPool(uint8_t* slab, uint16_t* links, unsigned int count);
+    static inline uint32_t poolHits() {     return _pool_hits;     };
+    static inline uint32_t poolMisses() {   return _pool_misses;   };
+    static inline uint32_t poolInUse() {    return _pool_in_use;   };
+    static inline uint32_t poolSize() {     return _pool_count;    };
+
+    void* inlineValue(size_t);   // Spare room in our slab slot for a small value, or nullptr.
 
     int8_t dropArg(Argument**, Argument*);
 
@@ -214,6 +227,19 @@ class Argument {
 
     // TODO: Might-should move this to someplace more accessable?
     static uintptr_t get_const_from_char_ptr(char*);
+
+
+  private:
+    static uint8_t*  _pool_slab;     // Where the slots are.
+    static uint16_t* _pool_links;    // Free-list linkage, one per slot.
+    static uint32_t  _pool_head;     // Free-list head. Index in the low half, ABA tag in the high.
+    static uint32_t  _pool_count;
+    static uint32_t  _pool_in_use;
+    static uint32_t  _pool_hits;
+    static uint32_t  _pool_misses;
 };
 
+/* How much memory does each Argument in the slab take? Includes inline value storage. */
+#define ARGUMENT_POOL_SLOT_SIZE  (((sizeof(Argument) + ARGUMENT_POOL_INLINE_BYTES) + 7) & ~((size_t) 7))
+
 #endif  // __MANUVR_ARGUMENT_H__
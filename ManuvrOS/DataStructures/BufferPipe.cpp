@@ -123,6 +123,15 @@ BufferPipe::~BufferPipe() {
     }
     _near  = nullptr;
   }
+  detachFar();
+}
+
+
+/**
+* Tells the far side that we are going away, and frees it if we allocated it.
+*   Used by the destructor, and by pipes that are recycled rather than freed.
+*/
+void BufferPipe::detachFar() {
   if (nullptr != _far) {
     _far->fromCounterparty(ManuvrPipeSignal::NEAR_SIDE_DETACH, nullptr);
     if (_bp_flag(BPIPE_FLAG_WE_ALLOCD_FAR)) {
@@ -130,6 +139,7 @@ BufferPipe::~BufferPipe() {
     }
     _far  = nullptr;
   }
+  _bp_set_flag(BPIPE_FLAG_WE_ALLOCD_FAR, false);
 }
 
 
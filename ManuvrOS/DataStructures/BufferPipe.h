@@ -262,6 +262,7 @@ class BufferPipe {
     /* Simple checks that we will need to do. */
     inline bool haveNear() {  return (nullptr != _near);  };
     bool haveFar();
+    void detachFar();       // Signal and release the far side, as the destructor would.
 
     virtual void printDebug(StringBuilder*);
 
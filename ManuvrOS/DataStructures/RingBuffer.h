@@ -20,64 +20,91 @@ limitations under the License.
 
 Template for a ring buffer.
 
+Capacity is always a power of two, so that wrapping is a mask. The read and
+  write indices run freely, and their difference is the number of pending
+  elements. Elements are copied in and out with memcpy(), so T must be
+  something that survives that (native types, pointers, and plain structs).
+
+One producer and one consumer may work the buffer concurrently without a lock
+  (an ISR and the main loop, or two threads). The producer only ever moves the
+  write index, and the consumer only ever moves the read index. That means a
+  full buffer refuses new elements rather than clobbering the oldest ones.
+
+For zero-copy work, reserve() and peek() hand out the longest contiguous span
+  that can be written or read. Call commit() or consume() with however much of
+  it was actually used.
 */
 
+#ifndef __MANUVR_RING_BUFFER_H__
+#define __MANUVR_RING_BUFFER_H__
+
 #include <stdlib.h>
+#include <string.h>
 
 
 template <class T> class RingBuffer {
-	public:
-		unsigned int first_element;
-		unsigned int last_element;
-
-		RingBuffer(unsigned int capacity);  // Constructor takes the number of slots as its sole argument.
-		~RingBuffer(void);
-
-		void clear(void);                // Wipe the buffer.
-		bool hasNext(void);              // Returns false if this list is empty. True otherwise.
-		int pending(void);               // Returns an integer representing how many members are unread.
-
-		int insert(T);     // Returns the ID of the data, or -1 on failure. Makes only a reference to the payload.
-		T get(void);       // Returns the data from the first element. Only appropriate for native types (and pointers).
-		int get(T*);       // Writes the data from the first element into the provided buffer.
-
-
-	private:
-		unsigned int size_of_element;
-		unsigned int capacity;
-		unsigned int element_count;
-		unsigned char *root;
+  public:
+    RingBuffer(unsigned int capacity);  // Rounded up to the next power of two.
+    ~RingBuffer(void);
+
+    void clear(void);                // Wipe the buffer. Only while neither side is working it.
+    bool hasNext(void);              // Returns false if this list is empty. True otherwise.
+    int  pending(void);              // Returns an integer representing how many members are unread.
+
+    inline unsigned int capacity(void) {   return (_mask + 1);   };
+
+    /* Producer side. */
+    int          insert(T);                                // 0 on success, -1 if full.
+    unsigned int insert(const T*, unsigned int count);     // Returns how many were taken.
+    T*           reserve(unsigned int* count);             // nullptr if full.
+    void         commit(unsigned int count);
+
+    /* Consumer side. */
+    T            get(void);        // Returns the first element, or 0 if empty. Only appropriate for native types (and pointers).
+    int          get(T*);          // 0 on success, -1 if empty.
+    unsigned int get(T*, unsigned int count);              // Returns how many were written.
+    T*           peek(unsigned int* count);                // nullptr if empty.
+    void         consume(unsigned int count);
+
+
+  private:
+    T*           _pool;
+    unsigned int _mask;
+    unsigned int _w;    // How many elements were ever written. Only the producer stores it.
+    unsigned int _r;    // How many elements were ever read. Only the consumer stores it.
 };
 
 
 template <class T> RingBuffer<T>::RingBuffer(unsigned int cap) {
-	capacity        = cap;
-	size_of_element = sizeof(T);
-	root = (unsigned char*) malloc(size_of_element * capacity);
-	clear();
+  unsigned int c = 1;
+  while (c < cap) c = c << 1;
+  _mask = c - 1;
+  _pool = (T*) malloc(sizeof(T) * c);
+  clear();
 }
 
 
 template <class T> RingBuffer<T>::~RingBuffer() {
-	first_element = 0;
-	last_element  = 0;
-	element_count = 0;
-	free(root);
-	root = nullptr;
+  _r = 0;
+  _w = 0;
+  free(_pool);
+  _pool = nullptr;
 }
 
 
-template <class T> bool RingBuffer<T>::hasNext(void) {    return (element_count > 0);    }
-template <class T> int RingBuffer<T>::pending(void) {     return element_count;          }
+template <class T> bool RingBuffer<T>::hasNext(void) {
+  return (0 < pending());
+}
+
+template <class T> int RingBuffer<T>::pending(void) {
+  return (int) (__atomic_load_n(&_w, __ATOMIC_ACQUIRE) - __atomic_load_n(&_r, __ATOMIC_ACQUIRE));
+}
 
 
 template <class T> void RingBuffer<T>::clear(void) {
-  for (int i = 0; i < (size_of_element * capacity)-1; i++) {
-    *((unsigned char*) root + i) = 0x00;
-  }
-  first_element = 0;
-  last_element  = 0;
-  element_count = 0;
+  memset(_pool, 0, sizeof(T) * capacity());
+  __atomic_store_n(&_r, 0, __ATOMIC_RELEASE);
+  __atomic_store_n(&_w, 0, __ATOMIC_RELEASE);
 }
 
 
@@ -86,47 +113,123 @@ template <class T> void RingBuffer<T>::clear(void) {
 *   for the caller to maintain local copies of data (unless T is a pointer).
 */
 template <class T> int RingBuffer<T>::insert(T d) {
-  int return_value = 0;
-	T *ref = &d;
-	unsigned int offset = size_of_element * last_element;
-	for (unsigned int i = 0; i < size_of_element; i++) {
-		*((unsigned char*) root + offset + i) = *((unsigned char*)ref + i);
-	}
-	if (element_count == capacity) {
-	  // We have wrapped our pointer because things have arrived faster than
-	  //  they have been removed. We need to clobber the oldest data.
-	  return_value = -1;
-	  first_element = ((first_element + 1) % capacity);
-	}
-	else {
-	  element_count++;
-	}
-	last_element = (last_element + 1) % capacity;
-	return return_value;
+  unsigned int w = __atomic_load_n(&_w, __ATOMIC_RELAXED);
+  if ((w - __atomic_load_n(&_r, __ATOMIC_ACQUIRE)) > _mask) {
+    return -1;
+  }
+  memcpy(&_pool[w & _mask], &d, sizeof(T));
+  __atomic_store_n(&_w, w + 1, __ATOMIC_RELEASE);
+  return 0;
+}
+
+
+/**
+* Copies in as many of the given elements as will fit.
+*
+* @param  src    The elements.
+* @param  count  How many there are.
+* @return How many were taken. The rest should be offered again later.
+*/
+template <class T> unsigned int RingBuffer<T>::insert(const T* src, unsigned int count) {
+  unsigned int w    = __atomic_load_n(&_w, __ATOMIC_RELAXED);
+  unsigned int room = capacity() - (w - __atomic_load_n(&_r, __ATOMIC_ACQUIRE));
+  if (count > room) count = room;
+  unsigned int idx   = w & _mask;
+  unsigned int first = capacity() - idx;   // Elements before the wrap.
+  if (first > count) first = count;
+  memcpy(&_pool[idx], src, sizeof(T) * first);
+  memcpy(_pool, src + first, sizeof(T) * (count - first));
+  __atomic_store_n(&_w, w + count, __ATOMIC_RELEASE);
+  return count;
+}
+
+
+/**
+* Hands out the longest contiguous run of free slots, to be filled in place.
+*   Nothing is visible to the consumer until commit().
+*
+* @param  count  Set to the length of the run.
+* @return The first slot of the run, or nullptr if the buffer is full.
+*/
+template <class T> T* RingBuffer<T>::reserve(unsigned int* count) {
+  unsigned int w    = __atomic_load_n(&_w, __ATOMIC_RELAXED);
+  unsigned int room = capacity() - (w - __atomic_load_n(&_r, __ATOMIC_ACQUIRE));
+  unsigned int idx  = w & _mask;
+  unsigned int run  = capacity() - idx;
+  *count = (run < room) ? run : room;
+  return (0 == *count) ? nullptr : &_pool[idx];
+}
+
+
+/**
+* @param  count  How many of the reserved slots were filled.
+*/
+template <class T> void RingBuffer<T>::commit(unsigned int count) {
+  __atomic_store_n(&_w, __atomic_load_n(&_w, __ATOMIC_RELAXED) + count, __ATOMIC_RELEASE);
 }
 
 
 template <class T> T RingBuffer<T>::get() {
-  if (element_count == 0) {
-    return (T)0;
-  }
-  T *return_value = (T*) (root + (first_element * size_of_element));
-  first_element = ((first_element + 1) % capacity);
-  element_count--;
-  return *return_value;
+  T return_value = (T) 0;
+  get(&return_value);
+  return return_value;
 }
 
+
 template <class T> int RingBuffer<T>::get(T* d) {
-  int return_value = 0;
-  if (element_count == 0) {
+  unsigned int r = __atomic_load_n(&_r, __ATOMIC_RELAXED);
+  if (__atomic_load_n(&_w, __ATOMIC_ACQUIRE) == r) {
     return -1;
   }
-  unsigned int offset = size_of_element * first_element;
-  for (unsigned int i = 0; i < size_of_element; i++) {
-    *((unsigned char*)d + i) = *((unsigned char*) root + offset + i);
-    return_value++;
-  }
-  first_element = ((first_element + 1) % capacity);
-  element_count--;
-  return return_value;
+  memcpy(d, &_pool[r & _mask], sizeof(T));
+  __atomic_store_n(&_r, r + 1, __ATOMIC_RELEASE);
+  return 0;
 }
+
+
+/**
+* Copies out as many elements as are pending, up to the given limit.
+*
+* @param  dest   Where to put them.
+* @param  count  The most that dest can take.
+* @return How many were written to dest.
+*/
+template <class T> unsigned int RingBuffer<T>::get(T* dest, unsigned int count) {
+  unsigned int r     = __atomic_load_n(&_r, __ATOMIC_RELAXED);
+  unsigned int avail = __atomic_load_n(&_w, __ATOMIC_ACQUIRE) - r;
+  if (count > avail) count = avail;
+  unsigned int idx   = r & _mask;
+  unsigned int first = capacity() - idx;   // Elements before the wrap.
+  if (first > count) first = count;
+  memcpy(dest, &_pool[idx], sizeof(T) * first);
+  memcpy(dest + first, _pool, sizeof(T) * (count - first));
+  __atomic_store_n(&_r, r + count, __ATOMIC_RELEASE);
+  return count;
+}
+
+
+/**
+* Hands out the longest contiguous run of pending elements, to be read in
+*   place. They stay in the buffer until consume().
+*
+* @param  count  Set to the length of the run.
+* @return The first element of the run, or nullptr if the buffer is empty.
+*/
+template <class T> T* RingBuffer<T>::peek(unsigned int* count) {
+  unsigned int r     = __atomic_load_n(&_r, __ATOMIC_RELAXED);
+  unsigned int avail = __atomic_load_n(&_w, __ATOMIC_ACQUIRE) - r;
+  unsigned int idx   = r & _mask;
+  unsigned int run   = capacity() - idx;
+  *count = (run < avail) ? run : avail;
+  return (0 == *count) ? nullptr : &_pool[idx];
+}
+
+
+/**
+* @param  count  How many of the peeked elements are done with.
+*/
+template <class T> void RingBuffer<T>::consume(unsigned int count) {
+  __atomic_store_n(&_r, __atomic_load_n(&_r, __ATOMIC_RELAXED) + count, __ATOMIC_RELEASE);
+}
+
+#endif  // __MANUVR_RING_BUFFER_H__
@@ -105,10 +105,16 @@ void StringBuilder::printBuffer(StringBuilder* output, uint8_t* buf, unsigned in
 * Vanilla constructor.
 */
 StringBuilder::StringBuilder() {
-  root        = nullptr;
-  str         = nullptr;
-  col_length  = 0;
-  preserve_ll = false;
+  root         = nullptr;
+  _tail        = nullptr;
+  str          = nullptr;
+  col_length   = 0;
+  preserve_ll  = false;
+  _chunks      = nullptr;
+  _current     = nullptr;
+  _inline_live = 0;
+  _arena_ptr   = _inline;
+  _arena_end   = _inline + STRINGBUILDER_INLINE_BYTES;
   #if defined(__BUILD_HAS_PTHREADS)
     #if defined (PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP)
     _mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
@@ -139,12 +145,7 @@ StringBuilder::StringBuilder(const char* initial) : StringBuilder() {
 */
 StringBuilder::~StringBuilder() {
   if (!this->preserve_ll) {
-    if (this->root != nullptr) destroyStrLL(this->root);
-
-    if (this->str != nullptr) {
-      free(this->str);
-      this->str = nullptr;
-    }
+    clear();
   }
   #if defined(__BUILD_HAS_PTHREADS)
     pthread_mutex_destroy(&_mutex);
@@ -154,6 +155,249 @@ StringBuilder::~StringBuilder() {
 }
 
 
+/****************************************************************************************************
+* The arena. Nothing outside of this block should call malloc() or free() on our behalf, apart from *
+*   the buffers that are handed to us with concatHandoff().                                        *
+****************************************************************************************************/
+
+/**
+* Takes memory from the arena. Every allocation counts against the chunk it
+*   came from, and must be given back with _release().
+*
+* @param  len    How many bytes.
+* @param  align  A power of two.
+* @return The memory, or nullptr if the heap is exhausted.
+*/
+void* StringBuilder::_alloc(int len, int align) {
+  uint8_t* p = (uint8_t*) ((((uintptr_t) _arena_ptr) + (align - 1)) & ~((uintptr_t) (align - 1)));
+  if ((p > _arena_end) || ((_arena_end - p) < len)) {
+    if (!_grow(len + align)) return nullptr;
+    p = (uint8_t*) ((((uintptr_t) _arena_ptr) + (align - 1)) & ~((uintptr_t) (align - 1)));
+  }
+  _arena_ptr = p + len;
+  if (nullptr == _current) {
+    _inline_live++;
+  }
+  else {
+    _current->live++;
+  }
+  return p;
+}
+
+
+/**
+* Gives back something that came from _alloc(). When a chunk has nothing left in
+*   use, it is either rewound (if we are still filling it) or freed.
+*
+* @param  p  Any address within the allocation.
+*/
+void StringBuilder::_release(void* p) {
+  if (_in_inline(p)) {
+    if ((0 == --_inline_live) && (nullptr == _current)) {
+      _arena_ptr = _inline;
+    }
+    return;
+  }
+  StrChunk* prior = nullptr;
+  StrChunk* chunk = _chunks;
+  while (nullptr != chunk) {
+    uint8_t* base = (uint8_t*) (chunk + 1);
+    if ((((uint8_t*) p) >= base) && (((uint8_t*) p) < (base + chunk->size))) {
+      if (0 == --chunk->live) {
+        if (chunk == _current) {
+          _arena_ptr = base;
+        }
+        else {
+          if (nullptr == prior) _chunks = chunk->next;
+          else prior->next = chunk->next;
+          free(chunk);
+        }
+      }
+      return;
+    }
+    prior = chunk;
+    chunk = chunk->next;
+  }
+}
+
+
+/**
+* Starts a new chunk, each twice the size of the last, so that the number of
+*   trips to the heap is logarithmic in the length of the string.
+*
+* @param  len  The new chunk must hold at least this many bytes.
+* @return true on success. False if the heap is exhausted.
+*/
+bool StringBuilder::_grow(int len) {
+  int size = (nullptr == _current) ? (STRINGBUILDER_INLINE_BYTES * 2) : (_current->size * 2);
+  if (size > STRINGBUILDER_CHUNK_MAX) size = STRINGBUILDER_CHUNK_MAX;
+  if (size < len) size = len;
+  StrChunk* nu = (StrChunk*) malloc(sizeof(StrChunk) + size);
+  if (nullptr == nu) return false;
+  nu->size = size;
+  nu->live = 0;
+  nu->next = _chunks;
+  _chunks  = nu;
+
+  // The chunk we were filling might have nothing left in it.
+  StrChunk* old = _current;
+  _current   = nu;
+  _arena_ptr = (uint8_t*) (nu + 1);
+  _arena_end = _arena_ptr + size;
+  if ((nullptr != old) && (0 == old->live)) {
+    StrChunk* prior = nu;
+    while (prior->next != old) prior = prior->next;
+    prior->next = old->next;
+    free(old);
+  }
+  return true;
+}
+
+
+/**
+* Frees every chunk, and goes back to filling the inline buffer. Whatever
+*   pointed into the arena is garbage after this.
+*/
+void StringBuilder::_free_arena() {
+  while (nullptr != _chunks) {
+    StrChunk* next = _chunks->next;
+    free(_chunks);
+    _chunks = next;
+  }
+  _current     = nullptr;
+  _inline_live = 0;
+  _arena_ptr   = _inline;
+  _arena_end   = _inline + STRINGBUILDER_INLINE_BYTES;
+}
+
+
+/**
+* @return A new list element from the arena, not yet in the list.
+*/
+StrLL* StringBuilder::_new_node(unsigned char* buf, int len, bool reap) {
+  StrLL* nu = (StrLL*) _alloc(sizeof(StrLL), sizeof(void*));
+  if (nullptr != nu) {
+    nu->str    = buf;
+    nu->next   = nullptr;
+    nu->mem    = nullptr;
+    nu->len    = len;
+    nu->reap   = reap;
+    nu->sealed = false;
+  }
+  return nu;
+}
+
+
+/**
+* Frees a list element and its string (if it is ours). Does not unlink it.
+*/
+void StringBuilder::_drop_node(StrLL* node) {
+  if (node->reap) {
+    if (nullptr != node->mem) free(node->mem);
+    else _release(node->str);
+  }
+  _release(node);
+}
+
+
+/**
+* Copies a string onto the end.
+*
+* @param  nu     The string.
+* @param  len    Its length.
+* @param  merge  If false, the string will be a list element of its own, and
+*                nothing appended later will be merged into it.
+*/
+void StringBuilder::_append(unsigned char* nu, int len, bool merge) {
+  if (merge && _mergeable(len)) {
+    // The last fragment ends where the arena does. Just extend it.
+    memcpy(_tail->str + _tail->len, nu, len);
+    _tail->len += len;
+    *(_tail->str + _tail->len) = '\0';
+    _arena_ptr += len;
+    return;
+  }
+  StrLL* nu_element = _new_node(nullptr, len, true);
+  if (nullptr != nu_element) {
+    // Allocated after the node, so that it is last in the arena, and can grow.
+    nu_element->sealed = !merge;
+    nu_element->str = (uint8_t*) _alloc(len + 1, 1);
+    if (nullptr != nu_element->str) {
+      memcpy(nu_element->str, nu, len);
+      *(nu_element->str + len) = '\0';
+      this->stackStrOntoList(nu_element);
+    }
+    else {
+      _release(nu_element);
+    }
+  }
+}
+
+
+/**
+* Takes every fragment from another instance. Fragments in the donor's heap
+*   chunks are taken along with the chunks themselves, without copying. Only
+*   what was in the donor's inline buffer is copied. The donor is left empty.
+*
+* @param  donor  The instance to empty.
+* @param  tail   Receives the last element of the returned list.
+* @return The first element of the list, which is not yet linked into ours.
+*/
+StrLL* StringBuilder::_adopt(StringBuilder* donor, StrLL** tail) {
+  StrLL* head = nullptr;
+  StrLL* last = nullptr;
+  donor->promote_collapsed_into_ll();
+
+  // The donor's chunks become ours. We won't fill them, but we will free them.
+  while (nullptr != donor->_chunks) {
+    StrChunk* chunk = donor->_chunks;
+    donor->_chunks = chunk->next;
+    if (0 == chunk->live) {
+      free(chunk);
+    }
+    else {
+      chunk->next = _chunks;
+      _chunks     = chunk;
+    }
+  }
+  // Whatever was in the donor's inline buffer has to be copied.
+  StrLL* current = donor->root;
+  while (nullptr != current) {
+    StrLL* next  = current->next;
+    StrLL* taken = current;
+    if (donor->_in_inline(current)) {
+      taken = _new_node(current->str, current->len, current->reap);
+      if (nullptr != taken) taken->mem = current->mem;
+    }
+    if ((nullptr != taken) && current->reap && (nullptr == current->mem) && donor->_in_inline(current->str)) {
+      uint8_t* copy = (uint8_t*) _alloc(current->len + 1, 1);
+      if (nullptr != copy) {
+        memcpy(copy, current->str, current->len);
+        *(copy + current->len) = '\0';
+        taken->str = copy;
+      }
+      else {
+        _release(taken);
+        taken = nullptr;
+      }
+    }
+    if (nullptr != taken) {
+      taken->next   = nullptr;
+      taken->sealed = true;   // The donor's fragments stay as the donor left them.
+      if (nullptr == last) head = taken;
+      else last->next = taken;
+      last = taken;
+    }
+    current = next;
+  }
+  donor->root     = nullptr;
+  donor->_tail    = nullptr;
+  donor->_free_arena();   // Only the inline buffer is left to reset.
+  *tail = last;
+  return head;
+}
+
+
 /****************************************************************************************************
 *                                                                                                   *
 ****************************************************************************************************/
@@ -193,7 +437,8 @@ unsigned short StringBuilder::count() {
 unsigned char* StringBuilder::string() {
   if ((this->str == nullptr) && (this->root == nullptr)) {
     // Nothing in this object. Return a zero-length string.
-    this->str = (uint8_t*) malloc(1);
+    this->str = (uint8_t*) _alloc(1, 1);
+    if (nullptr == this->str) return (uint8_t*) "";
     this->str[0] = '\0';
     this->col_length  = 0;
   }
@@ -212,11 +457,15 @@ void StringBuilder::clear() {
     //pthread_mutex_lock(&_mutex);
   #elif defined(__BUILD_HAS_FREERTOS)
   #endif
-  if (this->root != nullptr) destroyStrLL(this->root);
-  if (this->str != nullptr) {
-    free(this->str);
+  // Only the buffers handed to us need to be freed one at a time.
+  StrLL *current = this->root;
+  while (nullptr != current) {
+    if (current->reap && (nullptr != current->mem)) free(current->mem);
+    current = current->next;
   }
+  _free_arena();
   this->root   = nullptr;
+  this->_tail  = nullptr;
   this->str    = nullptr;
   this->col_length = 0;
   #if defined(__BUILD_HAS_PTHREADS)
@@ -354,6 +603,7 @@ char* StringBuilder::position_trimmed(int pos){
 }
 
 
+
 /**
 * Returns true on success, false on failure.
 */
@@ -361,7 +611,7 @@ bool StringBuilder::drop_position(unsigned int pos) {
   if (this->str != nullptr) {
     if (pos == 0) {
       this->col_length = 0;
-      free(this->str);
+      _release(this->str);
       this->str = nullptr;
       return true;
     }
@@ -378,14 +628,13 @@ bool StringBuilder::drop_position(unsigned int pos) {
   if (current != nullptr) {
     if (prior == nullptr) {
       this->root = current->next;
-      current->next = nullptr;
-      destroyStrLL(current);
     }
     else {
       prior->next = current->next;
-      current->next = nullptr;
-      destroyStrLL(current);
     }
+    if (current == this->_tail) this->_tail = prior;
+    current->next = nullptr;
+    destroyStrLL(current);
     return true;
   }
   return false;
@@ -394,10 +643,9 @@ bool StringBuilder::drop_position(unsigned int pos) {
 
 /**
 * This fxn is meant to hand off accumulated string data to us from the StringBuilder
-*   that is passed in as the parameter. This is very fast, but doesn't actually copy
-*   any data. So to eliminate the chance of dangling pointers and other
-*   difficult-to-trace bugs, we modify the donor SB to prevent its destruction from
-*   taking the data we now have with it.
+*   that is passed in as the parameter. Whatever the donor had on the heap is taken
+*   without copying. So to eliminate the chance of dangling pointers and other
+*   difficult-to-trace bugs, the donor is left empty.
 */
 void StringBuilder::concatHandoff(StringBuilder *nu) {
   #if defined(__BUILD_HAS_PTHREADS)
@@ -408,11 +656,10 @@ void StringBuilder::concatHandoff(StringBuilder *nu) {
     //xSemaphoreTakeRecursive(&nu->_mutex, 0);
   #endif
   if ((nullptr != nu) && (nu->length() > 0)) {
-    nu->promote_collapsed_into_ll();   // Promote the previously-collapsed string.
-
-    if (nullptr != nu->root) {
-      this->stackStrOntoList(nu->root);
-      nu->root = nullptr;  // Inform the origin instance...
+    StrLL* nu_tail = nullptr;
+    StrLL* nu_root = _adopt(nu, &nu_tail);
+    if (nullptr != nu_root) {
+      this->stackStrOntoList(nu_root);
     }
   }
   #if defined(__BUILD_HAS_PTHREADS)
@@ -447,16 +694,13 @@ void StringBuilder::prependHandoff(StringBuilder *nu) {
     #endif
     this->root = promote_collapsed_into_ll();   // Promote the previously-collapsed string.
 
-    // Promote the donor instance's previously-collapsed string so we don't have to worry about it.
-    StrLL *current = nu->promote_collapsed_into_ll();
+    StrLL* nu_tail = nullptr;
+    StrLL* nu_root = _adopt(nu, &nu_tail);
 
-    if (nullptr != nu->root) {
-      // Scan to the end of the donated LL...
-      while (nullptr != current->next) {   current = current->next;  }
-
-      current->next = this->root;  // ...and tack our existing list to the end of it.
-      this->root = nu->root;       // ...replace our idea of the root.
-      nu->root = nullptr;             // Inform the origin instance so it doesn't free what we just took.
+    if (nullptr != nu_root) {
+      nu_tail->next = this->root;  // ...and tack our existing list to the end of it.
+      this->root = nu_root;        // ...replace our idea of the root.
+      if (nullptr == this->_tail) this->_tail = nu_tail;
     }
     #if defined(__BUILD_HAS_PTHREADS)
       //pthread_mutex_unlock(&nu->_mutex);
@@ -477,12 +721,9 @@ void StringBuilder::concatHandoff(uint8_t* buf, int len) {
       //pthread_mutex_lock(&_mutex);
     #elif defined(__BUILD_HAS_FREERTOS)
     #endif
-    StrLL *nu_element = (StrLL *) malloc(sizeof(StrLL));
+    StrLL *nu_element = _new_node(buf, len, true);
     if (nu_element) {
-      nu_element->reap = true;
-      nu_element->next = nullptr;
-      nu_element->len  = len;
-      nu_element->str  = buf;
+      nu_element->mem = buf;
       this->stackStrOntoList(nu_element);
     }
     #if defined(__BUILD_HAS_PTHREADS)
@@ -500,17 +741,19 @@ void StringBuilder::concatHandoff(uint8_t* buf, int len) {
 * Always returns a pointer to the root of the LL. Changed or otherwise.
 */
 StrLL* StringBuilder::promote_collapsed_into_ll(void) {
-  if ((nullptr != str) && (col_length > 0)) {
-    StrLL *nu_element = (StrLL *) malloc(sizeof(StrLL));
-    if (nullptr != nu_element) {   // This is going to grief us later...
-      nu_element->reap = true;
+  if (nullptr != str) {
+    if (col_length > 0) {
+      StrLL *nu_element = _new_node(this->str, this->col_length, true);
+      if (nullptr == nu_element) return this->root;   // This is going to grief us later...
       nu_element->next = this->root;
       this->root = nu_element;
-      nu_element->str = this->str;
-      nu_element->len = this->col_length;
-      this->str = nullptr;
-      this->col_length = 0;
+      if (nullptr == this->_tail) this->_tail = nu_element;
+    }
+    else {
+      _release(this->str);
     }
+    this->str = nullptr;
+    this->col_length = 0;
   }
   return this->root;
 }
@@ -522,22 +765,21 @@ void StringBuilder::prepend(uint8_t*nu, int len) {
   if ((nullptr != nu) && (len > 0)) {
     this->root = promote_collapsed_into_ll();   // Promote the previously-collapsed string.
 
-    StrLL *nu_element = (StrLL *) malloc(sizeof(StrLL));
+    StrLL *nu_element = _new_node(nullptr, len, true);
     if (nullptr == nu_element) return;   // O no.
-    nu_element->reap = true;
-    nu_element->len  = len;
-    nu_element->str  = (uint8_t*) malloc(len+1);
+    nu_element->str = (uint8_t*) _alloc(len+1, 1);
     if (nu_element->str != nullptr) {
       *(nu_element->str + len) = '\0';
       memcpy(nu_element->str, nu, len);
       nu_element->next = this->root;
       this->root = nu_element;
+      if (nullptr == this->_tail) this->_tail = nu_element;
     }
     else {
-      // We were able to malloc the slot for the string, but not the buffer for
-      // the string itself. We should free() the slot before failing or we will
+      // We were able to get the slot for the string, but not the buffer for
+      // the string itself. We should give back the slot before failing or we will
       // exacerbate an already-present memory crunch.
-      free(nu_element);
+      _release(nu_element);
     }
   }
 }
@@ -554,9 +796,9 @@ void StringBuilder::prepend(const char *nu) {
 */
 int StringBuilder::totalStrLen(StrLL *node) {
   int len  = 0;
-  if (node != nullptr) {
-    len  = this->totalStrLen(node->next);
+  while (node != nullptr) {
     if (node->str != nullptr)  len  = len + node->len;
+    node = node->next;
   }
   return len;
 }
@@ -568,18 +810,7 @@ void StringBuilder::concat(uint8_t*nu, int len) {
       //pthread_mutex_lock(&_mutex);
     #elif defined(__BUILD_HAS_FREERTOS)
     #endif
-    StrLL *nu_element = (StrLL *) malloc(sizeof(StrLL));
-    if (nu_element != nullptr) {
-      nu_element->reap = true;
-      nu_element->next = nullptr;
-      nu_element->len  = len;
-      nu_element->str  = (uint8_t*) malloc(len+1);
-      if (nu_element->str != nullptr) {
-        *(nu_element->str + len) = '\0';
-        memcpy(nu_element->str, nu, len);
-        this->stackStrOntoList(nu_element);
-      }
-    }
+    _append(nu, len, true);
     #if defined(__BUILD_HAS_PTHREADS)
       //pthread_mutex_unlock(&_mutex);
     #elif defined(__BUILD_HAS_FREERTOS)
@@ -590,8 +821,10 @@ void StringBuilder::concat(uint8_t*nu, int len) {
 
 /**
 * Override to make best use of memory for const strings...
+* If the string fits at the end of the last fragment, it is copied there, since
+*   that costs less than a list element. Otherwise, we keep only the pointer.
 *
-* Crash warning: Any const char* concat'd to a StringBuilder will not be copied
+* Crash warning: Any const char* concat'd to a StringBuilder might not be copied
 *   until it is manipulated somehow. So be very careful if you cast to (const char*).
 */
 void StringBuilder::concat(const char *nu) {
@@ -602,13 +835,14 @@ void StringBuilder::concat(const char *nu) {
         //pthread_mutex_lock(&_mutex);
       #elif defined(__BUILD_HAS_FREERTOS)
       #endif
-      StrLL *nu_element = (StrLL *) malloc(sizeof(StrLL));
-      if (nu_element != nullptr) {
-        nu_element->reap = false;
-        nu_element->next = nullptr;
-        nu_element->len  = len;
-        nu_element->str  = (uint8_t*) nu;
-        this->stackStrOntoList(nu_element);
+      if (_mergeable(len)) {
+        _append((uint8_t*) nu, len, true);
+      }
+      else {
+        StrLL *nu_element = _new_node((uint8_t*) nu, len, false);
+        if (nu_element != nullptr) {
+          this->stackStrOntoList(nu_element);
+        }
       }
       #if defined(__BUILD_HAS_PTHREADS)
         //pthread_mutex_unlock(&_mutex);
@@ -620,33 +854,19 @@ void StringBuilder::concat(const char *nu) {
 
 
 void StringBuilder::concat(unsigned char nu) {
-  unsigned char* temp = (uint8_t*) alloca(1);
-  *(temp) = nu;
-  this->concat(temp, 1);
+  this->concat(&nu, 1);
 }
 void StringBuilder::concat(char nu) {
-  char* temp = (char *) alloca(2);
-  *(temp) = nu;
-  *(temp+1) = 0;
-  this->concat(temp);
+  this->concat((uint8_t*) &nu, 1);
 }
 void StringBuilder::concat(int nu) {
-  char * temp = (char *) alloca(12);
-  memset(temp, 0x00, 12);
-  sprintf(temp, "%d", nu);
-  this->concat(temp);
+  this->concatf("%d", nu);
 }
 void StringBuilder::concat(unsigned int nu) {
-  char * temp = (char *) alloca(12);
-  memset(temp, 0x00, 12);
-  sprintf(temp, "%u", nu);
-  this->concat(temp);
+  this->concatf("%u", nu);
 }
 void StringBuilder::concat(double nu) {
-  char * temp = (char *) alloca(16);
-  memset(temp, 0x00, 16);
-  sprintf(temp, "%f", nu);
-  this->concat(temp);
+  this->concatf("%f", nu);
 }
 
 /**
@@ -661,22 +881,58 @@ void StringBuilder::concat(StringBuilder *nu) {
 }
 
 /**
-* Variadic. No mutex required because all working memory is confined to stack.
+* Variadic. Formats directly into the arena. If the output fits at the end of the
+*   last fragment, that is where it goes. Otherwise, we learn how long it is from
+*   the first attempt, and format it once more into a space of the right size.
 */
 int StringBuilder::concatf(const char *format, ...) {
-  int len = strlen(format);
-  unsigned short f_codes = 0;  // Count how many format codes are in use...
-  for (unsigned short i = 0; i < len; i++) {  if (*(format+i) == '%') f_codes++; }
   va_list args;
-  // Allocate (hopefully) more space than we will need....
-  int est_len = len + 640 + (f_codes * 15);
-  char *temp = (char *) alloca(est_len);
-  memset(temp, 0, est_len);
+  va_list retry;
   int ret = 0;
   va_start(args, format);
-  ret = vsprintf(temp, format, args);
+  va_copy(retry, args);
+  if (nullptr != _tail && _mergeable(0)) {
+    uint8_t* dst = _tail->str + _tail->len;
+    ret = vsnprintf((char*) dst, (_arena_end - dst), format, args);
+    if ((ret >= 0) && (ret < (_arena_end - dst))) {
+      _tail->len += ret;
+      _arena_ptr += ret;
+      va_end(retry);
+      va_end(args);
+      return ret;
+    }
+    *dst = '\0';   // Didn't fit. Restore the terminator.
+  }
+  else {
+    // Try where a new fragment would land, just past its list element.
+    uint8_t* node = (uint8_t*) ((((uintptr_t) _arena_ptr) + (sizeof(void*) - 1)) & ~((uintptr_t) (sizeof(void*) - 1)));
+    uint8_t* dst  = node + sizeof(StrLL);
+    int room = (dst < _arena_end) ? (_arena_end - dst) : 0;
+    ret = vsnprintf((char*) dst, room, format, args);
+    if ((ret > 0) && (ret < room)) {
+      StrLL* nu_element = _new_node(nullptr, ret, true);
+      nu_element->str = (uint8_t*) _alloc(ret + 1, 1);   // Lands on what we already wrote.
+      this->stackStrOntoList(nu_element);
+      va_end(retry);
+      va_end(args);
+      return ret;
+    }
+  }
   va_end(args);
-  if (ret > 0) this->concat((char *) temp);
+  if (ret > 0) {
+    StrLL* nu_element = _new_node(nullptr, ret, true);
+    if (nullptr != nu_element) {
+      nu_element->str = (uint8_t*) _alloc(ret + 1, 1);
+      if (nullptr != nu_element->str) {
+        vsnprintf((char*) nu_element->str, ret + 1, format, retry);
+        this->stackStrOntoList(nu_element);
+      }
+      else {
+        _release(nu_element);
+      }
+    }
+  }
+  va_end(retry);
   return ret;
 }
 
@@ -706,16 +962,15 @@ void StringBuilder::cull(int offset, int length) {
     //pthread_mutex_lock(&_mutex);
   #elif defined(__BUILD_HAS_FREERTOS)
   #endif
-  if (this->length() >= (length-offset)) {   // Does the given range exist?
-    int remaining_length = length-offset;
-    unsigned char* temp = (unsigned char*) malloc(remaining_length+1);  // + 1 for null-terminator.
-    if (temp != nullptr) {
-      *(temp + remaining_length) = '\0';
-      this->collapseIntoBuffer();   // Room to optimize here...
-      memcpy(temp, this->str, remaining_length);
-      this->clear();         // Throw away all else.
-      this->str = temp;      // Replace our ref.
+  if ((offset >= 0) && (length >= 0) && (this->length() >= (offset + length))) {   // Does the given range exist?
+    if (0 == length) {
+      this->clear();
+    }
+    else {
+      this->cull(offset);
+      this->collapseIntoBuffer();
       this->col_length = length;
+      *(this->str + length) = '\0';
     }
   }
   #if defined(__BUILD_HAS_PTHREADS)
@@ -727,6 +982,8 @@ void StringBuilder::cull(int offset, int length) {
 
 /*
 * Given a character count (x), will throw away the first x characters and adjust the object appropriately.
+* Does not collapse the string, and does not move any bytes. Whole fragments are
+*   released, and the fragment that straddles the cut just begins later.
 */
 void StringBuilder::cull(int x) {
   #if defined(__BUILD_HAS_PTHREADS)
@@ -736,16 +993,35 @@ void StringBuilder::cull(int x) {
   if (x == this->length()) {
     clear();
   }
-  else if (this->length() > x) {   // Does the given range exist?
-    int remaining_length = this->length()-x;
-    unsigned char* temp = (unsigned char*) malloc(remaining_length+1);  // + 1 for null-terminator.
-    if (temp != nullptr) {
-      *(temp + remaining_length) = '\0';
-      this->collapseIntoBuffer();   // Room to optimize here...
-      memcpy(temp, (unsigned char*)(this->str + x), remaining_length);
-      this->clear();         // Throw away all else.
-      this->str = temp;      // Replace our ref.
-      this->col_length = remaining_length;
+  else if ((x > 0) && (this->length() > x)) {   // Does the given range exist?
+    if (nullptr != this->str) {
+      // The collapsed string is logically first.
+      if (x >= this->col_length) {
+        x -= this->col_length;
+        _release(this->str);
+        this->str = nullptr;
+        this->col_length = 0;
+      }
+      else {
+        this->str        += x;
+        this->col_length -= x;
+        x = 0;
+      }
+    }
+    while ((x > 0) && (nullptr != this->root)) {
+      StrLL *current = this->root;
+      if (x >= current->len) {
+        x -= current->len;
+        this->root = current->next;
+        if (current == this->_tail) this->_tail = nullptr;
+        current->next = nullptr;
+        destroyStrLL(current);
+      }
+      else {
+        current->str += x;
+        current->len -= x;
+        x = 0;
+      }
     }
   }
   #if defined(__BUILD_HAS_PTHREADS)
@@ -776,35 +1052,27 @@ bool StringBuilder::contains(char test) {
 }
 
 
-StrLL* StringBuilder::stackStrOntoList(StrLL *current, StrLL *nu) {
-  if (current != nullptr) {
-    if (current->next == nullptr) current->next = nu;
-    else this->stackStrOntoList(current->next, nu);
-  }
-  return current;
-}
-
 /*
-* Non-recursive override to make additions less cumbersome.
+* Adds an element (or a chain of them) to the end of the list.
 */
 StrLL* StringBuilder::stackStrOntoList(StrLL *nu) {
-  StrLL* return_value = nullptr;
   #if defined(__BUILD_HAS_PTHREADS)
     //pthread_mutex_lock(&_mutex);
   #elif defined(__BUILD_HAS_FREERTOS)
   #endif
   if (this->root == nullptr) {
     this->root  = nu;
-    return_value = this->root;
   }
   else {
-    return_value = this->stackStrOntoList(this->root, nu);
+    this->_tail->next = nu;
   }
+  while (nullptr != nu->next) nu = nu->next;
+  this->_tail = nu;
   #if defined(__BUILD_HAS_PTHREADS)
     //pthread_mutex_unlock(&_mutex);
   #elif defined(__BUILD_HAS_FREERTOS)
   #endif
-  return return_value;
+  return this->root;
 }
 
 
@@ -813,30 +1081,46 @@ StrLL* StringBuilder::stackStrOntoList(StrLL *nu) {
 * Traverse the list and keep appending strings to the buffer.
 * Will prepend the str buffer if it is not nullptr.
 * Updates the length.
+* If there is only one fragment, and it is ours, it becomes the collapsed
+*   string without being copied.
 */
 void StringBuilder::collapseIntoBuffer() {
   #if defined(__BUILD_HAS_PTHREADS)
     //pthread_mutex_lock(&_mutex);
   #elif defined(__BUILD_HAS_FREERTOS)
   #endif
-  StrLL *current = promote_collapsed_into_ll();   // Promote the previously-collapsed string.
-  if (current != nullptr) {
-    this->col_length = this->totalStrLen(this->root);
-    if (this->col_length > 0) {
-      this->str = (uint8_t*) malloc(this->col_length + 1);
-      if (this->str != nullptr) {
-        *(this->str + this->col_length) = '\0';
+  if (nullptr != this->root) {
+    StrLL *current = this->root;
+    if ((nullptr == this->str) && (current == this->_tail) && current->reap && (nullptr == current->mem)) {
+      this->str        = current->str;
+      this->col_length = current->len;
+      _release(current);
+      this->root  = nullptr;
+      this->_tail = nullptr;
+    }
+    else {
+      int total = this->col_length + this->totalStrLen(this->root);
+      uint8_t* nu = (uint8_t*) _alloc(total + 1, 1);
+      if (nu != nullptr) {
+        *(nu + total) = '\0';
         int tmp_len = 0;
+        if (nullptr != this->str) {
+          memcpy(nu, this->str, this->col_length);
+          tmp_len = this->col_length;
+          _release(this->str);
+        }
         while (current != nullptr) {
           if (current->str != nullptr) {
-            memcpy((void *)(this->str + tmp_len), (void *)(current->str), current->len);
+            memcpy((void *)(nu + tmp_len), (void *)(current->str), current->len);
             tmp_len = tmp_len + current->len;
           }
           current = current->next;
         }
+        this->destroyStrLL(this->root);
+        this->str        = nu;
+        this->col_length = total;
       }
     }
-    this->destroyStrLL(this->root);
   }
   #if defined(__BUILD_HAS_PTHREADS)
     //pthread_mutex_unlock(&_mutex);
@@ -845,22 +1129,56 @@ void StringBuilder::collapseIntoBuffer() {
 }
 
 
+#if defined(__MANUVR_LINUX)
+/**
+* Describes our content as a list of (pointer, length) pairs, in order, without
+*   collapsing it. The pointers remain ours, and are only good until this object
+*   is next changed.
+* If there are more fragments than will fit, only the first ones are exported,
+*   and the caller can tell by comparing the sum of the lengths to length().
+*
+* @param  vecs  The array to fill.
+* @param  max   How many elements the array has room for.
+* @return The number of elements that were filled.
+*/
+int StringBuilder::toIovec(struct iovec* vecs, int max) {
+  int i = 0;
+  if ((nullptr != this->str) && (this->col_length > 0) && (i < max)) {
+    vecs[i].iov_base = this->str;
+    vecs[i].iov_len  = this->col_length;
+    i++;
+  }
+  StrLL *current = this->root;
+  while ((nullptr != current) && (i < max)) {
+    if ((nullptr != current->str) && (current->len > 0)) {
+      vecs[i].iov_base = current->str;
+      vecs[i].iov_len  = current->len;
+      i++;
+    }
+    current = current->next;
+  }
+  return i;
+}
+#endif
+
+
 /**
-* Clean up after ourselves. Assumes that everything has been malloc'd into existance.
+* Clean up after ourselves. Releases every element in the chain, and the strings
+*   that they own.
 */
 void StringBuilder::destroyStrLL(StrLL *r_node) {
   #if defined(__BUILD_HAS_PTHREADS)
     //pthread_mutex_lock(&_mutex);
   #elif defined(__BUILD_HAS_FREERTOS)
   #endif
-  if (r_node != nullptr) {
-    if (r_node->next != nullptr) {
-      destroyStrLL(r_node->next);
-      r_node->next  = nullptr;
-    }
-    if (r_node->reap) free(r_node->str);
-    free(r_node);
-    if (r_node == this->root) this->root = nullptr;
+  if (r_node == this->root) {
+    this->root  = nullptr;
+    this->_tail = nullptr;
+  }
+  while (r_node != nullptr) {
+    StrLL* next = r_node->next;
+    _drop_node(r_node);
+    r_node = next;
   }
   #if defined(__BUILD_HAS_PTHREADS)
     //pthread_mutex_unlock(&_mutex);
@@ -907,11 +1225,11 @@ int StringBuilder::split(const char *delims) {
   char *temp_str  = strtok((char *)this->str, delims);
   if (temp_str != nullptr) {
     while (temp_str != nullptr) {
-      this->concat(temp_str);
+      _append((uint8_t*) temp_str, strlen(temp_str), false);   // Never merge tokens.
       return_value++;
       temp_str  = strtok(nullptr, delims);
     }
-    free(this->str);
+    _release(this->str);
     this->str = nullptr;
     this->col_length = 0;
   }
@@ -937,12 +1255,12 @@ int StringBuilder::split(const char *delims) {
 */
 void StringBuilder::null_term_check() {
   if (this->str != nullptr) {
-    if (*(this->str + (this->col_length-1)) != '\0') {
-      uint8_t*temp = (uint8_t*) malloc(this->col_length+1);
+    if (*(this->str + this->col_length) != '\0') {
+      uint8_t*temp = (uint8_t*) _alloc(this->col_length+1, 1);
       if (temp != nullptr) {
         *(temp + this->col_length) = '\0';
         memcpy(temp, this->str, this->col_length);
-        free(this->str);
+        _release(this->str);
         this->str = temp;
       }
     }
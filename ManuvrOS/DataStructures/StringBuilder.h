@@ -27,6 +27,10 @@ limitations under the License.
 #include <stdarg.h>
 #include <string.h>
 
+#if defined(__MANUVR_LINUX)
+  #include <sys/uio.h>
+#endif
+
 #if defined(__BUILD_HAS_PTHREADS)
   #include <pthread.h>
 #elif defined(__MANUVR_FREERTOS)
@@ -38,31 +42,58 @@ limitations under the License.
 int strcasestr(char *a, const char *b);
 #endif
 
+/* How many bytes of storage does each StringBuilder carry within itself? */
+#ifndef STRINGBUILDER_INLINE_BYTES
+  #define STRINGBUILDER_INLINE_BYTES  64
+#endif
+
+/* Chunks grow geometrically up to this size, and are only larger on demand. */
+#ifndef STRINGBUILDER_CHUNK_MAX
+  #define STRINGBUILDER_CHUNK_MAX     8192
+#endif
+
 /*
 *	This is a linked-list that is castable as a string.
+* Nodes always live in the StringBuilder's arena.
 */
 typedef struct str_ll_t {
 	unsigned char    *str;   // The string.
 	struct str_ll_t  *next;  // The next element.
+	void             *mem;   // If the string was handed to us from the heap, this is the allocation.
 	int              len;    // The length of this element.
-	bool             reap;   // Should this position be reaped?
+	bool             reap;   // Should this position be reaped? False if the string isn't ours.
+	bool             sealed; // If true, appends must not extend this element. Tokens are sealed.
 } StrLL;
 
+/*
+* A block of arena memory that a StringBuilder allocates from. Its bytes follow
+*   this header.
+*/
+typedef struct str_chunk_t {
+	struct str_chunk_t *next;
+	int                size;  // Bytes of storage after this header.
+	int                live;  // How many allocations within are still in use?
+} StrChunk;
+
 
 
 /*
 * The point of this class is to ease some of the burden of doing string manipulations.
-* This class uses lots of dynamic memory internally. Some of this is exposed as public
-*   members, so care needs to be taken if heap references are to be used directly.
 * There are two modes that this class uses to store strings: collapsed and tokenized.
 * The collapsed mode stores the entire string in the str member with a NULL root.
 * The tokenized mode stores the string as sequential elements in a linked-list.
 * When the full string is requested, the class will collapse the linked-list into the str
 *   member, respecting the fact that part of the string may already have been collapsed into
 *   str, in which case, str will be prepended to the linked-list, and the entire linked-list
-*   then collapsed. Needless to say, this shuffling act might cause the class to more-than
-*   double its memory usage while the string is being reorganized. So be aware of your memory
-*   usage.
+*   then collapsed.
+*
+* Memory comes from an arena that belongs to the instance: a small buffer inside the
+*   object, and then chunks from the heap that double in size as they are needed.
+*   Appends extend the last fragment in place when it sits at the end of the arena, so
+*   a string built from many small pieces is usually one fragment, and flattening it is
+*   free. Chunks are freed when nothing in them remains in use.
+* Pointers returned by string() and position() are only good until this object is
+*   next changed.
 */
 class StringBuilder {
 	public:
@@ -138,6 +169,11 @@ class StringBuilder {
 
 		int cmpBinString(unsigned char *unknown, int len);
 
+    #if defined(__MANUVR_LINUX)
+      /* Zero-copy export of the fragments, in order, for scatter-gather i/o. */
+      int toIovec(struct iovec*, int);
+    #endif
+
 		void printDebug(StringBuilder*);
 
     static void printBuffer(StringBuilder* output, uint8_t* buf, unsigned int len, const char* indent);
@@ -145,10 +181,18 @@ class StringBuilder {
 
 	private:
     StrLL *root;         // The root of the linked-list.
+    StrLL *_tail;        // The last element of the linked-list.
     int col_length;      // The length of the collapsed string.
-    unsigned char* str;  // The collapsed string.
+    unsigned char* str;  // The collapsed string. Always in the arena.
     bool preserve_ll;    // If true, do not reap the linked list in the destructor.
 
+    uint8_t*  _arena_ptr;    // The next free byte in the region we are filling.
+    uint8_t*  _arena_end;    // The end of that region.
+    StrChunk* _chunks;       // Every chunk we have from the heap.
+    StrChunk* _current;      // The chunk we are filling. nullptr means the inline buffer.
+    int       _inline_live;  // Allocations still in use in the inline buffer.
+    uint8_t   _inline[STRINGBUILDER_INLINE_BYTES] __attribute__ ((aligned (8)));
+
     #if defined(__BUILD_HAS_PTHREADS)
       // If we are on linux, we control for concurrency with a mutex...
       pthread_mutex_t _mutex;
@@ -157,11 +201,27 @@ class StringBuilder {
     #endif
 
 		int totalStrLen(StrLL *node);
-		StrLL* stackStrOntoList(StrLL *current, StrLL *nu);
 		StrLL* stackStrOntoList(StrLL *nu);
 		void collapseIntoBuffer();
 		void destroyStrLL(StrLL *r_node);
 		void null_term_check();
 		StrLL* promote_collapsed_into_ll();
+
+    void*  _alloc(int len, int align);    // Take memory from the arena.
+    void   _release(void*);               // Give back an arena allocation.
+    bool   _grow(int len);                // Start a new chunk that can hold len bytes.
+    void   _free_arena();                 // Free every chunk, and start over.
+    StrLL* _new_node(unsigned char*, int len, bool reap);
+    void   _drop_node(StrLL*);
+    void   _append(unsigned char*, int len, bool merge);
+    StrLL* _adopt(StringBuilder* donor, StrLL** tail);
+    inline bool _in_inline(void* p) {
+      return ((((uint8_t*) p) >= _inline) && (((uint8_t*) p) < (_inline + STRINGBUILDER_INLINE_BYTES)));
+    };
+    /* Can len bytes be written at the end of the last fragment, in place? */
+    inline bool _mergeable(int len) {
+      return ((nullptr != _tail) && _tail->reap && !_tail->sealed && (nullptr == _tail->mem) &&
+        ((_tail->str + _tail->len + 1) == _arena_ptr) && ((_arena_end - _arena_ptr) >= len));
+    };
 };
 #endif
@@ -122,6 +122,8 @@ class BusOp {
     //uint32_t time_began     = 0;        // This is the time when bus access begins.
     //uint32_t time_ended     = 0;        // This is the time when bus access stops (or is aborted).
 
+    virtual ~BusOp() {};   // Queues free ops through this type.
+
     /* Mandatory overrides from the BusOp interface... */
     //virtual XferFault advance() =0;
     virtual XferFault begin() =0;
@@ -185,6 +187,15 @@ class BusOp {
     */
     inline bool hasFault() {     return (XferFault::NONE != xfer_fault);     };
 
+    /**
+    * Urgent operations are queued in a lane that the adapter drains first.
+    *   Cleared when the operation goes back to its pool.
+    *
+    * @return true if this operation should jump the line.
+    */
+    inline bool urgent() {           return _urgent;   };
+    inline void urgent(bool nu) {    _urgent = nu;     };
+
 
     /* Inlines for protected access... TODO: These should be eliminated over time. */
     inline XferState get_state() {                 return xfer_state;       };
@@ -209,38 +220,283 @@ class BusOp {
     BusOpcode opcode     = BusOpcode::UNDEF;  // What is the particular operation being done?
     XferState xfer_state = XferState::UNDEF;  // What state is this transfer in?
     XferFault xfer_fault = XferFault::NONE;   // Fault code.
+    bool      _urgent    = false;             // Should the adapter queue this ahead of the rest?
 
     //static void        initBusOp(const char*, BusOp*, StringBuilder*);
 
 
   private:
+    uint16_t  _pool_link = 0;   // The next free op in our pool. Only BusOpPool touches this.
+
+    template <class T> friend class BusOpPool;
+};
+
+
+/*
+* A fixed-capacity freelist over an adapter's preallocated BusOps. The links
+*   live in the ops themselves, so taking and giving never allocate. The head
+*   packs a tag above the index of the first free op, and the tag changes with
+*   every take and give, so a CAS made with a stale head can't succeed (ABA).
+*   Safe from any thread, and from ISRs.
+*/
+template <class T> class BusOpPool {
+  public:
+    /**
+    * Hands the pool its ops. Must happen before anyone takes from it.
+    *
+    * @param  pool   The array of preallocated ops.
+    * @param  count  How many there are. Fewer than 65536.
+    */
+    void init(T* pool, uint16_t count) {
+      _pool  = pool;
+      _count = count;
+      _head  = 0;
+      _free  = 0;
+      for (uint16_t i = 0; i < count; i++) give(&pool[i]);
+    };
+
+    /**
+    * @return A free op, or nullptr if the pool is empty.
+    */
+    T* take() {
+      uint32_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+      while (head & 0xFFFF) {
+        T* op = &_pool[(head & 0xFFFF) - 1];
+        uint32_t nu = ((head + 0x10000) & 0xFFFF0000) | __atomic_load_n(&op->_pool_link, __ATOMIC_RELAXED);
+        if (__atomic_compare_exchange_n(&_head, &head, nu, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+          __atomic_sub_fetch(&_free, 1, __ATOMIC_RELAXED);
+          return op;
+        }
+      }
+      return nullptr;
+    };
+
+    /**
+    * @param  op  An op that came from this pool.
+    * @return false if the op was not one of ours.
+    */
+    bool give(T* op) {
+      if (!owns(op)) return false;
+      uint16_t idx  = (uint16_t) (op - _pool) + 1;
+      uint32_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+      uint32_t nu;
+      do {
+        __atomic_store_n(&op->_pool_link, (uint16_t) (head & 0xFFFF), __ATOMIC_RELAXED);
+        nu = ((head + 0x10000) & 0xFFFF0000) | idx;
+      } while (!__atomic_compare_exchange_n(&_head, &head, nu, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+      __atomic_add_fetch(&_free, 1, __ATOMIC_RELAXED);
+      return true;
+    };
+
+    inline bool owns(T* op) {
+      return (((uintptr_t) op >= (uintptr_t) _pool) && ((uintptr_t) op < (uintptr_t) (_pool + _count)));
+    };
+    inline uint16_t available() {  return __atomic_load_n(&_free, __ATOMIC_RELAXED);  };
+    inline uint16_t capacity() {   return _count;   };
+
+
+  private:
+    T*       _pool  = nullptr;
+    uint32_t _head  = 0;   // Tag in the high half. Index + 1 of the first free op in the low half.
+    uint16_t _count = 0;
+    uint16_t _free  = 0;
+};
+
+
+/*
+* A bounded FIFO of BusOps waiting for the bus, with a second lane for urgent
+*   ops that is always drained first. Each lane is a sequenced-slot ring, like
+*   the Kernel's MsgIngress: any number of threads may insert() without
+*   locking, and exactly one (whoever advances the adapter's work queue) may
+*   take ops back out, look at them, or remove them.
+*
+* remove() leaves a hole in the ring, which dequeue() skips. So a purge never
+*   reorders what is left.
+*/
+template <class T> class BusWorkQueue {
+  public:
+    BusWorkQueue(uint16_t depth) {
+      uint32_t c = 2;
+      while (c < depth) c = c << 1;
+      _mask  = c - 1;
+      _count = 0;
+      for (int l = 0; l < 2; l++) {
+        _lanes[l].slots = new BusQueueSlot[c];
+        _lanes[l].tail  = 0;
+        _lanes[l].head  = 0;
+        for (uint32_t i = 0; i < c; i++) {
+          _lanes[l].slots[i].seq = i;
+          _lanes[l].slots[i].op  = nullptr;
+        }
+      }
+    };
+
+    ~BusWorkQueue() {
+      for (int l = 0; l < 2; l++) delete[] _lanes[l].slots;
+    };
+
+    /**
+    * Any thread. Never blocks.
+    *
+    * @param  op      The op to queue.
+    * @param  urgent  Put it in the lane that is drained first?
+    * @return 0 on success, or -1 if the lane is full.
+    */
+    int insert(T* op, bool urgent) {
+      BusQueueLane* lane = &_lanes[urgent ? 0 : 1];
+      uint32_t pos = __atomic_load_n(&lane->tail, __ATOMIC_RELAXED);
+      BusQueueSlot* slot;
+      while (true) {
+        slot = &lane->slots[pos & _mask];
+        int32_t dif = (int32_t) (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+        if (0 == dif) {
+          if (__atomic_compare_exchange_n(&lane->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            break;
+          }
+        }
+        else if (dif < 0) {
+          return -1;   // Full.
+        }
+        else {
+          pos = __atomic_load_n(&lane->tail, __ATOMIC_RELAXED);
+        }
+      }
+      slot->op = op;
+      __atomic_add_fetch(&_count, 1, __ATOMIC_RELAXED);
+      __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);   // Publish.
+      return 0;
+    };
+
+    /**
+    * Consumer only.
+    *
+    * @return The oldest urgent op, or failing that, the oldest op. nullptr if empty.
+    */
+    T* dequeue() {
+      T* op = _pop(&_lanes[0]);
+      return (nullptr != op) ? op : _pop(&_lanes[1]);
+    };
+
+    /**
+    * Consumer only.
+    *
+    * @param  position  How far from the front of the queue.
+    * @return The op in that position, in the order dequeue() would give them.
+    */
+    T* get(int position) {
+      for (int l = 0; l < 2; l++) {
+        BusQueueLane* lane = &_lanes[l];
+        for (uint32_t pos = lane->head; _published(lane, pos); pos++) {
+          T* op = lane->slots[pos & _mask].op;
+          if ((nullptr != op) && (0 == position--)) return op;
+        }
+      }
+      return nullptr;
+    };
+
+    /**
+    * Consumer only.
+    *
+    * @param  op  The op to take out of the queue.
+    * @return true if it was queued.
+    */
+    bool remove(T* op) {
+      for (int l = 0; l < 2; l++) {
+        BusQueueLane* lane = &_lanes[l];
+        for (uint32_t pos = lane->head; _published(lane, pos); pos++) {
+          if (op == lane->slots[pos & _mask].op) {
+            lane->slots[pos & _mask].op = nullptr;
+            __atomic_sub_fetch(&_count, 1, __ATOMIC_RELAXED);
+            return true;
+          }
+        }
+      }
+      return false;
+    };
+
+    /* Only exact when called by the consumer. */
+    inline bool contains(T* op) {
+      for (int i = 0; i < size(); i++) {
+        if (op == get(i)) return true;
+      }
+      return false;
+    };
+
+    inline int  size() {       return (int) __atomic_load_n(&_count, __ATOMIC_RELAXED);  };
+    inline bool hasNext() {    return (0 < size());        };
+    inline int  capacity() {   return (int) (_mask + 1);   };   // Per lane.
+
+
+  private:
+    typedef struct {
+      uint32_t seq;
+      T*       op;    // nullptr if remove()'d.
+    } BusQueueSlot;
+
+    typedef struct {
+      BusQueueSlot* slots;
+      uint32_t      tail;    // Next ticket a producer will claim.
+      uint32_t      head;    // Next ticket the consumer will read. Consumer-owned.
+    } BusQueueLane;
+
+    BusQueueLane _lanes[2];  // The urgent lane is first.
+    uint32_t     _mask;
+    int32_t      _count;     // Ops queued, not counting holes.
+
+    inline bool _published(BusQueueLane* lane, uint32_t pos) {
+      return (__atomic_load_n(&lane->slots[pos & _mask].seq, __ATOMIC_ACQUIRE) == (pos + 1));
+    };
+
+    T* _pop(BusQueueLane* lane) {
+      while (_published(lane, lane->head)) {
+        BusQueueSlot* slot = &lane->slots[lane->head & _mask];
+        T* op = slot->op;
+        slot->op = nullptr;
+        __atomic_store_n(&slot->seq, lane->head + _mask + 1, __ATOMIC_RELEASE);   // Free for the next lap.
+        lane->head++;
+        if (nullptr != op) {
+          __atomic_sub_fetch(&_count, 1, __ATOMIC_RELAXED);
+          return op;
+        }
+      }
+      return nullptr;
+    };
 };
 
 
 /*
 * This class represents a generic bus adapter. We are not so concerned with
-*   performance and memory overhead in this class, because there is typically
-*   only a handful of such classes, and they have low turnover rates.
+*   memory overhead in this class, because there is typically only a handful of
+*   such classes, and they have low turnover rates. But every transaction on
+*   the bus passes through here, so taking an op, queueing it, and giving it
+*   back never lock, and never allocate unless the pool runs dry.
 */
 template <class T> class BusAdapter : public BusOpCallback {
   public:
     inline T* currentJob() {  return current_job;  };
 
+    /* Stats, for those that would measure the adapter from outside. */
+    inline int      queueDepth() {    return work_queue.size();  };
+    inline uint32_t totalXfers() {    return _total_xfers;       };
+    inline uint32_t failedXfers() {   return _failed_xfers;      };
+    inline uint16_t queueFloods() {   return _queue_floods;      };
+
 
   protected:
     T*       current_job      = nullptr;
     uint32_t _total_xfers     = 0;  // Transfer stats.
     uint32_t _failed_xfers    = 0;  // Transfer stats.
+    uint32_t _rate_mark_ms    = 0;  // When did we last report a transfer rate?
+    uint32_t _rate_mark_xfers = 0;  // What was _total_xfers then?
     uint16_t _prealloc_misses = 0;  // How many times have we starved the preallocation queue?
     uint16_t _heap_frees      = 0;  // How many times have we freed a BusOp?
     uint16_t _queue_floods    = 0;  // How many times has the queue rejected work?
     const uint16_t MAX_Q_DEPTH;     // Maximum tolerable queue depth.
     //TODO: const uint8_t  MAX_Q_PRINT;     // Maximum tolerable queue depth.
-    //TODO: const uint8_t  PREALLOC_SIZE;   // Maximum tolerable queue depth.
-    PriorityQueue<T*> work_queue;   // A work queue to keep transactions in order.
-    PriorityQueue<T*> preallocated; // TODO: Convert to ring buffer. This is the whole reason you embarked on this madness.
+    BusWorkQueue<T> work_queue;     // A work queue to keep transactions in order.
+    BusOpPool<T>    preallocated;   // Vacant ops, ready for new_op().
 
-    BusAdapter(uint16_t max) : MAX_Q_DEPTH(max) {};
+    BusAdapter(uint16_t max) : MAX_Q_DEPTH(max), work_queue(max) {};
 
     /* Mandatory overrides... */
     virtual int8_t advance_work_queue() =0;  // The nature of the bus dictates this implementation.
@@ -251,7 +507,8 @@ template <class T> class BusAdapter : public BusOpCallback {
 
     void return_op_to_pool(T* obj) {
       obj->wipe();
-      preallocated.insert(obj);
+      obj->urgent(false);
+      preallocated.give(obj);
     };
 
     /**
@@ -260,7 +517,7 @@ template <class T> class BusAdapter : public BusOpCallback {
     * @return an BusOp to be used. Only NULL if out-of-mem.
     */
     T* new_op() {
-      T* return_value = preallocated.dequeue();
+      T* return_value = preallocated.take();
       if (nullptr == return_value) {
         _prealloc_misses++;
         return_value = new T();
@@ -280,33 +537,26 @@ template <class T> class BusAdapter : public BusOpCallback {
     //  return return_value;
     //};
 
-    ///*
-    //* Purges only the work_queue. Leaves the currently-executing job.
-    //*/
-    //void purge_queued_work() {
-    //  T* current = work_queue.dequeue();
-    //  while (current) {
-    //    current->abort(XferFault::QUEUE_FLUSH);
-    //    if (current->callback) {
-    //      current->callback->io_op_callback(current);
-    //    }
-    //    reclaim_queue_item(current);
-    //    current = work_queue.dequeue();
-    //  }
-    //};
-
 
     /* Convenience function for guarding against queue floods. */
-    inline bool roomInQueue() {    return !(work_queue.size() < MAX_Q_DEPTH);  }
+    inline bool roomInQueue() {    return (work_queue.size() < MAX_Q_DEPTH);  }
 
     // TODO: I hate that I'm doing this in a template.
     void printAdapter(StringBuilder* output) {
+      uint32_t now   = millis();
+      uint32_t xfers = _total_xfers;
+      uint32_t span  = now - _rate_mark_ms;
       output->concatf("-- Xfers (fail/total)  %u/%u\n", _failed_xfers, _total_xfers);
+      if (span > 0) {
+        output->concatf("-- Xfers/sec           %u (last %ums)\n", (unsigned int) (((uint64_t) (xfers - _rate_mark_xfers) * 1000) / span), span);
+      }
+      _rate_mark_ms    = now;
+      _rate_mark_xfers = xfers;
       output->concat("-- Prealloc:\n");
-      output->concatf("--    available        %d\n",  preallocated.size());
+      output->concatf("--    available        %u/%u\n", preallocated.available(), preallocated.capacity());
       output->concatf("--    misses/frees     %u/%u\n", _prealloc_misses, _heap_frees);
       output->concat("-- Work queue:\n");
-      output->concatf("--    depth/max        %u/%u\n", work_queue.size(), MAX_Q_DEPTH);
+      output->concatf("--    depth/max        %d/%u\n", work_queue.size(), MAX_Q_DEPTH);
       output->concatf("--    floods           %u\n",  _queue_floods);
     };
 
@@ -74,6 +74,7 @@ void lds8160_chan_5(void) {
 */
 LDS8160::LDS8160(uint8_t addr) : EventReceiver("LDS8160"), I2CDeviceWithRegisters(addr) {
   init_complete = false;
+  multi_access_support = true;   // Registers auto-increment.
   defineRegister(LDS8160_BANK_A_CURRENT,     (uint8_t) 0x90, true,  false, true);
   defineRegister(LDS8160_BANK_B_CURRENT,     (uint8_t) 0x90, true,  false, true);
   defineRegister(LDS8160_BANK_C_CURRENT,     (uint8_t) 0x90, true,  false, true);
@@ -81,6 +81,39 @@ void EventReceiver::flushLocalLog() {
 }
 
 
+/**
+* Declares which message codes this ER reacts to in notify(), so that the Kernel
+*   need not call it for anything else. Boot completion and config load are
+*   always delivered, since the base notify() handles them. An ER that never
+*   calls this is notify()'d about everything.
+* An extending class that handles codes of its own must declare the codes of
+*   its ancestors as well.
+*
+* @param  list  Codes terminated by MANUVR_MSG_UNDEFINED. Must outlive our
+*                 subscription. Pass nullptr to receive everything again.
+*/
+void EventReceiver::setInterests(const uint16_t* list) {
+  _interests = list;
+  Kernel::subscriptionsChanged();
+}
+
+
+/**
+* Declares where the Kernel may run our notify(), if it has workers. Only
+*   notify() moves. Everything else the Kernel calls (callback_proc(), and so
+*   on) still comes from the kernel thread, so an ER that leaves the kernel
+*   thread must guard whatever notify() shares with those.
+* Pinned ERs see Msgs in order, and never concurrently with themselves. ERs that
+*   declare MANUVR_ER_AFFINITY_ANY may be notify()'d from several workers at
+*   once, about different Msgs, and in any order.
+*
+* @param  nu  A worker index, or one of the MANUVR_ER_AFFINITY_* values.
+*/
+void EventReceiver::setAffinity(int8_t nu) {
+  _affinity = nu;
+}
+
+
 #ifdef MANUVR_CONSOLE_SUPPORT
 /**
 * This is a base-level debug function that takes direct input from a user.
@@ -53,6 +53,13 @@ Lifecycle:
   #define MANUVR_ER_FLAG_THREADED           0x40  // This ER is maintaining its own thread.
   #define MANUVR_ER_FLAG_CONF_DIRTY         0x80  // Our configuration should be persisted.
 
+  /*
+  * Where may the Kernel run our notify()? Values of zero or more pin us to that
+  *   worker (modulo the number of workers), so we see Msgs in order.
+  */
+  #define MANUVR_ER_AFFINITY_KERNEL         -1  // Only on the kernel thread. The default.
+  #define MANUVR_ER_AFFINITY_ANY            -2  // notify() is thread-safe. Any worker may run it.
+
   class Kernel;
 
   extern "C" {
@@ -143,6 +150,20 @@ Lifecycle:
 
         inline void   wake() {    wakeThread(_thread_id);    };
 
+        /**
+        * Which message codes does this ER want to be notify()'d about?
+        *
+        * @return  A list terminated by MANUVR_MSG_UNDEFINED, or nullptr for all of them.
+        */
+        inline const uint16_t* interests() {   return _interests;   };
+
+        /**
+        * Which thread may the Kernel notify() us from?
+        *
+        * @return  A worker index, or one of the MANUVR_ER_AFFINITY_* values.
+        */
+        inline int8_t affinity() {   return _affinity;   };
+
 
 
       protected:
@@ -158,6 +179,8 @@ Lifecycle:
 
 
         void flushLocalLog();
+        void setInterests(const uint16_t*);
+        void setAffinity(int8_t);
 
         // These inlines are for convenience of extending classes.
         inline uint8_t _er_flags() {                 return _extnd_state;            };
@@ -173,6 +196,8 @@ Lifecycle:
 
       private:
         char const* const _receiver_name;
+        const uint16_t*   _interests     = nullptr;  // Not owned. Must outlive our subscription.
+        int8_t      _affinity      = MANUVR_ER_AFFINITY_KERNEL;
         uint8_t     _class_state   = (DEFAULT_CLASS_VERBOSITY & MANUVR_ER_FLAG_VERBOSITY_MASK);
         uint8_t     _extnd_state   = 0;  // This is here for use by the extending class.
 
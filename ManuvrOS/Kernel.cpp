@@ -45,7 +45,17 @@ uintptr_t   Kernel::_prealloc_max    = 0;
 uint32_t    Kernel::lagged_schedules = 0;
 Kernel*     Kernel::INSTANCE         = nullptr;
 BufferPipe* Kernel::_logger          = nullptr;  // The logger slot.
-PriorityQueue<ManuvrMsg*> Kernel::isr_exec_queue;
+unsigned long Kernel::_kernel_thread = 0;
+uint32_t    Kernel::_sched_clock     = 0;
+bool        Kernel::_sched_dirty     = false;
+MsgIngress  Kernel::_ingress;
+#if defined(__BUILD_HAS_PTHREADS)
+  ManuvrMsg*      Kernel::_spill_head  = nullptr;
+  ManuvrMsg*      Kernel::_spill_tail  = nullptr;
+  pthread_mutex_t Kernel::_spill_lock  = PTHREAD_MUTEX_INITIALIZER;
+  int             Kernel::_spill_depth = 0;
+  uint32_t        Kernel::_spilled     = 0;
+#endif
 
 
 /*
@@ -152,6 +162,45 @@ const uint16_t ManuvrMsg::TOTAL_MSG_DEFS = sizeof(ManuvrMsg::message_defs) / siz
 void Kernel::nextTick(BufferPipe* p) {
   INSTANCE->_pipe_io_pend.insert(p);
   INSTANCE->_pending_pipes(true);
+  if (!on_kernel_thread()) platform.wakeHook();  // The kernel thread may be blocked in idle.
+}
+
+/* Workers wake the kernel thread when they hand a Msg back. */
+static void _wake_kernel() {
+  platform.wakeHook();
+}
+
+/**
+* Starts the worker pool with the given number of workers, or stops it. Any
+*   workers already running are stopped first, after they finish what they
+*   have. Receivers that never called setAffinity() are unaffected, and the
+*   Kernel behaves exactly as it does without workers.
+* Only the kernel thread may call this.
+*
+* @param  count  How many workers to run. Zero stops the pool.
+* @return 0 on success, or -1 on failure.
+*/
+int8_t Kernel::workers(uint8_t count) {
+  #if defined(__BUILD_HAS_PTHREADS)
+    if (!on_kernel_thread()) return -1;
+    _workers.stop();
+    drain_workers();
+    if (0 == count) return 0;
+    return (_workers.start(count, _wake_kernel) > 0) ? 0 : -1;
+  #else
+    return (0 == count) ? 0 : -1;
+  #endif
+}
+
+/**
+* @return How many workers are running.
+*/
+int Kernel::workers() {
+  #if defined(__BUILD_HAS_PTHREADS)
+    return _workers.workers();
+  #else
+    return 0;
+  #endif
 }
 
 //void Kernel::nextTick(FxnPointer* p) {
@@ -175,6 +224,12 @@ void Kernel::nextTick(BufferPipe* p) {
 */
 Kernel::Kernel() : EventReceiver("Kernel") {
   INSTANCE             = this;  // For singleton reference.
+  _kernel_thread       = currentThreadId();  // Until procIdleFlags() tells us otherwise.
+  ingress_drained      = 0;
+  notifies_made        = 0;
+  notifies_dead        = 0;
+  notifies_skipped     = 0;
+  notifies_offloaded   = 0;
   _prealloc_max        = ((uintptr_t) _preallocation_pool) + (sizeof(ManuvrMsg) * EVENT_MANAGER_PREALLOC_COUNT);
   current_event        = nullptr;
   max_events_per_loop  = 2;
@@ -189,6 +244,10 @@ Kernel::Kernel() : EventReceiver("Kernel") {
         this class. */
     preallocated.insert(&_preallocation_pool[i]);
   }
+  #if (ARGUMENT_POOL_SIZE > 0)
+    // Same idea for the Arguments that ride on Msgs.
+    Argument::setPool(_arg_slab, _arg_links, ARGUMENT_POOL_SIZE);
+  #endif
 
   #if defined(MANUVR_DEBUG)
     profiler(true);          // spend time and memory measuring performance.
@@ -203,12 +262,17 @@ Kernel::Kernel() : EventReceiver("Kernel") {
 * Destructor. Should probably never be called.
 */
 Kernel::~Kernel() {
-  ManuvrMsg* temp = schedules.dequeue();
+  #if defined(__BUILD_HAS_PTHREADS)
+    _workers.stop();
+  #endif
+  ManuvrMsg* temp = schedules.get(0);
   while (temp) {
+    schedules.remove(temp);
     temp->decRefs();
     reclaim_event(temp);
-    temp = schedules.dequeue();
+    temp = schedules.get(0);
   }
+  if (nullptr != _latencies) delete _latencies;
 }
 
 
@@ -284,6 +348,7 @@ int8_t Kernel::subscribe(EventReceiver *client) {
 
   client->setVerbosity((int8_t)DEFAULT_CLASS_VERBOSITY);
   int8_t return_value = subscribers.insert(client);
+  _sub_index.invalidate();
   if (erAttached()) {
     // This subscriber is joining us after bootup. Call its attached() fxn to cause it to init.
     client->attached();
@@ -308,6 +373,7 @@ int8_t Kernel::subscribe(EventReceiver *client, uint8_t priority) {
 
   client->setVerbosity((int8_t)DEFAULT_CLASS_VERBOSITY);
   int8_t return_value = subscribers.insert(client, priority);
+  _sub_index.invalidate();
   if (erAttached()) {
     // This subscriber is joining us after bootup. Call its attached() fxn to cause it to init.
     //client.attached();
@@ -324,6 +390,7 @@ int8_t Kernel::subscribe(EventReceiver *client, uint8_t priority) {
 */
 int8_t Kernel::unsubscribe(EventReceiver *client) {
   if (nullptr == client) return -1;
+  _sub_index.invalidate();
   return (subscribers.remove(client) ? 0 : -1);
 }
 
@@ -346,21 +413,11 @@ EventReceiver* Kernel::getSubscriberByName(const char* search_str) {
 
 int8_t Kernel::registerCallbacks(uint16_t msgCode, listenerFxnPtr ca, listenerFxnPtr cb, uint32_t options) {
   if (ca != nullptr) {
-    PriorityQueue<listenerFxnPtr> *ca_queue = ca_listeners[msgCode];
-    if (nullptr == ca_queue) {
-      ca_queue = new PriorityQueue<listenerFxnPtr>();
-      ca_listeners[msgCode] = ca_queue;
-    }
-    ca_queue->insert(ca);
+    ca_listeners.add(msgCode, ca);
   }
 
   if (cb != nullptr) {
-    PriorityQueue<listenerFxnPtr> *cb_queue = cb_listeners[msgCode];
-    if (nullptr == cb_queue) {
-      cb_queue = new PriorityQueue<listenerFxnPtr>();
-      cb_listeners[msgCode] = cb_queue;
-    }
-    cb_queue->insert(cb);
+    cb_listeners.add(msgCode, cb);
   }
   return options%255;
 }
@@ -404,13 +461,34 @@ int8_t Kernel::raiseEvent(uint16_t code, EventReceiver* ori) {
 * @return  -1 on failure, and 0 on success.
 */
 int8_t Kernel::staticRaiseEvent(ManuvrMsg* active_runnable) {
-  int8_t return_value = INSTANCE->validate_insertion(active_runnable);
-  if (0 == return_value) {
-    INSTANCE->update_maximum_queue_depth();   // Check the queue depth
-    #if defined (__BUILD_HAS_THREADS)
-      if (INSTANCE->_thread_id) wakeThread(INSTANCE->_thread_id);
-    #endif
-    return return_value;
+  int8_t return_value = 0;
+  mark_raised(active_runnable);
+  if (on_kernel_thread()) {
+    return_value = INSTANCE->validate_insertion(active_runnable);
+    if (0 == return_value) {
+      INSTANCE->update_maximum_queue_depth();   // Check the queue depth
+      return return_value;
+    }
+  }
+  else {
+    // Foreign threads never touch the exec_queue. They hand the event to the
+    //   ingress, and the Kernel enqueues it on its next idle loop. We do the
+    //   checks that don't need the exec_queue here, so the failure handling
+    //   below stays the same for the caller.
+    if (nullptr == active_runnable) {
+      return_value = -1;
+    }
+    else if (MANUVR_MSG_UNDEFINED == active_runnable->eventCode()) {
+      return_value = -2;
+    }
+    else {
+      return_value = foreign_push(active_runnable);
+      if (0 == return_value) {
+        platform.wakeHook();   // The kernel thread may be blocked in idle.
+        return return_value;
+      }
+      if (-1 == return_value) return_value = -5;
+    }
   }
   INSTANCE->insertion_denials++;
 
@@ -444,6 +522,7 @@ int8_t Kernel::staticRaiseEvent(ManuvrMsg* active_runnable) {
       break;
     case -2:   // UNDEFINED event. This shall not stand, man....
     case -4:   // DEPRECATED: Message-level idempotency.
+    case -5:   // The ingress is full. The Kernel is badly behind.
     default:   // Should never occur.
       INSTANCE->reclaim_event(active_runnable);
       break;
@@ -453,37 +532,110 @@ int8_t Kernel::staticRaiseEvent(ManuvrMsg* active_runnable) {
 
 
 /**
-* Used to add a pre-formed event to the idle queue. Use this when a sophisticated event
-*   needs to be formed elsewhere and passed in. Kernel will only insert it into the
-*   queue in this case.
+* Removes a pending event from the idle queue. Only the Kernel's own thread can do
+*   this, since that is the only thread that touches the exec_queue. Events still
+*   sitting in the ingress are moved over first, so they can be found.
 *
 * @param   event  The event to be removed from the idle queue.
 * @return  true if the given event was aborted, false otherwise.
 */
 bool Kernel::abortEvent(ManuvrMsg* event) {
-  if (!INSTANCE->exec_queue.remove(event)) {
-    // Didn't find it? Check  the isr_queue...
-    if (!INSTANCE->isr_exec_queue.remove(event)) {
-      return false;
-    }
+  if (!on_kernel_thread()) {
+    return false;
   }
-  return true;
+  INSTANCE->drain_ingress();
+  return INSTANCE->exec_queue.remove(event);
 }
 
 
-// TODO: It would be bettter to put a semaphore on the exec_queue and set it in the idle loop.
-//       That way, we could check for it here, and have the (probable) possibility of not incurring
-//       the cost for merging these two queues if we don't have to.
-//             ---J. Ian Lindsay   Fri Jul 03 16:54:14 MST 2015
+/**
+* Used to raise an event from an ISR (or any other context that must not block).
+*   This never takes a lock, never allocates, and never reclaims. If it fails, the
+*   caller still owns the event.
+*
+* @param   event  The event to be inserted into the idle queue.
+* @return  -1 on failure (NULL, or the ingress is full), and 0 on success.
+*/
 int8_t Kernel::isrRaiseEvent(ManuvrMsg* event) {
-  int return_value = -1;
-  maskableInterrupts(false);
-  return_value = isr_exec_queue.insertIfAbsent(event, event->priority());
-  maskableInterrupts(true);
+  mark_raised(event);
+  int8_t return_value = _ingress.push(event);
+  if (0 == return_value) {
+    platform.wakeHook();   // Platforms that block in idle must make this ISR-safe.
+  }
+  return return_value;
+}
+
+
+/**
+* Hands a Msg from a thread other than the Kernel's to the Kernel. Bursts from
+*   busy threads can outrun the ingress ring, and unlike an ISR, a thread can
+*   afford a lock. So if the ring is full (or something is already waiting in
+*   the spill, which keeps order), the Msg goes into the spill instead.
+* The spill is a FIFO with its own link and flag in the Msg. The Msg may
+*   be in the exec_queue at the same time, and the Kernel thread is free to
+*   work on it there while we hold it. The drain sorts that out, as it does
+*   for the ring.
+*
+* @param   event  The event to hand over.
+* @return  0 on success, -1 if the ingress is full, or -3 if the Msg is
+*            already waiting in the spill.
+*/
+int8_t Kernel::foreign_push(ManuvrMsg* event) {
+  #if defined(__BUILD_HAS_PTHREADS)
+    if (0 == __atomic_load_n(&_spill_depth, __ATOMIC_ACQUIRE)) {
+      if (0 == _ingress.push(event)) return 0;
+    }
+    int8_t return_value = -3;
+    pthread_mutex_lock(&_spill_lock);
+    if (!event->isSpilled()) {
+      event->isSpilled(true);
+      event->_spill_next = nullptr;
+      if (nullptr == _spill_tail) {
+        _spill_head = event;
+      }
+      else {
+        _spill_tail->_spill_next = event;
+      }
+      _spill_tail = event;
+      _spilled++;
+      __atomic_store_n(&_spill_depth, _spill_depth + 1, __ATOMIC_RELEASE);
+      return_value = 0;
+    }
+    pthread_mutex_unlock(&_spill_lock);
+    return return_value;
+  #else
+    return _ingress.push(event);
+  #endif
+}
+
+
+/**
+* Is the caller running in the thread that calls procIdleFlags()? On builds
+*   without threads, there is only the one.
+*
+* @return true if the caller may touch the exec_queue directly.
+*/
+bool Kernel::on_kernel_thread() {
   #if defined (__BUILD_HAS_THREADS)
-    if (INSTANCE->_thread_id) wakeThread(INSTANCE->_thread_id);
+    return (currentThreadId() == _kernel_thread);
+  #else
+    return true;
+  #endif
+}
+
+
+/**
+* Notes when a Msg was raised, so the profiler can tell how long it waited.
+*   Costs nothing unless the profiler is on. Safe from any context.
+*
+* @param  event  The Msg being raised. May be NULL.
+*/
+void Kernel::mark_raised(ManuvrMsg* event) {
+  #if defined(MANUVR_EVENT_PROFILER)
+    if ((nullptr != event) && (nullptr != INSTANCE->_latencies)) {
+      event->profilerMark(micros());
+    }
   #endif
-  return return_value;
 }
 
 
@@ -527,18 +679,66 @@ int8_t Kernel::validate_insertion(ManuvrMsg* event) {
     return -2;  // No undefined events.
   }
 
-  if (exec_queue.contains(event)) {
-    // Bail out with error, because this event (which is status-bearing) cannot be in the
-    //   queue more than once.
+  // Go ahead and insert. The queue checks the Msg's enqueued flag for us, because
+  //   this event (which is status-bearing) cannot be in the queue more than once.
+  if (0 != exec_queue.insert(event)) {
     return -3;
   }
-
-  // Go ahead and insert.
-  INSTANCE->exec_queue.insert(event, event->priority());
   return 0;
 }
 
 
+/**
+* Moves events raised by ISRs and foreign threads into the exec_queue. Must only
+*   be called from the kernel thread. At most one ring's worth is moved per call,
+*   so a chatty producer can't keep us here forever. The spill (if any) is
+*   taken whole, since it only fills when producers have already outrun us.
+*
+* @return The number of events taken from the ingress.
+*/
+int Kernel::drain_ingress() {
+  int count = 0;
+  ManuvrMsg* nu = _ingress.pop();
+  while (nullptr != nu) {
+    count++;
+    switch (validate_insertion(nu)) {
+      case 0:    // Clear for insertion.
+        break;
+      case -3:   // Pointer idempotency. THIS EXACT runnable is already enqueued.
+      case -2:   // UNDEFINED event. Might be static in an ISR's scope, so no reclaim.
+      default:
+        insertion_denials++;
+        break;
+    }
+    nu = (count < MSG_INGRESS_CAPACITY) ? _ingress.pop() : nullptr;
+  }
+  #if defined(__BUILD_HAS_PTHREADS)
+    if (0 != __atomic_load_n(&_spill_depth, __ATOMIC_ACQUIRE)) {
+      // Take the whole spill at once, and file it outside the lock.
+      pthread_mutex_lock(&_spill_lock);
+      nu = _spill_head;
+      _spill_head = nullptr;
+      _spill_tail = nullptr;
+      __atomic_store_n(&_spill_depth, 0, __ATOMIC_RELEASE);
+      pthread_mutex_unlock(&_spill_lock);
+      while (nullptr != nu) {
+        ManuvrMsg* next = nu->_spill_next;
+        nu->_spill_next = nullptr;
+        nu->isSpilled(false);   // From here, it may be spilled again.
+        count++;
+        if (0 != validate_insertion(nu)) insertion_denials++;
+        nu = next;
+      }
+    }
+  #endif
+  if (count) {
+    ingress_drained += count;
+    update_maximum_queue_depth();
+  }
+  return count;
+}
+
+
 bool Kernel::returnToPrealloc(ManuvrMsg* obj) {
   uintptr_t obj_addr = ((uintptr_t) obj);
   if ((obj_addr < _prealloc_max) && (obj_addr >= ((uintptr_t) _preallocation_pool))) {
@@ -554,6 +754,8 @@ bool Kernel::returnToPrealloc(ManuvrMsg* obj) {
 /**
 * This is where events go to die. This function should inspect the Event and send it
 *   to the appropriate place.
+* Any thread may call this. The refcount is atomic, the preallocation queue
+*   takes its own lock, and the counters are bumped atomically.
 *
 * @param active_runnable The event that has reached the end of its life-cycle.
 */
@@ -563,8 +765,8 @@ void Kernel::reclaim_event(ManuvrMsg* active_runnable) {
       // No outstanding references.
       if (!returnToPrealloc(active_runnable)) {
         delete active_runnable;  // If we are to free() this msg...
-        events_destroyed++;      // ...and note the incident.
-        burden_of_specific++;
+        __atomic_add_fetch(&events_destroyed, 1, __ATOMIC_RELAXED);     // ...and note the incident.
+        __atomic_add_fetch(&burden_of_specific, 1, __ATOMIC_RELAXED);
       }
     }
   }
@@ -576,16 +778,14 @@ void Kernel::reclaim_event(ManuvrMsg* active_runnable) {
 *******************************************************************************/
 
 // This is the splice into v2's style of event handling (callaheads).
+// Listeners added during the walk are not called until the next Msg.
 int8_t Kernel::procCallAheads(ManuvrMsg* active_runnable) {
   int8_t return_value = 0;
-  PriorityQueue<listenerFxnPtr> *ca_queue = ca_listeners[active_runnable->eventCode()];
-  if (nullptr != ca_queue) {
-    listenerFxnPtr current_fxn;
-    for (int i = 0; i < ca_queue->size(); i++) {
-      current_fxn = ca_queue->recycle();  // TODO: This is ugly for many reasons.
-      if (current_fxn(active_runnable)) {
-        return_value++;
-      }
+  listenerFxnPtr* fxns;
+  int count = ca_listeners.lookup(active_runnable->eventCode(), &fxns);
+  for (int i = 0; i < count; i++) {
+    if (fxns[i](active_runnable)) {
+      return_value++;
     }
   }
   return return_value;
@@ -594,14 +794,11 @@ int8_t Kernel::procCallAheads(ManuvrMsg* active_runnable) {
 // This is the splice into v2's style of event handling (callbacks).
 int8_t Kernel::procCallBacks(ManuvrMsg* active_runnable) {
   int8_t return_value = 0;
-  PriorityQueue<listenerFxnPtr> *cb_queue = cb_listeners[active_runnable->eventCode()];
-  if (cb_queue) {
-    listenerFxnPtr current_fxn;
-    for (int i = 0; i < cb_queue->size(); i++) {
-      current_fxn = cb_queue->recycle();  // TODO: This is ugly for many reasons.
-      if (current_fxn(active_runnable)) {
-        return_value++;
-      }
+  listenerFxnPtr* fxns;
+  int count = cb_listeners.lookup(active_runnable->eventCode(), &fxns);
+  for (int i = 0; i < count; i++) {
+    if (fxns[i](active_runnable)) {
+      return_value++;
     }
   }
   return return_value;
@@ -609,6 +806,113 @@ int8_t Kernel::procCallBacks(ManuvrMsg* active_runnable) {
 
 
 
+/**
+* Everything that happens to a Msg after its subscribers have been notified:
+*   the callbacks, the originator's say in its fate, and then its reclamation.
+*   Always on the kernel thread, even if the notify()s were not.
+*
+* @param active_runnable  The Msg that has been dispatched.
+* @param activity         How many subscribers took action on it.
+*/
+void Kernel::complete_event(ManuvrMsg* active_runnable, uint8_t activity) {
+  procCallBacks(active_runnable);
+  // Listener lists that were replaced during this Msg can go now.
+  ca_listeners.reap();
+  cb_listeners.reap();
+
+  if (0 == activity) {
+    #ifdef MANUVR_DEBUG
+    if (getVerbosity() >= 3) local_log.concatf("\tDead event: %s\n", active_runnable->getMsgTypeString());
+    #endif
+    total_events_dead++;
+  }
+
+  /* Should we clean up the Event? */
+  bool clean_up_active_runnable = true;  // Defaults to 'yes'.
+
+  switch (active_runnable->callbackOriginator()) {
+    case EVENT_CALLBACK_RETURN_RECYCLE:     // The originating class wants us to re-insert the event.
+      #ifdef MANUVR_DEBUG
+      if (getVerbosity() > 6) local_log.concatf("Recycling %s.\n", active_runnable->getMsgTypeString());
+      #endif
+      mark_raised(active_runnable);
+      switch (validate_insertion(active_runnable)) {
+        case 0:    // Clear for insertion. validate_insertion() already enqueued it.
+          clean_up_active_runnable = false;
+          break;
+        case -1:   // NULL runnable! How?!?!
+          break;
+        case -2:   // UNDEFINED event. This shall not stand, man....
+          break;
+        case -3:   // Pointer idempotency. THIS EXACT runnable is already enqueue.
+          clean_up_active_runnable = false;   // It will come back here after that run.
+          break;
+      }
+      break;
+    case EVENT_CALLBACK_RETURN_ERROR:       // Something went wrong. Should never occur.
+    case EVENT_CALLBACK_RETURN_UNDEFINED:   // The originating class doesn't care what we do with the event.
+      //if (verbosity > 1) local_log.concatf("Kernel found a possible mistake. Unexpected return case from callback_proc.\n");
+      // NOTE: No break;
+    case EVENT_CALLBACK_RETURN_DROP:        // The originating class expects us to drop the event.
+      #ifdef MANUVR_DEBUG
+      //if (getVerbosity() > 6) local_log.concatf("Dropping %s after running.\n", active_runnable->getMsgTypeString());
+      #endif
+      // NOTE: No break;
+    case EVENT_CALLBACK_RETURN_REAP:        // The originating class is explicitly telling us to reap the event.
+      // NOTE: No break;
+    default:
+      //if (verbosity > 0) local_log.concatf("Event %s has no cleanup case.\n", active_runnable->getMsgTypeString());
+      break;
+  }
+
+  // All of the logic above ultimately informs this choice. But a Msg that was
+  //   raised again while the workers had it is back in the exec_queue by now.
+  //   It must not be reclaimed until that run is done with it.
+  if (clean_up_active_runnable && !active_runnable->isEnqueued()) {
+    reclaim_event(active_runnable);
+  }
+
+  total_events++;
+}
+
+
+/**
+* Finishes the Msgs whose notify()s the workers have all made. Must only be
+*   called from the kernel thread.
+*
+* @return The number of Msgs finished.
+*/
+int Kernel::drain_workers() {
+  int count = 0;
+  #if defined(__BUILD_HAS_PTHREADS)
+    int acted = 0;
+    int dead  = 0;
+    ManuvrMsg* msg = _workers.finished(&acted, &dead);
+    while (nullptr != msg) {
+      count++;
+      notifies_dead += dead;
+      #if defined(MANUVR_EVENT_PROFILER)
+        if ((nullptr != _latencies) && (0 != msg->profilerMark())) {
+          LatencyProfile* latency = _latencies->lookup(msg->eventCode());
+          if (nullptr != latency) latency->run.record(micros() - msg->profilerMark());
+        }
+        msg->profilerMark(0);
+      #endif
+      if (_held.remove(msg)) {
+        // It was raised again while the workers had it. Back in line it goes,
+        //   which also keeps complete_event() from reclaiming it.
+        if (0 != validate_insertion(msg)) insertion_denials++;
+      }
+      current_event = msg;
+      complete_event(msg, (uint8_t) acted);
+      msg = _workers.finished(&acted, &dead);
+    }
+    current_event = nullptr;
+  #endif
+  return count;
+}
+
+
 /**
 * Process any open events.
 *
@@ -634,36 +938,49 @@ int8_t Kernel::procIdleFlags() {
   ManuvrMsg *active_runnable = nullptr;  // Our short-term focus.
   uint8_t activity_count    = 0;     // Incremented whenever a subscriber reacts to an event.
 
-  globalIRQDisable();
-  while (isr_exec_queue.size() > 0) {
-    active_runnable = isr_exec_queue.dequeue();
-
-    switch (validate_insertion(active_runnable)) {
-      case 0:    // Clear for insertion.
-        break;
-      case -1:   // NULL runnable! How?!?!
-        break;
-      case -2:   // UNDEFINED event. This shall not stand, man....
-        break;
-      case -3:   // Pointer idempotency. THIS EXACT runnable is already enqueue.
-        break;
-      default:   // Should never occur.
-        break;
-    }
-  }
-  globalIRQEnable();
-
-  active_runnable = nullptr;   // Pedantic...
+  // Whatever thread is running the idle loop is the kernel thread.
+  _kernel_thread = currentThreadId();
+  drain_ingress();   // Take in anything raised from ISRs or other threads.
+  drain_workers();   // Finish the Msgs that the workers are done with.
 
   /* As long as we have an open event and we aren't yet at our proc ceiling... */
   while (exec_queue.hasNext() && should_run_another_event(return_value, profiler_mark)) {
+    #if defined(__BUILD_HAS_PTHREADS)
+      if ((_workers.workers() > 0) && _workers.saturated()) {
+        // The workers are as far behind as we let them get. Whatever lands
+        //   next will wake us.
+        break;
+      }
+    #endif
     active_runnable = exec_queue.dequeue();       // Grab the Event and remove it in the same call.
     msg_code_local = active_runnable->eventCode();  // This gets used after the life of the event.
+    MANUVR_TRACE_SPAN(TraceCat::MSG, msg_code_local, active_runnable->getMsgTypeString(), exec_queue.size());
+    int flight = -1;   // If the workers take any of this Msg, this is how we track it.
+
+    #if defined(__BUILD_HAS_PTHREADS)
+      if (_workers.workers() > 0) {
+        if (_workers.inFlight(active_runnable)) {
+          // Raised again before the workers were done with it. It goes back
+          //   in line once they are.
+          _held.insert(active_runnable);
+          continue;
+        }
+        flight = _workers.open(active_runnable);
+      }
+    #endif
 
     current_event = active_runnable;
 
     // Chat and measure.
     profiler_mark_0 = micros();
+    #if defined(MANUVR_EVENT_PROFILER)
+      // How long did it wait? From here on, the mark is when it was dispatched.
+      LatencyProfile* latency = (nullptr == _latencies) ? nullptr : _latencies->lookup(msg_code_local);
+      if ((nullptr != latency) && (0 != active_runnable->profilerMark())) {
+        latency->wait.record(profiler_mark_0 - active_runnable->profilerMark());
+      }
+      active_runnable->profilerMark(profiler_mark_0);
+    #endif
 
     procCallAheads(active_runnable);
 
@@ -672,116 +989,66 @@ int8_t Kernel::procIdleFlags() {
     if (_profiler_enabled()) profiler_mark_1 = micros();
 
     if (active_runnable->singleTarget()) {
-      activity_count += active_runnable->execute();
+      subscriber = active_runnable->executionTarget();
+      if ((nullptr == subscriber) || !offload(flight, subscriber)) {
+        activity_count += active_runnable->execute();
+      }
     }
     else {
-      for (int i = 0; i < subscribers.size(); i++) {
-        subscriber = subscribers.get(i);
+      if (_sub_index.dirty()) _sub_index.rebuild(&subscribers);
+      EventReceiver** interested = _sub_index.lookup(msg_code_local);
+      int sub_count = subscribers.size();
+      int notified  = 0;
+      for (int i = 0; (interested) ? (nullptr != interested[i]) : (i < sub_count); i++) {
+        subscriber = (interested) ? interested[i] : subscribers.get(i);
+        if (interested && _sub_index.dirty() && !subscribers.contains(subscriber)) {
+          // Someone we were about to notify has unsubscribed during this dispatch.
+          continue;
+        }
+        notified++;
+        if (offload(flight, subscriber)) continue;
 
+        MANUVR_TRACE_SPAN(TraceCat::NOTIFY, msg_code_local, subscriber->getReceiverName(), 0);
         switch (subscriber->notify(active_runnable)) {
           case -1:  // The subscriber choked. Figure out why. Technically, this is action. Case fall-through...
             subscriber->printDebug(&local_log);
           default:   // The subscriber acted.
             activity_count++;
+            break;
           case 0:   // The nominal case. No response.
+            notifies_dead++;
             break;
         }
       }
+      notifies_made += notified;
+      if (sub_count > notified) notifies_skipped += (sub_count - notified);
     }
     if (_profiler_enabled()) profiler_mark_2 = micros();
 
-    procCallBacks(active_runnable);
-
-    #if defined(MANUVR_EVENT_PROFILER)
-      active_runnable->noteExecutionTime(profiler_mark_0, micros());
-    #endif  //MANUVR_EVENT_PROFILER
-
-    if (0 == activity_count) {
-      #ifdef MANUVR_DEBUG
-      if (getVerbosity() >= 3) local_log.concatf("\tDead event: %s\n", active_runnable->getMsgTypeString());
-      #endif
-      total_events_dead++;
-    }
-
-    /* Should we clean up the Event? */
-    bool clean_up_active_runnable = true;  // Defaults to 'yes'.
-
-    switch (active_runnable->callbackOriginator()) {
-      case EVENT_CALLBACK_RETURN_RECYCLE:     // The originating class wants us to re-insert the event.
-        #ifdef MANUVR_DEBUG
-        if (getVerbosity() > 6) local_log.concatf("Recycling %s.\n", active_runnable->getMsgTypeString());
-        #endif
-        switch (validate_insertion(active_runnable)) {
-          case 0:    // Clear for insertion.
-            exec_queue.insert(active_runnable, active_runnable->priority());
-            clean_up_active_runnable = false;
-            break;
-          case -1:   // NULL runnable! How?!?!
-            break;
-          case -2:   // UNDEFINED event. This shall not stand, man....
-            break;
-          case -3:   // Pointer idempotency. THIS EXACT runnable is already enqueue.
-            break;
+    #if defined(__BUILD_HAS_PTHREADS)
+      if (flight >= 0) {
+        int acted = 0;
+        int dead  = 0;
+        if (!_workers.close(flight, &acted, &dead)) {
+          // The workers still have it. drain_workers() will finish it.
+          return_value++;
+          continue;
         }
-        break;
-      case EVENT_CALLBACK_RETURN_ERROR:       // Something went wrong. Should never occur.
-      case EVENT_CALLBACK_RETURN_UNDEFINED:   // The originating class doesn't care what we do with the event.
-        //if (verbosity > 1) local_log.concatf("Kernel found a possible mistake. Unexpected return case from callback_proc.\n");
-        // NOTE: No break;
-      case EVENT_CALLBACK_RETURN_DROP:        // The originating class expects us to drop the event.
-        #ifdef MANUVR_DEBUG
-        //if (getVerbosity() > 6) local_log.concatf("Dropping %s after running.\n", active_runnable->getMsgTypeString());
-        #endif
-        // NOTE: No break;
-      case EVENT_CALLBACK_RETURN_REAP:        // The originating class is explicitly telling us to reap the event.
-        // NOTE: No break;
-      default:
-        //if (verbosity > 0) local_log.concatf("Event %s has no cleanup case.\n", active_runnable->getMsgTypeString());
-        break;
-    }
-
-    // All of the logic above ultimately informs this choice.
-    if (clean_up_active_runnable) {
-      reclaim_event(active_runnable);
-    }
-
-    total_events++;
+        activity_count += acted;
+        notifies_dead  += dead;
+      }
+    #endif
 
     #if defined(MANUVR_EVENT_PROFILER)
-      // This is a stat-gathering block.
-      if (_profiler_enabled()) {
-        profiler_mark_3 = micros();
-
-        TaskProfilerData* profiler_item = nullptr;
-        int cost_size = event_costs.size();
-        int i = 0;
-        while ((nullptr == profiler_item) && (i < cost_size)) {
-          if (event_costs.get(i)->msg_code == msg_code_local) {
-            profiler_item = event_costs.get(i);
-          }
-          i++;
-        }
-        if (nullptr == profiler_item) {
-          // If we don't yet have a profiler item for this message type...
-          profiler_item = new TaskProfilerData();    // ...create one...
-          profiler_item->msg_code = msg_code_local;   // ...assign the code...
-          event_costs.insert(profiler_item, 1);       // ...and insert it for the future.
-        }
-        else {
-          // If we already have a profiler item for this code...
-          event_costs.incrementPriority(profiler_item);
-        }
-        profiler_item->executions++;
-        profiler_item->run_time_last    = wrap_accounted_delta(profiler_mark_2, profiler_mark_1);
-        profiler_item->run_time_best    = strict_min(profiler_item->run_time_last, profiler_item->run_time_best);
-        profiler_item->run_time_worst   = strict_max(profiler_item->run_time_last, profiler_item->run_time_worst);
-        profiler_item->run_time_total  += profiler_item->run_time_last;
-        profiler_item->run_time_average = profiler_item->run_time_total / ((profiler_item->executions) ? profiler_item->executions : 1);
-
-        profiler_mark_2 = 0;  // Reset for next iteration.
+      active_runnable->noteExecutionTime(profiler_mark_0, micros());
+      if ((nullptr != latency) && (0 != profiler_mark_2)) {
+        latency->run.record(profiler_mark_2 - profiler_mark_0);
       }
+      active_runnable->profilerMark(0);
     #endif  //MANUVR_EVENT_PROFILER
 
+    complete_event(active_runnable, activity_count);
+
     if (exec_queue.size() > 30) {
       #ifdef MANUVR_DEBUG
       local_log.concatf("Depth %10d \t %s\n", exec_queue.size(), ManuvrMsg::getMsgTypeString(msg_code_local));
@@ -794,6 +1061,7 @@ int8_t Kernel::procIdleFlags() {
   if (_pending_pipes()) {
     BufferPipe* _temp_io = _pipe_io_pend.dequeue();
     while (_temp_io) {
+      MANUVR_TRACE_SPAN(TraceCat::PIPE, 0, _temp_io->pipeName(), _pipe_io_pend.size());
       _temp_io->asyncCallback();
       _temp_io = _pipe_io_pend.dequeue();
     }
@@ -878,7 +1146,14 @@ void Kernel::profiler(bool enabled) {
   insertion_denials  = 0;
 
   #if defined(MANUVR_EVENT_PROFILER)
-    while (event_costs.hasNext()) delete event_costs.dequeue();
+    if (enabled) {
+      if (nullptr == _latencies) _latencies = new LatencyTable();
+      else _latencies->clear();
+    }
+    else if (nullptr != _latencies) {
+      delete _latencies;
+      _latencies = nullptr;
+    }
   #endif   // MANUVR_EVENT_PROFILER
 }
 
@@ -901,8 +1176,28 @@ void Kernel::printProfiler(StringBuilder* output) {
     output->concatf("-- Queue depth        \t%d\n", exec_queue.size());
     output->concatf("-- Preallocation depth\t%d\n", preallocated.size());
     output->concatf("-- Prealloc starves   \t%u\n", (unsigned long) prealloc_starved);
+    output->concatf("-- Arg pool in use    \t%u/%u\n", (unsigned long) Argument::poolInUse(), (unsigned long) Argument::poolSize());
+    output->concatf("-- Arg pool hits      \t%u\n", (unsigned long) Argument::poolHits());
+    output->concatf("-- Arg pool misses    \t%u\n", (unsigned long) Argument::poolMisses());
     output->concatf("-- events_destroyed   \t%u\n", (unsigned long) events_destroyed);
+    output->concatf("-- Notifies made      \t%u\n", (unsigned long) notifies_made);
+    unsigned int dead_pm = notifies_made ? (unsigned int) ((1000ULL * notifies_dead) / notifies_made) : 0;
+    output->concatf("-- Notifies dead      \t%u (%u.%u%%)\n", (unsigned int) notifies_dead, dead_pm / 10, dead_pm % 10);
+    output->concatf("-- Notifies skipped   \t%u\n", (unsigned long) notifies_skipped);
+    #if defined(__BUILD_HAS_PTHREADS)
+      output->concatf("-- Notifies offloaded \t%u\n", (unsigned long) notifies_offloaded);
+      output->concatf("-- Workers            \t%d (%u tasks, %u stolen)\n", _workers.workers(), (unsigned long) _workers.executed(), (unsigned long) _workers.steals());
+    #endif
+    output->concatf("-- Indexed codes      \t%d\n", _sub_index.codes());
+    output->concatf("-- Call-aheads        \t%d over %d codes\n", ca_listeners.listeners(), ca_listeners.codes());
+    output->concatf("-- Call-backs         \t%d over %d codes\n", cb_listeners.listeners(), cb_listeners.codes());
     output->concatf("-- specificity burden \t%u\n", (unsigned long) burden_of_specific);
+    output->concatf("-- Ingress depth      \t%d/%d\n", _ingress.size(), _ingress.capacity());
+    output->concatf("-- Ingress drained    \t%u\n", (unsigned long) ingress_drained);
+    output->concatf("-- Ingress overflows  \t%u\n", (unsigned long) _ingress.overflows());
+    #if defined(__BUILD_HAS_PTHREADS)
+      output->concatf("-- Ingress spilled    \t%u\n", (unsigned long) _spilled);
+    #endif
   }
 
   output->concatf("-- total_events       \t%u\n", (unsigned long) total_events);
@@ -921,16 +1216,26 @@ void Kernel::printProfiler(StringBuilder* output) {
     output->concatf("   CPU use by clock: %f\n", (double)cpu_usage());
 
     #if defined(MANUVR_EVENT_PROFILER)
-      TaskProfilerData *profiler_item;
-      int stat_mode = event_costs.getPriority(0);
-      int x = event_costs.size();
-
-      TaskProfilerData::printDebugHeader(output);
-      for (int i = 0; i < x; i++) {
-        profiler_item = event_costs.get(i);
-        stat_mode     = event_costs.getPriority(i);
-        output->concatf("\t (%10d)\t", stat_mode);
-        profiler_item->printDebug(output);
+      if (nullptr != _latencies) {
+        output->concat("\n\t                 Event      Execd |  Wait p50       p99      p999 |   Run p50       p99      p999     worst\n");
+        for (int i = 0; i < _latencies->capacity(); i++) {
+          LatencyProfile* p = _latencies->get(i);
+          if (nullptr == p) continue;
+          output->concatf("\t%22s  %9u | %9u %9u %9u | %9u %9u %9u %9u\n",
+            ManuvrMsg::getMsgTypeString(p->code),
+            (unsigned int) p->run.count(),
+            (unsigned int) p->wait.percentile(500),
+            (unsigned int) p->wait.percentile(990),
+            (unsigned int) p->wait.percentile(999),
+            (unsigned int) p->run.percentile(500),
+            (unsigned int) p->run.percentile(990),
+            (unsigned int) p->run.percentile(999),
+            (unsigned int) p->run.worst()
+          );
+        }
+        if (_latencies->turnedAway()) {
+          output->concatf("\t %u records were turned away. Raise MANUVR_PROFILER_CODES.\n", (unsigned int) _latencies->turnedAway());
+        }
       }
     #endif   // MANUVR_EVENT_PROFILER
   }
@@ -945,7 +1250,7 @@ void Kernel::printProfiler(StringBuilder* output) {
 
       int sched_it_count = schedules.size();
       for (int i = 0; i < sched_it_count; i++) {
-        current = schedules.recycle();   // TODO: Still awful.
+        current = schedules.get(i);
         if (current->profilingEnabled()) {
           current->printProfilerData(output);
         }
@@ -973,7 +1278,7 @@ void Kernel::printScheduler(StringBuilder* output) {
   #if defined(MANUVR_DEBUG)
   int sched_it_count = schedules.size();
   for (int i = 0; i < sched_it_count; i++) {
-    schedules.recycle()->printDebug(output);
+    schedules.get(i)->printDebug(output);
   }
   #endif
 }
@@ -1143,7 +1448,7 @@ unsigned int Kernel::countActiveSchedules() {
   ManuvrMsg *current;
   int sched_it_count = schedules.size();
   for (int i = 0; i < sched_it_count; i++) {
-    current = schedules.recycle();
+    current = schedules.get(i);
     if (current->scheduleEnabled()) {
       return_value++;
     }
@@ -1212,7 +1517,8 @@ ManuvrMsg* Kernel::createSchedule(uint32_t sch_period, int16_t recurrence, bool
 *   are in an ISR.
 */
 void Kernel::advanceScheduler(unsigned int ms_elapsed) {
-  _ms_elapsed += (uint32_t) ms_elapsed;
+  // More than one context might be advancing us (a timer and an idle wakeup).
+  __atomic_fetch_add(&_ms_elapsed, (uint32_t) ms_elapsed, __ATOMIC_RELAXED);
 
   if (_skip_detected()) {
     // Failsafe block
@@ -1270,39 +1576,89 @@ bool Kernel::addSchedule(ManuvrMsg* obj) {
 }
 
 
+/**
+* How long may the kernel thread sleep before a schedule needs servicing?
+* Platforms that block in their idle hook use this as their timeout.
+*
+* @return ms until the soonest schedule is due, 0 if one is due now, or -1 if
+*           there are no enabled schedules.
+*/
+int32_t Kernel::msToNextSchedule() {
+  return schedules.timeToNextDue(_sched_clock + _ms_elapsed);
+}
+
+
+/**
+* EventReceivers call this when they change their declared interests. The index
+*   is only ever rebuilt on the kernel thread, so all we do here is mark it stale.
+*/
+void Kernel::subscriptionsChanged() {
+  if (nullptr != INSTANCE) INSTANCE->_sub_index.invalidate();
+}
+
+
+/**
+* ManuvrMsg calls this whenever something changes when a schedule will fire.
+* The schedule heap belongs to the kernel thread. If the change came from some
+*   other thread, we can't touch the heap, so we re-sort all of it on the next tick.
+*
+* @param  obj  The schedule that was altered.
+*/
+void Kernel::scheduleChanged(ManuvrMsg* obj) {
+  if (nullptr == INSTANCE) return;   // Static init. Will be sorted on insertion.
+  if (on_kernel_thread()) {
+    INSTANCE->schedules.update(obj);
+  }
+  else {
+    __atomic_store_n(&_sched_dirty, true, __ATOMIC_RELEASE);
+    platform.wakeHook();   // The deadline we were sleeping toward may have moved.
+  }
+}
+
+
 /**
 * This is the function that is called from the main loop to offload big
 *  tasks into idle CPU time. If many scheduled items have fired, function
 *  will churn through all of them. The presumption is that they are
 *  latency-sensitive.
+* Only schedules that are due are touched. The rest wait in the heap.
 */
 int Kernel::serviceSchedules() {
   if (!platform.booted() || (0 == _ms_elapsed)) return -1;
   int return_value = 0;
-  uint32_t mse = _ms_elapsed;  // Concurrency....
-  _ms_elapsed = 0;
+  uint32_t mse = __atomic_exchange_n(&_ms_elapsed, 0, __ATOMIC_RELAXED);  // Concurrency....
+  _sched_clock += mse;
 
-  int x = schedules.size();
-  ManuvrMsg *current;
+  if (__atomic_exchange_n(&_sched_dirty, false, __ATOMIC_ACQ_REL)) {
+    schedules.rebuild();
+  }
 
-  for (int i = 0; i < x; i++) {
-    current = schedules.recycle();
-    if (current->scheduleEnabled()) {
-      switch (current->applyTime(mse)) {
-        case 1:   // Schedule should be exec'd and retained.
-          Kernel::staticRaiseEvent(current);
-          break;
-        case -1:  // Schedule should be dropped and executed.
-          Kernel::staticRaiseEvent(current);
-        case -2:  // Schedule should be dropped without execution.
-          removeSchedule(current);
-          x--;
-          break;
-        case 0:   // Nominal outcome. No action.
-        default:  // Nonsense.
-          break;
-      }
+  ManuvrMsg *current = schedules.nextDue(_sched_clock);
+  while (nullptr != current) {
+    MANUVR_TRACE_INSTANT(TraceCat::SCHEDULE, current->eventCode(), current->getMsgTypeString(), schedules.size());
+    switch (current->fireSchedule(_sched_clock)) {
+      case 1:   // Schedule should be exec'd and retained.
+        Kernel::staticRaiseEvent(current);
+        schedules.update(current);
+        break;
+      case -1:  // Schedule should be dropped and executed.
+        // Unhook it from the scheduler, but don't reclaim it. It will be
+        //   reclaimed after it runs, like any other Msg.
+        schedules.remove(current);
+        current->isScheduled(false);
+        current->decRefs();
+        Kernel::staticRaiseEvent(current);
+        break;
+      case -2:  // Schedule should be dropped without execution.
+        removeSchedule(current);
+        break;
+      case 0:   // Nominal outcome. No action.
+      default:  // Nonsense.
+        schedules.update(current);
+        break;
     }
+    return_value++;
+    current = schedules.nextDue(_sched_clock);
   }
 
   // We just ran a loop. Punch the bistable swtich.
@@ -1349,6 +1705,26 @@ void Kernel::procDirectDebugInstruction(StringBuilder* input) {
       profiler('P' == c);
       break;
 
+    #if defined(MANUVR_TRACE)
+      case 'T':
+      case 't':
+        local_log.concatf("Kernel tracing %sabled.\n", ('T' == c) ? "en" : "dis");
+        Tracer::enabled('T' == c);
+        break;
+      case 'X':   // Export the trace, to a file if one is named.
+        if (input->count() > 1) {
+          const char* path = (const char*) input->position(1);
+          temp_int = Tracer::exportJSON(path);
+          if (temp_int < 0) local_log.concatf("Failed to write the trace to %s.\n", path);
+          else local_log.concatf("Wrote %d trace records to %s.\n", temp_int, path);
+        }
+        else {
+          Tracer::exportJSON(&local_log);
+        }
+        if (Tracer::dropped()) local_log.concatf("%u trace records were dropped.\n", (unsigned int) Tracer::dropped());
+        break;
+    #endif  // MANUVR_TRACE
+
     case 'y':    // Power mode.
       {
         ManuvrMsg* event = returnEvent(MANUVR_MSG_SYS_POWER_MODE);
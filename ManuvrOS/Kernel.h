@@ -37,6 +37,17 @@ limitations under the License.
   #include <DataStructures/PriorityQueue.h>
   #include <DataStructures/StringBuilder.h>
   #include <EventReceiver.h>
+  #include <Tracer.h>
+  #include <ManuvrMsg/MsgQueue.h>
+  #include <ManuvrMsg/MsgIngress.h>
+  #include <ManuvrMsg/ScheduleHeap.h>
+  #include <ManuvrMsg/SubscriberIndex.h>
+  #include <ManuvrMsg/ListenerTable.h>
+  #include <ManuvrMsg/LatencyHistogram.h>
+  #if defined(__BUILD_HAS_PTHREADS)
+    #include <pthread.h>
+    #include <ManuvrMsg/WorkerPool.h>
+  #endif
 
   /*
   * These state flags are hosted by the EventReceiver. This may change in the future.
@@ -113,6 +124,7 @@ limitations under the License.
       bool removeSchedule(ManuvrMsg*);  // Clears all data relating to the given schedule.
       bool addSchedule(ManuvrMsg*);
       void printScheduler(StringBuilder*);
+      int32_t msToNextSchedule();       // How long until a schedule needs servicing? -1 if never.
 
       /*
       * These are the core functions of the kernel that must be called from outside.
@@ -126,6 +138,10 @@ limitations under the License.
       void profiler(bool enabled);
       void printProfiler(StringBuilder*);
 
+      /* Worker threads for receivers that don't need the kernel thread. */
+      int8_t workers(uint8_t count);            // Kernel thread only. Zero stops them.
+      int    workers();
+
       inline void maxEventsPerLoop(int8_t nu) { max_events_per_loop = (nu > 0) ? nu : 1; }
       inline int8_t maxEventsPerLoop() {        return max_events_per_loop; }
       inline int queueSize() {                  return INSTANCE->exec_queue.size();     }
@@ -144,6 +160,11 @@ limitations under the License.
       static BufferPipe* _logger;        // The log pipe.
       static uint32_t lagged_schedules;  // How many schedules were skipped? Ideally this is zero.
 
+      /* The scheduler's notion of time, in ms. Advances as schedules are serviced. */
+      static inline uint32_t schedulerClock() {   return _sched_clock;   };
+      static void scheduleChanged(ManuvrMsg*);  // A schedule's timing was altered.
+      static void subscriptionsChanged();       // A subscriber's interests were altered.
+
       /* These functions deal with logging.*/
       static void log(int severity, const char *str);  // Pass-through to the logger class, whatever that happens to be.
       static void log(const char *str);                // Pass-through to the logger class, whatever that happens to be.
@@ -165,14 +186,19 @@ limitations under the License.
 
     private:
       ManuvrMsg* current_event = nullptr;  // The presently-executing event.
-      PriorityQueue<ManuvrMsg*>        exec_queue;    // Msgs that are pending execution.
-      PriorityQueue<ManuvrMsg*>        schedules;     // These are Msgs scheduled to be run.
+      MsgQueue                         exec_queue;    // Msgs that are pending execution.
+      ScheduleHeap                     schedules;     // These are Msgs scheduled to be run.
       PriorityQueue<ManuvrMsg*>        preallocated;  // This is the listing of pre-allocated Msgs.
       PriorityQueue<BufferPipe*>       _pipe_io_pend; // Pending BufferPipe transfers that wish to be async.
-      PriorityQueue<TaskProfilerData*> event_costs;   // Message code is the priority. Calculates average cost in uS.
       PriorityQueue<EventReceiver*>    subscribers;   // Our manifest of EventReceivers we service.
-      std::map<uint16_t, PriorityQueue<listenerFxnPtr>*> ca_listeners;  // Call-ahead listeners.
-      std::map<uint16_t, PriorityQueue<listenerFxnPtr>*> cb_listeners;  // Call-back listeners.
+      SubscriberIndex                  _sub_index;    // Which subscribers care about which codes?
+      ListenerTable                    ca_listeners;  // Call-ahead listeners.
+      ListenerTable                    cb_listeners;  // Call-back listeners.
+      LatencyTable*                    _latencies = nullptr;  // Per-code wait and run times. Only while profiling.
+      #if defined(__BUILD_HAS_PTHREADS)
+        WorkerPool                     _workers;      // Runs notify() for receivers that let it.
+        PriorityQueue<ManuvrMsg*>      _held;         // Raised again while the workers still had them.
+      #endif
 
       uint32_t _ms_elapsed        = 0; // How much time has passed since we serviced our schedules?
       uint32_t _skips_observed    = 0; // How many sequential scheduler skips have we noticed?
@@ -191,21 +217,46 @@ limitations under the License.
       uint32_t prealloc_starved;       // How many times did we starve the prealloc queue?
       uint32_t burden_of_specific;     // How many events have we reaped?
       uint32_t insertion_denials;      // How many times have we rejected events?
+      uint32_t ingress_drained;        // How many events have come in from other threads?
+      uint32_t notifies_made;          // How many times have we called a subscriber's notify()?
+      uint32_t notifies_dead;          // How many of those notify() calls took no action?
+      uint32_t notifies_skipped;       // How many notify() calls did the subscriber index save us?
+      uint32_t notifies_offloaded;     // How many notify() calls went to workers?
 
       ManuvrMsg _preallocation_pool[EVENT_MANAGER_PREALLOC_COUNT];
+      #if (ARGUMENT_POOL_SIZE > 0)
+        uint8_t  _arg_slab[ARGUMENT_POOL_SIZE * ARGUMENT_POOL_SLOT_SIZE] __attribute__ ((aligned (8)));
+        uint16_t _arg_links[ARGUMENT_POOL_SIZE];
+      #endif
 
       uint8_t  max_events_p_loop;     // What is the most events we've handled in a single loop?
       int8_t   max_events_per_loop;
 
       int8_t procCallAheads(ManuvrMsg* active_event);
       int8_t procCallBacks(ManuvrMsg* active_event);
+      void   complete_event(ManuvrMsg* active_event, uint8_t activity);
+      static void mark_raised(ManuvrMsg*);
+      int    drain_workers();
 
       unsigned int countActiveSchedules(void);  // How many active schedules are present?
       int serviceSchedules(void);         // Prep any schedules that have come due for exec.
 
       int8_t validate_insertion(ManuvrMsg*);
+      int    drain_ingress();
+      static int8_t foreign_push(ManuvrMsg*);
+      static bool on_kernel_thread();
       bool returnToPrealloc(ManuvrMsg*);
       void reclaim_event(ManuvrMsg*);
+      /* Hands a notify() to the workers, if the Msg has a flight and the receiver lets us. */
+      inline bool offload(int flight, EventReceiver* er) {
+        #if defined(__BUILD_HAS_PTHREADS)
+          if ((flight >= 0) && (0 == _workers.submit(flight, er))) {
+            notifies_offloaded++;
+            return true;
+          }
+        #endif
+        return false;
+      };
       inline void update_maximum_queue_depth() {   max_queue_depth = (exec_queue.size() > (int) max_queue_depth) ? exec_queue.size() : max_queue_depth;   };
 
 
@@ -221,7 +272,17 @@ limitations under the License.
 
       static uintptr_t   _prealloc_max;
       static Kernel*     INSTANCE;
-      static PriorityQueue<ManuvrMsg*> isr_exec_queue;   // Events that have been raised from ISRs.
+      static unsigned long _kernel_thread;  // The thread that runs procIdleFlags().
+      static uint32_t      _sched_clock;    // Total ms applied to the schedules.
+      static bool          _sched_dirty;    // A schedule was altered from another thread.
+      static MsgIngress    _ingress;        // Events raised from ISRs and foreign threads.
+      #if defined(__BUILD_HAS_PTHREADS)
+        static ManuvrMsg*      _spill_head;     // Foreign threads overflow into this FIFO if the ingress is full.
+        static ManuvrMsg*      _spill_tail;
+        static pthread_mutex_t _spill_lock;
+        static int             _spill_depth;
+        static uint32_t        _spilled;        // How many Msgs ever went through the spill?
+      #endif
   };
 
 
@@ -0,0 +1,247 @@
+/*
+File:   LatencyHistogram.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+These are the Kernel's per-code latency records, for when the event profiler
+  is on.
+
+A LatencyHistogram counts microsecond durations in log-linear buckets, in the
+  manner of HdrHistogram. By default, each power of two is split into 8
+  buckets, so any reported value is within 12.5% of the truth, no matter its
+  magnitude. Durations of 2^24us (about 17 seconds) or more share the last
+  bucket.
+  Recording is a handful of shifts and a few relaxed atomics. It never
+  allocates, and never locks, so it is safe from any thread.
+
+A LatencyTable holds a pair of histograms for each message code: how long Msgs
+  waited in the queue, and how long they took to run. Codes are found by
+  open-addressed hashing, and claim a slot the first time they are seen. A
+  full table turns new codes away, rather than evict.
+
+The Kernel only allocates its table when the profiler is turned on. Even so,
+  the defaults cost 4 * 2 * LATENCY_BUCKETS (176) bytes per code, or 45KB for
+  32 codes. Builds for small parts will want to trim LATENCY_SUB_BITS,
+  LATENCY_MAX_BITS, and MANUVR_PROFILER_CODES. For instance, 2 and 20 give 76
+  buckets, within 25%, up to a second.
+*/
+
+
+#ifndef __MANUVR_LATENCY_HISTOGRAM_H__
+#define __MANUVR_LATENCY_HISTOGRAM_H__
+
+#include <inttypes.h>
+#include "MessageDefs.h"
+
+// How many distinct codes can the profiler track? Must be a power of two.
+#ifndef MANUVR_PROFILER_CODES
+  #define MANUVR_PROFILER_CODES 32
+#endif
+#if (MANUVR_PROFILER_CODES < 2) || (MANUVR_PROFILER_CODES & (MANUVR_PROFILER_CODES - 1))
+  #error MANUVR_PROFILER_CODES must be a power of two, and at least 2.
+#endif
+
+// Each power of two gets 2^LATENCY_SUB_BITS buckets.
+#ifndef LATENCY_SUB_BITS
+  #define LATENCY_SUB_BITS   3
+#endif
+
+// The last bucket holds everything from 2^LATENCY_MAX_BITS us up.
+#ifndef LATENCY_MAX_BITS
+  #define LATENCY_MAX_BITS   24
+#endif
+
+#if (LATENCY_SUB_BITS < 1) || (LATENCY_MAX_BITS <= LATENCY_SUB_BITS) || (LATENCY_MAX_BITS > 31)
+  #error LATENCY_MAX_BITS must be more than LATENCY_SUB_BITS, which must be at least 1, and less than 32.
+#endif
+
+#define LATENCY_BUCKETS      ((LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS)
+
+
+class LatencyHistogram {
+  public:
+    void     record(uint32_t us);   // Any thread.
+    void     clear();
+    uint32_t percentile(uint16_t permille);
+
+    inline uint32_t count() {   return __atomic_load_n(&_total, __ATOMIC_RELAXED);   };
+    inline uint32_t worst() {   return __atomic_load_n(&_worst, __ATOMIC_RELAXED);   };
+
+    static uint16_t bucketOf(uint32_t us);
+    static uint32_t bucketCeiling(uint16_t bucket);
+
+
+  private:
+    uint32_t _counts[LATENCY_BUCKETS];
+    uint32_t _total;
+    uint32_t _worst;
+};
+
+
+/* Everything we know about how one message code behaves. */
+typedef struct {
+  uint16_t         code;   // MANUVR_MSG_UNDEFINED if the slot is free.
+  LatencyHistogram wait;   // From being raised, to being dispatched.
+  LatencyHistogram run;    // From being dispatched, to being done with.
+} LatencyProfile;
+
+
+class LatencyTable {
+  public:
+    LatencyTable();
+
+    LatencyProfile* lookup(uint16_t code);   // Claims a slot if needed. nullptr if full.
+    LatencyProfile* get(int slot);           // nullptr if the slot is free.
+    void            clear();
+
+    inline int      capacity() {   return MANUVR_PROFILER_CODES;   };
+    inline uint32_t turnedAway() { return __atomic_load_n(&_turned_away, __ATOMIC_RELAXED);   };
+
+
+  private:
+    LatencyProfile _profiles[MANUVR_PROFILER_CODES];
+    uint32_t       _turned_away;   // Records dropped because the table was full.
+
+    static inline uint16_t _slot(uint16_t code) {
+      return ((uint16_t) (code * 40503u)) >> (16 - __builtin_ctz(MANUVR_PROFILER_CODES));
+    };
+};
+
+
+
+/**
+* @param  us  A duration.
+* @return The bucket that it belongs in.
+*/
+inline uint16_t LatencyHistogram::bucketOf(uint32_t us) {
+  if (us < (1 << LATENCY_SUB_BITS)) return (uint16_t) us;
+  if (us >= (1u << LATENCY_MAX_BITS)) return (LATENCY_BUCKETS - 1);
+  int msb = 31 - __builtin_clz(us);
+  int shift = msb - LATENCY_SUB_BITS;
+  return (uint16_t) (((shift + 1) << LATENCY_SUB_BITS) + ((us >> shift) & ((1 << LATENCY_SUB_BITS) - 1)));
+}
+
+
+/**
+* @param  bucket  A bucket index.
+* @return The largest duration that lands in the bucket.
+*/
+inline uint32_t LatencyHistogram::bucketCeiling(uint16_t bucket) {
+  if (bucket < (1 << LATENCY_SUB_BITS)) return bucket;
+  if (bucket >= (LATENCY_BUCKETS - 1)) return 0xFFFFFFFF;
+  int shift = (bucket >> LATENCY_SUB_BITS) - 1;
+  uint32_t floor = ((1u << LATENCY_SUB_BITS) + (bucket & ((1 << LATENCY_SUB_BITS) - 1))) << shift;
+  return floor + (1u << shift) - 1;
+}
+
+
+inline void LatencyHistogram::record(uint32_t us) {
+  __atomic_add_fetch(&_counts[bucketOf(us)], 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&_total, 1, __ATOMIC_RELAXED);
+  uint32_t w = __atomic_load_n(&_worst, __ATOMIC_RELAXED);
+  while ((us > w) && !__atomic_compare_exchange_n(&_worst, &w, us, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+
+inline void LatencyHistogram::clear() {
+  for (int i = 0; i < LATENCY_BUCKETS; i++) _counts[i] = 0;
+  _total = 0;
+  _worst = 0;
+}
+
+
+/**
+* Records that land while we count might be missed. That is fine for a report.
+*
+* @param  permille  The percentile, in tenths, from 0 to 1000. So p99.9 is 999.
+* @return The duration that permille of the recorded durations did not
+*           exceed, rounded up to its bucket's ceiling. Zero if empty.
+*/
+inline uint32_t LatencyHistogram::percentile(uint16_t permille) {
+  uint32_t total = count();
+  if (0 == total) return 0;
+  // The rank is rounded up, so that p99.9 of 100 samples is the worst of them.
+  uint32_t target = (uint32_t) ((((uint64_t) total * permille) + 999) / 1000);
+  if (target < 1) target = 1;
+  uint32_t seen = 0;
+  for (int i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += __atomic_load_n(&_counts[i], __ATOMIC_RELAXED);
+    if (seen >= target) {
+      uint32_t ceiling = bucketCeiling(i);
+      return (ceiling < worst()) ? ceiling : worst();
+    }
+  }
+  return worst();
+}
+
+
+
+inline LatencyTable::LatencyTable() {
+  clear();
+}
+
+
+/**
+* Forgets every code, and everything recorded. Nobody may be recording.
+*/
+inline void LatencyTable::clear() {
+  for (int i = 0; i < MANUVR_PROFILER_CODES; i++) {
+    _profiles[i].code = MANUVR_MSG_UNDEFINED;
+    _profiles[i].wait.clear();
+    _profiles[i].run.clear();
+  }
+  _turned_away = 0;
+}
+
+
+/**
+* Finds the code's profile, claiming a free slot for it if this is the first
+*   time we have seen it. Safe from any thread.
+*
+* @param  code  The message code.
+* @return The code's profile, or nullptr if the table is full.
+*/
+inline LatencyProfile* LatencyTable::lookup(uint16_t code) {
+  uint16_t s = _slot(code);
+  for (int probes = 0; probes < MANUVR_PROFILER_CODES; probes++) {
+    uint16_t held = __atomic_load_n(&_profiles[s].code, __ATOMIC_ACQUIRE);
+    if (code == held) return &_profiles[s];
+    if (MANUVR_MSG_UNDEFINED == held) {
+      if (__atomic_compare_exchange_n(&_profiles[s].code, &held, code, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return &_profiles[s];
+      }
+      if (code == held) return &_profiles[s];   // Someone claimed it for us.
+    }
+    s = (s + 1) & (MANUVR_PROFILER_CODES - 1);
+  }
+  __atomic_add_fetch(&_turned_away, 1, __ATOMIC_RELAXED);
+  return nullptr;
+}
+
+
+/**
+* @param  slot  A slot index, less than capacity().
+* @return The profile in that slot, or nullptr if it is free.
+*/
+inline LatencyProfile* LatencyTable::get(int slot) {
+  if ((slot < 0) || (slot >= MANUVR_PROFILER_CODES)) return nullptr;
+  if (MANUVR_MSG_UNDEFINED == __atomic_load_n(&_profiles[slot].code, __ATOMIC_ACQUIRE)) return nullptr;
+  return &_profiles[slot];
+}
+
+#endif  // __MANUVR_LATENCY_HISTOGRAM_H__
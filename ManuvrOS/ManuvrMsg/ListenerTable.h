@@ -0,0 +1,190 @@
+/*
+File:   ListenerTable.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+This is the Kernel's table of call-ahead (or call-back) listeners. The codes
+  that have listeners are kept sorted in one dense array. All the listeners sit
+  in one contiguous array of function pointers, grouped by code, in the order
+  they were added.
+
+Looking up a code is a binary search, and never allocates. Codes that nobody
+  listens for cost nothing.
+
+Listeners are added rarely, and dispatched often. So adding one rebuilds the
+  function array rather than editing it. The old array is retired instead of
+  freed, because a dispatch might be walking it at that moment (a listener may
+  add another listener). Retired arrays are freed by reap(), which the Kernel
+  calls between Msgs.
+*/
+
+
+#ifndef __MANUVR_LISTENER_TABLE_H__
+#define __MANUVR_LISTENER_TABLE_H__
+
+#include <inttypes.h>
+#include <EnumeratedTypeCodes.h>
+#include <DataStructures/PriorityQueue.h>
+
+
+class ListenerTable {
+  public:
+    ListenerTable();
+    ~ListenerTable();
+
+    int  add(uint16_t code, listenerFxnPtr);   // Returns 0 on success, or -1 if NULL or OOM.
+    void reap();                               // Frees retired arrays. Only between dispatches.
+
+    /*
+    * Finds the listeners for a code. The array stays valid until the next reap(),
+    *   even if more listeners are added meanwhile.
+    * Returns how many listeners there are.
+    */
+    int lookup(uint16_t code, listenerFxnPtr** list);
+
+    inline int codes() {       return _code_count;   };
+    inline int listeners() {   return _fxn_count;    };
+
+
+  private:
+    uint16_t*       _codes;       // Sorted. _code_count long.
+    uint16_t*       _starts;      // Where each code's listeners begin. _code_count + 1 long.
+    listenerFxnPtr* _fxns;        // Every listener, grouped by code.
+    int             _code_count;
+    int             _fxn_count;
+    PriorityQueue<listenerFxnPtr*> _retired;  // Old _fxns that a dispatch might still hold.
+
+    int _find(uint16_t code);     // Index of the first code >= the given code.
+};
+
+
+inline ListenerTable::ListenerTable() {
+  _codes      = nullptr;
+  _starts     = nullptr;
+  _fxns       = nullptr;
+  _code_count = 0;
+  _fxn_count  = 0;
+}
+
+inline ListenerTable::~ListenerTable() {
+  reap();
+  if (nullptr != _codes)  delete[] _codes;
+  if (nullptr != _starts) delete[] _starts;
+  if (nullptr != _fxns)   delete[] _fxns;
+}
+
+
+inline int ListenerTable::_find(uint16_t code) {
+  int lo = 0;
+  int hi = _code_count;
+  while (lo < hi) {
+    int mid = (lo + hi) >> 1;
+    if (_codes[mid] < code) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+
+/**
+* @param  code  The message code.
+* @param  list  Receives a pointer to the first listener. Untouched if there are none.
+* @return How many listeners the code has.
+*/
+inline int ListenerTable::lookup(uint16_t code, listenerFxnPtr** list) {
+  int i = _find(code);
+  if ((i < _code_count) && (code == _codes[i])) {
+    *list = &_fxns[_starts[i]];
+    return (_starts[i + 1] - _starts[i]);
+  }
+  return 0;
+}
+
+
+/**
+* Adds a listener to the end of a code's list. Adding the same function twice
+*   will have it called twice.
+*
+* @param  code  The message code.
+* @param  fxn   The listener.
+* @return 0 on success, or -1 if the listener was NULL, or we ran out of memory.
+*/
+inline int ListenerTable::add(uint16_t code, listenerFxnPtr fxn) {
+  if ((nullptr == fxn) || (0xFFFF == _fxn_count)) return -1;
+  int  i          = _find(code);
+  bool nu_code    = !((i < _code_count) && (code == _codes[i]));
+  int  code_count = _code_count + (nu_code ? 1 : 0);
+
+  listenerFxnPtr* fxns = new listenerFxnPtr[_fxn_count + 1];
+  if (nullptr == fxns) return -1;
+  uint16_t* codes  = _codes;
+  uint16_t* starts = _starts;
+  if (nu_code) {
+    codes  = new uint16_t[code_count];
+    starts = new uint16_t[code_count + 1];
+    if ((nullptr == codes) || (nullptr == starts)) {
+      if (nullptr != codes)  delete[] codes;
+      if (nullptr != starts) delete[] starts;
+      delete[] fxns;
+      return -1;
+    }
+    for (int x = 0; x < i; x++) {
+      codes[x]  = _codes[x];
+      starts[x] = _starts[x];
+    }
+    codes[i]  = code;
+    starts[i] = (i < _code_count) ? _starts[i] : _fxn_count;
+    for (int x = i; x < _code_count; x++) {
+      codes[x + 1]  = _codes[x];
+      starts[x + 1] = _starts[x] + 1;
+    }
+    starts[code_count] = _fxn_count + 1;
+  }
+  else {
+    for (int x = i + 1; x <= _code_count; x++) starts[x]++;
+  }
+
+  // The new listener goes at the end of its code's group.
+  int slot = starts[i + 1] - 1;
+  for (int x = 0; x < slot; x++)           fxns[x]     = _fxns[x];
+  fxns[slot] = fxn;
+  for (int x = slot; x < _fxn_count; x++)  fxns[x + 1] = _fxns[x];
+
+  if (nu_code) {
+    if (nullptr != _codes)  delete[] _codes;
+    if (nullptr != _starts) delete[] _starts;
+    _codes  = codes;
+    _starts = starts;
+  }
+  if (nullptr != _fxns) _retired.insert(_fxns);
+  _fxns       = fxns;
+  _code_count = code_count;
+  _fxn_count++;
+  return 0;
+}
+
+
+/**
+* Frees every retired function array. Must not be called while anyone is
+*   walking a list returned by lookup().
+*/
+inline void ListenerTable::reap() {
+  while (_retired.hasNext()) delete[] _retired.dequeue();
+}
+
+#endif  // __MANUVR_LISTENER_TABLE_H__
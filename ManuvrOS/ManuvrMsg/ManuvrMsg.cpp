@@ -43,7 +43,11 @@ extern inline uint16_t parseUint16Fromchars(unsigned char *input);
 * Static members and initializers should be located here.
 *******************************************************************************/
 // Runtime manifest of Msg definitions.
-std::map<uint16_t, const MessageTypeDef*> ManuvrMsg::message_defs_extended;
+#define MSG_DEF_TABLE_MIN_BITS  6
+
+const MessageTypeDef** ManuvrMsg::_def_table      = nullptr;
+uint8_t                ManuvrMsg::_def_table_bits = 0;
+uint16_t               ManuvrMsg::_def_count      = 0;
 
 // Generic argument def for a message with no args.
 const unsigned char ManuvrMsg::MSG_ARGS_NONE[] = {0};
@@ -58,6 +62,103 @@ bool ManuvrMsg::isExportable(const MessageTypeDef* message_def) {
   return (message_def->msg_type_flags & MSG_FLAG_EXPORTABLE);
 }
 
+
+/**
+* Is the given def one of our own compiled-in defs?
+*/
+bool ManuvrMsg::_def_is_static(const MessageTypeDef* def) {
+  return ((def >= &message_defs[0]) && (def < &message_defs[TOTAL_MSG_DEFS]));
+}
+
+
+/**
+* Re-files every def we know into a table of the given size. The first time
+*   this is called, it files the compiled-in defs.
+* Registration is expected to happen at boot. It is not safe against lookups
+*   from other threads while the table is being replaced.
+*
+* @param  bits  The new table will have 2^bits slots.
+* @return 0 on success. -1 on failure, in which case the old table remains.
+*/
+int8_t ManuvrMsg::_def_table_resize(uint8_t bits) {
+  if (nullptr == _def_table) {
+    // Make room for the compiled-in defs with space to spare.
+    while ((1u << bits) < (unsigned int) (TOTAL_MSG_DEFS * 4)) bits++;
+  }
+  if (bits > 16) return -1;
+  unsigned int size = (1 << bits);
+  const MessageTypeDef** nu_table = (const MessageTypeDef**) malloc(size * sizeof(MessageTypeDef*));
+  if (nullptr == nu_table) return -1;
+  for (unsigned int i = 0; i < size; i++) nu_table[i] = nullptr;
+
+  const MessageTypeDef** old_table = _def_table;
+  unsigned int old_size = (nullptr != old_table) ? (1 << _def_table_bits) : 0;
+  _def_table      = nu_table;
+  _def_table_bits = bits;
+  _def_count      = 0;
+  if (nullptr == old_table) {
+    // The compiled-in defs go first, so that they take precedence.
+    for (int i = 0; i < TOTAL_MSG_DEFS; i++) _def_insert(&message_defs[i]);
+  }
+  else {
+    for (unsigned int i = 0; i < old_size; i++) {
+      if (nullptr != old_table[i]) _def_insert(old_table[i]);
+    }
+    free(old_table);
+  }
+  return 0;
+}
+
+
+/**
+* Files a def by its code, replacing any runtime-loaded def with the same code.
+*   Compiled-in defs are never replaced.
+*
+* @param  def  The def to file.
+* @return 0 on success. Non-zero otherwise.
+*/
+int8_t ManuvrMsg::_def_insert(const MessageTypeDef* def) {
+  if ((nullptr == _def_table) && _def_table_resize(MSG_DEF_TABLE_MIN_BITS)) {
+    return -1;
+  }
+  if ((unsigned int) (_def_count + 1) > ((1u << _def_table_bits) >> 1)) {
+    // Keep the table at most half-full.
+    if (_def_table_resize(_def_table_bits + 1)) return -1;
+  }
+  unsigned int mask = (1 << _def_table_bits) - 1;
+  unsigned int i    = _def_slot(def->msg_type_code, _def_table_bits);
+  while (nullptr != _def_table[i]) {
+    if (_def_table[i]->msg_type_code == def->msg_type_code) {
+      if (!_def_is_static(_def_table[i])) _def_table[i] = def;
+      return 0;
+    }
+    i = (i + 1) & mask;
+  }
+  _def_table[i] = def;
+  _def_count++;
+  return 0;
+}
+
+
+/**
+* @param  code  The message code to find.
+* @return The def for that code, or nullptr if we have none.
+*/
+const MessageTypeDef* ManuvrMsg::_def_find(uint16_t code) {
+  if ((nullptr == _def_table) && _def_table_resize(MSG_DEF_TABLE_MIN_BITS)) {
+    // Nothing has been registered yet, and we failed to file the compiled-in defs.
+    return nullptr;
+  }
+  unsigned int mask = (1 << _def_table_bits) - 1;
+  unsigned int i    = _def_slot(code, _def_table_bits);
+  while (nullptr != _def_table[i]) {
+    if (_def_table[i]->msg_type_code == code) return _def_table[i];
+    i = (i + 1) & mask;
+  }
+  return nullptr;
+}
+
+
 /**
 * Called by other classes to add their event definitions to the runtime
 *   manifest.
@@ -68,7 +169,7 @@ bool ManuvrMsg::isExportable(const MessageTypeDef* message_def) {
 */
 int8_t ManuvrMsg::registerMessages(const MessageTypeDef defs[], int mes_count) {
   for (int i = 0; i < mes_count; i++) {
-    message_defs_extended[defs[i].msg_type_code] = &defs[i];
+    if (_def_insert(&defs[i])) return -1;
   }
   return 0;
 }
@@ -81,8 +182,7 @@ int8_t ManuvrMsg::registerMessages(const MessageTypeDef defs[], int mes_count) {
 * @return 0 on success. Non-zero otherwise.
 */
 int8_t ManuvrMsg::registerMessage(MessageTypeDef* nu_def) {
-  message_defs_extended[nu_def->msg_type_code] = nu_def;
-  return 0;
+  return _def_insert(nu_def);
 }
 
 /**
@@ -119,19 +219,7 @@ int8_t ManuvrMsg::registerMessage(uint16_t tc, uint16_t tf, const char* lab, con
 * @return a pointer to the human-readable label for this Msg code. Never nullptr.
 */
 const char* ManuvrMsg::getMsgTypeString(uint16_t code) {
-  for (int i = 0; i < TOTAL_MSG_DEFS; i++) {
-    if (ManuvrMsg::message_defs[i].msg_type_code == code) {
-      return ManuvrMsg::message_defs[i].debug_label;
-    }
-  }
-
-  // Didn't find it there. Search in the extended defs...
-  const MessageTypeDef* temp_type_def = message_defs_extended[code];
-  if ( temp_type_def) {
-    return temp_type_def->debug_label;
-  }
-  // If we've come this far, we don't know what the caller is asking for. Return the default.
-  return ManuvrMsg::message_defs[0].debug_label;
+  return lookupMsgDefByCode(code)->debug_label;
 }
 
 
@@ -143,14 +231,8 @@ const char* ManuvrMsg::getMsgTypeString(uint16_t code) {
 * @return a pointer to the MessageTypeDef for this Msg code. Never nullptr.
 */
 const MessageTypeDef* ManuvrMsg::lookupMsgDefByCode(uint16_t code) {
-  for (int i = 0; i < TOTAL_MSG_DEFS; i++) {
-    if (ManuvrMsg::message_defs[i].msg_type_code == code) {
-      return &ManuvrMsg::message_defs[i];
-    }
-  }
-  // Didn't find it there. Search in the extended defs...
-  const MessageTypeDef* temp_type_def = message_defs_extended[code];
-  if (temp_type_def) {
+  const MessageTypeDef* temp_type_def = _def_find(code);
+  if (nullptr != temp_type_def) {
     return temp_type_def;
   }
   // If we've come this far, we don't know what the caller is asking for. Return the default.
@@ -173,13 +255,15 @@ const MessageTypeDef* ManuvrMsg::lookupMsgDefByLabel(char* label) {
     }
   }
 
-  // Didn't find it there. Search in the extended defs...
-  const MessageTypeDef* temp_type_def;
-	std::map<uint16_t, const MessageTypeDef*>::iterator it;
-	for (it = message_defs_extended.begin(); it != message_defs_extended.end(); it++) {
-    temp_type_def = it->second;
-    if (strstr(label, temp_type_def->debug_label)) {
-      return temp_type_def;
+  // Didn't find it there. Search in the runtime-loaded defs...
+  if (nullptr != _def_table) {
+    for (unsigned int i = 0; i < (1u << _def_table_bits); i++) {
+      const MessageTypeDef* temp_type_def = _def_table[i];
+      if ((nullptr != temp_type_def) && !_def_is_static(temp_type_def)) {
+        if (strstr(label, temp_type_def->debug_label)) {
+          return temp_type_def;
+        }
+      }
     }
   }
   // If we've come this far, we don't know what the caller is asking for. Return the default.
@@ -228,9 +312,9 @@ int8_t ManuvrMsg::getMsgLegend(StringBuilder* output) {
     }
   }
 
-	std::map<uint16_t, const MessageTypeDef*>::iterator it;
-	for (it = message_defs_extended.begin(); it != message_defs_extended.end(); it++) {
-    temp_def = it->second;
+  for (unsigned int i = 0; (nullptr != _def_table) && (i < (1u << _def_table_bits)); i++) {
+    temp_def = _def_table[i];
+    if ((nullptr == temp_def) || _def_is_static(temp_def)) continue;
 
     if (isExportable(temp_def)) {
       output->concat((unsigned char*) temp_def, 4);
@@ -304,7 +388,7 @@ ManuvrMsg::ManuvrMsg(int16_t recurrence, uint32_t sch_period, bool ac, FxnPointe
   autoClear(ac);
   _sched_recurs  = recurrence;
   _sched_period  = sch_period;
-  _sched_ttw     = sch_period;
+  _sched_due     = Kernel::schedulerClock() + sch_period;
   schedule_callback = sch_callback;    // This constructor uses the legacy callback.
 }
 
@@ -322,7 +406,7 @@ ManuvrMsg::ManuvrMsg(int16_t recurrence, uint32_t sch_period, bool ac, EventRece
   autoClear(ac);
   _sched_recurs  = recurrence;
   _sched_period  = sch_period;
-  _sched_ttw     = sch_period;
+  _sched_due     = Kernel::schedulerClock() + sch_period;
   _origin        = ori;
 }
 
@@ -349,8 +433,8 @@ ManuvrMsg::~ManuvrMsg() {
 */
 int8_t ManuvrMsg::repurpose(uint16_t code, EventReceiver* cb) {
   // These things have implications for memory management, which is why repurpose() doesn't touch them.
-  uint32_t _persist_mask = MANUVR_RUNNABLE_FLAG_SCHEDULED;
-  _flags            = _flags & _persist_mask;
+  uint32_t _persist_mask = MANUVR_RUNNABLE_FLAG_SCHEDULED | MANUVR_MSG_FLAG_ENQUEUED;
+  __atomic_and_fetch(&_flags, _persist_mask, __ATOMIC_ACQ_REL);
   _origin           = cb;
   specific_target   = nullptr;
   schedule_callback = nullptr;
@@ -483,7 +567,16 @@ uint8_t ManuvrMsg::inflateArgumentsFromBuffer(uint8_t* buffer, int len) {
 
       // Variable-length types...
       case TCode::STR:
-        nu_arg = new Argument(strdup((const char*) buffer));
+        nu_arg = new Argument((const char*) buffer);
+        nu_arg->target_mem = nu_arg->inlineValue(nu_arg->length());
+        if (nullptr != nu_arg->target_mem) {
+          // Small enough to ride along with the Argument.
+          memcpy(nu_arg->target_mem, buffer, nu_arg->length());
+        }
+        else {
+          nu_arg->target_mem = strdup((const char*) buffer);
+          nu_arg->reapValue(true);
+        }
         buffer = buffer + nu_arg->length();
         len    = len - nu_arg->length();
         break;
@@ -818,7 +911,7 @@ void ManuvrMsg::printDebug(StringBuilder *output) {
   if (isScheduled()) {
     output->concatf("\t [%p] Schedule \n\t --------------------------------\n", this);
     output->concatf("\t Enabled       \t%s\n", (scheduleEnabled() ? YES_STR : NO_STR));
-    output->concatf("\t Time-till-fire\t%u\n", _sched_ttw);
+    output->concatf("\t Time-till-fire\t%d\n", (int32_t) (_sched_due - Kernel::schedulerClock()));
     output->concatf("\t Period        \t%u\n", _sched_period);
     output->concatf("\t Recurs?       \t%d\n", _sched_recurs);
     output->concatf("\t Exec pending: \t%s\n", (shouldFire() ? YES_STR : NO_STR));
@@ -914,6 +1007,15 @@ bool ManuvrMsg::abort() {
 }
 
 
+/**
+* Anything that changes when this schedule will next fire must call this, so
+*   that the Kernel can re-sort it.
+*/
+void ManuvrMsg::_sched_refile() {
+  if (isScheduled()) Kernel::scheduleChanged(this);
+}
+
+
 /**
 * @param  uint32_t  The desired period (in mS) for this schedule.
 * @return  true if the schedule alteraction succeeded.
@@ -922,8 +1024,9 @@ bool ManuvrMsg::alterSchedulePeriod(uint32_t nu_period) {
   bool return_value  = false;
   if (nu_period > 1) {
     _sched_period       = nu_period;
-    _sched_ttw = nu_period;
+    _sched_due          = Kernel::schedulerClock() + nu_period;
     return_value  = true;
+    _sched_refile();
   }
   return return_value;
 }
@@ -936,6 +1039,7 @@ bool ManuvrMsg::alterSchedulePeriod(uint32_t nu_period) {
 bool ManuvrMsg::alterScheduleRecurrence(int16_t recurrence) {
   shouldFire(false);
   _sched_recurs = recurrence;
+  _sched_refile();
   return true;
 }
 
@@ -960,9 +1064,10 @@ bool ManuvrMsg::alterSchedule(uint32_t sch_p, int16_t sch_r, bool ac, FxnPointer
       autoClear(ac);
       _sched_recurs     = sch_r;
       _sched_period     = sch_p;
-      _sched_ttw        = sch_p;
+      _sched_due        = Kernel::schedulerClock() + sch_p;
       schedule_callback = sch_cb;
       return_value      = true;
+      _sched_refile();
     }
   }
   return return_value;
@@ -1005,27 +1110,32 @@ bool ManuvrMsg::willRunAgain() {
 
 
 /**
-* Applies time to the schedule, bringing it closer to execution.
+* Called by the Kernel when this schedule has come due (or was asked to fire
+*   now). Sets the next deadline relative to the given clock, carrying over any
+*   lateness so that the schedule doesn't drift.
+* The Kernel is responsible for re-sorting us after this returns.
 *
-* @param  uint32_t The number of milliseconds to drop from the schedule.
+* @param  uint32_t The scheduler clock, in milliseconds.
 * @return  an integer code directing the kernel how to procede.
 */
-int8_t ManuvrMsg::applyTime(uint32_t mse) {
+int8_t ManuvrMsg::fireSchedule(uint32_t now) {
   int8_t return_value = 0;
   if (scheduleEnabled()) {
-    if ((_sched_ttw > mse) && (!shouldFire())) {
-      _sched_ttw -= mse;
+    if (((int32_t) (_sched_due - now) > 0) && (!shouldFire())) {
+      // Not due yet. Nothing to do.
     }
     else {
       // The schedule should execute this time.
-      uint32_t adjusted_ttw = (mse - _sched_ttw);
+      uint32_t adjusted_ttw = shouldFire() ? 0 : (now - _sched_due);
       if (adjusted_ttw > _sched_period) {
         // TODO: Possible error-case? Too many clicks passed. We have schedule jitter...
         // For now, we'll just throw away the difference.
         adjusted_ttw = 0;
         Kernel::lagged_schedules++;
       }
-      _sched_ttw = _sched_period - adjusted_ttw;
+      // Never re-arm for the same tick, even with a zero period.
+      uint32_t ttw = _sched_period - adjusted_ttw;
+      _sched_due = now + (ttw ? ttw : 1);
       switch (_sched_recurs) {
         default:
           // If we are on a fixed execution-count, but will run again.
@@ -1058,9 +1168,10 @@ int8_t ManuvrMsg::applyTime(uint32_t mse) {
 bool ManuvrMsg::enableSchedule(bool en) {
   shouldFire(en);
   if (en) {
-    _sched_ttw = _sched_period;
+    _sched_due = Kernel::schedulerClock() + _sched_period;
   }
   scheduleEnabled(en);
+  _sched_refile();
   return true;
 }
 
@@ -1073,8 +1184,9 @@ bool ManuvrMsg::enableSchedule(bool en) {
 * @return  true, always.
 */
 bool ManuvrMsg::delaySchedule(uint32_t by_ms) {
-  _sched_ttw = by_ms;
+  _sched_due = Kernel::schedulerClock() + by_ms;
   scheduleEnabled(true);
+  _sched_refile();
   return true;
 }
 
@@ -53,12 +53,16 @@ This class forms the foundation of internal events. It contains the identity of
 #define MANUVR_MSG_FLAG_SCHED_ENABLED   0x08000000  // Is the schedule running?
 #define MANUVR_MSG_FLAG_SCHEDULED       0x10000000  // Set to true to cause the Kernel to not free().
 #define MANUVR_MSG_FLAG_PENDING_EXEC    0x20000000  // This schedule is pending execution.
+#define MANUVR_MSG_FLAG_ENQUEUED        0x40000000  // This Msg is presently in the Kernel's exec_queue.
+#define MANUVR_MSG_FLAG_SPILLED         0x80000000  // This Msg is presently in the Kernel's spill.
 
 #define MANUVR_MSG_FLAG_PRIORITY_MASK   0x0000FF00
 #define MANUVR_MSG_FLAG_REF_COUNT_MASK  0x0000007F
 
 
 class EventReceiver;
+class MsgQueue;
+class ScheduleHeap;
 
 /*
 * Messages are defined by this struct. Note that this amounts to nothing more than definition.
@@ -267,14 +271,17 @@ class ManuvrMsg {
     */
     inline bool singleTarget() { return (schedule_callback || specific_target); };
 
+    /* If singleTarget is true, whose notify() will execute() call? nullptr if it calls a function. */
+    inline EventReceiver* executionTarget() {  return ((schedule_callback) ? nullptr : specific_target);  };
+
     /* If singleTarget is true, the kernel calls this to proc the event. */
     int8_t execute();
 
     /* If this ManuvrMsg is scheduled, aborts it. Returns true if aborted. */
     bool abort();
 
-    /* Applies time to the schedule, bringing it closer to execution. */
-    int8_t applyTime(uint32_t ms);
+    /* Called by the Kernel when this schedule comes due. Re-times it from the given clock. */
+    int8_t fireSchedule(uint32_t now);
 
     /* Called from the kernel to inform the class that it has completed. */
     int8_t callbackOriginator();
@@ -303,14 +310,14 @@ class ManuvrMsg {
     * All schedule members are treated normally, so if the schedule recurs,
     *   it will be re-timed after next-tick, with a decremented recur counter.
     */
-    inline void fireNow() { shouldFire(true); };
+    inline void fireNow() { shouldFire(true);  _sched_refile();  };
 
     /**
     * Is the schedule pending execution ahread of schedule (next tick)?
     *
     * @return true if the schedule will execute ahread of schedule.
     */
-    inline bool shouldFire() { return (_flags & MANUVR_RUNNABLE_FLAG_PENDING_EXEC); };
+    inline bool shouldFire() { return (_load_flags() & MANUVR_RUNNABLE_FLAG_PENDING_EXEC); };
 
     /**
     * Is this schedule being observed? If yes, it will execute in the future
@@ -318,7 +325,7 @@ class ManuvrMsg {
     *
     * @return true if the schedule is enabled.
     */
-    inline bool scheduleEnabled() { return (_flags & MANUVR_RUNNABLE_FLAG_SCHED_ENABLED); };
+    inline bool scheduleEnabled() { return (_load_flags() & MANUVR_RUNNABLE_FLAG_SCHED_ENABLED); };
 
     /**
     * When this schedule completes normally, will it be dropped from the
@@ -327,10 +334,8 @@ class ManuvrMsg {
     *
     * @return true if the schedule will be dropped from the schedule queue.
     */
-    inline bool autoClear() { return (_flags & MANUVR_RUNNABLE_FLAG_AUTOCLEAR); };
-    inline void autoClear(bool en) {
-      _flags = (en) ? (_flags | MANUVR_RUNNABLE_FLAG_AUTOCLEAR) : (_flags & ~(MANUVR_RUNNABLE_FLAG_AUTOCLEAR));
-    };
+    inline bool autoClear() { return (_load_flags() & MANUVR_RUNNABLE_FLAG_AUTOCLEAR); };
+    inline void autoClear(bool en) {   _set_flag(MANUVR_RUNNABLE_FLAG_AUTOCLEAR, en);   };
 
     /**
     * Is the kernel holding a lock on us? We are in the scheduler queue, and
@@ -338,21 +343,34 @@ class ManuvrMsg {
     *
     * @return true if the kernel has us in the scheduler queue.
     */
-    inline bool isScheduled() { return (_flags & MANUVR_RUNNABLE_FLAG_SCHEDULED); };
-    inline void isScheduled(bool en) {
-      _flags = (en) ? (_flags | MANUVR_RUNNABLE_FLAG_SCHEDULED) : (_flags & ~(MANUVR_RUNNABLE_FLAG_SCHEDULED));
-    };
+    inline bool isScheduled() { return (_load_flags() & MANUVR_RUNNABLE_FLAG_SCHEDULED); };
+    inline void isScheduled(bool en) {   _set_flag(MANUVR_RUNNABLE_FLAG_SCHEDULED, en);   };
 
 
-    inline uint8_t refCount() {  return (_flags & MANUVR_MSG_FLAG_REF_COUNT_MASK); };
-    inline bool    decRefs() {   return (0 == --_flags);  };
-    inline void    incRefs() {   _flags++;  };
+    /*
+    * The flags are shared with the Kernel's workers, so every change to them is
+    *   atomic. A reference can be taken or dropped from any thread.
+    */
+    inline uint8_t refCount() {  return (_load_flags() & MANUVR_MSG_FLAG_REF_COUNT_MASK); };
+    inline bool    decRefs() {
+      return (0 == (__atomic_sub_fetch(&_flags, 1, __ATOMIC_ACQ_REL) & MANUVR_MSG_FLAG_REF_COUNT_MASK));
+    };
+    inline void    incRefs() {   __atomic_add_fetch(&_flags, 1, __ATOMIC_ACQ_REL);  };
 
-    inline uint8_t priority() {  return ((_flags & MANUVR_MSG_FLAG_PRIORITY_MASK) >> 8); };
+    inline uint8_t priority() {  return ((_load_flags() & MANUVR_MSG_FLAG_PRIORITY_MASK) >> 8); };
     inline void    priority(uint8_t pri) {
-      _flags = (_flags & ~(MANUVR_MSG_FLAG_PRIORITY_MASK)) + (pri << 8);
+      uint32_t f = _load_flags();
+      while (!__atomic_compare_exchange_n(&_flags, &f, (f & ~(MANUVR_MSG_FLAG_PRIORITY_MASK)) | (pri << 8), true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {}
     };
 
+    /**
+    * Is this Msg sitting in a MsgQueue? This is how the Kernel enforces pointer
+    *   idempotency without searching the queue.
+    *
+    * @return true if the Msg is enqueued.
+    */
+    inline bool isEnqueued() { return (_load_flags() & MANUVR_MSG_FLAG_ENQUEUED); };
+
 
     #if defined(MANUVR_EVENT_PROFILER)
       /**
@@ -368,6 +386,10 @@ class ManuvrMsg {
 
       /* Function for pinging the profiler data. */
       void noteExecutionTime(uint32_t start, uint32_t stop);
+
+      /* When the Msg was raised. Once dispatched, when it was dispatched. */
+      inline uint32_t profilerMark() {             return _prof_mark;   };
+      inline void     profilerMark(uint32_t t) {   _prof_mark = t;      };
     #endif
 
 
@@ -392,6 +414,10 @@ class ManuvrMsg {
 
 
   private:
+    friend class MsgQueue;      // MsgQueue threads its buckets through our _q_next.
+    friend class ScheduleHeap;  // ScheduleHeap sorts on _sched_due, and tracks us by _sched_idx.
+    friend class Kernel;        // The Kernel's spill is threaded through our _spill_next.
+
     const MessageTypeDef* message_def  = nullptr;  // The definition for the message (once it is associated).
     FxnPointer     schedule_callback   = nullptr;  // Pointers to the schedule service function.
     EventReceiver* _origin             = nullptr;  // This is an optional ref to the class that raised this runnable.
@@ -400,29 +426,57 @@ class ManuvrMsg {
     uint16_t       _code  = MANUVR_MSG_UNDEFINED;  // The identity of the event (or command).
     int16_t        _sched_recurs       = 0;        // See Note 2.
     uint32_t       _sched_period       = 0;        // How often does this schedule execute?
-    uint32_t       _sched_ttw          = 0;        // How much longer until the schedule fires?
+    uint32_t       _sched_due          = 0;        // When (on the Kernel's scheduler clock) does the schedule fire?
+    int            _sched_idx          = -1;       // Our place in the Kernel's ScheduleHeap, if any.
+    ManuvrMsg*     _q_next             = nullptr;  // Intrusive link for MsgQueue.
+    uint8_t        _q_pri              = 0;        // The MsgQueue bucket we were filed under.
+    ManuvrMsg*     _spill_next         = nullptr;  // Intrusive link for the Kernel's spill.
 
     #if defined(MANUVR_EVENT_PROFILER)
     TaskProfilerData* prof_data = nullptr;  // If this schedule is being profiled, the ref will be here.
+    uint32_t          _prof_mark = 0;       // See profilerMark().
     #endif
 
+    void   _sched_refile();
     int8_t getArgAs(uint8_t idx, void *dat);
     int8_t writePointerArgAs(uint8_t idx, void *trg_buf);
 
     char* is_valid_argument_buffer(int len);
     int   collect_valid_grammatical_forms(int, LinkedList<char*>*);
 
-    inline void scheduleEnabled(bool en) {
-      _flags = (en) ? (_flags | MANUVR_RUNNABLE_FLAG_SCHED_ENABLED) : (_flags & ~(MANUVR_RUNNABLE_FLAG_SCHED_ENABLED));
-    };
-    inline void shouldFire(bool en) {
-      _flags = (en) ? (_flags | MANUVR_RUNNABLE_FLAG_PENDING_EXEC) : (_flags & ~(MANUVR_RUNNABLE_FLAG_PENDING_EXEC));
+    inline void scheduleEnabled(bool en) {   _set_flag(MANUVR_RUNNABLE_FLAG_SCHED_ENABLED, en);   };
+    inline void shouldFire(bool en) {        _set_flag(MANUVR_RUNNABLE_FLAG_PENDING_EXEC, en);    };
+    inline void isEnqueued(bool en) {        _set_flag(MANUVR_MSG_FLAG_ENQUEUED, en);             };
+    inline bool isSpilled() {   return (_load_flags() & MANUVR_MSG_FLAG_SPILLED);   };
+    inline void isSpilled(bool en) {         _set_flag(MANUVR_MSG_FLAG_SPILLED, en);              };
+
+    inline uint32_t _load_flags() {   return __atomic_load_n(&_flags, __ATOMIC_ACQUIRE);   };
+    inline void _set_flag(uint32_t flag, bool en) {
+      if (en) __atomic_or_fetch(&_flags, flag, __ATOMIC_ACQ_REL);
+      else    __atomic_and_fetch(&_flags, ~flag, __ATOMIC_ACQ_REL);
     };
 
 
 
-    // Where runtime-loaded message defs go.
-    static std::map<uint16_t, const MessageTypeDef*> message_defs_extended;
+    /*
+    * Every message def we know about, static and runtime-loaded alike, is filed
+    *   by its code in an open-addressed hash table. Its size is a power of two,
+    *   and it is never more than half full, so a lookup is a multiply, a shift,
+    *   and (nearly always) one comparison.
+    */
+    static const MessageTypeDef** _def_table;
+    static uint8_t                _def_table_bits;
+    static uint16_t               _def_count;
+
+    static const MessageTypeDef* _def_find(uint16_t code);
+    static int8_t _def_insert(const MessageTypeDef*);
+    static int8_t _def_table_resize(uint8_t bits);
+    static bool   _def_is_static(const MessageTypeDef*);
+
+    /* Fibonacci hashing on the 16-bit code. */
+    static inline unsigned int _def_slot(uint16_t code, uint8_t bits) {
+      return ((uint16_t) (code * 40503u)) >> (16 - bits);
+    };
 };
 
 #endif
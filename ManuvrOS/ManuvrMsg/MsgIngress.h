@@ -0,0 +1,156 @@
+/*
+File:   MsgIngress.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+This is the Kernel's front door for Msgs raised outside of its own thread
+  (ISRs, transport listeners, driver workers). It is a bounded ring of
+  ManuvrMsg pointers that any number of producers may push into without
+  locking, and from which exactly one consumer (the Kernel) may pull.
+
+The design is the well-known sequenced-slot ring: every slot carries a sequence
+  number that tells a producer whether the slot is free for its ticket, and tells
+  the consumer whether the slot has been published. Producers contend only on a
+  single CAS of the tail index. The consumer never contends at all.
+
+No idempotency checking is possible here. That happens when the Kernel drains
+  the ring into its exec_queue.
+*/
+
+
+#ifndef __MANUVR_MSG_INGRESS_H__
+#define __MANUVR_MSG_INGRESS_H__
+
+#include <inttypes.h>
+#include "ManuvrMsg.h"
+
+// How many Msgs can be in-flight between a foreign thread and the Kernel?
+// Must be a power of two.
+#ifndef MSG_INGRESS_CAPACITY
+  #define MSG_INGRESS_CAPACITY 64
+#endif
+#if (MSG_INGRESS_CAPACITY < 2) || (MSG_INGRESS_CAPACITY & (MSG_INGRESS_CAPACITY - 1))
+  #error MSG_INGRESS_CAPACITY must be a power of two, and at least 2.
+#endif
+
+
+class MsgIngress {
+  public:
+    MsgIngress();
+
+    int        push(ManuvrMsg*);  // Any thread. Returns 0 on success, or -1 if NULL or full.
+    ManuvrMsg* pop();             // Consumer only. Returns nullptr if empty.
+
+    /* Approximate, since producers may be mid-push. Good enough for profiling. */
+    inline int size() {
+      return (int) (_load(&_tail) - _load(&_head));
+    };
+    inline int capacity() {        return MSG_INGRESS_CAPACITY;  };
+    inline uint32_t overflows() {  return _load(&_overflows);   };
+
+
+  private:
+    struct IngressSlot {
+      uint32_t   seq;
+      ManuvrMsg* msg;
+    };
+
+    IngressSlot _slots[MSG_INGRESS_CAPACITY];
+    uint32_t    _tail;       // Next ticket a producer will claim.
+    uint32_t    _head;       // Next ticket the consumer will read. Consumer-owned.
+    uint32_t    _overflows;  // How many pushes were refused because we were full?
+
+    static inline uint32_t _load(uint32_t* v) {
+      return __atomic_load_n(v, __ATOMIC_ACQUIRE);
+    };
+
+    static inline void _store(uint32_t* v, uint32_t nu) {
+      __atomic_store_n(v, nu, __ATOMIC_RELEASE);
+    };
+};
+
+
+/**
+* Constructor. Every slot starts out free for the ticket that matches its index.
+*/
+inline MsgIngress::MsgIngress() {
+  for (uint32_t i = 0; i < MSG_INGRESS_CAPACITY; i++) {
+    _slots[i].seq = i;
+    _slots[i].msg = nullptr;
+  }
+  _tail      = 0;
+  _head      = 0;
+  _overflows = 0;
+}
+
+
+/**
+* Claims a ticket and publishes the given Msg into its slot. Safe to call from
+*   any number of threads (and from ISRs) concurrently. Never blocks.
+*
+* @param  msg  The Msg to pass to the consumer.
+* @return 0 on success, or -1 if the Msg was NULL or the ring is full.
+*/
+inline int MsgIngress::push(ManuvrMsg* msg) {
+  if (nullptr == msg) return -1;
+  uint32_t     pos = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+  IngressSlot* slot;
+  while (true) {
+    slot = &_slots[pos & (MSG_INGRESS_CAPACITY - 1)];
+    int32_t dif = (int32_t) (_load(&slot->seq) - pos);
+    if (0 == dif) {
+      // Slot is free for this ticket. Try to claim it.
+      if (__atomic_compare_exchange_n(&_tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+      // On failure, pos was reloaded for us.
+    }
+    else if (dif < 0) {
+      // The consumer hasn't gotten around to this slot since the last lap.
+      __atomic_fetch_add(&_overflows, 1, __ATOMIC_RELAXED);
+      return -1;
+    }
+    else {
+      // Another producer beat us to it.
+      pos = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+    }
+  }
+  slot->msg = msg;
+  _store(&slot->seq, pos + 1);   // Publish.
+  return 0;
+}
+
+
+/**
+* Takes the oldest published Msg. Only one thread may call this.
+*
+* @return The Msg, or nullptr if nothing has been published.
+*/
+inline ManuvrMsg* MsgIngress::pop() {
+  IngressSlot* slot = &_slots[_head & (MSG_INGRESS_CAPACITY - 1)];
+  if ((int32_t) (_load(&slot->seq) - (_head + 1)) < 0) {
+    return nullptr;  // Empty, or the producer hasn't finished publishing.
+  }
+  ManuvrMsg* ret = slot->msg;
+  slot->msg = nullptr;
+  _store(&slot->seq, _head + MSG_INGRESS_CAPACITY);   // Free for the next lap.
+  _store(&_head, _head + 1);
+  return ret;
+}
+
+#endif  // __MANUVR_MSG_INGRESS_H__
@@ -0,0 +1,214 @@
+/*
+File:   MsgQueue.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+This is the Kernel's run-queue. It replaces a PriorityQueue<ManuvrMsg*> for
+  the exec_queue, and preserves its ordering semantics: higher priority first,
+  and FIFO among Msgs of equal priority.
+
+Every priority level has its own FIFO bucket, which is an intrusive singly-linked
+  list threaded through the ManuvrMsgs themselves. A two-level bitmap tracks which
+  buckets are occupied. The result is that insertion, dequeue, and the idempotency
+  check (via a flag in the ManuvrMsg) are all O(1), and no heap traffic is incurred.
+
+Since the links are intrusive, a ManuvrMsg can only be in one MsgQueue at a time.
+
+This class does no locking. Only the Kernel's own thread touches its exec_queue.
+  Everything else goes through MsgIngress.
+*/
+
+
+#ifndef __MANUVR_MSG_QUEUE_H__
+#define __MANUVR_MSG_QUEUE_H__
+
+#include <inttypes.h>
+#include <CommonConstants.h>
+#include "ManuvrMsg.h"
+
+// ManuvrMsg::priority() is 8-bit. So we need this many buckets to be exact.
+// Memory-constrained builds may supply a smaller multiple of 32. Priorities
+//   beyond the last bucket will be filed in the last bucket.
+#ifndef MSG_QUEUE_PRIORITY_LEVELS
+  #define MSG_QUEUE_PRIORITY_LEVELS 256
+#endif
+#if (MSG_QUEUE_PRIORITY_LEVELS > 256) || (MSG_QUEUE_PRIORITY_LEVELS & 0x1F) || (MSG_QUEUE_PRIORITY_LEVELS == 0)
+  #error MSG_QUEUE_PRIORITY_LEVELS must be a non-zero multiple of 32, no larger than 256.
+#endif
+#define MSG_QUEUE_BITMAP_WORDS      (MSG_QUEUE_PRIORITY_LEVELS >> 5)
+
+
+class MsgQueue {
+  public:
+    MsgQueue();
+    ~MsgQueue();
+
+    int        insert(ManuvrMsg*);  // Returns 0 on success, or -1 if NULL or already enqueued.
+    ManuvrMsg* dequeue();           // Returns the highest-priority Msg, or nullptr if empty.
+    bool       remove(ManuvrMsg*);  // Removes the given Msg from the queue. True on success.
+
+    inline int  size() {                    return _count;            };
+    inline bool hasNext() {                 return (0 != _summary);   };
+    inline bool contains(ManuvrMsg* msg) {  return msg->isEnqueued(); };
+
+
+  private:
+    ManuvrMsg* _heads[MSG_QUEUE_PRIORITY_LEVELS];
+    ManuvrMsg* _tails[MSG_QUEUE_PRIORITY_LEVELS];
+    uint32_t   _bitmap[MSG_QUEUE_BITMAP_WORDS];  // One bit per occupied bucket.
+    uint8_t    _summary;                         // One bit per non-zero word in _bitmap.
+    int        _count;
+
+    bool _remove_from_bucket(ManuvrMsg*, int bucket);
+
+    inline void _mark_bucket(int b) {
+      _bitmap[b >> 5] |= ((uint32_t) 1 << (b & 0x1F));
+      _summary        |= (1 << (b >> 5));
+    };
+
+    inline void _clear_bucket(int b) {
+      _bitmap[b >> 5] &= ~((uint32_t) 1 << (b & 0x1F));
+      if (0 == _bitmap[b >> 5]) _summary &= ~(1 << (b >> 5));
+    };
+
+    /* Returns the index of the most-significant set bit. Argument must be non-zero. */
+    static inline int _msb(uint32_t x) {
+      #if defined(__GNUC__)
+        return (31 - __builtin_clz(x));
+      #else
+        int r = 0;
+        while (x >>= 1) r++;
+        return r;
+      #endif
+    };
+};
+
+
+/**
+* Constructor.
+*/
+inline MsgQueue::MsgQueue() {
+  for (int i = 0; i < MSG_QUEUE_PRIORITY_LEVELS; i++) {
+    _heads[i] = nullptr;
+    _tails[i] = nullptr;
+  }
+  for (int i = 0; i < MSG_QUEUE_BITMAP_WORDS; i++) _bitmap[i] = 0;
+  _summary = 0;
+  _count   = 0;
+}
+
+/**
+* Destructor. Releases any Msgs still enqueued, but does not free them. Memory
+*   management of Msgs is the Kernel's concern.
+*/
+inline MsgQueue::~MsgQueue() {
+  while (nullptr != dequeue()) {}
+}
+
+
+/**
+* Appends the given Msg to the tail of the bucket for its priority.
+*
+* @param  msg  The Msg to enqueue.
+* @return 0 on success, or -1 if the Msg was NULL or is already enqueued.
+*/
+inline int MsgQueue::insert(ManuvrMsg* msg) {
+  if (nullptr == msg) return -1;
+  if (msg->isEnqueued()) return -1;
+  int b = strict_min(msg->priority(), (uint8_t) (MSG_QUEUE_PRIORITY_LEVELS - 1));
+  msg->_q_next = nullptr;
+  msg->_q_pri  = (uint8_t) b;
+  if (nullptr == _tails[b]) {
+    _heads[b] = msg;
+    _mark_bucket(b);
+  }
+  else {
+    _tails[b]->_q_next = msg;
+  }
+  _tails[b] = msg;
+  msg->isEnqueued(true);
+  _count++;
+  return 0;
+}
+
+
+/**
+* Removes the oldest Msg of the highest occupied priority.
+*
+* @return The Msg, or nullptr if the queue is empty.
+*/
+inline ManuvrMsg* MsgQueue::dequeue() {
+  ManuvrMsg* ret = nullptr;
+  if (0 != _summary) {
+    int w = _msb(_summary);
+    int b = (w << 5) + _msb(_bitmap[w]);
+    ret = _heads[b];
+    _heads[b] = ret->_q_next;
+    if (nullptr == _heads[b]) {
+      _tails[b] = nullptr;
+      _clear_bucket(b);
+    }
+    ret->_q_next = nullptr;
+    ret->isEnqueued(false);
+    _count--;
+  }
+  return ret;
+}
+
+
+/**
+* Removes the given Msg from wherever it is in the queue. This is the only
+*   operation that is not O(1). It walks the bucket the Msg was filed under.
+*
+* @param  msg  The Msg to remove.
+* @return true if the Msg was found and removed.
+*/
+inline bool MsgQueue::remove(ManuvrMsg* msg) {
+  bool ret = false;
+  if ((nullptr != msg) && msg->isEnqueued()) {
+    ret = _remove_from_bucket(msg, msg->_q_pri);
+  }
+  return ret;
+}
+
+
+inline bool MsgQueue::_remove_from_bucket(ManuvrMsg* msg, int b) {
+  ManuvrMsg* prior   = nullptr;
+  ManuvrMsg* current = _heads[b];
+  while (nullptr != current) {
+    if (current == msg) {
+      if (nullptr == prior) {
+        _heads[b] = current->_q_next;
+      }
+      else {
+        prior->_q_next = current->_q_next;
+      }
+      if (_tails[b] == current) _tails[b] = prior;
+      if (nullptr == _heads[b]) _clear_bucket(b);
+      msg->_q_next = nullptr;
+      msg->isEnqueued(false);
+      _count--;
+      return true;
+    }
+    prior   = current;
+    current = current->_q_next;
+  }
+  return false;
+}
+
+#endif  // __MANUVR_MSG_QUEUE_H__
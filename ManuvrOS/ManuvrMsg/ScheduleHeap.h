@@ -0,0 +1,225 @@
+/*
+File:   ScheduleHeap.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+This is the Kernel's schedule list. It is a binary min-heap of scheduled
+  ManuvrMsgs, keyed on the absolute time (on the Kernel's scheduler clock) at
+  which each will next fire. So a scheduler tick costs O(1) when nothing is
+  due, and O(log n) per schedule that fires, no matter how many schedules exist.
+
+Ordering puts enabled schedules ahead of disabled ones, schedules that were
+  asked to fireNow() ahead of the rest, and then earliest deadline first.
+  Deadlines are compared with wrap-around arithmetic, so no schedule may be
+  more than 2^31 ms away from the clock.
+
+Each Msg carries its own heap index, so removal and re-keying after a change
+  are O(log n) without a search. A ManuvrMsg can only be in one ScheduleHeap.
+*/
+
+
+#ifndef __MANUVR_SCHEDULE_HEAP_H__
+#define __MANUVR_SCHEDULE_HEAP_H__
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include "ManuvrMsg.h"
+
+#ifndef SCHEDULE_HEAP_INITIAL_SIZE
+  #define SCHEDULE_HEAP_INITIAL_SIZE 16
+#endif
+
+
+class ScheduleHeap {
+  public:
+    ScheduleHeap();
+    ~ScheduleHeap();
+
+    int  insert(ManuvrMsg*);   // Returns 0 on success, or -1 if NULL, already present, or OOM.
+    bool remove(ManuvrMsg*);   // True if the Msg was present and removed.
+    void update(ManuvrMsg*);   // Re-sorts a Msg whose timing was changed.
+    void rebuild();            // Re-sorts everything. For when we don't know what changed.
+
+    /* Returns the soonest schedule if it is due at the given time. nullptr otherwise. */
+    ManuvrMsg* nextDue(uint32_t now);
+    /* Returns ms until the soonest schedule is due, 0 if overdue, or -1 if none are enabled. */
+    int32_t    timeToNextDue(uint32_t now);
+
+    inline int        size() {           return _count;                                  };
+    inline ManuvrMsg* get(int i) {       return ((i >= 0) && (i < _count)) ? _heap[i] : nullptr;  };  // Heap order. Not sorted.
+    inline bool contains(ManuvrMsg* m) {
+      return ((nullptr != m) && (m->_sched_idx >= 0) && (m->_sched_idx < _count) && (_heap[m->_sched_idx] == m));
+    };
+
+
+  private:
+    ManuvrMsg** _heap;
+    int         _count;
+    int         _capacity;
+
+    void _sift_up(int);
+    void _sift_down(int);
+
+    inline void _place(int idx, ManuvrMsg* m) {
+      _heap[idx]     = m;
+      m->_sched_idx  = idx;
+    };
+
+    /* Should a be serviced before b? */
+    static inline bool _before(ManuvrMsg* a, ManuvrMsg* b) {
+      if (a->scheduleEnabled() != b->scheduleEnabled()) return a->scheduleEnabled();
+      if (!a->scheduleEnabled()) return false;   // Disabled schedules are unordered.
+      if (a->shouldFire() != b->shouldFire()) return a->shouldFire();
+      return ((int32_t) (a->_sched_due - b->_sched_due) < 0);
+    };
+};
+
+
+inline ScheduleHeap::ScheduleHeap() {
+  _heap     = nullptr;
+  _count    = 0;
+  _capacity = 0;
+}
+
+/**
+* Destructor. Forgets any Msgs still present, but does not free them. Memory
+*   management of Msgs is the Kernel's concern.
+*/
+inline ScheduleHeap::~ScheduleHeap() {
+  for (int i = 0; i < _count; i++) _heap[i]->_sched_idx = -1;
+  if (nullptr != _heap) free(_heap);
+}
+
+
+/**
+* @param  m  The schedule to add.
+* @return 0 on success, or -1 if the Msg was NULL, already present, or we are out of memory.
+*/
+inline int ScheduleHeap::insert(ManuvrMsg* m) {
+  if ((nullptr == m) || contains(m)) return -1;
+  if (_count == _capacity) {
+    int nu_cap = _capacity ? (_capacity << 1) : SCHEDULE_HEAP_INITIAL_SIZE;
+    // realloc(), since new[] can't report failure under -fno-exceptions.
+    ManuvrMsg** nu = (ManuvrMsg**) realloc(_heap, nu_cap * sizeof(ManuvrMsg*));
+    if (nullptr == nu) return -1;   // The heap we had is still good.
+    _heap     = nu;
+    _capacity = nu_cap;
+  }
+  _place(_count, m);
+  _sift_up(_count++);
+  return 0;
+}
+
+
+/**
+* @param  m  The schedule to remove.
+* @return true if the Msg was present and has been removed.
+*/
+inline bool ScheduleHeap::remove(ManuvrMsg* m) {
+  if (!contains(m)) return false;
+  int idx = m->_sched_idx;
+  m->_sched_idx = -1;
+  if (idx != --_count) {
+    // Fill the hole with the last leaf, and let it find its level.
+    ManuvrMsg* last = _heap[_count];
+    _place(idx, last);
+    _sift_up(idx);
+    _sift_down(last->_sched_idx);
+  }
+  return true;
+}
+
+
+/**
+* Call after anything that might change where a schedule sorts: its deadline,
+*   whether it is enabled, or whether it is pending a fireNow().
+*
+* @param  m  The schedule that changed. Ignored if not present.
+*/
+inline void ScheduleHeap::update(ManuvrMsg* m) {
+  if (contains(m)) {
+    _sift_up(m->_sched_idx);
+    _sift_down(m->_sched_idx);
+  }
+}
+
+
+/**
+* Restores heap order from scratch. O(n).
+*/
+inline void ScheduleHeap::rebuild() {
+  for (int i = (_count >> 1) - 1; i >= 0; i--) _sift_down(i);
+}
+
+
+/**
+* @param  now  The scheduler clock.
+* @return The soonest schedule, if it should fire at the given time. Otherwise nullptr.
+*/
+inline ManuvrMsg* ScheduleHeap::nextDue(uint32_t now) {
+  if (0 == _count) return nullptr;
+  ManuvrMsg* m = _heap[0];
+  if (!m->scheduleEnabled()) return nullptr;   // Nothing enabled at all.
+  if (m->shouldFire() || ((int32_t) (m->_sched_due - now) <= 0)) {
+    return m;
+  }
+  return nullptr;
+}
+
+
+/**
+* @param  now  The scheduler clock.
+* @return How many ms until the soonest schedule is due. 0 if it is already due,
+*           or -1 if there are no enabled schedules.
+*/
+inline int32_t ScheduleHeap::timeToNextDue(uint32_t now) {
+  if (0 == _count) return -1;
+  ManuvrMsg* m = _heap[0];
+  if (!m->scheduleEnabled()) return -1;
+  if (m->shouldFire()) return 0;
+  int32_t ret = (int32_t) (m->_sched_due - now);
+  return (ret > 0) ? ret : 0;
+}
+
+
+inline void ScheduleHeap::_sift_up(int idx) {
+  ManuvrMsg* m = _heap[idx];
+  while (idx > 0) {
+    int parent = (idx - 1) >> 1;
+    if (!_before(m, _heap[parent])) break;
+    _place(idx, _heap[parent]);
+    idx = parent;
+  }
+  _place(idx, m);
+}
+
+
+inline void ScheduleHeap::_sift_down(int idx) {
+  ManuvrMsg* m = _heap[idx];
+  while (true) {
+    int child = (idx << 1) + 1;
+    if (child >= _count) break;
+    if ((child + 1 < _count) && _before(_heap[child + 1], _heap[child])) child++;
+    if (!_before(_heap[child], m)) break;
+    _place(idx, _heap[child]);
+    idx = child;
+  }
+  _place(idx, m);
+}
+
+#endif  // __MANUVR_SCHEDULE_HEAP_H__
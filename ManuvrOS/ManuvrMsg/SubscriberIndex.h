@@ -0,0 +1,260 @@
+/*
+File:   SubscriberIndex.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+This is the Kernel's dispatch index. For each message code that any subscriber
+  has declared an interest in, it holds the list of subscribers that should be
+  notify()'d about that code. That list is every subscriber that declared the
+  code, plus every subscriber that declared nothing at all (the catch-all
+  subscribers). Codes that nobody declared go to the catch-all subscribers only.
+
+Every list preserves the subscription order of the Kernel's manifest, so
+  priority semantics are unchanged. Codes that the base EventReceiver reacts to
+  (boot completion, and config load) go to every subscriber, regardless of
+  what it declared.
+
+The index is rebuilt lazily, on the kernel thread, the first time it is asked
+  for a list after a subscription changes. Lists are nullptr-terminated arrays
+  in a single flat allocation. Code lookup is open-addressed, and so is O(1).
+*/
+
+
+#ifndef __MANUVR_SUBSCRIBER_INDEX_H__
+#define __MANUVR_SUBSCRIBER_INDEX_H__
+
+#include <inttypes.h>
+#include <DataStructures/PriorityQueue.h>
+#include "ManuvrMsg.h"
+
+class EventReceiver;
+
+
+class SubscriberIndex {
+  public:
+    SubscriberIndex();
+    ~SubscriberIndex();
+
+    /* Returns the nullptr-terminated list of subscribers interested in the given code. */
+    EventReceiver** lookup(uint16_t code);
+    /* Returns 0 on success, or -1 on OOM. On failure, every code maps to every subscriber. */
+    int  rebuild(PriorityQueue<EventReceiver*>*);
+
+    inline void invalidate() {   _dirty = true;    };
+    inline bool dirty() {        return _dirty;    };
+    inline int  codes() {        return _code_count;   };
+
+    /* Does the given receiver want to be notified about the given code? */
+    static bool wants(EventReceiver*, uint16_t code);
+
+
+  private:
+    EventReceiver** _pool;          // Every list, back-to-back.
+    uint16_t*       _codes;         // Open-addressed. MANUVR_MSG_UNDEFINED marks an empty slot.
+    uint32_t*       _offsets;       // Where in the pool each code's list begins.
+    uint32_t        _all;           // Offset of the list of every subscriber.
+    uint32_t        _catch_all;     // Offset of the list of subscribers with no interests.
+    int             _code_count;
+    uint8_t         _bits;          // The code table has 2^_bits slots.
+    bool            _dirty;
+
+    void _wipe();
+    uint32_t _fill(EventReceiver** subs, int count, uint16_t code, uint32_t offset);
+
+    static inline uint16_t _slot(uint16_t code, uint8_t bits) {
+      return ((uint16_t) (code * 40503u)) >> (16 - bits);
+    };
+
+    /* Codes that the base EventReceiver handles, and so must go to everyone. */
+    static inline bool _broadcast(uint16_t code) {
+      return ((MANUVR_MSG_SYS_BOOT_COMPLETED == code) || (MANUVR_MSG_SYS_CONF_LOAD == code));
+    };
+};
+
+
+/* We need the full EventReceiver definition for interests(). */
+#include <EventReceiver.h>
+
+
+inline SubscriberIndex::SubscriberIndex() {
+  _pool       = nullptr;
+  _codes      = nullptr;
+  _offsets    = nullptr;
+  _all        = 0;
+  _catch_all  = 0;
+  _code_count = 0;
+  _bits       = 0;
+  _dirty      = true;
+}
+
+inline SubscriberIndex::~SubscriberIndex() {
+  _wipe();
+}
+
+
+inline void SubscriberIndex::_wipe() {
+  if (nullptr != _pool)    delete[] _pool;
+  if (nullptr != _codes)   delete[] _codes;
+  if (nullptr != _offsets) delete[] _offsets;
+  _pool       = nullptr;
+  _codes      = nullptr;
+  _offsets    = nullptr;
+  _code_count = 0;
+  _bits       = 0;
+}
+
+
+/**
+* @param  er    The receiver in question.
+* @param  code  The message code.
+* @return true if the receiver declared the code, declared nothing, or the code
+*           is one that every receiver must see.
+*/
+inline bool SubscriberIndex::wants(EventReceiver* er, uint16_t code) {
+  const uint16_t* i = er->interests();
+  if ((nullptr == i) || _broadcast(code)) return true;
+  while (MANUVR_MSG_UNDEFINED != *i) {
+    if (code == *i++) return true;
+  }
+  return false;
+}
+
+
+/**
+* Writes (if there is a pool) the list for the given code at the given offset.
+*
+* @param  subs    The subscribers, in priority order.
+* @param  count   How many subscribers there are.
+* @param  code    The code to filter for.
+* @param  offset  Where in the pool the list should go.
+* @return The length of the list, including its terminator.
+*/
+inline uint32_t SubscriberIndex::_fill(EventReceiver** subs, int count, uint16_t code, uint32_t offset) {
+  uint32_t n = 0;
+  for (int i = 0; i < count; i++) {
+    if (wants(subs[i], code)) {
+      if (nullptr != _pool) _pool[offset + n] = subs[i];
+      n++;
+    }
+  }
+  if (nullptr != _pool) _pool[offset + n] = nullptr;
+  return n + 1;
+}
+
+
+/**
+* Throws away the index and builds it again from the given manifest.
+*
+* @param  manifest  The Kernel's subscribers.
+* @return 0 on success, or -1 if we ran out of memory.
+*/
+inline int SubscriberIndex::rebuild(PriorityQueue<EventReceiver*>* manifest) {
+  _wipe();
+  _dirty = false;
+  int count = manifest->size();
+  EventReceiver** subs = new EventReceiver*[count + 1];
+  if (nullptr == subs) return -1;
+
+  int declared = 0;   // How many codes were declared in total? Duplicates included.
+  for (int i = 0; i < count; i++) {
+    subs[i] = manifest->get(i);
+    const uint16_t* interests = subs[i]->interests();
+    if (nullptr != interests) {
+      while (MANUVR_MSG_UNDEFINED != *interests++) declared++;
+    }
+  }
+
+  _bits = 3;
+  while ((1 << _bits) < (declared << 1)) _bits++;
+  int slots = 1 << _bits;
+  _codes   = new uint16_t[slots];
+  _offsets = new uint32_t[slots];
+  if ((nullptr == _codes) || (nullptr == _offsets)) {
+    delete[] subs;
+    _wipe();
+    return -1;
+  }
+  for (int i = 0; i < slots; i++) _codes[i] = MANUVR_MSG_UNDEFINED;
+
+  // Collect the distinct codes.
+  for (int i = 0; i < count; i++) {
+    const uint16_t* interests = subs[i]->interests();
+    if (nullptr == interests) continue;
+    for (; MANUVR_MSG_UNDEFINED != *interests; interests++) {
+      if (_broadcast(*interests)) continue;
+      uint16_t s = _slot(*interests, _bits);
+      while ((MANUVR_MSG_UNDEFINED != _codes[s]) && (*interests != _codes[s])) {
+        s = (s + 1) & (slots - 1);
+      }
+      if (MANUVR_MSG_UNDEFINED == _codes[s]) {
+        _codes[s] = *interests;
+        _code_count++;
+      }
+    }
+  }
+
+  // Two passes. The first measures the pool, and the second fills it.
+  for (int pass = 0; pass < 2; pass++) {
+    uint32_t offset = 0;
+    _all = offset;
+    offset += _fill(subs, count, MANUVR_MSG_SYS_BOOT_COMPLETED, offset);
+    _catch_all = offset;
+    offset += _fill(subs, count, MANUVR_MSG_UNDEFINED, offset);
+    for (int i = 0; i < slots; i++) {
+      if (MANUVR_MSG_UNDEFINED != _codes[i]) {
+        _offsets[i] = offset;
+        offset += _fill(subs, count, _codes[i], offset);
+      }
+    }
+    if (0 == pass) {
+      _pool = new EventReceiver*[offset];
+      if (nullptr == _pool) {
+        delete[] subs;
+        _wipe();
+        return -1;
+      }
+    }
+  }
+  delete[] subs;
+  return 0;
+}
+
+
+/**
+* Rebuild the index before calling this if it is dirty. A list stays valid
+*   until the next rebuild.
+*
+* @param  code  The message code about to be dispatched.
+* @return The subscribers that want it, in priority order, ending with nullptr.
+*           nullptr if the index is not built.
+*/
+inline EventReceiver** SubscriberIndex::lookup(uint16_t code) {
+  if (nullptr == _pool) return nullptr;
+  if (_broadcast(code)) return &_pool[_all];
+  if (_code_count > 0) {
+    uint16_t mask = (1 << _bits) - 1;
+    uint16_t s    = _slot(code, _bits);
+    while (MANUVR_MSG_UNDEFINED != _codes[s]) {
+      if (code == _codes[s]) return &_pool[_offsets[s]];
+      s = (s + 1) & mask;
+    }
+  }
+  return &_pool[_catch_all];
+}
+
+#endif  // __MANUVR_SUBSCRIBER_INDEX_H__
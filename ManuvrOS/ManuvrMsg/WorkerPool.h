@@ -0,0 +1,489 @@
+/*
+File:   WorkerPool.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+This is the Kernel's optional pool of worker threads. When it is running, the
+  Kernel hands notify() calls for receivers that have declared an affinity to
+  the pool, instead of making them itself.
+
+Each worker has two queues. The pinned queue holds work for receivers that
+  named this worker as their home. Only the owner takes from it, and always
+  from the front, so a pinned receiver sees Msgs in the order they were
+  dispatched. The shared queue holds work for receivers that declared
+  themselves thread-safe. The owner takes from the front, and a worker with
+  nothing to do will steal from the back of anyone else's.
+
+The Kernel tracks each Msg it has farmed out as a flight. A flight counts the
+  tasks that are still out (plus one for the Kernel, until it has finished
+  dispatching). Whoever brings that count to zero hands the Msg back to the
+  Kernel, through a lock-free ring, for its callbacks and reclamation. Those
+  always happen on the kernel thread.
+
+Only the kernel thread may call open(), submit(), close(), and finished().
+*/
+
+
+#ifndef __MANUVR_WORKER_POOL_H__
+#define __MANUVR_WORKER_POOL_H__
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include "MsgIngress.h"
+#include <Tracer.h>
+
+class EventReceiver;
+
+// How many workers can the pool have?
+#ifndef MANUVR_MAX_WORKERS
+  #define MANUVR_MAX_WORKERS 8
+#endif
+
+// How many tasks can wait in each of a worker's queues? Must be a power of two.
+#ifndef MANUVR_WORKER_QUEUE_DEPTH
+  #define MANUVR_WORKER_QUEUE_DEPTH 32
+#endif
+#if (MANUVR_WORKER_QUEUE_DEPTH < 2) || (MANUVR_WORKER_QUEUE_DEPTH & (MANUVR_WORKER_QUEUE_DEPTH - 1))
+  #error MANUVR_WORKER_QUEUE_DEPTH must be a power of two, and at least 2.
+#endif
+
+// How many Msgs can be out with the workers at once?
+#ifndef MANUVR_WORKER_FLIGHTS
+  #define MANUVR_WORKER_FLIGHTS 16
+#endif
+#if (MANUVR_WORKER_FLIGHTS > MSG_INGRESS_CAPACITY) || (MANUVR_WORKER_FLIGHTS > 255)
+  #error MANUVR_WORKER_FLIGHTS must fit in the completion ring.
+#endif
+
+
+class WorkerPool {
+  public:
+    WorkerPool();
+    ~WorkerPool();
+
+    int  start(int count, FxnPointer wake);  // Returns how many workers are running.
+    void stop();                             // Finishes any queued work first.
+
+    inline int workers() {   return _count;   };
+
+    /* Kernel thread only. */
+    int  open(ManuvrMsg*);                   // Returns a flight, or -1 if none are free.
+    int  submit(int flight, EventReceiver*); // Returns 0 if queued, or -1 if the caller must run it.
+    bool close(int flight, int* acted, int* dead);   // Returns true if the flight is already done.
+    ManuvrMsg* finished(int* acted, int* dead);      // A Msg whose workers are done, or nullptr.
+    bool inFlight(ManuvrMsg*);
+    bool saturated();                        // True if open() would fail.
+
+    uint32_t executed();                     // How many tasks have workers ever run?
+    uint32_t steals();                       // How many of those were stolen?
+
+
+  private:
+    struct WorkItem {
+      EventReceiver* er;
+      uint8_t        flight;
+    };
+
+    struct Flight {
+      ManuvrMsg* msg;      // nullptr if the flight is free. Only the kernel thread writes it.
+      uint32_t   tasks;    // Outstanding tasks. Atomic.
+      uint32_t   acted;    // How many notify() calls took action? Atomic.
+      uint32_t   dead;     // How many took no action? Atomic.
+    };
+
+    struct Worker {
+      WorkerPool*     pool;
+      pthread_t       thread;
+      pthread_mutex_t lock;
+      pthread_cond_t  cond;
+      WorkItem        pinned[MANUVR_WORKER_QUEUE_DEPTH];
+      WorkItem        shared[MANUVR_WORKER_QUEUE_DEPTH];
+      uint32_t        p_head;
+      uint32_t        p_tail;
+      uint32_t        s_head;
+      uint32_t        s_tail;
+      uint32_t        executed;
+      uint32_t        stolen;
+      bool            sleeping;
+    };
+
+    Worker     _workers[MANUVR_MAX_WORKERS];
+    Flight     _flights[MANUVR_WORKER_FLIGHTS];
+    MsgIngress _done;          // Msgs whose flights have landed.
+    FxnPointer _wake;          // Tells the kernel thread that something landed.
+    uint32_t   _epoch;         // Bumped whenever shared work is queued. Atomic.
+    uint32_t   _next_shared;   // Round-robin for shared work.
+    int        _count;
+    bool       _stopping;
+
+    bool _take(Worker*, WorkItem*);    // From our own queues. Call with our lock held.
+    bool _steal(Worker*, WorkItem*);   // From the back of someone else's shared queue.
+    void _run(Worker*, WorkItem*);
+    void _land(uint8_t flight);        // One task of the flight is done.
+    void _collect(int flight, int* acted, int* dead);
+
+    static void* _worker_main(void*);
+};
+
+
+/* We need the full EventReceiver definition for affinity() and notify(). */
+#include <EventReceiver.h>
+
+
+inline WorkerPool::WorkerPool() {
+  _wake        = nullptr;
+  _epoch       = 0;
+  _next_shared = 0;
+  _count       = 0;
+  _stopping    = false;
+  for (int i = 0; i < MANUVR_WORKER_FLIGHTS; i++) {
+    _flights[i].msg = nullptr;
+  }
+  for (int i = 0; i < MANUVR_MAX_WORKERS; i++) {
+    _workers[i].executed = 0;
+    _workers[i].stolen   = 0;
+  }
+}
+
+inline WorkerPool::~WorkerPool() {
+  stop();
+}
+
+
+/**
+* Starts the workers. Does nothing if any are already running.
+*
+* @param  count  How many workers we want. Capped at MANUVR_MAX_WORKERS.
+* @param  wake   Called from a worker when a Msg lands.
+* @return How many workers are running.
+*/
+inline int WorkerPool::start(int count, FxnPointer wake) {
+  if (_count > 0) return _count;
+  if (count > MANUVR_MAX_WORKERS) count = MANUVR_MAX_WORKERS;
+  _wake     = wake;
+  _stopping = false;
+  for (int i = 0; i < count; i++) {
+    Worker* w = &_workers[i];
+    w->pool     = this;
+    w->p_head   = 0;
+    w->p_tail   = 0;
+    w->s_head   = 0;
+    w->s_tail   = 0;
+    w->sleeping = false;
+    pthread_mutex_init(&w->lock, nullptr);
+    pthread_cond_init(&w->cond, nullptr);
+  }
+  // Every worker is set up before any of them runs, so it is safe to steal
+  //   from one whose thread hasn't started yet.
+  int running = 0;
+  while (running < count) {
+    if (0 != pthread_create(&_workers[running].thread, nullptr, _worker_main, (void*) &_workers[running])) {
+      break;
+    }
+    __atomic_store_n(&_count, ++running, __ATOMIC_RELEASE);
+  }
+  for (int i = _count; i < count; i++) {
+    pthread_mutex_destroy(&_workers[i].lock);
+    pthread_cond_destroy(&_workers[i].cond);
+  }
+  return _count;
+}
+
+
+/**
+* Stops the workers. They finish whatever is in their queues before they go.
+*   Msgs that land while we wait are still waiting in finished() afterward.
+*/
+inline void WorkerPool::stop() {
+  if (0 == _count) return;
+  for (int i = 0; i < _count; i++) {
+    pthread_mutex_lock(&_workers[i].lock);
+  }
+  _stopping = true;
+  for (int i = 0; i < _count; i++) {
+    pthread_cond_signal(&_workers[i].cond);
+    pthread_mutex_unlock(&_workers[i].lock);
+  }
+  for (int i = 0; i < _count; i++) {
+    pthread_join(_workers[i].thread, nullptr);
+  }
+  for (int i = 0; i < _count; i++) {
+    pthread_mutex_destroy(&_workers[i].lock);
+    pthread_cond_destroy(&_workers[i].cond);
+  }
+  _count = 0;
+}
+
+
+/**
+* @param  msg  The Msg about to be dispatched.
+* @return A flight for the Msg's tasks, or -1 if every flight is out.
+*/
+inline int WorkerPool::open(ManuvrMsg* msg) {
+  for (int i = 0; i < MANUVR_WORKER_FLIGHTS; i++) {
+    if (nullptr == _flights[i].msg) {
+      __atomic_store_n(&_flights[i].tasks, 1, __ATOMIC_RELAXED);   // The Kernel's hold.
+      __atomic_store_n(&_flights[i].acted, 0, __ATOMIC_RELAXED);
+      __atomic_store_n(&_flights[i].dead,  0, __ATOMIC_RELAXED);
+      _flights[i].msg = msg;
+      return i;
+    }
+  }
+  return -1;
+}
+
+
+/**
+* Queues a notify() of the flight's Msg to the given receiver. Pinned work
+*   always goes to its home worker, and if that worker is full, we wait for
+*   it. Shared work goes to whichever worker has room.
+*
+* @param  flight  From open().
+* @param  er      The receiver to notify.
+* @return 0 if a worker has it, or -1 if the caller should notify() it itself.
+*/
+inline int WorkerPool::submit(int flight, EventReceiver* er) {
+  int8_t affinity = er->affinity();
+  if ((0 == _count) || (MANUVR_ER_AFFINITY_KERNEL == affinity)) return -1;
+  WorkItem item = {er, (uint8_t) flight};
+  __atomic_add_fetch(&_flights[flight].tasks, 1, __ATOMIC_ACQ_REL);
+
+  if (affinity >= 0) {
+    Worker* w = &_workers[affinity % _count];
+    pthread_mutex_lock(&w->lock);
+    while ((w->p_tail - w->p_head) >= MANUVR_WORKER_QUEUE_DEPTH) {
+      // The home worker is behind. Order matters more than our time.
+      pthread_mutex_unlock(&w->lock);
+      sched_yield();
+      pthread_mutex_lock(&w->lock);
+    }
+    w->pinned[w->p_tail++ & (MANUVR_WORKER_QUEUE_DEPTH - 1)] = item;
+    pthread_cond_signal(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+    return 0;
+  }
+
+  for (int i = 0; i < _count; i++) {
+    Worker* w = &_workers[_next_shared++ % _count];
+    pthread_mutex_lock(&w->lock);
+    if ((w->s_tail - w->s_head) < MANUVR_WORKER_QUEUE_DEPTH) {
+      w->shared[w->s_tail & (MANUVR_WORKER_QUEUE_DEPTH - 1)] = item;
+      __atomic_store_n(&w->s_tail, w->s_tail + 1, __ATOMIC_RELAXED);   // Thieves peek without the lock.
+      pthread_cond_signal(&w->cond);
+      pthread_mutex_unlock(&w->lock);
+      // If the owner is busy, someone idle can steal it. Wake one.
+      __atomic_add_fetch(&_epoch, 1, __ATOMIC_SEQ_CST);
+      for (int j = 0; j < _count; j++) {
+        Worker* idle = &_workers[j];
+        if (idle == w) continue;
+        pthread_mutex_lock(&idle->lock);
+        bool asleep = idle->sleeping;
+        if (asleep) pthread_cond_signal(&idle->cond);
+        pthread_mutex_unlock(&idle->lock);
+        if (asleep) break;
+      }
+      return 0;
+    }
+    pthread_mutex_unlock(&w->lock);
+  }
+  __atomic_sub_fetch(&_flights[flight].tasks, 1, __ATOMIC_ACQ_REL);
+  return -1;   // Everyone is full. Thread-safe work can be run by anyone.
+}
+
+
+/**
+* The Kernel is done dispatching the flight's Msg, and lets go of its hold.
+*
+* @param  flight  From open().
+* @param  acted   Receives how many workers' notify() calls took action.
+* @param  dead    Receives how many didn't.
+* @return true if every task was already done, in which case the flight is
+*           free again, and the Msg will not come out of finished().
+*/
+inline bool WorkerPool::close(int flight, int* acted, int* dead) {
+  if (0 == __atomic_sub_fetch(&_flights[flight].tasks, 1, __ATOMIC_ACQ_REL)) {
+    _collect(flight, acted, dead);
+    return true;
+  }
+  return false;
+}
+
+
+/**
+* @param  acted   Receives how many workers' notify() calls took action.
+* @param  dead    Receives how many didn't.
+* @return A Msg whose tasks are all done, or nullptr if there are none.
+*/
+inline ManuvrMsg* WorkerPool::finished(int* acted, int* dead) {
+  ManuvrMsg* msg = _done.pop();
+  if (nullptr != msg) {
+    for (int i = 0; i < MANUVR_WORKER_FLIGHTS; i++) {
+      if ((msg == _flights[i].msg) && (0 == __atomic_load_n(&_flights[i].tasks, __ATOMIC_ACQUIRE))) {
+        _collect(i, acted, dead);
+        break;
+      }
+    }
+  }
+  return msg;
+}
+
+
+/**
+* @return true if the given Msg has tasks out with the workers.
+*/
+inline bool WorkerPool::inFlight(ManuvrMsg* msg) {
+  for (int i = 0; i < MANUVR_WORKER_FLIGHTS; i++) {
+    if (msg == _flights[i].msg) return true;
+  }
+  return false;
+}
+
+
+/**
+* @return true if every flight is out. Nothing more should be dispatched until
+*           one lands, or pinned receivers would be run out of turn.
+*/
+inline bool WorkerPool::saturated() {
+  for (int i = 0; i < MANUVR_WORKER_FLIGHTS; i++) {
+    if (nullptr == _flights[i].msg) return false;
+  }
+  return true;
+}
+
+
+inline uint32_t WorkerPool::executed() {
+  uint32_t ret = 0;
+  for (int i = 0; i < MANUVR_MAX_WORKERS; i++) ret += __atomic_load_n(&_workers[i].executed, __ATOMIC_RELAXED);
+  return ret;
+}
+
+inline uint32_t WorkerPool::steals() {
+  uint32_t ret = 0;
+  for (int i = 0; i < MANUVR_MAX_WORKERS; i++) ret += __atomic_load_n(&_workers[i].stolen, __ATOMIC_RELAXED);
+  return ret;
+}
+
+
+inline void WorkerPool::_collect(int flight, int* acted, int* dead) {
+  *acted = (int) __atomic_load_n(&_flights[flight].acted, __ATOMIC_ACQUIRE);
+  *dead  = (int) __atomic_load_n(&_flights[flight].dead,  __ATOMIC_ACQUIRE);
+  _flights[flight].msg = nullptr;
+}
+
+
+inline bool WorkerPool::_take(Worker* w, WorkItem* item) {
+  if (w->p_head != w->p_tail) {
+    *item = w->pinned[w->p_head++ & (MANUVR_WORKER_QUEUE_DEPTH - 1)];
+    return true;
+  }
+  if (w->s_head != w->s_tail) {
+    *item = w->shared[w->s_head & (MANUVR_WORKER_QUEUE_DEPTH - 1)];
+    __atomic_store_n(&w->s_head, w->s_head + 1, __ATOMIC_RELAXED);
+    return true;
+  }
+  return false;
+}
+
+
+inline bool WorkerPool::_steal(Worker* thief, WorkItem* item) {
+  int me    = thief - _workers;
+  int count = __atomic_load_n(&_count, __ATOMIC_ACQUIRE);
+  for (int i = 1; i < count; i++) {
+    Worker* victim = &_workers[(me + i) % count];
+    if (__atomic_load_n(&victim->s_head, __ATOMIC_RELAXED) == __atomic_load_n(&victim->s_tail, __ATOMIC_RELAXED)) {
+      continue;   // A cheap look before we bother with the lock.
+    }
+    pthread_mutex_lock(&victim->lock);
+    bool got = (victim->s_head != victim->s_tail);
+    if (got) {
+      __atomic_store_n(&victim->s_tail, victim->s_tail - 1, __ATOMIC_RELAXED);
+      *item = victim->shared[victim->s_tail & (MANUVR_WORKER_QUEUE_DEPTH - 1)];
+    }
+    pthread_mutex_unlock(&victim->lock);
+    if (got) {
+      __atomic_add_fetch(&thief->stolen, 1, __ATOMIC_RELAXED);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+inline void WorkerPool::_run(Worker* w, WorkItem* item) {
+  Flight* f = &_flights[item->flight];
+  MANUVR_TRACE_SPAN(TraceCat::NOTIFY, f->msg->eventCode(), item->er->getReceiverName(), 0);
+  if (0 == item->er->notify(f->msg)) {
+    __atomic_add_fetch(&f->dead, 1, __ATOMIC_RELAXED);
+  }
+  else {
+    __atomic_add_fetch(&f->acted, 1, __ATOMIC_RELAXED);
+  }
+  __atomic_add_fetch(&w->executed, 1, __ATOMIC_RELAXED);
+  _land(item->flight);
+}
+
+
+inline void WorkerPool::_land(uint8_t flight) {
+  Flight* f = &_flights[flight];
+  if (0 == __atomic_sub_fetch(&f->tasks, 1, __ATOMIC_ACQ_REL)) {
+    // We were last. The ring has room for every flight, so this can't fail.
+    _done.push(f->msg);
+    if (nullptr != _wake) _wake();
+  }
+}
+
+
+/**
+* A worker's life. Our own pinned work comes first, then our own shared work,
+*   then anyone else's shared work. Only when there is none of that do we sleep.
+*/
+inline void* WorkerPool::_worker_main(void* arg) {
+  Worker*     w    = (Worker*) arg;
+  WorkerPool* pool = w->pool;
+  WorkItem    item;
+  while (true) {
+    uint32_t epoch = __atomic_load_n(&pool->_epoch, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&w->lock);
+    bool got = pool->_take(w, &item);
+    pthread_mutex_unlock(&w->lock);
+    if (!got) got = pool->_steal(w, &item);
+    if (got) {
+      pool->_run(w, &item);
+      continue;
+    }
+
+    pthread_mutex_lock(&w->lock);
+    if ((w->p_head == w->p_tail) && (w->s_head == w->s_tail)) {
+      if (pool->_stopping) {
+        pthread_mutex_unlock(&w->lock);
+        return nullptr;
+      }
+      if (epoch == __atomic_load_n(&pool->_epoch, __ATOMIC_SEQ_CST)) {
+        // Nothing was queued anywhere since we looked. Sleep until something is.
+        w->sleeping = true;
+        pthread_cond_wait(&w->cond, &w->lock);
+        w->sleeping = false;
+      }
+    }
+    pthread_mutex_unlock(&w->lock);
+  }
+  return nullptr;
+}
+
+#endif  // __MANUVR_WORKER_POOL_H__
@@ -46,7 +46,14 @@ This file is the tortured result of growing pains since the beginning of
 
 I2CBusOp I2CAdapter::__prealloc_pool[I2CADAPTER_PREALLOC_COUNT];
 char I2CAdapter::_ping_state_chr[4] = {' ', '.', '*', ' '};
-//template<> PriorityQueue<I2CBusOp*> BusAdapter<I2CBusOp>::preallocated;
+
+// The codes that our notify() handles.
+const uint16_t I2CAdapter::_i2c_interests[] = {
+  MANUVR_MSG_SYS_REBOOT,
+  MANUVR_MSG_SYS_BOOTLOADER,
+  MANUVR_MSG_I2C_QUEUE_READY,
+  MANUVR_MSG_UNDEFINED
+};
 
 /*******************************************************************************
 *   ___ _              ___      _ _              _      _
@@ -63,12 +70,11 @@ I2CAdapter::I2CAdapter(const I2CAdapterOptions* o) : EventReceiver("I2CAdapter")
   _er_clear_flag(I2C_BUS_FLAG_BUS_ERROR | I2C_BUS_FLAG_BUS_ONLINE);
   _er_clear_flag(I2C_BUS_FLAG_PING_RUN  | I2C_BUS_FLAG_PINGING);
 
-  // Mark all of our preallocated SPI jobs as "No Reap" and pass them into the prealloc queue.
-  for (uint8_t i = 0; i < I2CADAPTER_PREALLOC_COUNT; i++) {
-    preallocated.insert(&__prealloc_pool[i]);
-  }
+  // Pass all of our preallocated jobs into the prealloc pool.
+  preallocated.init(__prealloc_pool, I2CADAPTER_PREALLOC_COUNT);
 
   for (uint16_t i = 0; i < 32; i++) ping_map[i] = 0;   // Zero the ping map.
+  setInterests(_i2c_interests);
 }
 
 
@@ -112,11 +118,7 @@ I2CBusOp* I2CAdapter::new_op(BusOpcode _op, BusOpCallback* _req) {
 * @param item The I2CBusOp to be reclaimed.
 */
 void I2CAdapter::reclaim_queue_item(I2CBusOp* op) {
-  uintptr_t obj_addr = ((uintptr_t) op);
-  uintptr_t pre_min  = ((uintptr_t) __prealloc_pool);
-  uintptr_t pre_max  = pre_min + (sizeof(I2CBusOp) * I2CADAPTER_PREALLOC_COUNT);
-
-  if ((obj_addr < pre_max) && (obj_addr >= pre_min)) {
+  if (preallocated.owns(op)) {
     // If we are in this block, it means obj was preallocated. wipe and reclaim it.
     BusAdapter::return_op_to_pool(op);
   }
@@ -291,7 +293,13 @@ int8_t I2CAdapter::queue_io_job(BusOp* op) {
   nu->device = (I2CAdapter*)this;
 	if (current_job) {
 		// Something is already going on with the bus. Queue...
-		work_queue.insert(nu);
+		if (0 != work_queue.insert(nu, nu->urgent())) {
+		  _queue_floods++;
+		  nu->abort(XferFault::QUEUE_FLUSH);
+		  nu->execCB();
+		  reclaim_queue_item(nu);
+		  return -1;
+		}
 	}
 	else {
 		// Bus is idle. Put this work item in the active slot and start the bus operations...
@@ -331,6 +339,7 @@ int8_t I2CAdapter::queue_io_job(BusOp* op) {
 */
 int8_t I2CAdapter::advance_work_queue() {
   int8_t return_value = 0;
+  MANUVR_TRACE_SPAN(TraceCat::BUS, 0, getReceiverName(), work_queue.size());
   bool recycle = busOnline();
   while (recycle) {
     return_value++;
@@ -377,8 +386,13 @@ int8_t I2CAdapter::advance_work_queue() {
           // Note that we forgo a separate callback queue, and are therefore unable to
           //   pipeline I/O and processing. They must happen sequentially.
           current_job->execCB();
-    			reclaim_queue_item(current_job);   // Delete the queued work AND its buffer.
-    			current_job = nullptr;
+          {
+            // Ops that shared a transaction with this one finish right behind it.
+            I2CBusOp* next = current_job->next_in_batch;
+      			reclaim_queue_item(current_job);   // Delete the queued work AND its buffer.
+      			current_job = next;
+            recycle = (nullptr != next);
+          }
           break;
       }
   	}
@@ -408,13 +422,14 @@ int8_t I2CAdapter::advance_work_queue() {
 void I2CAdapter::purge_queued_work_by_dev(I2CDevice *dev) {
   I2CBusOp* current = nullptr;
 
-  if (work_queue.size() > 0) {
-    for (int i = 0; i < work_queue.size(); i++) {
-      current = work_queue.get(i);
-      if (current->dev_addr == dev->_dev_addr) {
-        work_queue.remove(current);
-        reclaim_queue_item(current);   // Delete the queued work AND its buffer.
-      }
+  int i = 0;
+  while (nullptr != (current = work_queue.get(i))) {
+    if (current->dev_addr == dev->_dev_addr) {
+      work_queue.remove(current);
+      reclaim_queue_item(current);   // Delete the queued work AND its buffer.
+    }
+    else {
+      i++;
     }
   }
 
@@ -432,7 +447,6 @@ void I2CAdapter::purge_queued_work_by_dev(I2CDevice *dev) {
 void I2CAdapter::purge_queued_work() {
   I2CBusOp* current = work_queue.dequeue();
   while (current) {
-    current = work_queue.get();
     current->abort(XferFault::QUEUE_FLUSH);
     if (current->callback) {
       current->callback->io_op_callback(current);
@@ -444,14 +458,56 @@ void I2CAdapter::purge_queued_work() {
 
 
 void I2CAdapter::purge_stalled_job() {
-  if (current_job) {
+  while (current_job) {
+    I2CBusOp* next = current_job->next_in_batch;
     current_job->abort(XferFault::QUEUE_FLUSH);
     if (current_job->callback) {
       current_job->callback->io_op_callback(current_job);
     }
-    delete current_job;
-    current_job = nullptr;
+    reclaim_queue_item(current_job);
+    current_job = next;
+  }
+}
+
+
+/**
+* Chains queued ops behind the given one, in queue order, so that a platform
+*   can put them all on the bus in one transaction. Stops at the first op that
+*   addresses a device already in the chain, since a device may depend on one
+*   access finishing before the next is built.
+* Chained ops leave the queue, and are finished right behind the head by
+*   advance_work_queue(). Any that refuse their callahead are aborted, and so
+*   ride along without touching the bus.
+*
+* @param  head  The op that is about to begin.
+* @param  max   The longest chain the platform can take, head included.
+* @return How many ops were chained behind the head.
+*/
+int I2CAdapter::chain_queued_work(I2CBusOp* head, int max) {
+  int count = 0;
+  I2CBusOp* tail = head;
+  while (count + 1 < max) {
+    I2CBusOp* nu = work_queue.get(0);
+    if (nullptr == nu) {
+      break;
+    }
+    for (I2CBusOp* op = head; op; op = op->next_in_batch) {
+      if (op->dev_addr == nu->dev_addr) {
+        return count;
+      }
+    }
+    work_queue.remove(nu);
+    if (0 == nu->execCA()) {
+      nu->set_state(XferState::INITIATE);
+    }
+    else {
+      nu->abort(XferFault::IO_RECALL);
+    }
+    tail->next_in_batch = nu;
+    tail = nu;
+    count++;
   }
+  return count;
 }
 
 
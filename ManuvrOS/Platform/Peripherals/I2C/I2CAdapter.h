@@ -57,6 +57,14 @@ This file is the tortured result of growing pains since the beginning of
     // How many queue items should we have on-tap?
     #define I2CADAPTER_PREALLOC_COUNT 4
   #endif
+  #ifndef I2CADAPTER_MAX_BATCH
+    // On platforms that can, how many queued ops may share one bus transaction?
+    #define I2CADAPTER_MAX_BATCH 8
+  #endif
+  #ifndef I2CDEVICE_MAX_BURST_LEN
+    // How many bytes of contiguous registers may be merged into one access?
+    #define I2CDEVICE_MAX_BURST_LEN 32
+  #endif
 
   /*
   * These are used as function-return codes, and have nothing to do with bus
@@ -90,6 +98,7 @@ This file is the tortured result of growing pains since the beginning of
 
   /* These are transfer flags specific to I2C. */
   #define I2C_BUSOP_FLAG_SUBADDR         0x80    // Send a sub-address?
+  #define I2C_BUSOP_FLAG_BURST           0x40    // Spans several registers, through a buffer of its own.
   #define I2C_BUSOP_FLAG_VERBOSITY_MASK  0x07    // Low three bits store verbosity.
 
   // Forward declaration. Definition order in this file is very important.
@@ -149,6 +158,7 @@ This file is the tortured result of growing pains since the beginning of
       I2CAdapter* device  = nullptr;
       int16_t sub_addr = -1;
       uint8_t dev_addr =  0;
+      I2CBusOp* next_in_batch = nullptr;  // Ops that ride along in the same transaction.
 
       I2CBusOp();
       I2CBusOp(BusOpcode nu_op, BusOpCallback* requester);
@@ -180,6 +190,11 @@ This file is the tortured result of growing pains since the beginning of
       */
       inline bool need_to_send_subaddr() {	return ((sub_addr != -1) && !subaddr_sent());  }
 
+      inline bool burst() {  return (_flags & I2C_BUSOP_FLAG_BURST);  };
+      inline void burst(bool en) {
+        _flags = (en) ? (_flags | I2C_BUSOP_FLAG_BURST) : (_flags & ~(I2C_BUSOP_FLAG_BURST));
+      };
+
       inline int8_t getVerbosity() {   return (_flags & I2C_BUSOP_FLAG_VERBOSITY_MASK);   };
       inline void setVerbosity(int8_t v) {
         _flags = (v & I2C_BUSOP_FLAG_VERBOSITY_MASK) | (_flags & ~I2C_BUSOP_FLAG_VERBOSITY_MASK);
@@ -232,6 +247,9 @@ This file is the tortured result of growing pains since the beginning of
       int8_t addSlaveDevice(I2CDevice*);     // Adds a new device to the bus.
       int8_t removeSlaveDevice(I2CDevice*);  // Removes a device from the bus.
 
+      // For platforms that can carry several ops in one bus transaction.
+      int chain_queued_work(I2CBusOp* head, int max);
+
 
       // These are meant to be called from the bus jobs. They deal with specific bus functions
       //   that may or may not be present on a given platform.
@@ -277,6 +295,7 @@ This file is the tortured result of growing pains since the beginning of
 
       static I2CBusOp __prealloc_pool[I2CADAPTER_PREALLOC_COUNT];
       static char _ping_state_chr[4];
+      static const uint16_t _i2c_interests[];
   };
 
 
@@ -345,7 +364,11 @@ This file is the tortured result of growing pains since the beginning of
     protected:
       LinkedList<DeviceRegister*> reg_defs;     // Here is where registers will be enumerated.
       //uint8_t*  pooled_registers     = NULL;    // TODO: Make this happen!
-      bool      multi_access_support;     // TODO: Make this happen! Depends on pooled_registers.
+      // Set by drivers whose device auto-increments its register pointer. Syncs and
+      //   dirty writes are then merged into bursts over contiguous registers. Such
+      //   a driver will see one callback per burst, with the registers already
+      //   updated, and the op's buffer already gone.
+      bool      multi_access_support;
 
 
       // Callback for requested operation completion.
@@ -388,6 +411,9 @@ This file is the tortured result of growing pains since the beginning of
 
       int8_t writeRegister(DeviceRegister* reg);
       int8_t readRegister(DeviceRegister* reg);
+
+      int8_t burstRegisters(BusOpcode);
+      int8_t burstComplete(I2CBusOp*);
   };
 
 #endif  //I2C_ABSTRACTION_LAYER_ADAPTER
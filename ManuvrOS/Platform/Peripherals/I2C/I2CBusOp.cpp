@@ -65,8 +65,8 @@ I2CBusOp::~I2CBusOp() {
 
 /* Call to mark something completed that may not be. Also sends a stop. */
 int8_t I2CBusOp::abort(XferFault er) {
+  xfer_fault = er;   // Before markComplete(), or the fault might go unseen.
   markComplete();
-  xfer_fault = er;
   return 0;
 }
 
@@ -102,6 +102,8 @@ void I2CBusOp::wipe() {
     buf         = nullptr;
   }
   callback    = nullptr;
+  next_in_batch = nullptr;
+  burst(false);
 }
 
 
@@ -282,6 +282,9 @@ void I2CDeviceWithRegisters::printDebug(StringBuilder* temp) {
 *   register values into alignment with "what really is" in the device.
 */
 int8_t I2CDeviceWithRegisters::syncRegisters(void) {
+  if (multi_access_support) {
+    return burstRegisters(BusOpcode::RX);
+  }
   DeviceRegister *temp = nullptr;
   int8_t return_value = I2C_ERR_SLAVE_NO_ERROR;
   uint8_t count = reg_defs.size();
@@ -311,6 +314,9 @@ int8_t I2CDeviceWithRegisters::syncRegisters(void) {
 * Any registers marked dirty will be written to the device if the register is also marked wriatable.
 */
 int8_t I2CDeviceWithRegisters::writeDirtyRegisters(void) {
+  if (multi_access_support) {
+    return burstRegisters(BusOpcode::TX);
+  }
   int8_t return_value = I2C_ERR_SLAVE_NO_ERROR;
   DeviceRegister *temp = nullptr;
   for (int i = 0; i < reg_defs.size(); i++) {
@@ -341,6 +347,135 @@ int8_t I2CDeviceWithRegisters::writeDirtyRegisters(void) {
 }
 
 
+/*
+* For devices that auto-increment their register pointer. Plans the fewest bus
+*   ops that will cover the registers of interest, by merging those that are
+*   contiguous in the device's address space. A register that is alone goes
+*   out the ordinary way.
+* For RX, every register is of interest. For TX, only those that are dirty and
+*   writable.
+*
+* @param  opcode  RX or TX.
+* @return I2C_ERR_SLAVE_NO_ERROR, or the first failure.
+*/
+int8_t I2CDeviceWithRegisters::burstRegisters(BusOpcode opcode) {
+  if (_bus == nullptr) {
+    return I2C_ERR_SLAVE_INVALID;
+  }
+  int8_t return_value = I2C_ERR_SLAVE_NO_ERROR;
+  const bool rx = (BusOpcode::RX == opcode);
+  int count = reg_defs.size();
+  DeviceRegister* regs[count + 1];
+  int n = 0;
+
+  // Take the registers of interest, in address order.
+  for (int i = 0; i < count; i++) {
+    DeviceRegister* temp = reg_defs.get(i);
+    if (!rx) {
+      if (!temp->dirty) continue;
+      if (!temp->writable) {
+        #ifdef MANUVR_DEBUG
+          StringBuilder output;
+          output.concatf("Uh oh... register %d was marked dirty but it isn't writable. Marking clean with no write...\n", temp->addr);
+          Kernel::log(&output);
+        #endif
+        continue;
+      }
+    }
+    int x = n++;
+    while ((x > 0) && (regs[x - 1]->addr > temp->addr)) {
+      regs[x] = regs[x - 1];
+      x--;
+    }
+    regs[x] = temp;
+  }
+
+  int i = 0;
+  while ((i < n) && (I2C_ERR_SLAVE_NO_ERROR == return_value)) {
+    // Extend the run for as long as the next register follows on directly.
+    int j   = i;
+    int len = regs[i]->len;
+    while ((j + 1 < n) && (regs[j + 1]->addr == (regs[j]->addr + regs[j]->len)) && ((len + regs[j + 1]->len) <= I2CDEVICE_MAX_BURST_LEN)) {
+      j++;
+      len += regs[j]->len;
+    }
+
+    if (i == j) {
+      return_value = rx ? readRegister(regs[i]) : writeRegister(regs[i]);
+    }
+    else {
+      uint8_t* buf = (uint8_t*) malloc(len);
+      if (nullptr == buf) {
+        return I2C_ERR_SLAVE_INSERTION;
+      }
+      if (!rx) {
+        int offset = 0;
+        for (int x = i; x <= j; x++) {
+          memcpy(buf + offset, regs[x]->val, regs[x]->len);
+          offset += regs[x]->len;
+        }
+      }
+      I2CBusOp* nu = _bus->new_op(opcode, this);
+      nu->dev_addr = _dev_addr;
+      nu->sub_addr = (int16_t) regs[i]->addr;
+      nu->buf      = buf;
+      nu->buf_len  = len;
+      nu->burst(true);
+      if (0 != _bus->queue_io_job(nu)) {
+        // The adapter called us back, so the buffer is already gone.
+        return_value = I2C_ERR_SLAVE_BUS_FAULT;
+      }
+    }
+    i = j + 1;
+  }
+
+  #ifdef MANUVR_DEBUG
+  if (I2C_ERR_SLAVE_NO_ERROR != return_value) {
+    StringBuilder output;
+    output.concatf("Failed to %s register %d with code(%d).\n", (rx ? "read" : "write"), regs[i - 1]->addr, return_value);
+    Kernel::log(&output);
+  }
+  #endif
+  return return_value;
+}
+
+
+/*
+* Finishes a burst op by scattering its buffer back into the registers it
+*   spans (or marking them clean), and then freeing the buffer. That happens
+*   whether or not the op succeeded, since nobody else knows it was ours.
+*
+* @param  op  The burst op.
+* @return 0 on success, or -1 if the op failed.
+*/
+int8_t I2CDeviceWithRegisters::burstComplete(I2CBusOp* op) {
+  int8_t return_value = op->hasFault() ? -1 : 0;
+  if (0 == return_value) {
+    int offset = 0;
+    while (offset < op->buf_len) {
+      DeviceRegister* reg = getRegisterByBaseAddress(op->sub_addr + offset);
+      if (nullptr == reg) {
+        // The register map changed under a pending burst.
+        return_value = -1;
+        break;
+      }
+      if (BusOpcode::RX == op->get_opcode()) {
+        memcpy(reg->val, op->buf + offset, reg->len);
+        reg->unread = true;
+      }
+      else {
+        reg->dirty = false;
+      }
+      offset += reg->len;
+    }
+  }
+  free(op->buf);
+  op->buf     = nullptr;
+  op->buf_len = 0;
+  return return_value;
+}
+
+
 int8_t I2CDeviceWithRegisters::io_op_callahead(BusOp* op) {
   // Default is to allow the transfer.
   return 0;
@@ -351,6 +486,9 @@ int8_t I2CDeviceWithRegisters::io_op_callback(BusOp* _op) {
   I2CBusOp* completed = (I2CBusOp*) _op;
 
   if (completed) {
+    if (completed->burst()) {
+      return burstComplete(completed);
+    }
     if (!completed->hasFault()) {
       DeviceRegister *nu = getRegisterByBaseAddress(completed->sub_addr);
       if (nu) {
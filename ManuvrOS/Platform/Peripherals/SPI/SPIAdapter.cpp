@@ -24,6 +24,10 @@ This is the platform-invariant implementation of a peripheral wraspper
 
 #include <Platform/Peripherals/SPI/SPIAdapter.h>
 
+#if defined(__MANUVR_LINUX) && !defined(MANUVR_BUS_SIM)
+  #include <unistd.h>
+#endif
+
 
 /*******************************************************************************
 *      _______.___________.    ___   .___________. __    ______     _______.
@@ -39,7 +43,6 @@ This is the platform-invariant implementation of a peripheral wraspper
 volatile static bool timeout_punch = false;
 
 SPIBusOp  SPIAdapter::preallocated_bus_jobs[SPIADAPTER_PREALLOC_COUNT];
-//template<> PriorityQueue<SPIBusOp*> BusAdapter<SPIBusOp>::preallocated;
 
 const MessageTypeDef spi_message_defs[] = {
   {  MANUVR_MSG_SPI_QUEUE_READY,    0x0000,  "SPI_Q_RDY",  ManuvrMsg::MSG_ARGS_NONE }, //
@@ -59,7 +62,7 @@ const MessageTypeDef spi_message_defs[] = {
 /**
 * Constructor. Also populates the global pointer reference.
 */
-SPIAdapter::SPIAdapter(uint8_t idx, uint8_t d_in, uint8_t d_out, uint8_t clk) : EventReceiver("SPIAdapter"), BusAdapter(SPIADAPTER_PREALLOC_COUNT) {
+SPIAdapter::SPIAdapter(uint8_t idx, uint8_t d_in, uint8_t d_out, uint8_t clk) : EventReceiver("SPIAdapter"), BusAdapter(SPIADAPTER_MAX_QUEUE_DEPTH), _adapter_id(idx) {
   ManuvrMsg::registerMessages(spi_message_defs, sizeof(spi_message_defs) / sizeof(MessageTypeDef));
 
   // Build some pre-formed Events.
@@ -73,14 +76,18 @@ SPIAdapter::SPIAdapter(uint8_t idx, uint8_t d_in, uint8_t d_out, uint8_t clk) :
   SPIBusOp::event_spi_queue_ready.specific_target = (EventReceiver*) this;
   SPIBusOp::event_spi_queue_ready.priority(5);
 
-  // Mark all of our preallocated SPI jobs as "No Reap" and pass them into the prealloc queue.
+  // Mark all of our preallocated SPI jobs as "No Reap" and pass them into the prealloc pool.
   for (uint8_t i = 0; i < SPIADAPTER_PREALLOC_COUNT; i++) {
     preallocated_bus_jobs[i].returnToPrealloc(true);     // Implies SHOuLD_REAP = false.
-    preallocated.insert(&preallocated_bus_jobs[i]);
   }
+  preallocated.init(preallocated_bus_jobs, SPIADAPTER_PREALLOC_COUNT);
 
   current_job = nullptr;
   _er_set_flag(SPI_FLAG_QUEUE_IDLE);
+
+  #if defined(__MANUVR_LINUX) && !defined(MANUVR_BUS_SIM)
+    for (int i = 0; i < SPIADAPTER_LINUX_MAX_CS; i++) _spidev_fds[i] = -1;
+  #endif
 }
 
 
@@ -90,6 +97,14 @@ SPIAdapter::SPIAdapter(uint8_t idx, uint8_t d_in, uint8_t d_out, uint8_t clk) :
 SPIAdapter::~SPIAdapter() {
   bus_deinit();
   purge_queued_work();
+  #if defined(__MANUVR_LINUX) && !defined(MANUVR_BUS_SIM)
+    for (int i = 0; i < SPIADAPTER_LINUX_MAX_CS; i++) {
+      if (_spidev_fds[i] >= 0) {
+        close(_spidev_fds[i]);
+        _spidev_fds[i] = -1;
+      }
+    }
+  #endif
 }
 
 
@@ -166,6 +181,7 @@ int8_t SPIAdapter::queue_io_job(BusOp* _op) {
       // We assign the bus adapter itself to be notified on job completion.
       op->callback = (BusOpCallback*) this;
     }
+    op->adapter = this;
 
     if (getVerbosity() > 6) {
       op->profile(true);
@@ -185,13 +201,14 @@ int8_t SPIAdapter::queue_io_job(BusOp* _op) {
     else {    // If there is something already in progress, queue up.
       if (_er_flag(SPI_FLAG_QUEUE_GUARD) && (SPIADAPTER_MAX_QUEUE_DEPTH <= work_queue.size())) {
         if (getVerbosity() > 3) Kernel::log("SPIAdapter::queue_io_job(): \t Bus queue at max size. Dropping transaction.\n");
+        _queue_floods++;
         op->abort(XferFault::QUEUE_FLUSH);
         callback_queue.insertIfAbsent(op);
         if (callback_queue.size() == 1) Kernel::staticRaiseEvent(&event_spi_callback_ready);
         return -1;
       }
 
-      if (0 > work_queue.insertIfAbsent(op)) {
+      if (work_queue.contains(op)) {
         if (getVerbosity() > 2) {
           local_log.concat("SPIAdapter::queue_io_job(): \t Double-insertion. Dropping transaction with no status change.\n");
           op->printDebug(&local_log);
@@ -199,6 +216,13 @@ int8_t SPIAdapter::queue_io_job(BusOp* _op) {
         }
         return -3;
       }
+      if (0 != work_queue.insert(op, op->urgent())) {
+        _queue_floods++;
+        op->abort(XferFault::QUEUE_FLUSH);
+        callback_queue.insertIfAbsent(op);
+        if (callback_queue.size() == 1) Kernel::staticRaiseEvent(&event_spi_callback_ready);
+        return -1;
+      }
     }
     return 0;
   }
@@ -230,6 +254,7 @@ int8_t SPIAdapter::bus_deinit() {
 */
 int8_t SPIAdapter::advance_work_queue() {
   int8_t return_value = 0;
+  MANUVR_TRACE_SPAN(TraceCat::BUS, 0, getReceiverName(), work_queue.size());
 
   timeout_punch = false;
   if (current_job) {
@@ -244,11 +269,8 @@ int8_t SPIAdapter::advance_work_queue() {
          }
          // NOTE: No break on purpose.
        case XferState::COMPLETE:
-         callback_queue.insert(current_job);
+         queue_for_callback(current_job);
          current_job = nullptr;
-         if (callback_queue.size() == 1) {
-           Kernel::staticRaiseEvent(&event_spi_callback_ready);
-         }
          break;
 
        case XferState::IDLE:
@@ -263,9 +285,8 @@ int8_t SPIAdapter::advance_work_queue() {
              break;
            default:    // Began the transfer, and it barffed... was aborted.
              if (getVerbosity() > 3) local_log.concat("SPIAdapter::advance_work_queue():\t Failed to begin transfer after starting.\n");
-             callback_queue.insert(current_job);
+             queue_for_callback(current_job);
              current_job = nullptr;
-             if (callback_queue.size() == 1) Kernel::staticRaiseEvent(&event_spi_callback_ready);
              break;
          }
          break;
@@ -313,19 +334,16 @@ int8_t SPIAdapter::advance_work_queue() {
 void SPIAdapter::purge_queued_work_by_dev(BusOpCallback *dev) {
   if (NULL == dev) return;
 
-  if (work_queue.size() > 0) {
-    SPIBusOp* current = nullptr;
-    int i = 0;
-    while (i < work_queue.size()) {
-      current = work_queue.get(i);
-      if (current->callback == dev) {
-        current->abort(XferFault::QUEUE_FLUSH);
-        work_queue.remove(current);
-        reclaim_queue_item(current);
-      }
-      else {
-        i++;
-      }
+  SPIBusOp* current = nullptr;
+  int i = 0;
+  while (nullptr != (current = work_queue.get(i))) {
+    if (current->callback == dev) {
+      current->abort(XferFault::QUEUE_FLUSH);
+      work_queue.remove(current);
+      reclaim_queue_item(current);
+    }
+    else {
+      i++;
     }
   }
   // Lastly... initiate the next bus transfer if the bus is not sideways.
@@ -353,14 +371,45 @@ void SPIAdapter::purge_queued_work() {
 * Purges a stalled job from the active slot.
 */
 void SPIAdapter::purge_stalled_job() {
-  if (current_job) {
+  while (current_job) {
+    SPIBusOp* next = current_job->next_in_batch;
     current_job->abort(XferFault::QUEUE_FLUSH);
     reclaim_queue_item(current_job);
-    current_job = nullptr;
+    current_job = next;
   }
 }
 
 
+/**
+* Chains the queued ops that follow the given one onto it, so that a platform
+*   can put them all on the bus in one transaction. Only ops for the same
+*   device (by callback and chip-select) that are next in line are taken, so
+*   that nothing is reordered.
+* Chained ops leave the queue, and are passed back along with the head once
+*   it completes.
+*
+* @param  head  The op that is about to begin.
+* @param  max   The longest chain the platform can take, head included.
+* @return How many ops were chained behind the head.
+*/
+int SPIAdapter::chain_queued_work(SPIBusOp* head, int max) {
+  int count = 0;
+  SPIBusOp* tail = head;
+  while (count + 1 < max) {
+    SPIBusOp* nu = work_queue.get(0);
+    if ((nullptr == nu) || (nu->callback != head->callback) || (nu->getCSPin() != head->getCSPin())) {
+      break;
+    }
+    work_queue.remove(nu);
+    nu->set_state(XferState::INITIATE);
+    tail->next_in_batch = nu;
+    tail = nu;
+    count++;
+  }
+  return count;
+}
+
+
 /**
 * Return a vacant SPIBusOp to the caller, allocating if necessary.
 *
@@ -409,6 +458,26 @@ void SPIAdapter::reclaim_queue_item(SPIBusOp* op) {
 }
 
 
+/**
+* Moves a finished op, along with any that shared its transaction, into the
+*   callback queue. The whole batch is announced with one event.
+*
+* @param  op  The head of the finished batch.
+*/
+void SPIAdapter::queue_for_callback(SPIBusOp* op) {
+  bool was_empty = (0 == callback_queue.size());
+  while (op) {
+    SPIBusOp* next = op->next_in_batch;
+    op->next_in_batch = nullptr;   // Recycled ops must start over alone.
+    callback_queue.insert(op);
+    op = next;
+  }
+  if (was_empty) {
+    Kernel::staticRaiseEvent(&event_spi_callback_ready);
+  }
+}
+
+
 /**
 * Execute any I/O callbacks that are pending. The function is present because
 *   this class contains the bus implementation.
@@ -417,10 +486,10 @@ void SPIAdapter::reclaim_queue_item(SPIBusOp* op) {
 */
 int8_t SPIAdapter::service_callback_queue() {
   int8_t return_value = 0;
-  SPIBusOp* temp_op = callback_queue.dequeue();
+  SPIBusOp* temp_op = nullptr;
 
-  while ((nullptr != temp_op) && (return_value < spi_cb_per_event)) {
-  //if (nullptr != temp_op) {
+  // Check the budget before dequeueing, so that an op isn't left in limbo.
+  while ((return_value < spi_cb_per_event) && (nullptr != (temp_op = callback_queue.dequeue()))) {
     if (getVerbosity() > 6) temp_op->printDebug(&local_log);
     if (temp_op->callback) {
       int8_t cb_code = temp_op->callback->io_op_callback(temp_op);
@@ -446,7 +515,6 @@ int8_t SPIAdapter::service_callback_queue() {
       reclaim_queue_item(temp_op);
     }
     return_value++;
-    temp_op = callback_queue.dequeue();
   }
 
   flushLocalLog();
@@ -535,7 +603,11 @@ void SPIAdapter::printDebug(StringBuilder *output) {
     output->concatf("-- spi_cb_per_event    %d\n--\n",   spi_cb_per_event);
   }
   printAdapter(output);
-  output->concatf("-- callback q depth    %d\n\n", callback_queue.size());
+  output->concatf("-- callback q depth    %d\n", callback_queue.size());
+  #if defined(MANUVR_CONSOLE_SUPPORT) && defined(__MANUVR_LINUX)
+    printHardwareState(output);
+  #endif
+  output->concat("\n");
 
   if (getVerbosity() > 3) {
     printWorkQueue(output, SPIADAPTER_MAX_QUEUE_PRINT);
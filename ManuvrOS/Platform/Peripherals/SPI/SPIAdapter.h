@@ -41,6 +41,16 @@ limitations under the License.
   // How many queue items should we have on-tap?
   #define SPIADAPTER_PREALLOC_COUNT  10
 #endif
+#if defined(__MANUVR_LINUX) && !defined(MANUVR_BUS_SIM)
+  #ifndef SPIADAPTER_LINUX_MAX_CS
+    // How many chip-selects should we look for on the bus?
+    #define SPIADAPTER_LINUX_MAX_CS 4
+  #endif
+#endif
+#ifndef SPIADAPTER_MAX_BATCH
+  // How many queued ops for one device may share a single transaction?
+  #define SPIADAPTER_MAX_BATCH 8
+#endif
 
 
 #define MANUVR_MSG_SPI_QUEUE_READY      0x0230 // There is a new job in the SPI bus queue.
@@ -77,6 +87,18 @@ class SPIAdapter : public EventReceiver, public BusAdapter<SPIBusOp> {
 
     void purge_queued_work_by_dev(BusOpCallback *dev);   // Flush the work queue by callback match
 
+    // For platforms that can carry several ops in one bus transaction.
+    int chain_queued_work(SPIBusOp* head, int max);
+
+    inline uint8_t getAdapterId() {  return _adapter_id;  };
+
+    #if defined(__MANUVR_LINUX) && !defined(MANUVR_BUS_SIM)
+      /* The spidev opened for the given chip-select. -1 if there isn't one. */
+      inline int spidev(uint8_t cs) {
+        return (cs < SPIADAPTER_LINUX_MAX_CS) ? _spidev_fds[cs] : -1;
+      };
+    #endif
+
     /* Overrides from EventReceiver */
     void printDebug(StringBuilder*);
     int8_t notify(ManuvrMsg*);
@@ -97,15 +119,20 @@ class SPIAdapter : public EventReceiver, public BusAdapter<SPIBusOp> {
   private:
     ManuvrMsg event_spi_callback_ready;
     ManuvrMsg event_spi_timeout;
+    const uint8_t _adapter_id;
 
     /* List of pending callbacks for bus transactions. */
     PriorityQueue<SPIBusOp*> callback_queue;
     uint32_t  bus_timeout_millis = 5;  // How long to spend in IO_WAIT?
-    uint8_t   spi_cb_per_event   = 3;  // Limit the number of callbacks processed per event.
+    uint8_t   spi_cb_per_event   = SPIADAPTER_MAX_BATCH;  // Limit the number of callbacks processed per event.
+    #if defined(__MANUVR_LINUX) && !defined(MANUVR_BUS_SIM)
+      int     _spidev_fds[SPIADAPTER_LINUX_MAX_CS];   // One per chip-select on this bus.
+    #endif
 
     void purge_queued_work();     // Flush the work queue.
     void purge_stalled_job();     // TODO: Misnomer. Really purges the active job.
     int8_t service_callback_queue();
+    void queue_for_callback(SPIBusOp*);
     void reclaim_queue_item(SPIBusOp*);
 
     /* Setup and init fxns. */
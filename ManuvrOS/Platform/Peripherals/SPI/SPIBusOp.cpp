@@ -312,6 +312,8 @@ void SPIBusOp::wipe() {
   buf_len     = 0;
   buf         = nullptr;
   callback    = nullptr;
+  adapter     = nullptr;
+  next_in_batch = nullptr;
   _cs_pin     = 255;
   _param_len  = 0;
   xfer_params[0] = 0;
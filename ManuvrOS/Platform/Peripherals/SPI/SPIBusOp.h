@@ -48,6 +48,8 @@ This is the class that is used to keep bus operations on the SPI atomic.
   #define SPI_CALLBACK_RECYCLE   1
 
 
+class SPIAdapter;
+
 /*
 * This class represents a single transaction on the SPI bus.
 */
@@ -87,6 +89,7 @@ class SPIBusOp : public BusOp {
     inline uint8_t transferParamLength() {    return _param_len;     };
 
     inline void setCSPin(uint8_t pin) {   _cs_pin = pin;  };
+    inline uint8_t getCSPin() {           return _cs_pin; };
 
     /* Flag management fxns... */
     bool shouldReap(bool);    // Override to set the reap behavior.
@@ -148,6 +151,9 @@ class SPIBusOp : public BusOp {
     inline bool shouldReap() {        return ((_flags & SPI_XFER_FLAG_NO_FREE) == 0);   }
 
 
+    SPIAdapter* adapter       = nullptr;  // The adapter that is running this op.
+    SPIBusOp*   next_in_batch = nullptr;  // Ops that ride along in the same transaction.
+
     static uint16_t  spi_wait_timeout;   // In microseconds. Per-byte.
     static ManuvrMsg event_spi_queue_ready;
 
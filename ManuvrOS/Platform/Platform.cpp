@@ -390,6 +390,12 @@ void ManuvrPlatform::printDebug() {
 /*******************************************************************************
 * System hook-points                                                           *
 *******************************************************************************/
+/*
+* The idle hook is called by the Kernel on every loop once it has been idle for
+*   a while. A platform may block in it, provided that its wake hook will break
+*   the block. The Kernel calls the wake hook whenever work arrives from outside
+*   its own thread (including from ISRs), so wake hooks must be ISR-safe.
+*/
 void ManuvrPlatform::idleHook() {
   if (_idle_hook) _idle_hook();
 }
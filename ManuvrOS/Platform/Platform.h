@@ -350,12 +350,15 @@ int wakeThread(unsigned long);
 #if defined(__BUILD_HAS_PTHREADS)
   inline int  yieldThread() {   return pthread_yield();   };
   inline void suspendThread() {  sleep_millis(100); };   // TODO
+  inline unsigned long currentThreadId() {  return (unsigned long) pthread_self();  };
 #elif defined(__MANUVR_FREERTOS)
   inline int  yieldThread() {   taskYIELD();  return 0;   };
   inline void suspendThread() {  sleep_millis(100); };   // TODO
+  inline unsigned long currentThreadId() {  return (unsigned long) xTaskGetCurrentTaskHandle();  };
 #else
   inline int  yieldThread() {   return 0;   };
   inline void suspendThread() { };
+  inline unsigned long currentThreadId() {  return 0;   };
 #endif
 
 
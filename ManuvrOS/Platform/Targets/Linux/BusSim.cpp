@@ -0,0 +1,269 @@
+/*
+File:   BusSim.cpp
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#if defined(MANUVR_BUS_SIM)
+
+#include <Platform/Targets/Linux/BusSim.h>
+#include <DataStructures/StringBuilder.h>
+
+#include <string.h>
+#include <time.h>
+#include <linux/i2c.h>
+#include <linux/spi/spidev.h>
+
+
+BusSimDevice* BusSim::_devs[BUSSIM_MAX_DEVICES] = {nullptr};
+
+uint32_t BusSim::ns_per_byte = 0;
+uint32_t BusSim::fault_every = 0;
+uint32_t BusSim::calls       = 0;
+uint32_t BusSim::segments    = 0;
+uint32_t BusSim::bytes       = 0;
+uint32_t BusSim::faults      = 0;
+
+
+/*******************************************************************************
+* A register-mapped device.
+*******************************************************************************/
+
+BusSimDevice::BusSimDevice(uint8_t b, uint8_t a) : bus(b), addr(a) {
+  memset(regs, 0, sizeof(regs));
+}
+
+
+void BusSimDevice::resetCounters() {
+  addressed = 0;
+  naks      = 0;
+  rx_bytes  = 0;
+  tx_bytes  = 0;
+}
+
+
+/**
+* Called as a transfer addresses us.
+*
+* @return true if we ACK.
+*/
+bool BusSimDevice::addressPhase() {
+  addressed++;
+  if (!present || ((0 != nak_every) && (0 == (addressed % nak_every)))) {
+    naks++;
+    return false;
+  }
+  return true;
+}
+
+
+void BusSimDevice::write(uint8_t b) {
+  regs[ptr++] = b;
+  rx_bytes++;
+}
+
+
+uint8_t BusSimDevice::read() {
+  tx_bytes++;
+  return regs[ptr++];
+}
+
+
+void BusSimDevice::printDebug(StringBuilder* output) {
+  output->concatf("\t Bus %u, addr 0x%02x (%s)  ptr 0x%02x\n", bus, addr, (present ? "present" : "absent"), ptr);
+  output->concatf("\t   addressed %u, NAK'd %u, %u bytes in, %u bytes out\n", addressed, naks, rx_bytes, tx_bytes);
+}
+
+
+
+/*******************************************************************************
+* The buses.
+*******************************************************************************/
+
+/**
+* @param  dev  The device to put on its bus.
+* @return 0 on success, or -1 if the address is taken or there is no room.
+*/
+int8_t BusSim::attach(BusSimDevice* dev) {
+  if ((nullptr == dev) || (nullptr != device(dev->bus, dev->addr))) {
+    return -1;
+  }
+  for (int i = 0; i < BUSSIM_MAX_DEVICES; i++) {
+    if (nullptr == _devs[i]) {
+      _devs[i] = dev;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+
+int8_t BusSim::detach(BusSimDevice* dev) {
+  for (int i = 0; i < BUSSIM_MAX_DEVICES; i++) {
+    if (dev == _devs[i]) {
+      _devs[i] = nullptr;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+
+BusSimDevice* BusSim::device(uint8_t bus, uint8_t addr) {
+  for (int i = 0; i < BUSSIM_MAX_DEVICES; i++) {
+    if ((nullptr != _devs[i]) && (bus == _devs[i]->bus) && (addr == _devs[i]->addr)) {
+      return _devs[i];
+    }
+  }
+  return nullptr;
+}
+
+
+/**
+* Behaves as ioctl(I2C_RDWR) would. Messages are carried out in order, and the
+*   first one that is NAK'd ends the call. Whatever came before it has
+*   already happened, just as it would have on the wire.
+*
+* @param  bus    The adapter id.
+* @param  msgs   The messages.
+* @param  count  How many.
+* @return The number of messages, or -1 on failure.
+*/
+int BusSim::i2cTransfer(uint8_t bus, struct i2c_msg* msgs, unsigned int count) {
+  calls++;
+  if (_injected_fault()) return -1;
+  uint32_t moved = 0;
+  int return_value = (int) count;
+  for (unsigned int i = 0; i < count; i++) {
+    segments++;
+    BusSimDevice* dev = device(bus, (uint8_t) msgs[i].addr);
+    if ((nullptr == dev) || !dev->addressPhase()) {
+      faults++;
+      return_value = -1;
+      break;
+    }
+    if (msgs[i].flags & I2C_M_RD) {
+      for (int x = 0; x < msgs[i].len; x++) msgs[i].buf[x] = dev->read();
+    }
+    else if (msgs[i].len > 0) {
+      dev->ptr = msgs[i].buf[0];
+      for (int x = 1; x < msgs[i].len; x++) dev->write(msgs[i].buf[x]);
+    }
+    moved += msgs[i].len + 1;   // The address byte costs bus time, too.
+  }
+  _spend(moved);
+  return return_value;
+}
+
+
+/**
+* Behaves as ioctl(SPI_IOC_MESSAGE(count)) would. Chip-select is held across
+*   the whole message, unless a transfer asks for it to be dropped after it.
+*   Each assertion of chip-select begins with an address byte.
+*   There is nobody to NAK on SPI. An absent device just reads as 0xFF.
+*
+* @param  bus    The spidev bus.
+* @param  cs     The chip-select.
+* @param  xfers  The transfers.
+* @param  count  How many.
+* @return The number of bytes clocked, or -1 on failure.
+*/
+int BusSim::spiTransfer(uint8_t bus, uint8_t cs, struct spi_ioc_transfer* xfers, unsigned int count) {
+  calls++;
+  if (_injected_fault()) return -1;
+  BusSimDevice* dev = device(bus, cs);
+  if ((nullptr != dev) && !dev->present) dev = nullptr;
+  bool selecting = true;   // The next byte is an address.
+  bool reading   = false;
+  uint32_t moved = 0;
+  for (unsigned int i = 0; i < count; i++) {
+    segments++;
+    const uint8_t* tx = (const uint8_t*) (uintptr_t) xfers[i].tx_buf;
+    uint8_t*       rx = (uint8_t*) (uintptr_t) xfers[i].rx_buf;
+    for (uint32_t x = 0; x < xfers[i].len; x++) {
+      uint8_t out = (nullptr != tx) ? tx[x] : 0;
+      uint8_t in  = 0xFF;
+      if (nullptr != dev) {
+        if (selecting) {
+          dev->addressed++;
+          dev->ptr  = out & ~BUSSIM_SPI_READ_FLAG;
+          reading   = (out & BUSSIM_SPI_READ_FLAG);
+          selecting = false;
+          in = 0x00;
+        }
+        else if (reading) {
+          in = dev->read();
+        }
+        else {
+          dev->write(out);
+        }
+      }
+      if (nullptr != rx) rx[x] = in;
+    }
+    moved += xfers[i].len;
+    if (xfers[i].cs_change) selecting = true;
+  }
+  _spend(moved);
+  return (int) moved;
+}
+
+
+void BusSim::resetCounters() {
+  calls    = 0;
+  segments = 0;
+  bytes    = 0;
+  faults   = 0;
+  for (int i = 0; i < BUSSIM_MAX_DEVICES; i++) {
+    if (nullptr != _devs[i]) _devs[i]->resetCounters();
+  }
+}
+
+
+void BusSim::printDebug(StringBuilder* output) {
+  output->concatf("-- BusSim: %u calls, %u segments, %u bytes, %u faults\n", calls, segments, bytes, faults);
+  output->concatf("-- %uns/byte, faulting every %u calls\n", ns_per_byte, fault_every);
+  for (int i = 0; i < BUSSIM_MAX_DEVICES; i++) {
+    if (nullptr != _devs[i]) _devs[i]->printDebug(output);
+  }
+}
+
+
+bool BusSim::_injected_fault() {
+  if ((0 != fault_every) && (0 == (calls % fault_every))) {
+    faults++;
+    return true;
+  }
+  return false;
+}
+
+
+/*
+* Accounts for bytes moved, and burns the time they would have taken.
+*/
+void BusSim::_spend(uint32_t byte_count) {
+  bytes += byte_count;
+  if (0 == ns_per_byte) return;
+  struct timespec t0, t;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  uint64_t target = (uint64_t) byte_count * ns_per_byte;
+  do {
+    clock_gettime(CLOCK_MONOTONIC, &t);
+  } while ((uint64_t) (((t.tv_sec - t0.tv_sec) * 1000000000LL) + (t.tv_nsec - t0.tv_nsec)) < target);
+}
+
+#endif  // MANUVR_BUS_SIM
@@ -0,0 +1,124 @@
+/*
+File:   BusSim.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+An in-process stand-in for /dev/i2c-* and spidev, so that the bus adapters,
+  their queues, and the drivers above them can be run (and timed) without
+  hardware. Build with BUS_SIM=1, which defines MANUVR_BUS_SIM. The Linux
+  back ends then hand their transfers here instead of to the kernel, and
+  carry them out in-line rather than on an I/O thread.
+
+Each simulated device is a 256-byte register file with a pointer that
+  auto-increments, which is how most register-mapped parts behave:
+  I2C: The first byte of a write sets the pointer, and the rest are written
+       from there. Reads come from the pointer.
+  SPI: The first byte after chip-select is the register address, with the
+       read flag in the top bit. The rest is clocked in or out from there.
+
+Faults are injected by count rather than by chance, so that a test knows
+  exactly which transfer ought to fail:
+  - A device that isn't present NAKs its address. So does one whose
+    nak_every count comes up.
+  - The bus's fault_every count fails whichever call is in flight, before
+    anything reaches a device.
+
+Latency is a busy-wait for every byte moved, so that throughput figures say
+  something about a real bus. It defaults to zero.
+
+Nothing here locks. On a sim build, transfers come from whoever begins the
+  bus op, which is the Kernel's thread.
+*/
+
+
+#ifndef __MANUVR_BUS_SIM_H__
+#define __MANUVR_BUS_SIM_H__
+
+#include <inttypes.h>
+
+class StringBuilder;
+struct i2c_msg;
+struct spi_ioc_transfer;
+
+// How many simulated devices may be attached at once, across all buses?
+#ifndef BUSSIM_MAX_DEVICES
+  #define BUSSIM_MAX_DEVICES 16
+#endif
+
+#define BUSSIM_SPI_READ_FLAG  0x80   // Set in the address byte of an SPI read.
+
+
+/*
+* A register-mapped device on a simulated bus.
+*/
+class BusSimDevice {
+  public:
+    BusSimDevice(uint8_t bus, uint8_t addr);
+
+    const uint8_t bus;          // The I2C adapter id, or the spidev bus.
+    const uint8_t addr;         // The I2C address, or the chip-select.
+    uint8_t  regs[256];         // The register file.
+    uint8_t  ptr       = 0;     // The register pointer.
+    bool     present   = true;  // If false, the address is NAK'd.
+    uint32_t nak_every = 0;     // NAK every nth addressing. 0 for never.
+
+    /* Counters. */
+    uint32_t addressed = 0;     // How many times have we been addressed?
+    uint32_t naks      = 0;     // How many of those did we NAK?
+    uint32_t rx_bytes  = 0;     // Bytes written to us.
+    uint32_t tx_bytes  = 0;     // Bytes read from us.
+
+    void resetCounters();
+    void printDebug(StringBuilder*);
+
+    bool   addressPhase();      // Returns false if we NAK.
+    void   write(uint8_t);
+    uint8_t read();
+};
+
+
+class BusSim {
+  public:
+    static int8_t attach(BusSimDevice*);
+    static int8_t detach(BusSimDevice*);
+    static BusSimDevice* device(uint8_t bus, uint8_t addr);
+
+    static int i2cTransfer(uint8_t bus, struct i2c_msg* msgs, unsigned int count);
+    static int spiTransfer(uint8_t bus, uint8_t cs, struct spi_ioc_transfer* xfers, unsigned int count);
+
+    static void resetCounters();
+    static void printDebug(StringBuilder*);
+
+    static uint32_t ns_per_byte;   // Latency. 0 for none.
+    static uint32_t fault_every;   // Fail every nth call. 0 for never.
+
+    /* Counters. */
+    static uint32_t calls;         // How many transfer calls?
+    static uint32_t segments;      // How many i2c_msgs or spi_ioc_transfers did they carry?
+    static uint32_t bytes;         // How many bytes moved?
+    static uint32_t faults;        // How many calls failed, for any reason?
+
+
+  private:
+    static BusSimDevice* _devs[BUSSIM_MAX_DEVICES];
+
+    static bool _injected_fault();
+    static void _spend(uint32_t byte_count);
+};
+
+#endif  // __MANUVR_BUS_SIM_H__
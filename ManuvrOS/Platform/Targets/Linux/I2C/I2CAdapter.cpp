@@ -3,6 +3,7 @@
 #if defined(MANUVR_SUPPORT_I2C)
 #include <stdlib.h>
 #include <unistd.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
@@ -12,10 +13,28 @@
 #include <fcntl.h>
 #include <inttypes.h>
 #include <ctype.h>
+#include <string.h>
+
+#if defined(MANUVR_BUS_SIM)
+  #include <Platform/Targets/Linux/BusSim.h>
+#endif
 
 
 int open_bus_handle = -1;        //TODO: This is a hack. Re-work it.
-int8_t  last_used_bus_addr = 0;  //TODO: This is a hack. Re-work it.
+
+/*
+* Every op goes to the kernel as one I2C_RDWR, so a register read is a write of
+*   the subaddress and a read joined by a repeated START, rather than two
+*   syscalls with a STOP between them. Queued ops for other devices are packed
+*   into the same call. These count how well that is working.
+*/
+static uint32_t _rdwr_calls = 0;   // How many I2C_RDWR ioctls have we made?
+static uint32_t _rdwr_ops   = 0;   // How many ops did they carry?
+
+// The kernel won't take more than I2C_RDWR_IOCTL_MAX_MSGS, and an op can take two.
+#if (I2CADAPTER_MAX_BATCH * 2) > I2C_RDWR_IOCTL_MAX_MSGS
+  #error I2CADAPTER_MAX_BATCH is too large for I2C_RDWR on linux.
+#endif
 
 
 I2CBusOp* _threaded_op = nullptr;
@@ -39,50 +58,95 @@ void* i2c_worker_thread(void* arg) {
 
 
 /*
-* Private function that will switch the addressed i2c device via ioctl. This
-*   function is meaningless on anything but a linux system, in which case it
-*   will always return true;
-* On a linux system, this will only return true if the ioctl call succeeded.
+* Every op gets a byte of scratch for its subaddress. A write behind a
+*   subaddress needs room for the data as well, since the two must be contiguous.
+*   This is how much more than the one byte an op needs.
 */
-bool switch_device(I2CAdapter* adapter, uint8_t nu_addr) {
-  bool return_value = false;
-  unsigned short timeout = 10000;
-  if (nu_addr != last_used_bus_addr) {
-    if (open_bus_handle < 0) {
-      // If the bus is either uninitiallized or not idle, decline
-      // to switch the device. Return false;
-      #ifdef MANUVR_DEBUG
-      Kernel::log("i2c bus is not online, so won't switch device. Failing....\n");
-      #endif
-      return return_value;
-    }
-    else {
-      while (adapter->busError() && (timeout > 0)) { timeout--; }
-      if (adapter->busError()) {
-        #ifdef MANUVR_DEBUG
-        Kernel::log("i2c bus was held for too long. Failing....\n");
-        #endif
-        return return_value;
-      }
+static int _rdwr_scratch_len(I2CBusOp* op) {
+  return ((BusOpcode::TX == op->get_opcode()) && (op->sub_addr >= 0)) ? (op->buf_len + 1) : 0;
+}
 
-      if (ioctl(open_bus_handle, I2C_SLAVE, nu_addr) >= 0) {
-        last_used_bus_addr = nu_addr;
-        return_value = true;
+
+/*
+* Describes one op as I2C_RDWR messages.
+*
+* @param  op       The op.
+* @param  msgs     Room for at least two messages.
+* @param  scratch  Room for _rdwr_scratch_len(op) + 1 bytes.
+* @return How many messages were written, or 0 if the op can't be expressed.
+*/
+static int _op_to_msgs(I2CBusOp* op, struct i2c_msg* msgs, uint8_t* scratch) {
+  *scratch = (uint8_t) (op->sub_addr & 0x00FF);
+  switch (op->get_opcode()) {
+    case BusOpcode::RX:
+      if (op->sub_addr >= 0) {
+        msgs[0] = { op->dev_addr, 0, 1, scratch };
+        msgs[1] = { op->dev_addr, I2C_M_RD, op->buf_len, op->buf };
+        return 2;
+      }
+      msgs[0] = { op->dev_addr, I2C_M_RD, op->buf_len, op->buf };
+      return 1;
+    case BusOpcode::TX:
+      if (op->sub_addr >= 0) {
+        memcpy(scratch + 1, op->buf, op->buf_len);
+        msgs[0] = { op->dev_addr, 0, (uint16_t) (op->buf_len + 1), scratch };
       }
       else {
-        #ifdef MANUVR_DEBUG
-        StringBuilder local_log;
-        local_log.concatf("Failed to acquire bus access and/or talk to slave at %d.\n", nu_addr);
-        Kernel::log(&local_log);
-        #endif
-        adapter->busError(true);
+        msgs[0] = { op->dev_addr, 0, op->buf_len, op->buf };
       }
-    }
+      return 1;
+    case BusOpcode::TX_CMD:
+      // Without a subaddress, this is a zero-length write. Which is a ping.
+      msgs[0] = { op->dev_addr, 0, (uint16_t) ((op->sub_addr >= 0) ? 1 : 0), scratch };
+      return 1;
+    default:
+      break;
   }
-  else {
-    return_value = true;
+  return 0;
+}
+
+
+static bool _rdwr_expressible(I2CBusOp* op) {
+  switch (op->get_opcode()) {
+    case BusOpcode::RX:
+    case BusOpcode::TX:
+    case BusOpcode::TX_CMD:
+      return true;
+    default:
+      return false;
   }
-  return return_value;
+}
+
+
+/*
+* Puts the given ops on the bus in a single I2C_RDWR. The kernel stops at the
+*   first message that fails, and doesn't tell us which one it was.
+*
+* @param  ops    The ops, all of which must be expressible.
+* @param  count  How many.
+* @return true if every message went through.
+*/
+static bool _rdwr(I2CBusOp** ops, int count) {
+  struct i2c_msg msgs[I2CADAPTER_MAX_BATCH * 2];
+  int scratch_len = 0;
+  for (int i = 0; i < count; i++) {
+    scratch_len += _rdwr_scratch_len(ops[i]) + 1;
+  }
+  uint8_t scratch[scratch_len];
+  uint8_t* s = scratch;
+  int n = 0;
+  for (int i = 0; i < count; i++) {
+    n += _op_to_msgs(ops[i], &msgs[n], s);
+    s += _rdwr_scratch_len(ops[i]) + 1;
+  }
+  _rdwr_calls++;
+  _rdwr_ops += count;
+  #if defined(MANUVR_BUS_SIM)
+    return (BusSim::i2cTransfer(ops[0]->device->getAdapterId(), msgs, n) == n);
+  #else
+    struct i2c_rdwr_ioctl_data xfer = { msgs, (uint32_t) n };
+    return (ioctl(open_bus_handle, I2C_RDWR, &xfer) == n);
+  #endif
 }
 
 
@@ -94,6 +158,10 @@ bool switch_device(I2CAdapter* adapter, uint8_t nu_addr) {
 *******************************************************************************/
 
 int8_t I2CAdapter::bus_init() {
+  #if defined(MANUVR_BUS_SIM)
+    // There is no device to open. BusSim carries out each op as it begins.
+    busOnline(true);
+  #else
   char *filename = (char *) alloca(24);
   *filename = 0;
   if (sprintf(filename, "/dev/i2c-%d", getAdapterId()) > 0) {
@@ -119,6 +187,7 @@ int8_t I2CAdapter::bus_init() {
     Kernel::log(&local_log);
   }
   #endif
+  #endif  // MANUVR_BUS_SIM
   return (busOnline() ? 0:-1);
 }
 
@@ -136,6 +205,10 @@ int8_t I2CAdapter::bus_deinit() {
 
 void I2CAdapter::printHardwareState(StringBuilder* output) {
   output->concatf("-- I2C%d (%sline)\n", getAdapterId(), (_er_flag(I2C_BUS_FLAG_BUS_ONLINE)?"on":"OFF"));
+  output->concatf("-- I2C_RDWR calls    %u (%u ops)\n", _rdwr_calls, _rdwr_ops);
+  #if defined(MANUVR_BUS_SIM)
+    BusSim::printDebug(output);
+  #endif
 }
 
 
@@ -166,8 +239,13 @@ XferFault I2CBusOp::begin() {
         case 1:
           if ((nullptr == callback) || (0 == callback->io_op_callahead(this))) {
             set_state(XferState::INITIATE);
-            _threaded_op = this;
-            device->wake();
+            device->chain_queued_work(this, I2CADAPTER_MAX_BATCH);
+            #if defined(MANUVR_BUS_SIM)
+              advance_operation(0);
+            #else
+              _threaded_op = this;
+              device->wake();
+            #endif
             return XferFault::NONE;
           }
           else {
@@ -194,68 +272,54 @@ XferFault I2CBusOp::begin() {
 /*
 * Linux doesn't have a concept of interrupt, but we might call this
 *   from an I/O thread.
+* This op, and any chained behind it, go out in one I2C_RDWR. If that fails,
+*   we don't know which op was at fault, nor how many messages went out before
+*   it did. Trying them again might repeat a write, or a read that clears what
+*   it reads. So they all fail together, as on SPI, and each driver decides
+*   whether its op is safe to retry.
+* The head goes on the wire first, and the chain follows it in queue order.
+*   But the head is marked last, since advance_work_queue() finishes the whole
+*   chain as soon as it sees the head complete.
 */
 int8_t I2CBusOp::advance_operation(uint32_t status_reg) {
+  I2CBusOp* batch[I2CADAPTER_MAX_BATCH];
+  int count = 0;
   xfer_state = XferState::ADDR;
-  if (device->generateStart()) {
-    // Failure to generate START condition.
-    abort(XferFault::BUS_BUSY);
-    return -1;
+  bool expressible = _rdwr_expressible(this);
+  if (expressible) {
+    batch[count++] = this;
   }
-
-  if (!switch_device(device, dev_addr)) {
-    abort(XferFault::BUS_FAULT);
-    return -1;
-  }
-
-  if (opcode == BusOpcode::RX) {
-    uint8_t sa = (uint8_t) (sub_addr & 0x00FF);
-
-    if (write(open_bus_handle, &sa, 1) == 1) {
-      if (read(open_bus_handle, buf, buf_len) == buf_len) {
-        markComplete();
+  const int chained = count;   // Where the chain starts in batch[].
+  for (I2CBusOp* op = next_in_batch; op; op = op->next_in_batch) {
+    if (XferState::INITIATE == op->get_state()) {
+      if (_rdwr_expressible(op)) {
+        op->set_state(XferState::ADDR);
+        batch[count++] = op;
       }
       else {
-        abort(XferFault::BUS_FAULT);
-        return -1;
+        // Fails without sinking the rest.
+        op->abort(XferFault::BAD_PARAM);
       }
     }
-    else {
-      abort(XferFault::BUS_FAULT);
-      return -1;
-    }
   }
-  else if (opcode == BusOpcode::TX) {
-    uint8_t buffer[buf_len + 1];
-    buffer[0] = (uint8_t) (sub_addr & 0x00FF);
-
-    for (int i = 0; i < buf_len; i++) buffer[i + 1] = *(buf + i);
 
-    if (write(open_bus_handle, &buffer, buf_len+1) == buf_len+1) {
-      markComplete();
-    }
-    else {
-      abort(XferFault::BUS_FAULT);
-      return -1;
-    }
+  if (device->generateStart()) {
+    // Failure to generate START condition.
+    for (int i = chained; i < count; i++) batch[i]->abort(XferFault::BUS_BUSY);
+    abort(XferFault::BUS_BUSY);
+    return -1;
   }
-  else if (opcode == BusOpcode::TX_CMD) {
-    uint8_t buffer[buf_len + 1];
-    buffer[0] = (uint8_t) (sub_addr & 0x00FF);
-    if (write(open_bus_handle, &buffer, 1) == 1) {
-      markComplete();
-    }
-    else {
-      abort(XferFault::BUS_FAULT);
-      return -1;
-    }
+
+  if ((0 < count) && _rdwr(batch, count)) {
+    for (int i = chained; i < count; i++) batch[i]->markComplete();
+    if (expressible) markComplete();
+    else abort(XferFault::BUS_FAULT);
   }
   else {
+    for (int i = chained; i < count; i++) batch[i]->abort(XferFault::BUS_FAULT);
     abort(XferFault::BUS_FAULT);
-    return -1;
   }
-
-  return 0;
+  return hasFault() ? -1 : 0;
 }
 
 #endif  // MANUVR_SUPPORT_I2C
@@ -22,10 +22,13 @@ This file forms the catch-all for linux platforms that have no support.
 */
 
 #include <sys/time.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 #include <signal.h>
+#include <poll.h>
 
 #include <Platform/Platform.h>
+#include <DataStructures/RingBuffer.h>
 
 #if defined(MANUVR_STORAGE)
 #include "LinuxStorage.h"
@@ -48,6 +51,12 @@ struct sigaction _signal_action_SIGALRM = {0};
 
 static unsigned long _last_millis = 0;
 
+/* The kernel thread blocks on this when idle. Anyone with work for it writes to it. */
+static int _kernel_wake_fd = -1;
+
+/* Even with nothing scheduled, we will wake up this often. Belt and suspenders. */
+#define LINUX_IDLE_MAX_BLOCK_MS  1000
+
 char* _binary_name = nullptr;
 static int   _main_pid    = 0;
 
@@ -123,10 +132,48 @@ void sig_handler(int signo) {
   //}
 }
 
-void linux_timer_handler(int sig_num) {
+/*
+* Credits the scheduler with however much time has passed since the last call.
+* The interval timer counts process time, so it stops while we are blocked in
+*   idle. The idle hook calls this on its way out to make up the difference.
+*/
+static void linux_advance_scheduler() {
   unsigned long _this_millis = millis();
-  ((Kernel*)__kernel)->advanceScheduler(_this_millis - _last_millis);
-  _last_millis = _this_millis;
+  unsigned long _prior = __atomic_exchange_n(&_last_millis, _this_millis, __ATOMIC_RELAXED);
+  ((Kernel*)__kernel)->advanceScheduler(_this_millis - _prior);
+}
+
+void linux_timer_handler(int sig_num) {
+  linux_advance_scheduler();
+}
+
+
+/*
+* Idle hook. Blocks the kernel thread until someone wakes it, or until the
+*   next schedule comes due, whichever is sooner.
+*/
+void linux_idle_block() {
+  int timeout = ((Kernel*)__kernel)->msToNextSchedule();
+  if ((timeout < 0) || (timeout > LINUX_IDLE_MAX_BLOCK_MS)) {
+    timeout = LINUX_IDLE_MAX_BLOCK_MS;
+  }
+  if (timeout > 0) {
+    struct pollfd pfd = {_kernel_wake_fd, POLLIN, 0};
+    if (0 < poll(&pfd, 1, timeout)) {
+      uint64_t wakes;
+      read(_kernel_wake_fd, &wakes, sizeof(wakes));   // Reset the counter. We don't care about its value.
+    }
+  }
+  linux_advance_scheduler();
+}
+
+
+/*
+* Wake hook. Async-signal-safe, since the Kernel calls it from isrRaiseEvent().
+*/
+void linux_wake_kernel() {
+  uint64_t one = 1;
+  write(_kernel_wake_fd, &one, sizeof(one));
 }
 
 
@@ -274,9 +321,9 @@ volatile uint8_t  watchdog_mark      = 42;
 /*******************************************************************************
 * Randomness                                                                   *
 *******************************************************************************/
-volatile uint32_t randomness_pool[PLATFORM_RNG_CARRY_CAPACITY];
-volatile unsigned int _random_pool_r_ptr = 0;
-volatile unsigned int _random_pool_w_ptr = 0;
+// The reader thread is the only producer. Callers of randomInt() consume.
+// Never freed, since the reader thread may outlive static destruction.
+RingBuffer<uint32_t>* randomness_pool = nullptr;
 
 long unsigned int rng_thread_id = 0;
 
@@ -285,29 +332,23 @@ long unsigned int rng_thread_id = 0;
 */
 static void* dev_urandom_reader(void*) {
   FILE* ur_file = fopen("/dev/urandom", "rb");
-  unsigned int rng_level    = 0;
   unsigned int needed_count = 0;
 
   if (ur_file) {
     while (platform.platformState() <= MANUVR_INIT_STATE_NOMINAL) {
-      rng_level = _random_pool_w_ptr - _random_pool_r_ptr;
-      if (rng_level == PLATFORM_RNG_CARRY_CAPACITY) {
+      uint32_t* span = randomness_pool->reserve(&needed_count);
+      if (nullptr == span) {
         // We have filled our entropy pool. Sleep.
         // TODO: Implement wakeThread() and this can go way higher.
         sleep_millis(10);
       }
       else {
         // We continue feeding the entropy pool as demanded until the platform
-        //   leaves its nominal state. Don't write past the wrap-point.
-        unsigned int _w_ptr = _random_pool_w_ptr % PLATFORM_RNG_CARRY_CAPACITY;
-        unsigned int _delta_to_wrap = PLATFORM_RNG_CARRY_CAPACITY - _w_ptr;
-        unsigned int _delta_to_fill = PLATFORM_RNG_CARRY_CAPACITY - rng_level;
-
-        needed_count = ((_delta_to_fill < _delta_to_wrap) ? _delta_to_fill : _delta_to_wrap);
-        size_t ret = fread((void*)&randomness_pool[_w_ptr], sizeof(uint32_t), needed_count, ur_file);
+        //   leaves its nominal state. The span never crosses the wrap-point.
+        size_t ret = fread((void*) span, sizeof(uint32_t), needed_count, ur_file);
         //printf("Read %d uint32's from /dev/urandom.\n", ret);
         if((ret > 0) && !ferror(ur_file)) {
-          _random_pool_w_ptr += ret;
+          randomness_pool->commit(ret);
         }
         else {
           fclose(ur_file);
@@ -336,9 +377,10 @@ static void* dev_urandom_reader(void*) {
 */
 uint32_t randomInt() {
   // Preferably, we'd shunt to a PRNG at this point. For now we block.
-  while (_random_pool_w_ptr <= _random_pool_r_ptr) {
+  uint32_t ret = 0;
+  while (0 != randomness_pool->get(&ret)) {
   }
-  return randomness_pool[_random_pool_r_ptr++ % PLATFORM_RNG_CARRY_CAPACITY];
+  return ret;
 }
 
 
@@ -347,12 +389,15 @@ uint32_t randomInt() {
 */
 void LinuxPlatform::init_rng() {
   srand(time(nullptr));          // Seed the PRNG...
+  if (nullptr == randomness_pool) {
+    randomness_pool = new RingBuffer<uint32_t>(PLATFORM_RNG_CARRY_CAPACITY);
+  }
   if (createThread(&rng_thread_id, nullptr, dev_urandom_reader, nullptr)) {
     printf("Failed to create RNG thread.\n");
     exit(-1);
   }
   int t_out = 30;
-  while ((_random_pool_w_ptr < PLATFORM_RNG_CARRY_CAPACITY) && (t_out > 0)) {
+  while ((randomness_pool->pending() < (int) randomness_pool->capacity()) && (t_out > 0)) {
     sleep_millis(20);
     t_out--;
   }
@@ -631,6 +676,13 @@ int8_t LinuxPlatform::platformPreInit(Argument* root_config) {
   // Used for timer and signal callbacks.
   __kernel = (volatile Kernel*) &_kernel;
 
+  _kernel_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (0 <= _kernel_wake_fd) {
+    // Rather than napping in idle, block until there is something to do.
+    setIdleHook(linux_idle_block);
+    setWakeHook(linux_wake_kernel);
+  }
+
   uint32_t default_flags = DEFAULT_PLATFORM_FLAGS;
   _main_pid = getpid();  // Our PID.
   Argument* temp = nullptr;
@@ -26,7 +26,12 @@ On Linux, we don't deal with chip-select in the same manner as other platforms,
 For instance: On a RasPi v1 with the kernel driver loaded we have...
     /dev/spidev0.0
     /dev/spidev0.1
-  ...for CS0 and CS1.
+  ...for CS0 and CS1. So an op's CS pin is taken to be the spidev chip-select.
+
+Ops are handed to spidev as an array of spi_ioc_transfer in a single
+  SPI_IOC_MESSAGE ioctl. Queued ops for the same device that are next in line
+  ride along with the one that is beginning, and chip-select is dropped between
+  them, so each looks to the device as it would have alone.
 */
 
 #include <Platform/Peripherals/SPI/SPIAdapter.h>
@@ -35,12 +40,30 @@ For instance: On a RasPi v1 with the kernel driver loaded we have...
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <getopt.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <linux/types.h>
 #include <linux/spi/spidev.h>
 
+#if defined(MANUVR_BUS_SIM)
+  #include <Platform/Targets/Linux/BusSim.h>
+#endif
+
+/* These count how well batching is working. */
+static uint32_t _spidev_calls = 0;   // How many SPI_IOC_MESSAGE ioctls have we made?
+static uint32_t _spidev_ops   = 0;   // How many ops did they carry?
+
+
+/*
+* An op that never chose a chip-select gets the first one.
+*/
+static inline uint8_t _spidev_cs(uint8_t cs_pin) {
+  return (255 == cs_pin) ? 0 : cs_pin;
+}
+
+
 /*******************************************************************************
 * ######## ##     ## ######## ##    ## ########  ######
 * ##       ##     ## ##       ###   ##    ##    ##    ##
@@ -56,63 +79,139 @@ For instance: On a RasPi v1 with the kernel driver loaded we have...
 /**
 * This is called when the kernel attaches the module.
 * This is the first time the class can be expected to have kernel access.
+* Opens whichever chip-selects the kernel gives us on this bus. Mode and clock
+*   are left as the kernel has them.
 *
 * @return 0 on no action, 1 on action, -1 on failure.
 */
 int8_t SPIAdapter::attached() {
   if (EventReceiver::attached()) {
-    // We should init the SPI library...
-    //SPI.begin();
-    //SPI.setDataMode(SPI_MODE0);
-    //SPI.setClockDivider(SPI_CLOCK_DIV32);
+    #if defined(MANUVR_BUS_SIM)
+      // There is no device to open. BusSim carries out each op as it begins.
+      _er_set_flag(SPI_FLAG_SPI_READY);
+    #else
+    char filename[24];
+    for (int i = 0; i < SPIADAPTER_LINUX_MAX_CS; i++) {
+      if (_spidev_fds[i] >= 0) continue;
+      if (sprintf(filename, "/dev/spidev%u.%d", getAdapterId(), i) > 0) {
+        _spidev_fds[i] = open(filename, O_RDWR);
+        if (_spidev_fds[i] >= 0) {
+          _er_set_flag(SPI_FLAG_SPI_READY);
+        }
+      }
+    }
+    #if defined(MANUVR_DEBUG)
+    if (!_er_flag(SPI_FLAG_SPI_READY) && (getVerbosity() > 2)) {
+      local_log.concatf("Failed to open any spidev on bus %u.\n", getAdapterId());
+      Kernel::log(&local_log);
+    }
+    #endif
+    #endif  // MANUVR_BUS_SIM
     return 1;
   }
   return 0;
 }
 
 
+#if defined(MANUVR_CONSOLE_SUPPORT)
+void SPIAdapter::printHardwareState(StringBuilder* output) {
+  output->concatf("-- SPI%u (%sline)\n", getAdapterId(), (_er_flag(SPI_FLAG_SPI_READY)?"on":"OFF"));
+  output->concatf("-- SPI_IOC_MESSAGE calls %u (%u ops)\n", _spidev_calls, _spidev_ops);
+  #if defined(MANUVR_BUS_SIM)
+    BusSim::printDebug(output);
+  #endif
+}
+#endif  // MANUVR_CONSOLE_SUPPORT
+
+
+
+/*******************************************************************************
+* ___     _                              These members are mandatory overrides
+*  |   / / \ o     |  _  |_              from the BusOp class.
+* _|_ /  \_/ o   \_| (_) |_)
+*******************************************************************************/
+
 /**
 * Calling this member will cause the bus operation to be started.
+* This op, and any chained behind it, go out in one SPI_IOC_MESSAGE. Each op
+*   is its params (if any) and then its buffer (if any). A failed ioctl tells
+*   us nothing about which op was at fault, so they all fail together.
+* The head is marked last, since advance_work_queue() finishes the whole chain
+*   as soon as it sees the head complete.
+*
+* NOTE: The linux SPI driver abstracts chip-select pins away from us, so we
+*   don't assert them here. The kernel drops chip-select between ops on our
+*   instruction.
 *
-* @return 0 on success, or non-zero on failure.
+* @return XferFault::NONE on success, or the reason for failure.
 */
 XferFault SPIBusOp::begin() {
-  //time_began    = micros();
-  //if (0 == _param_len) {
-  //  // Obvious invalidity. We must have at least one transfer parameter.
-  //  abort(XferFault::BAD_PARAM);
-  //  return XferFault::BAD_PARAM;
-  //}
-
-  //if (SPI1->SR & SPI_FLAG_BSY) {
-  //  Kernel::log("SPI op aborted before taking bus control.\n");
-  //  abort(XferFault::BUS_BUSY);
-  //  return XferFault::BUS_BUSY;
-  //}
+  if (nullptr == adapter) {
+    abort(XferFault::DEV_NOT_FOUND);
+    return xfer_fault;
+  }
+  const uint8_t cs = _spidev_cs(_cs_pin);
+  #if !defined(MANUVR_BUS_SIM)
+    if (0 > adapter->spidev(cs)) {
+      abort(XferFault::BAD_PARAM);
+      return xfer_fault;
+    }
+  #endif
 
   set_state(XferState::INITIATE);  // Indicate that we now have bus control.
-
-  // NOTE: The linux SPI driver abstracts chip-select pins away from us. If the
-  //  CS pin number is set to 255, this fxn call loses its hardware implications
-  //  and degrades into a state-tracking marker.
-  _assert_cs(true);
-
-  if (_param_len) {
-    set_state(XferState::ADDR);
-    for (int i = 0; i < _param_len; i++) {
-      SPI.transfer(xfer_params[i]);
+  adapter->chain_queued_work(this, SPIADAPTER_MAX_BATCH);
+
+  SPIBusOp* batch[SPIADAPTER_MAX_BATCH];
+  struct spi_ioc_transfer xfers[SPIADAPTER_MAX_BATCH * 2];
+  memset(xfers, 0, sizeof(xfers));
+  int count = 0;
+  int n     = 0;
+  for (SPIBusOp* op = this; op; op = op->next_in_batch) {
+    batch[count++] = op;
+    if (op->_param_len) {
+      op->set_state(XferState::ADDR);
+      xfers[n].tx_buf = (uintptr_t) op->xfer_params;
+      xfers[n].len    = op->_param_len;
+      n++;
+    }
+    if (op->buf_len) {
+      if (BusOpcode::TX == op->opcode) {
+        op->set_state(XferState::TX_WAIT);
+        xfers[n].tx_buf = (uintptr_t) op->buf;
+      }
+      else {
+        op->set_state(XferState::RX_WAIT);
+        xfers[n].rx_buf = (uintptr_t) op->buf;
+      }
+      xfers[n].len = op->buf_len;
+      n++;
+    }
+    if (n > 0) {
+      // Release chip-select between ops, but not after the last one.
+      xfers[n - 1].cs_change = (nullptr != op->next_in_batch) ? 1 : 0;
     }
   }
 
-  if (buf_len) {
-    set_state((opcode == BusOpcode::TX) ? XferState::TX_WAIT : XferState::RX_WAIT);
-    for (int i = 0; i < buf_len; i++) {
-      SPI.transfer(*(buf + i));
-    }
+  int ret = 0;
+  if (n > 0) {
+    _spidev_calls++;
+    _spidev_ops += count;
+    #if defined(MANUVR_BUS_SIM)
+      ret = BusSim::spiTransfer(adapter->getAdapterId(), cs, xfers, n);
+    #else
+      ret = ioctl(adapter->spidev(cs), SPI_IOC_MESSAGE(n), xfers);
+    #endif
   }
 
-  markComplete();
-  return XferFault::NONE;
+  for (int i = count - 1; i >= 0; i--) {
+    if (ret < 0) {
+      batch[i]->abort(XferFault::BUS_FAULT);
+    }
+    else {
+      batch[i]->markComplete();
+    }
+  }
+  return xfer_fault;
 }
 
 
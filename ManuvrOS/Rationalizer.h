@@ -67,6 +67,16 @@
   #define EVENT_MANAGER_PREALLOC_COUNT 8
 #endif
 
+// How many Arguments should the Kernel keep in its slab? Zero means always use the heap.
+#ifndef ARGUMENT_POOL_SIZE
+  #define ARGUMENT_POOL_SIZE (EVENT_MANAGER_PREALLOC_COUNT * 4)
+#endif
+
+// How many bytes of value can an Argument from the slab hold without a malloc()?
+#ifndef ARGUMENT_POOL_INLINE_BYTES
+  #define ARGUMENT_POOL_INLINE_BYTES 16
+#endif
+
 #ifndef MAXIMUM_SEQUENTIAL_SKIPS
   #define MAXIMUM_SEQUENTIAL_SKIPS 20
 #endif
@@ -0,0 +1,230 @@
+/*
+File:   Tracer.cpp
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+
+#include <Tracer.h>
+#include <Platform/Platform.h>
+
+#if defined(__MANUVR_LINUX)
+  #include <unistd.h>
+  #include <fcntl.h>
+#endif
+
+
+/* One thread's records. */
+typedef struct {
+  unsigned long thread;     // The thread that writes here.
+  uint32_t      head;       // How many records have ever been written.
+  bool          orphaned;   // The thread is gone. Another may take the ring over.
+  TraceRecord   records[MANUVR_TRACE_DEPTH];
+} TraceRing;
+
+static TraceRing* _rings[MANUVR_TRACE_THREADS] = {nullptr};
+
+bool     Tracer::_enabled = false;
+uint32_t Tracer::_dropped = 0;
+
+
+#if defined(__BUILD_HAS_PTHREADS)
+  static pthread_key_t  _ring_key;
+  static pthread_once_t _ring_key_once = PTHREAD_ONCE_INIT;
+
+  /* Called as a thread exits. Its records stay until a new thread needs the ring. */
+  static void _ring_orphan(void* ring) {
+    __atomic_store_n(&((TraceRing*) ring)->orphaned, true, __ATOMIC_RELEASE);
+  }
+
+  static void _ring_key_init() {
+    pthread_key_create(&_ring_key, _ring_orphan);
+  }
+#endif
+
+
+/**
+* Finds the calling thread's ring, claiming one if this is its first record.
+*
+* @return The ring, or nullptr if every ring belongs to a living thread.
+*/
+static TraceRing* _my_ring() {
+  #if defined(__BUILD_HAS_PTHREADS)
+    pthread_once(&_ring_key_once, _ring_key_init);
+    TraceRing* ring = (TraceRing*) pthread_getspecific(_ring_key);
+    if (nullptr != ring) return ring;
+
+    // A free slot is best. Failing that, a ring whose thread has exited.
+    for (int i = 0; i < MANUVR_TRACE_THREADS; i++) {
+      if (nullptr == __atomic_load_n(&_rings[i], __ATOMIC_ACQUIRE)) {
+        TraceRing* nu = new TraceRing();
+        TraceRing* expected = nullptr;
+        nu->thread = currentThreadId();
+        if (__atomic_compare_exchange_n(&_rings[i], &expected, nu, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+          pthread_setspecific(_ring_key, nu);
+          return nu;
+        }
+        delete nu;   // Someone beat us to it.
+      }
+    }
+    for (int i = 0; i < MANUVR_TRACE_THREADS; i++) {
+      ring = __atomic_load_n(&_rings[i], __ATOMIC_ACQUIRE);
+      bool orphaned = true;
+      if (__atomic_compare_exchange_n(&ring->orphaned, &orphaned, false, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        ring->thread = currentThreadId();
+        __atomic_store_n(&ring->head, 0, __ATOMIC_RELEASE);   // The old thread's records would confuse us.
+        pthread_setspecific(_ring_key, ring);
+        return ring;
+      }
+    }
+    return nullptr;
+  #else
+    if (nullptr == _rings[0]) {
+      _rings[0] = new TraceRing();
+      _rings[0]->thread = currentThreadId();
+    }
+    return _rings[0];
+  #endif
+}
+
+
+/**
+* Records a span boundary, or an instant. Does nothing unless tracing is
+*   enabled. Never locks.
+*
+* @param  phase  Begin, end, or instant.
+* @param  cat    What sort of thing happened.
+* @param  code   The Msg code, if any.
+* @param  label  A name for the thing. Must outlive the trace.
+* @param  depth  The depth of the relevant queue, if any.
+*/
+void Tracer::record(TracePhase phase, TraceCat cat, uint16_t code, const char* label, uint16_t depth) {
+  if (!__atomic_load_n(&_enabled, __ATOMIC_RELAXED)) return;
+  TraceRing* ring = _my_ring();
+  if (nullptr == ring) {
+    __atomic_add_fetch(&_dropped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  uint32_t head = ring->head;
+  TraceRecord* r = &ring->records[head & (MANUVR_TRACE_DEPTH - 1)];
+  r->ts    = micros();
+  r->label = label;
+  r->code  = code;
+  r->depth = depth;
+  r->cat   = cat;
+  r->phase = phase;
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+* @param  en  Start or stop recording. Existing records are kept either way.
+*/
+void Tracer::enabled(bool en) {
+  __atomic_store_n(&_enabled, en, __ATOMIC_RELEASE);
+}
+
+
+void Tracer::clear() {
+  for (int i = 0; i < MANUVR_TRACE_THREADS; i++) {
+    TraceRing* ring = __atomic_load_n(&_rings[i], __ATOMIC_ACQUIRE);
+    if (nullptr != ring) __atomic_store_n(&ring->head, 0, __ATOMIC_RELEASE);
+  }
+  _dropped = 0;
+}
+
+
+const char* Tracer::catString(TraceCat cat) {
+  switch (cat) {
+    case TraceCat::MSG:       return "msg";
+    case TraceCat::NOTIFY:    return "notify";
+    case TraceCat::SCHEDULE:  return "schedule";
+    case TraceCat::PIPE:      return "pipe";
+    case TraceCat::BUS:       return "bus";
+  }
+  return "?";
+}
+
+
+/**
+* Writes every record we have as Chrome trace-event JSON. Recording is paused
+*   while we do it, so that we aren't chasing our own tail.
+*
+* @param  out  The buffer to write into.
+* @return The number of records exported.
+*/
+int Tracer::exportJSON(StringBuilder* out) {
+  bool was_enabled = enabled();
+  enabled(false);
+  int count = 0;
+  const char* sep = "";
+  out->concat("{\"traceEvents\":[");
+  for (int i = 0; i < MANUVR_TRACE_THREADS; i++) {
+    TraceRing* ring = __atomic_load_n(&_rings[i], __ATOMIC_ACQUIRE);
+    if (nullptr == ring) continue;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t n    = (head > MANUVR_TRACE_DEPTH) ? MANUVR_TRACE_DEPTH : head;
+    out->concatf("%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Thread %lu\"}}", sep, i + 1, ring->thread);
+    sep = ",";
+    for (uint32_t x = head - n; x != head; x++) {
+      TraceRecord* r = &ring->records[x & (MANUVR_TRACE_DEPTH - 1)];
+      if (TracePhase::END == r->phase) {
+        out->concatf(",\n{\"ph\":\"E\",\"ts\":%u,\"pid\":1,\"tid\":%d}", (unsigned int) r->ts, i + 1);
+      }
+      else {
+        out->concatf(",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",%s\"ts\":%u,\"pid\":1,\"tid\":%d,\"args\":{\"code\":%u,\"depth\":%u}}",
+          (nullptr == r->label) ? "?" : r->label,
+          catString(r->cat),
+          (char) r->phase,
+          (TracePhase::INSTANT == r->phase) ? "\"s\":\"t\"," : "",
+          (unsigned int) r->ts,
+          i + 1,
+          (unsigned int) r->code,
+          (unsigned int) r->depth
+        );
+      }
+      count++;
+    }
+  }
+  out->concat("\n],\"displayTimeUnit\":\"ms\"}\n");
+  enabled(was_enabled);
+  return count;
+}
+
+
+/**
+* Writes the trace to a file, clobbering whatever was there.
+*
+* @param  path  Where to write.
+* @return The number of records exported, or -1 on failure.
+*/
+int Tracer::exportJSON(const char* path) {
+  #if defined(__MANUVR_LINUX)
+    if (nullptr == path) return -1;
+    StringBuilder json;
+    int count = exportJSON(&json);
+    int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) return -1;
+    int len = json.length();
+    int written = write(fd, json.string(), len);
+    close(fd);
+    return (written == len) ? count : -1;
+  #else
+    return -1;
+  #endif
+}
@@ -0,0 +1,136 @@
+/*
+File:   Tracer.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+A flight recorder for the Kernel. When MANUVR_TRACE is defined, the Kernel
+  (and the bus adapters, and the worker pool) leave spans and instants in a
+  ring of fixed-size binary records, which can later be exported as Chrome
+  trace-event JSON. Load that into chrome://tracing or Perfetto to see how
+  Msgs, schedules, pipe callbacks, and bus work interleaved.
+
+Each thread writes only to its own ring, so recording never locks, and never
+  allocates after a thread's first record. When a ring is full, the oldest
+  records are overwritten. On builds without pthreads, there is only one ring.
+  Nothing should be traced from an ISR.
+
+Labels are stored as pointers, and so must outlive the trace. Msg type
+  strings, receiver names, and pipe names all do.
+
+Without MANUVR_TRACE, the macros at the bottom compile to nothing.
+*/
+
+
+#ifndef __MANUVR_TRACER_H__
+#define __MANUVR_TRACER_H__
+
+#include <inttypes.h>
+
+class StringBuilder;
+
+// How many records does each thread keep? Must be a power of two.
+#ifndef MANUVR_TRACE_DEPTH
+  #define MANUVR_TRACE_DEPTH 1024
+#endif
+#if (MANUVR_TRACE_DEPTH < 2) || (MANUVR_TRACE_DEPTH & (MANUVR_TRACE_DEPTH - 1))
+  #error MANUVR_TRACE_DEPTH must be a power of two, and at least 2.
+#endif
+
+// How many threads can have a ring at once?
+#ifndef MANUVR_TRACE_THREADS
+  #define MANUVR_TRACE_THREADS 8
+#endif
+
+
+/* What was going on? */
+enum class TraceCat : uint8_t {
+  MSG,       // The Kernel dispatching a Msg.
+  NOTIFY,    // A single receiver's notify().
+  SCHEDULE,  // A schedule firing.
+  PIPE,      // A BufferPipe's async callback.
+  BUS        // A bus adapter advancing its work queue.
+};
+
+/* The values are Chrome's phase codes. */
+enum class TracePhase : uint8_t {
+  BEGIN   = 'B',
+  END     = 'E',
+  INSTANT = 'i'
+};
+
+
+typedef struct {
+  uint32_t    ts;      // micros()
+  const char* label;   // Not owned. See the note above.
+  uint16_t    code;    // The Msg code, if there was one.
+  uint16_t    depth;   // The depth of whatever queue was being worked.
+  TraceCat    cat;
+  TracePhase  phase;
+} TraceRecord;
+
+
+class Tracer {
+  public:
+    static void record(TracePhase, TraceCat, uint16_t code, const char* label, uint16_t depth);
+    static void enabled(bool);
+    static void clear();     // Forgets every record. Only while nobody is recording.
+
+    static int  exportJSON(StringBuilder*);   // Returns how many records were exported.
+    static int  exportJSON(const char* path); // Linux only. -1 on failure.
+
+    static inline bool     enabled() {   return _enabled;   };
+    static inline uint32_t dropped() {   return _dropped;   };
+
+    static const char* catString(TraceCat);
+
+
+  private:
+    static bool     _enabled;
+    static uint32_t _dropped;   // Records lost because every ring was taken.
+};
+
+
+/*
+* Records a span for as long as it is in scope, so that early returns still
+*   close it.
+*/
+class TraceSpan {
+  public:
+    TraceSpan(TraceCat cat, uint16_t code, const char* label, uint16_t depth) : _cat(cat), _code(code), _label(label) {
+      Tracer::record(TracePhase::BEGIN, cat, code, label, depth);
+    };
+    ~TraceSpan() {
+      Tracer::record(TracePhase::END, _cat, _code, _label, 0);
+    };
+
+  private:
+    TraceCat    _cat;
+    uint16_t    _code;
+    const char* _label;
+};
+
+
+#if defined(MANUVR_TRACE)
+  #define MANUVR_TRACE_SPAN(cat, code, label, depth)     TraceSpan _trace_span(cat, code, label, depth)
+  #define MANUVR_TRACE_INSTANT(cat, code, label, depth)  Tracer::record(TracePhase::INSTANT, cat, code, label, depth)
+#else
+  #define MANUVR_TRACE_SPAN(cat, code, label, depth)
+  #define MANUVR_TRACE_INSTANT(cat, code, label, depth)
+#endif  // MANUVR_TRACE
+
+#endif  // __MANUVR_TRACER_H__
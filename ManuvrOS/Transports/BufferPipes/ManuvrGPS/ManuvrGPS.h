@@ -26,218 +26,78 @@ This class in unidirectional in the sense that it only reads from the
   whatever reason can extend this class into something with a non-trivial
   fromCounterparty() method.
 
-This class was an adaption to Manuvr based on Kosma Moczek's minmea.
-https://github.com/cloudyourcar/minmea
-*/
+Parsing is done by NMEAParser, a byte at a time, as the bytes arrive. Nothing
+  is accumulated here. Each record the parser reports is latched, and a
+  preformed message is raised to say so. So if the Kernel falls behind a fast
+  receiver, it sees the latest of each, rather than a backlog.
 
-/*
-* Copyright © 2014 Kosma Moczek <kosma@cloudyourcar.com>
-* This program is free software. It comes without any warranty, to the extent
-* permitted by applicable law. You can redistribute it and/or modify it under
-* the terms of the Do What The Fuck You Want To Public License, Version 2, as
-* published by Sam Hocevar. See the COPYING file for more details.
+Transports usually feed us from their own read threads, so the records are
+  handed across in a GPSLatch, and subscribers take copies of them with fix(),
+  velocity(), and satellites(). Those may be called from any thread.
+
+This class was originally an adaption to Manuvr of Kosma Moczek's minmea.
+https://github.com/cloudyourcar/minmea
 */
 
 
 #ifndef __MANUVR_BASIC_GPS_H__
 #define __MANUVR_BASIC_GPS_H__
 
-#define MINMEA_MAX_LENGTH 80
-
-
 #include <DataStructures/BufferPipe.h>
 #include <Kernel.h>
+#include "NMEAParser.h"
+#include <string.h>
 
+/*
+* Each carries one BUFFERPIPE argument: the ManuvrGPS whose record changed.
+*/
+#define MANUVR_MSG_GPS_LOCATION    0x2039   // A GPSFix.
+#define MANUVR_MSG_GPS_VELOCITY    0x203A   // A GPSVelocity.
+#define MANUVR_MSG_GPS_SATELLITES  0x203B   // A GPSSatellites.
 
-#include <stdio.h>
-#include <stdint.h>
-#include <stdbool.h>
-#include <errno.h>
-#include <time.h>
-#include <math.h>
-
-
-
-/*******************************************************************************
-* Undigested GPS types. Gradually morph these into Manuvr.                     *
-*******************************************************************************/
-
-enum minmea_sentence_id {
-    MINMEA_INVALID = -1,
-    MINMEA_UNKNOWN = 0,
-    MINMEA_SENTENCE_RMC,
-    MINMEA_SENTENCE_GGA,
-    MINMEA_SENTENCE_GSA,
-    MINMEA_SENTENCE_GLL,
-    MINMEA_SENTENCE_GST,
-    MINMEA_SENTENCE_GSV,
-    MINMEA_SENTENCE_VTG,
-};
-
-struct minmea_float {
-    int_least32_t value;
-    int_least32_t scale;
-};
-
-struct minmea_date {
-    int day;
-    int month;
-    int year;
-};
-
-struct minmea_time {
-    int hours;
-    int minutes;
-    int seconds;
-    int microseconds;
-};
-
-struct minmea_sentence_rmc {
-    struct minmea_time time;
-    bool valid;
-    struct minmea_float latitude;
-    struct minmea_float longitude;
-    struct minmea_float speed;
-    struct minmea_float course;
-    struct minmea_date date;
-    struct minmea_float variation;
-};
-
-struct minmea_sentence_gga {
-    struct minmea_time time;
-    struct minmea_float latitude;
-    struct minmea_float longitude;
-    int fix_quality;
-    int satellites_tracked;
-    struct minmea_float hdop;
-    struct minmea_float altitude; char altitude_units;
-    struct minmea_float height; char height_units;
-    int dgps_age;
-};
-
-enum minmea_gll_status {
-    MINMEA_GLL_STATUS_DATA_VALID = 'A',
-    MINMEA_GLL_STATUS_DATA_NOT_VALID = 'V',
-};
-
-// FAA mode added to some fields in NMEA 2.3.
-enum minmea_faa_mode {
-    MINMEA_FAA_MODE_AUTONOMOUS = 'A',
-    MINMEA_FAA_MODE_DIFFERENTIAL = 'D',
-    MINMEA_FAA_MODE_ESTIMATED = 'E',
-    MINMEA_FAA_MODE_MANUAL = 'M',
-    MINMEA_FAA_MODE_SIMULATED = 'S',
-    MINMEA_FAA_MODE_NOT_VALID = 'N',
-    MINMEA_FAA_MODE_PRECISE = 'P',
-};
-
-struct minmea_sentence_gll {
-    struct minmea_float latitude;
-    struct minmea_float longitude;
-    struct minmea_time time;
-    char status;
-    char mode;
-};
-
-struct minmea_sentence_gst {
-    struct minmea_time time;
-    struct minmea_float rms_deviation;
-    struct minmea_float semi_major_deviation;
-    struct minmea_float semi_minor_deviation;
-    struct minmea_float semi_major_orientation;
-    struct minmea_float latitude_error_deviation;
-    struct minmea_float longitude_error_deviation;
-    struct minmea_float altitude_error_deviation;
-};
-
-enum minmea_gsa_mode {
-    MINMEA_GPGSA_MODE_AUTO = 'A',
-    MINMEA_GPGSA_MODE_FORCED = 'M',
-};
-
-enum minmea_gsa_fix_type {
-    MINMEA_GPGSA_FIX_NONE = 1,
-    MINMEA_GPGSA_FIX_2D = 2,
-    MINMEA_GPGSA_FIX_3D = 3,
-};
-
-struct minmea_sentence_gsa {
-    char mode;
-    int fix_type;
-    int sats[12];
-    struct minmea_float pdop;
-    struct minmea_float hdop;
-    struct minmea_float vdop;
-};
 
-struct minmea_sat_info {
-    int nr;
-    int elevation;
-    int azimuth;
-    int snr;
-};
+/*
+* The latest of some record, passed from the one thread that writes it, to any
+*   that read it. There are two slots. Writes go to the one that isn't current,
+*   and then bumping the sequence count makes it current. A reader that sees
+*   the count move while it copies tries again, since the next write might have
+*   been to the slot it was reading.
+*/
+template <class T> class GPSLatch {
+  public:
+    GPSLatch() {  memset(_slots, 0, sizeof(_slots));  };
+
+    inline void store(const T* rec) {
+      uint32_t s = __atomic_load_n(&_seq, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_RELEASE);   // Readers must see s before these writes.
+      memcpy(&_slots[(s + 1) & 1], rec, sizeof(T));
+      __atomic_store_n(&_seq, s + 1, __ATOMIC_RELEASE);
+    };
+
+    /* Returns how many records have been stored. Zero means out is all zeros. */
+    inline uint32_t load(T* out) {
+      uint32_t s;
+      do {
+        s = __atomic_load_n(&_seq, __ATOMIC_ACQUIRE);
+        memcpy(out, &_slots[s & 1], sizeof(T));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      } while (s != __atomic_load_n(&_seq, __ATOMIC_RELAXED));
+      return s;
+    };
 
-struct minmea_sentence_gsv {
-    int total_msgs;
-    int msg_nr;
-    int total_sats;
-    struct minmea_sat_info sats[4];
-};
 
-struct minmea_sentence_vtg {
-    struct minmea_float true_track_degrees;
-    struct minmea_float magnetic_track_degrees;
-    struct minmea_float speed_knots;
-    struct minmea_float speed_kph;
-    enum minmea_faa_mode faa_mode;
+  private:
+    T        _slots[2];
+    uint32_t _seq = 0;
 };
 
-/**
- * Rescale a fixed-point value to a different scale. Rounds towards zero.
- */
-static inline int_least32_t minmea_rescale(struct minmea_float *f, int_least32_t new_scale)
-{
-    if (f->scale == 0)
-        return 0;
-    if (f->scale == new_scale)
-        return f->value;
-    if (f->scale > new_scale)
-        return (f->value + ((f->value > 0) - (f->value < 0)) * f->scale/new_scale/2) / (f->scale/new_scale);
-    else
-        return f->value * (new_scale/f->scale);
-}
-
-/**
- * Convert a fixed-point value to a floating-point value.
- * Returns NaN for "unknown" values.
- */
-static inline float minmea_tofloat(struct minmea_float *f)
-{
-    if (f->scale == 0)
-        return NAN;
-    return (float) f->value / (float) f->scale;
-}
-
-/**
- * Convert a raw coordinate to a floating point DD.DDD... value.
- * Returns NaN for "unknown" values.
- */
-static inline float minmea_tocoord(struct minmea_float *f)
-{
-    if (f->scale == 0)
-        return NAN;
-    int_least32_t degrees = f->value / (f->scale * 100);
-    int_least32_t minutes = f->value % (f->scale * 100);
-    return (float) degrees + (float) minutes / (60 * f->scale);
-}
-
 
 /*
 * A BufferPipe that is specialized for parsing NMEA.
 * After enough successful parsing, this class will emit messages into the
 *   Kernel's general message queue containing framed high-level GPS data.
 */
-class ManuvrGPS : public BufferPipe {
+class ManuvrGPS : public BufferPipe, public NMEAListener {
   public:
     ManuvrGPS();
     ManuvrGPS(BufferPipe*);
@@ -248,6 +108,18 @@ class ManuvrGPS : public BufferPipe {
     virtual int8_t toCounterparty(StringBuilder* buf, int8_t mm);
     virtual int8_t fromCounterparty(StringBuilder* buf, int8_t mm);
 
+    /* Override from NMEAListener. */
+    void nmeaFix(const GPSFix*);
+    void nmeaVelocity(const GPSVelocity*);
+    void nmeaSatellites(const GPSSatellites*);
+
+    inline NMEAParser* parser() {   return &_nmea;   };
+
+    /* Copy out the latest of each record. Each returns how many have been seen. */
+    inline uint32_t fix(GPSFix* out) {                return _fix.load(out);    };
+    inline uint32_t velocity(GPSVelocity* out) {      return _vel.load(out);    };
+    inline uint32_t satellites(GPSSatellites* out) {  return _sats.load(out);   };
+
     void printDebug(StringBuilder*);
 
 
@@ -256,60 +128,13 @@ class ManuvrGPS : public BufferPipe {
 
 
   private:
-    uint32_t       _sentences_parsed;
-    StringBuilder  _accumulator;
-    ManuvrMsg _gps_frame;
-
-    bool _attempt_parse();
-
-    /**
-    * Calculate raw sentence checksum. Does not check sentence integrity.
-    */
-    uint8_t _checksum(const char *sentence);
-
-    /**
-    * Check sentence validity and checksum. Returns true for valid sentences.
-    */
-    bool _check(const char *sentence, bool strict);
-
-    /**
-    * Determine talker identifier.
-    */
-    bool _talker_id(char talker[3], const char *sentence);
-
-    /**
-    * Determine sentence identifier.
-    */
-    enum minmea_sentence_id _sentence_id(const char *sentence, bool strict);
-
-    /*
-    * Parse a specific type of sentence. Return true on success.
-    */
-    bool _parse_rmc(struct minmea_sentence_rmc *frame, const char *sentence);
-    bool _parse_gga(struct minmea_sentence_gga *frame, const char *sentence);
-    bool _parse_gsa(struct minmea_sentence_gsa *frame, const char *sentence);
-    bool _parse_gll(struct minmea_sentence_gll *frame, const char *sentence);
-    bool _parse_gst(struct minmea_sentence_gst *frame, const char *sentence);
-    bool _parse_gsv(struct minmea_sentence_gsv *frame, const char *sentence);
-    bool _parse_vtg(struct minmea_sentence_vtg *frame, const char *sentence);
-
-    /**
-    * Scanf-like processor for NMEA sentences. Supports the following formats:
-    * c - single character (char *)
-    * d - direction, returned as 1/-1, default 0 (int *)
-    * f - fractional, returned as value + scale (int *, int *)
-    * i - decimal, default zero (int *)
-    * s - string (char *)
-    * t - talker identifier and type (char *)
-    * T - date/time stamp (int *, int *, int *)
-    * Returns true on success. See library source code for details.
-    */
-    bool _scan(const char *sentence, const char *format, ...);
-
-    /**
-    * Convert GPS UTC date/time representation to a UNIX timestamp.
-    */
-    int _gettime(struct timespec *ts, const struct minmea_date *date, const struct minmea_time *time_);
+    NMEAParser              _nmea;
+    GPSLatch<GPSFix>        _fix;
+    GPSLatch<GPSVelocity>   _vel;
+    GPSLatch<GPSSatellites> _sats;
+    ManuvrMsg               _gps_frame;
+    ManuvrMsg               _vel_frame;
+    ManuvrMsg               _sats_frame;
 };
 
 #endif   // __MANUVR_BASIC_GPS_H__
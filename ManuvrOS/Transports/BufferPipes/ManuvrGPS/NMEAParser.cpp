@@ -0,0 +1,525 @@
+/*
+File:   NMEAParser.cpp
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#if defined(MANUVR_GPS_PIPE)
+
+#include "NMEAParser.h"
+#include <DataStructures/StringBuilder.h>
+
+#include <string.h>
+
+// Sentence types are the last three characters of the address, packed.
+#define NMEA_TYPE(a, b, c)  ((((uint32_t) (a)) << 16) | (((uint32_t) (b)) << 8) | ((uint32_t) (c)))
+#define NMEA_TYPE_RMC  NMEA_TYPE('R', 'M', 'C')
+#define NMEA_TYPE_GGA  NMEA_TYPE('G', 'G', 'A')
+#define NMEA_TYPE_VTG  NMEA_TYPE('V', 'T', 'G')
+#define NMEA_TYPE_GSV  NMEA_TYPE('G', 'S', 'V')
+
+// Which fields must be numbers, if present? Bit n is field n.
+#define NMEA_NUMERIC_RMC  0x000003AA   // 1, 3, 5, 7, 8, 9
+#define NMEA_NUMERIC_GGA  0x000003D6   // 1, 2, 4, 6, 7, 8, 9
+#define NMEA_NUMERIC_VTG  0x000000AA   // 1, 3, 5, 7
+
+
+const NMEAField NMEAParser::_empty = {0, -1, 0, 0, '\0', false, false};
+
+static const int64_t _pow10[] = {
+  1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+  100000000LL, 1000000000LL
+};
+
+static inline int8_t _hex(uint8_t c) {
+  if ((c >= '0') && (c <= '9')) return (c - '0');
+  if ((c >= 'A') && (c <= 'F')) return (c - 'A' + 10);
+  if ((c >= 'a') && (c <= 'f')) return (c - 'a' + 10);
+  return -1;
+}
+
+
+/**
+* Constructor.
+*
+* @param  listener  Who to tell about what we parse. May be nullptr.
+*/
+NMEAParser::NMEAParser(NMEAListener* listener) : _listener(listener) {
+  memset(&_fix,  0, sizeof(_fix));
+  memset(&_vel,  0, sizeof(_vel));
+  memset(&_sats, 0, sizeof(_sats));
+  memset(&_gsv,  0, sizeof(_gsv));
+  _gsv_next = 0;
+  reset();
+}
+
+
+void NMEAParser::reset() {
+  _state = NMEAState::IDLE;
+  _len   = 0;
+  _field = 0;
+  _sum   = 0;
+  _type  = 0;
+}
+
+
+/**
+* Takes bytes as they come. A sentence may be split anywhere, across any
+*   number of calls.
+*
+* @param  buf  The bytes.
+* @param  len  How many.
+* @return How many sentences were completed and accepted.
+*/
+int NMEAParser::feed(const uint8_t* buf, int len) {
+  int return_value = 0;
+  for (int i = 0; i < len; i++) {
+    const uint8_t c = buf[i];
+    if ('$' == c) {
+      // Always the start of a sentence. Whatever was in progress is lost.
+      if (NMEAState::IDLE != _state) malformed++;
+      _begin();
+      continue;
+    }
+    if (NMEAState::IDLE == _state) {
+      continue;
+    }
+    if (++_len > NMEA_MAX_LENGTH) {
+      malformed++;
+      _state = NMEAState::IDLE;
+      continue;
+    }
+
+    switch (_state) {
+      case NMEAState::BODY:
+        if (',' == c) {
+          _sum ^= c;
+          _field_end();
+        }
+        else if ('*' == c) {
+          _field_end();
+          _state = NMEAState::CHECK_HI;
+        }
+        else if (('\r' == c) || ('\n' == c)) {
+          // No checksum.
+          _field_end();
+          _state = NMEAState::IDLE;
+          if (strict) {
+            malformed++;
+          }
+          else if (_commit()) {
+            return_value++;
+          }
+        }
+        else if ((c < 0x20) || (c > 0x7E)) {
+          malformed++;
+          _state = NMEAState::IDLE;
+        }
+        else {
+          _sum ^= c;
+          _field_byte(c);
+        }
+        break;
+
+      case NMEAState::CHECK_HI:
+        if (0 > _hex(c)) {
+          malformed++;
+          _state = NMEAState::IDLE;
+        }
+        else {
+          _sum_rx = _hex(c) << 4;
+          _state  = NMEAState::CHECK_LO;
+        }
+        break;
+
+      case NMEAState::CHECK_LO:
+        if (0 > _hex(c)) {
+          malformed++;
+          _state = NMEAState::IDLE;
+        }
+        else {
+          _sum_rx |= _hex(c);
+          _state   = NMEAState::EOL;
+        }
+        break;
+
+      case NMEAState::EOL:
+        _state = NMEAState::IDLE;
+        if (('\r' != c) && ('\n' != c)) {
+          malformed++;
+        }
+        else if (_sum != _sum_rx) {
+          bad_checksum++;
+        }
+        else if (_commit()) {
+          return_value++;
+        }
+        break;
+
+      default:
+        _state = NMEAState::IDLE;
+        break;
+    }
+  }
+  return return_value;
+}
+
+
+void NMEAParser::printDebug(StringBuilder* output) {
+  output->concatf("-- NMEA: %u sentences (%u unhandled), %u bad checksums, %u malformed\n", sentences, unhandled, bad_checksum, malformed);
+  output->concatf("--   Fix (%s%s)   %d, %d  alt %dmm  q %u  sats %u  hdop %u\n",
+    _fix.talker, (_fix.valid ? "" : ", invalid"),
+    _fix.latitude, _fix.longitude, _fix.altitude, _fix.quality, _fix.satellites, _fix.hdop
+  );
+  output->concatf("--   Velocity      %umm/s  course %u\n", _vel.speed, _vel.course);
+  output->concatf("--   Satellites    %u of %u (%s)\n", _sats.count, _sats.in_view, _sats.talker);
+}
+
+
+/*******************************************************************************
+* Byte-level                                                                   *
+*******************************************************************************/
+
+void NMEAParser::_begin() {
+  _state = NMEAState::BODY;
+  _len   = 1;
+  _field = 0;
+  _sum   = 0;
+  _type  = 0;
+  memset(_addr, 0, sizeof(_addr));
+  _fields[0] = _empty;
+}
+
+
+void NMEAParser::_field_byte(uint8_t c) {
+  if (0 == _field) {
+    // The address.
+    if (_fields[0].len < 5) _addr[_fields[0].len] = c;
+    if (_fields[0].len < 255) _fields[0].len++;
+    return;
+  }
+  if ((0 == _type) || (_field >= NMEA_MAX_FIELDS)) {
+    // Nobody will look at this field.
+    return;
+  }
+  NMEAField* f = &_fields[_field];
+  if (0 == f->len) {
+    f->c      = c;
+    f->number = true;
+  }
+  if (f->len < 255) f->len++;
+
+  if ((c >= '0') && (c <= '9')) {
+    if ((0 == f->digits) && ('0' == c) && (0 > f->frac)) {
+      // Leading zeros cost nothing.
+    }
+    else if (f->digits < 9) {
+      f->value = (f->value * 10) + (c - '0');
+      f->digits++;
+      if (0 <= f->frac) f->frac++;
+    }
+    else if (0 > f->frac) {
+      f->number = false;   // Too big to be any field we decode.
+    }
+    // Otherwise, it's precision we can't hold. Truncate.
+  }
+  else if (('.' == c) && (0 > f->frac)) {
+    f->frac = 0;
+  }
+  else if (('-' == c) && (1 == f->len)) {
+    f->neg = true;
+  }
+  else {
+    f->number = false;
+  }
+}
+
+
+void NMEAParser::_field_end() {
+  if (0 == _field) {
+    _type = 0;
+    if (5 == _fields[0].len) {
+      switch (NMEA_TYPE(_addr[2], _addr[3], _addr[4])) {
+        case NMEA_TYPE_RMC:
+        case NMEA_TYPE_GGA:
+        case NMEA_TYPE_VTG:
+        case NMEA_TYPE_GSV:
+          _type = NMEA_TYPE(_addr[2], _addr[3], _addr[4]);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  if (_field < 255) _field++;
+  if (_field < NMEA_MAX_FIELDS) {
+    _fields[_field] = _empty;
+  }
+}
+
+
+
+/*******************************************************************************
+* Sentence-level                                                               *
+*******************************************************************************/
+
+/*
+* The sentence checked out. Turn its fields into records.
+*
+* @return true if the sentence was accepted.
+*/
+bool NMEAParser::_commit() {
+  bool return_value = true;
+  switch (_type) {
+    case NMEA_TYPE_RMC:   return_value = _rmc();          break;
+    case NMEA_TYPE_GGA:   return_value = _gga();          break;
+    case NMEA_TYPE_VTG:   return_value = _vtg();          break;
+    case NMEA_TYPE_GSV:   return_value = _gsv_collect();  break;
+    default:
+      unhandled++;
+      break;
+  }
+  if (return_value) {
+    sentences++;
+  }
+  else {
+    malformed++;
+  }
+  return return_value;
+}
+
+
+/*
+* @param  mask  Bit n is set if field n must be a number, when it isn't empty.
+* @return true if every field in the mask checks out.
+*/
+bool NMEAParser::_numeric(uint32_t mask) {
+  for (uint8_t i = 1; (i < _field) && (i < NMEA_MAX_FIELDS) && (i < 32); i++) {
+    if ((mask & (1 << i)) && (0 < _fields[i].len) && !_fields[i].number) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/*
+* $xxRMC,hhmmss.ss,A,ddmm.mm,N,dddmm.mm,W,knots,course,ddmmyy,var,E[,mode]
+*/
+bool NMEAParser::_rmc() {
+  if ((_field < 10) || !_numeric(NMEA_NUMERIC_RMC)) {
+    return false;
+  }
+  _fix.talker[0] = _addr[0];
+  _fix.talker[1] = _addr[1];
+  _fix.valid     = ('A' == _at(2)->c);
+  if (0 < _at(1)->len) {
+    _fix.time = _time(_at(1));
+  }
+  if ((0 < _at(3)->len) && (0 < _at(5)->len)) {
+    _fix.latitude  = _coord(_at(3), _at(4));
+    _fix.longitude = _coord(_at(5), _at(6));
+  }
+  if (6 == _at(9)->len) {
+    int32_t d  = _at(9)->value;
+    int32_t yy = d % 100;
+    _fix.day   = d / 10000;
+    _fix.month = (d / 100) % 100;
+    _fix.year  = yy + ((yy < 80) ? 2000 : 1900);
+  }
+
+  _vel.talker[0] = _addr[0];
+  _vel.talker[1] = _addr[1];
+  _vel.valid     = _fix.valid;
+  _vel.speed     = (uint32_t) (((int64_t) _fixed(_at(7), 3) * 514444) / 1000000);
+  _vel.course    = (uint16_t) _fixed(_at(8), 2);
+
+  if (nullptr != _listener) {
+    _listener->nmeaFix(&_fix);
+    _listener->nmeaVelocity(&_vel);
+  }
+  return true;
+}
+
+
+/*
+* $xxGGA,hhmmss.ss,ddmm.mm,N,dddmm.mm,W,quality,sats,hdop,alt,M,sep,M,age,station
+*/
+bool NMEAParser::_gga() {
+  if ((_field < 10) || !_numeric(NMEA_NUMERIC_GGA)) {
+    return false;
+  }
+  _fix.talker[0] = _addr[0];
+  _fix.talker[1] = _addr[1];
+  if (0 < _at(1)->len) {
+    _fix.time = _time(_at(1));
+  }
+  if ((0 < _at(2)->len) && (0 < _at(4)->len)) {
+    _fix.latitude  = _coord(_at(2), _at(3));
+    _fix.longitude = _coord(_at(4), _at(5));
+  }
+  _fix.quality    = (uint8_t) _fixed(_at(6), 0);
+  _fix.satellites = (uint8_t) _fixed(_at(7), 0);
+  _fix.hdop       = (uint16_t) _fixed(_at(8), 2);
+  if (0 < _at(9)->len) {
+    _fix.altitude = _fixed(_at(9), 3);
+  }
+  _fix.valid = (0 < _fix.quality);
+
+  if (nullptr != _listener) {
+    _listener->nmeaFix(&_fix);
+  }
+  return true;
+}
+
+
+/*
+* $xxVTG,course,T,course,M,knots,N,kph,K[,mode]
+*/
+bool NMEAParser::_vtg() {
+  if ((_field < 8) || !_numeric(NMEA_NUMERIC_VTG)) {
+    return false;
+  }
+  _vel.talker[0] = _addr[0];
+  _vel.talker[1] = _addr[1];
+  if (0 < _at(5)->len) {
+    _vel.speed = (uint32_t) (((int64_t) _fixed(_at(5), 3) * 514444) / 1000000);
+  }
+  else {
+    _vel.speed = (uint32_t) (((int64_t) _fixed(_at(7), 3) * 10) / 36);
+  }
+  _vel.course = (uint16_t) _fixed(_at(1), 2);
+  // NMEA 2.3 added a mode. 'N' means the rest is junk.
+  _vel.valid  = ((0 < _at(5)->len) || (0 < _at(7)->len)) && ('N' != _at(9)->c);
+
+  if (nullptr != _listener) {
+    _listener->nmeaVelocity(&_vel);
+  }
+  return true;
+}
+
+
+/*
+* $xxGSV,total,number,in_view{,prn,elevation,azimuth,snr}[,signal]
+* Up to four satellites per sentence. NMEA 4.10 may put a signal id after the
+*   last of them, which is why the satellite count is taken in whole groups.
+*/
+bool NMEAParser::_gsv_collect() {
+  if (_field < 4) {
+    return false;
+  }
+  int groups = (_field - 4) / 4;
+  if (groups > 4) groups = 4;
+  if (!_numeric(0x0000000E | (((1 << (groups * 4)) - 1) << 4))) {
+    return false;
+  }
+  uint8_t total = (uint8_t) _fixed(_at(1), 0);
+  uint8_t num   = (uint8_t) _fixed(_at(2), 0);
+  if ((0 == num) || (num > total)) {
+    return false;
+  }
+
+  if (1 == num) {
+    _gsv.count     = 0;
+    _gsv.talker[0] = _addr[0];
+    _gsv.talker[1] = _addr[1];
+    _gsv_next      = 1;
+  }
+  else if ((num != _gsv_next) || (_gsv.talker[0] != _addr[0]) || (_gsv.talker[1] != _addr[1])) {
+    // We missed part of this group. The sentence was fine, but we wait for
+    //   the next group to begin.
+    _gsv_next = 0;
+    return true;
+  }
+  _gsv.in_view = (uint8_t) _fixed(_at(3), 0);
+
+  for (int i = 0; i < groups; i++) {
+    const uint8_t base = 4 + (i * 4);
+    if ((0 < _at(base)->len) && (_gsv.count < NMEA_MAX_SATS)) {
+      GPSSatellite* s = &_gsv.sats[_gsv.count++];
+      s->prn       = (uint8_t)  _fixed(_at(base), 0);
+      s->elevation = (int8_t)   _fixed(_at(base + 1), 0);
+      s->azimuth   = (uint16_t) _fixed(_at(base + 2), 0);
+      s->snr       = (uint8_t)  _fixed(_at(base + 3), 0);
+    }
+  }
+
+  _gsv_next = num + 1;
+  if (num == total) {
+    memcpy(&_sats, &_gsv, sizeof(GPSSatellites));
+    _gsv_next = 0;
+    if (nullptr != _listener) {
+      _listener->nmeaSatellites(&_sats);
+    }
+  }
+  return true;
+}
+
+
+
+/*******************************************************************************
+* Fixed-point conversions                                                      *
+*******************************************************************************/
+
+/*
+* @param  f       The field.
+* @param  places  How many decimal places to keep. 0 to 9.
+* @return The field's value, times 10^places, truncated. 0 if the field was empty.
+*/
+int32_t NMEAParser::_fixed(const NMEAField* f, int8_t places) {
+  const int8_t have = (0 > f->frac) ? 0 : f->frac;
+  int64_t v = f->value;
+  if (places > have) {
+    v *= _pow10[places - have];
+  }
+  else if (places < have) {
+    v /= _pow10[have - places];
+  }
+  if (v > INT32_MAX) v = INT32_MAX;
+  return (int32_t) (f->neg ? -v : v);
+}
+
+
+/*
+* NMEA gives coordinates as degrees and decimal minutes, run together.
+*
+* @param  f           The coordinate. (d)ddmm.mmmm
+* @param  hemisphere  N, S, E, or W.
+* @return 1e-7 degrees. South and west are negative.
+*/
+int32_t NMEAParser::_coord(const NMEAField* f, const NMEAField* hemisphere) {
+  const int64_t scale = _pow10[(0 > f->frac) ? 0 : f->frac];
+  int64_t deg = f->value / (100 * scale);
+  int64_t min = f->value % (100 * scale);
+  int64_t v   = (deg * 10000000LL) + ((min * 10000000LL) / (60 * scale));
+  if (f->neg) v = -v;
+  if (('S' == hemisphere->c) || ('W' == hemisphere->c)) v = -v;
+  return (int32_t) v;
+}
+
+
+/*
+* @param  f  The time. hhmmss(.sss)
+* @return Milliseconds since midnight.
+*/
+uint32_t NMEAParser::_time(const NMEAField* f) {
+  uint32_t t = (uint32_t) _fixed(f, 3);   // hhmmssmmm
+  return ((t / 10000000) * 3600000) + (((t / 100000) % 100) * 60000) + (t % 100000);
+}
+
+#endif  // MANUVR_GPS_PIPE
@@ -0,0 +1,207 @@
+/*
+File:   NMEAParser.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+A streaming NMEA-0183 parser. Bytes go in as they arrive, in pieces of any
+  size, and typed records come out through an NMEAListener.
+
+Nothing is buffered but the state of the sentence in progress. Each field is
+  decoded as its characters go by, into a fixed-point number (digits, and how
+  many of them were after the point), and the checksum is XOR'd in as we go.
+  When the sentence ends and the checksum matches, the fields are converted
+  into the records below, and the listener is told. A sentence that fails any
+  check changes nothing. There is no heap use at all after construction.
+
+Sentences understood:
+  RMC   Fix (position, time, date, validity), and velocity.
+  GGA   Fix (position, time, quality, satellites used, HDOP, altitude).
+  VTG   Velocity.
+  GSV   Satellites in view. A group of GSVs from one talker is collected, and
+          reported once its last sentence arrives. Each constellation (GP, GL,
+          GA, GB...) is reported separately.
+Anything else is checked, counted, and ignored.
+
+Units are integers throughout, chosen so that nothing a receiver can report
+  is lost, and nothing overflows:
+  Position:  1e-7 degrees. North and east are positive.
+  Altitude:  Millimeters above mean sea level.
+  Speed:     Millimeters per second.
+  Course:    Hundredths of a degree, from true north.
+  Time:      Milliseconds since midnight, UTC.
+  HDOP:      Hundredths.
+*/
+
+
+#ifndef __MANUVR_NMEA_PARSER_H__
+#define __MANUVR_NMEA_PARSER_H__
+
+#include <inttypes.h>
+
+class StringBuilder;
+
+// The longest sentence we will take, from '$' through "\r\n". The standard says
+//   82, but there are receivers that don't care.
+#ifndef NMEA_MAX_LENGTH
+  #define NMEA_MAX_LENGTH 100
+#endif
+
+// How many fields of a sentence are decoded, counting the address. GSV needs 20.
+#ifndef NMEA_MAX_FIELDS
+  #define NMEA_MAX_FIELDS 21
+#endif
+
+// How many satellites of one constellation we will report.
+#ifndef NMEA_MAX_SATS
+  #define NMEA_MAX_SATS 32
+#endif
+
+
+typedef struct gps_fix_t {
+  int32_t  latitude;     // 1e-7 degrees.
+  int32_t  longitude;    // 1e-7 degrees.
+  int32_t  altitude;     // Millimeters. GGA only.
+  uint32_t time;         // Milliseconds since midnight, UTC.
+  uint16_t year;         // RMC only.
+  uint8_t  month;        // RMC only.
+  uint8_t  day;          // RMC only.
+  uint16_t hdop;         // Hundredths. GGA only.
+  uint8_t  quality;      // GGA fix quality. 0 is no fix.
+  uint8_t  satellites;   // How many were used in the solution. GGA only.
+  bool     valid;        // Did the last sentence say the fix was any good?
+  char     talker[3];
+} GPSFix;
+
+typedef struct gps_velocity_t {
+  uint32_t speed;        // Millimeters per second.
+  uint16_t course;       // Hundredths of a degree, from true north.
+  bool     valid;
+  char     talker[3];
+} GPSVelocity;
+
+typedef struct gps_satellite_t {
+  uint8_t  prn;
+  int8_t   elevation;    // Degrees.
+  uint16_t azimuth;      // Degrees.
+  uint8_t  snr;          // dB-Hz. 0 if not being tracked.
+} GPSSatellite;
+
+typedef struct gps_satellites_t {
+  uint8_t      in_view;  // As the receiver counts them.
+  uint8_t      count;    // How many are in sats. Never more than NMEA_MAX_SATS.
+  char         talker[3];
+  GPSSatellite sats[NMEA_MAX_SATS];
+} GPSSatellites;
+
+
+/*
+* Implemented by whoever wants the records. Each is only good until the call
+*   returns. Copy what you want to keep.
+*/
+class NMEAListener {
+  public:
+    virtual void nmeaFix(const GPSFix*)               = 0;
+    virtual void nmeaVelocity(const GPSVelocity*)     = 0;
+    virtual void nmeaSatellites(const GPSSatellites*) = 0;
+};
+
+
+/*
+* A field, as decoded so far.
+*/
+typedef struct nmea_field_t {
+  int32_t value;    // The digits, without the point.
+  int8_t  frac;     // How many of them came after the point. -1 if there was no point.
+  uint8_t digits;   // How many digits are in value. Those past 9 are dropped.
+  uint8_t len;      // How many characters were in the field. 0 if it was empty.
+  char    c;        // The first of them.
+  bool    neg;
+  bool    number;   // False if the field held anything a number can't.
+} NMEAField;
+
+
+enum class NMEAState : uint8_t {
+  IDLE     = 0,   // Waiting for '$'.
+  BODY     = 1,   // Between '$' and '*'.
+  CHECK_HI = 2,   // The first hex digit of the checksum.
+  CHECK_LO = 3,   // The second.
+  EOL      = 4    // Waiting for CR or LF.
+};
+
+
+class NMEAParser {
+  public:
+    NMEAParser(NMEAListener* listener = nullptr);
+
+    int  feed(const uint8_t* buf, int len);   // Returns how many sentences were accepted.
+    void reset();                             // Drops the sentence in progress.
+
+    inline void listener(NMEAListener* l) {        _listener = l;  };
+    inline const GPSFix*        fix() {            return &_fix;   };
+    inline const GPSVelocity*   velocity() {       return &_vel;   };
+    inline const GPSSatellites* satellites() {     return &_sats;  };
+
+    void printDebug(StringBuilder*);
+
+    bool strict = false;   // If true, sentences without a checksum are refused.
+
+    /* Counters. */
+    uint32_t sentences    = 0;   // Sentences that passed every check.
+    uint32_t bad_checksum = 0;   // Sentences whose checksum didn't match.
+    uint32_t malformed    = 0;   // Sentences that were cut off, too long, or nonsense.
+    uint32_t unhandled    = 0;   // Good sentences of a type we don't decode.
+
+
+  private:
+    NMEAListener* _listener;
+    GPSFix        _fix;
+    GPSVelocity   _vel;
+    GPSSatellites _sats;
+    GPSSatellites _gsv;        // The GSV group being collected.
+    NMEAField     _fields[NMEA_MAX_FIELDS];
+    char          _addr[6];    // Talker and type, such as "GPRMC".
+    uint32_t      _type;       // The last three characters of _addr, packed.
+    NMEAState     _state;
+    uint8_t       _len;        // Characters in this sentence so far.
+    uint8_t       _field;      // The field in progress.
+    uint8_t       _sum;        // The checksum, so far.
+    uint8_t       _sum_rx;     // The checksum, as sent.
+    uint8_t       _gsv_next;   // The GSV sentence number we expect next. 0 for none.
+
+    void _begin();
+    void _field_byte(uint8_t);
+    void _field_end();
+    bool _commit();
+    bool _numeric(uint32_t mask);
+
+    bool _rmc();
+    bool _gga();
+    bool _vtg();
+    bool _gsv_collect();
+
+    inline const NMEAField* _at(uint8_t idx) {
+      return ((idx < _field) && (idx < NMEA_MAX_FIELDS)) ? &_fields[idx] : &_empty;
+    };
+
+    static const NMEAField _empty;
+    static int32_t  _fixed(const NMEAField*, int8_t places);
+    static int32_t  _coord(const NMEAField*, const NMEAField* hemisphere);
+    static uint32_t _time(const NMEAField*);
+};
+
+#endif  // __MANUVR_NMEA_PARSER_H__
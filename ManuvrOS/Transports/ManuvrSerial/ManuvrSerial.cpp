@@ -99,6 +99,7 @@ Platforms that require it should be able to extend this driver for specific
 */
 ManuvrSerial::ManuvrSerial(const char* tty_path, int b_rate, uint32_t opts) : ManuvrXport("ManuvrSerial") {
   set_xport_state(MANUVR_XPORT_FLAG_STREAM_ORIENTED);
+  setInterests(_xport_interests);
   if (tty_path) {
     size_t addr_len = strlen(tty_path);
     if (0 < addr_len) {
@@ -33,6 +33,7 @@ Platforms that require it should be able to extend this driver for specific
 #if defined(MANUVR_SUPPORT_TCPSOCKET) | defined(MANUVR_SUPPORT_UDP)
 
 #include "ManuvrSocket.h"
+#include "SocketReactor.h"
 #include <CommonConstants.h>
 
 #include <Kernel.h>
@@ -49,6 +50,7 @@ Platforms that require it should be able to extend this driver for specific
   #include <fstream>
   #include <iostream>
   #include <sys/socket.h>
+  #include <errno.h>
 
 
 /*******************************************************************************
@@ -85,8 +87,12 @@ ManuvrSocket::ManuvrSocket(const char* nom, const char* addr, int port, uint32_t
     for (uint16_t i = 0; i < sizeof(_sockaddr);  i++) {
       *((uint8_t *) &_sockaddr + i) = 0;
     }
+    pthread_mutex_init(&_tx_lock, nullptr);
   #endif
 
+  // Sockets are driven by the SocketReactor, rather than a thread of their own.
+  set_xport_state(MANUVR_XPORT_FLAG_NON_BLOCKING);
+
   // Build some pre-formed Events.
   read_abort_event.repurpose(MANUVR_MSG_XPORT_QUEUE_RDY, (EventReceiver*) this);
   read_abort_event.incRefs();
@@ -99,6 +105,7 @@ ManuvrSocket::ManuvrSocket(const char* nom, const char* addr, int port, uint32_t
 */
 ManuvrSocket::~ManuvrSocket() {
   if (_sock) {
+    SocketReactor::remove(this);
     close(_sock);  // Close the socket.
     _sock = 0;
   }
@@ -106,6 +113,7 @@ ManuvrSocket::~ManuvrSocket() {
     free(_addr);
     _addr = nullptr;
   }
+  pthread_mutex_destroy(&_tx_lock);
 }
 
 
@@ -124,14 +132,157 @@ int8_t ManuvrSocket::disconnect() {
   }
 
   if (_sock) {
+    SocketReactor::remove(this);
     close(_sock);  // Close the socket.
     _sock = 0;
   }
+  pthread_mutex_lock(&_tx_lock);
+  _tx_pending.clear();
+  pthread_mutex_unlock(&_tx_lock);
   ManuvrXport::disconnect();
   return 0;
 }
 
 
+/**
+* Writes to the socket without blocking.
+*
+* @param  out      The buffer containing the outbound data.
+* @param  out_len  The length of data in the buffer.
+* @return false if the socket failed, or too much is already pending. True otherwise.
+*/
+bool ManuvrSocket::_send(uint8_t* out, int out_len) {
+  struct iovec vec;
+  vec.iov_base = out;
+  vec.iov_len  = out_len;
+  return _sendv(&vec, 1, out_len);
+}
+
+
+/**
+* Writes a StringBuilder to the socket without collapsing it. Its fragments go
+*   to the network stack in a single gathering call. A buffer too fragmented
+*   for that is collapsed first, which is what would have happened anyway.
+*
+* @param  out  The buffer containing the outbound data. It is not changed.
+* @return false if the socket failed, or too much is already pending. True otherwise.
+*/
+bool ManuvrSocket::_send(StringBuilder* out) {
+  struct iovec vecs[MANUVR_SOCKET_IOV_MAX];
+  int out_len = out->length();
+  int count   = out->toIovec(vecs, MANUVR_SOCKET_IOV_MAX);
+  int covered = 0;
+  for (int i = 0; i < count; i++) covered += vecs[i].iov_len;
+  if (covered < out_len) {
+    return _send(out->string(), out_len);
+  }
+  return _sendv(vecs, count, out_len);
+}
+
+
+/**
+* Whatever the network stack won't take right now is held, and the SocketReactor
+*   is asked to tell us when there is room for it. Output order is preserved.
+* The reactor holds its own lock while it calls _flush_tx(), which takes ours.
+*   So we must never call into the reactor while holding _tx_lock.
+*
+* @param  vecs     The fragments to send, in order.
+* @param  count    How many fragments there are.
+* @param  out_len  The sum of their lengths.
+* @return false if the socket failed, or too much is already pending. True otherwise.
+*/
+bool ManuvrSocket::_sendv(struct iovec* vecs, int count, int out_len) {
+  bool return_value = false;
+  bool want_write   = false;
+  int n = 0;
+  pthread_mutex_lock(&_tx_lock);
+  if (0 == _tx_pending.length()) {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = vecs;
+    msg.msg_iovlen = count;
+    n = (int) sendmsg(_sock, &msg, MSG_NOSIGNAL);
+    if (0 > n) {
+      n = ((EAGAIN == errno) || (EWOULDBLOCK == errno)) ? 0 : -1;
+    }
+    if (0 <= n) {
+      bytes_sent += n;
+      want_write = (n < out_len);
+      return_value = true;
+    }
+  }
+  else if ((_tx_pending.length() + out_len) <= MANUVR_SOCKET_TX_PENDING_MAX) {
+    // Something is already waiting. Get in line behind it.
+    return_value = true;
+  }
+
+  if (return_value) {
+    // Hold whatever wasn't taken.
+    for (int i = 0; i < count; i++) {
+      int len = (int) vecs[i].iov_len;
+      if (n >= len) {
+        n -= len;
+      }
+      else {
+        _tx_pending.concat(((uint8_t*) vecs[i].iov_base) + n, len - n);
+        n = 0;
+      }
+    }
+  }
+  pthread_mutex_unlock(&_tx_lock);
+  if (want_write) {
+    SocketReactor::wantWrite(this, true);
+  }
+  return return_value;
+}
+
+
+/**
+* Called by the SocketReactor when the socket can take more output.
+* Write interest is dropped only after _tx_lock is released (see _sendv()). A
+*   writer might queue more in that window, and ask for write interest before
+*   we drop it. So we look again afterward, and ask again if we must.
+*
+* @return 0 if everything pending was written, 1 if some remains, -1 on failure.
+*/
+int8_t ManuvrSocket::_flush_tx() {
+  int8_t return_value = 0;
+  pthread_mutex_lock(&_tx_lock);
+  if (0 < _tx_pending.length()) {
+    struct iovec vecs[MANUVR_SOCKET_IOV_MAX];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = vecs;
+    msg.msg_iovlen = _tx_pending.toIovec(vecs, MANUVR_SOCKET_IOV_MAX);
+    int n = (int) sendmsg(_sock, &msg, MSG_NOSIGNAL);
+    if (0 < n) {
+      bytes_sent += n;
+      _tx_pending.cull(n);
+    }
+    else if ((EAGAIN != errno) && (EWOULDBLOCK != errno)) {
+      _tx_pending.clear();   // The peer is gone. The read side will notice.
+      return_value = -1;
+    }
+  }
+  bool drained = (0 == _tx_pending.length());
+  if (!drained && (0 == return_value)) {
+    return_value = 1;
+  }
+  pthread_mutex_unlock(&_tx_lock);
+
+  if (drained) {
+    SocketReactor::wantWrite(this, false);
+    pthread_mutex_lock(&_tx_lock);
+    drained = (0 == _tx_pending.length());
+    pthread_mutex_unlock(&_tx_lock);
+    if (!drained) {
+      SocketReactor::wantWrite(this, true);
+    }
+  }
+  return return_value;
+}
+
+
 #else   //Unsupportedness
 #endif  // __LINUX
 
@@ -41,12 +41,24 @@ This is basically only for linux until it is needed in a smaller space.
   #include <fstream>
   #include <iostream>
   #include <sys/socket.h>
+  #include <sys/uio.h>
   #include <netinet/in.h>
   #include <arpa/inet.h>
+  #include <pthread.h>
 #else
   // No supportage.
 #endif
 
+// How much outbound data will we hold for a peer that isn't keeping up?
+#ifndef MANUVR_SOCKET_TX_PENDING_MAX
+  #define MANUVR_SOCKET_TX_PENDING_MAX  65536
+#endif
+
+// How many buffer fragments will we hand the network stack in one call?
+#ifndef MANUVR_SOCKET_IOV_MAX
+  #define MANUVR_SOCKET_IOV_MAX  32
+#endif
+
 
 /*
 * This is a wrapper around sockets as they exist in a linux system.
@@ -72,8 +84,23 @@ class ManuvrSocket : public ManuvrXport {
 
     ManuvrSocket(const char* nom, const char* addr, int port, uint32_t opts);
 
+    bool _send(uint8_t* out, int out_len);
+    bool _send(StringBuilder* out);   // Gather-writes the fragments without collapsing.
+
 
   private:
+    friend class SocketReactor;
+
+    #if defined(__MANUVR_LINUX)
+      StringBuilder   _tx_pending;   // Outbound bytes the network stack hasn't taken yet.
+      pthread_mutex_t _tx_lock;
+    #endif
+
+    int8_t _flush_tx();
+
+    #if defined(__MANUVR_LINUX)
+      bool _sendv(struct iovec* vecs, int count, int out_len);
+    #endif
 };
 
 #endif  // Header guard __MANUVR_SOCKET_H__
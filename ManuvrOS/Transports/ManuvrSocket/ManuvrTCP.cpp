@@ -26,10 +26,16 @@ This is basically only for linux for now.
 #if defined(MANUVR_SUPPORT_TCPSOCKET)
 
 #include "ManuvrTCP.h"
+#include "SocketReactor.h"
 #include <CommonConstants.h>
 
 #include <Kernel.h>
 
+#if defined(__MANUVR_LINUX)
+  #include <arpa/inet.h>
+  #include <errno.h>
+#endif
+
 /*******************************************************************************
 *      _______.___________.    ___   .___________. __    ______     _______.
 *     /       |           |   /   \  |           ||  |  /      |   /       |
@@ -41,89 +47,6 @@ This is basically only for linux for now.
 * Static members and initializers should be located here.
 *******************************************************************************/
 
-/*******************************************************************************
-* .-. .----..----.    .-.     .--.  .-. .-..----.
-* | |{ {__  | {}  }   | |    / {} \ |  `| || {}  \
-* | |.-._} }| .-. \   | `--./  /\  \| |\  ||     /
-* `-'`----' `-' `-'   `----'`-'  `-'`-' `-'`----'
-*
-* Interrupt service routine support functions. Everything in this block
-*   executes under an ISR. Keep it brief...
-*******************************************************************************/
-
-#if defined(__MANUVR_FREERTOS) || defined(__MANUVR_LINUX)
-  #include <arpa/inet.h>
-
-  // Threaded platforms will need this to compensate for a loss of ISR.
-  extern void* xport_read_handler(void* active_xport);
-
-
-  /*
-  * Since listening for connections on this transport involves blocking, we have a
-  *   thread dedicated to the task...
-  */
-  void* socket_listener_loop(void* active_xport) {
-    if (NULL != active_xport) {
-      sigset_t set;
-      sigemptyset(&set);
-      //sigaddset(&set, SIGIO);
-      sigaddset(&set, SIGQUIT);
-      sigaddset(&set, SIGHUP);
-      sigaddset(&set, SIGTERM);
-      sigaddset(&set, SIGVTALRM);
-      sigaddset(&set, SIGINT);
-      int s = pthread_sigmask(SIG_BLOCK, &set, NULL);
-
-      ManuvrTCP* listening_inst = (ManuvrTCP*) active_xport;
-      StringBuilder output;
-      if (0 != s) {
-        output.concatf("pthread_sigmask() returned an error: %d\n", s);
-        Kernel::log(&output);
-        return NULL;
-      }
-      int      cli_sock;
-      struct sockaddr_in cli_addr;
-      while (listening_inst->listening()) {
-        unsigned int clientlen = sizeof(cli_addr);
-
-        /* Wait for client connection */
-        if ((cli_sock = accept(listening_inst->getSockID(), (struct sockaddr *) &cli_addr, &clientlen)) < 0) {
-          output.concat("Failed to accept client connection.\n");
-        }
-        else {
-          ManuvrTCP* nu_connection = new ManuvrTCP(listening_inst, cli_sock, &cli_addr);
-          nu_connection->setPipeStrategy(listening_inst->getPipeStrategy());
-
-          ManuvrMsg* event = Kernel::returnEvent(MANUVR_MSG_SYS_ADVERTISE_SRVC);
-          event->addArg((EventReceiver*) nu_connection);
-          Kernel::staticRaiseEvent(event);
-
-          output.concatf("TCP Client connected: %s\n", (char*) inet_ntoa(cli_addr.sin_addr));
-        }
-        Kernel::log(&output);
-
-        for (uint16_t i = 0; i < sizeof(cli_addr);  i++) {
-          // Zero the sockaddr structure for next use. The new transport
-          //   instance should have copied it by now.
-          *((uint8_t *) &cli_addr  + i) = 0;
-        }
-      }
-      // Close the listener...
-      // TODO: Is this all we need to do?   ---J. Ian Lindsay   Fri Jan 15 11:32:12 PST 2016
-      close(listening_inst->getSockID());
-    }
-    else {
-      Kernel::log("Tried to listen with a NULL transport.");
-    }
-
-    return NULL;
-  }
-
-#else
-  // No special globals needed for this platform.
-#endif
-
-
 /*******************************************************************************
 *   ___ _              ___      _ _              _      _
 *  / __| |__ _ ______ | _ ) ___(_) |___ _ _ _ __| |__ _| |_ ___
@@ -138,6 +61,7 @@ This is basically only for linux for now.
 */
 ManuvrTCP::ManuvrTCP(const char* addr, int port, uint32_t opts) : ManuvrSocket("ManuvrTCP", addr, port, opts) {
   set_xport_state(MANUVR_XPORT_FLAG_STREAM_ORIENTED);
+  setInterests(_xport_interests);
 }
 
 /**
@@ -195,13 +119,13 @@ int8_t ManuvrTCP::toCounterparty(StringBuilder* buf, int8_t mm) {
       /* The system that allocated this buffer either...
           a) Did so with the intention that it never be free'd, or...
           b) Has a means of discovering when it is safe to free.  */
-      return (write_port(buf->string(), buf->length()) ? MEM_MGMT_RESPONSIBLE_CREATOR : MEM_MGMT_RESPONSIBLE_CALLER);
+      return (write_port(buf) ? MEM_MGMT_RESPONSIBLE_CREATOR : MEM_MGMT_RESPONSIBLE_CALLER);
 
     case MEM_MGMT_RESPONSIBLE_BEARER:
       /* We are now the bearer. That means that by returning non-failure, the
           caller will expect _us_ to manage this memory.  */
       // TODO: Freeing the buffer?
-      return (write_port(buf->string(), buf->length()) ? MEM_MGMT_RESPONSIBLE_BEARER : MEM_MGMT_RESPONSIBLE_CALLER);
+      return (write_port(buf) ? MEM_MGMT_RESPONSIBLE_BEARER : MEM_MGMT_RESPONSIBLE_CALLER);
 
     default:
       /* This is more ambiguity than we are willing to bear... */
@@ -253,6 +177,10 @@ int8_t ManuvrTCP::connect() {
 
   initialized(true);
   connected(true);
+  if (erAttached()) {
+    // Otherwise, this will happen in attached().
+    SocketReactor::add(this);
+  }
 
   return 0;
 }
@@ -282,15 +210,19 @@ int8_t ManuvrTCP::listen() {
     return -1;
   }
   /* Listen on the server socket */
-  if (::listen(_sock, 4) < 0) {
+  if (::listen(_sock, SOMAXCONN) < 0) {
     Kernel::log("Failed to listen on server socket\n");
     return -1;
   }
 
   initialized(true);
-  createThread(&_thread_id, NULL, socket_listener_loop, (void*) this);
-
   listening(true);
+  if (SocketReactor::add(this)) {
+    Kernel::log("Failed to hand the server socket to the reactor.\n");
+    disconnect();
+    return -1;
+  }
+
   local_log.concatf("TCP Now listening at %s:%d.\n", _addr, _port_number);
 
   flushLocalLog();
@@ -305,30 +237,74 @@ int8_t ManuvrTCP::reset() {
 
 
 
+/**
+* Called by the SocketReactor when our socket is readable. Never blocks.
+* If we are listening, this means a client is waiting to be accepted.
+*
+* @return 0 on success. Negative value on failure.
+*/
 int8_t ManuvrTCP::read_port() {
-  if (connected()) {
-    unsigned char *buf = (unsigned char *) alloca(256);
-    int n;
-
-    while (connected()) {
-      n = read(_sock, buf, 255);
-      if (n > 0) {
-        bytes_received += n;
-        BufferPipe::fromCounterparty(buf, n, MEM_MGMT_RESPONSIBLE_BEARER);
-      }
-      else {
-        // Don't thrash the CPU for no reason...
-        sleep_millis(20);
-      }
+  if (listening()) {
+    return accept_connection();
+  }
+  else if (connected()) {
+    uint8_t buf[MANUVR_TCP_READ_SIZE];
+    int n = (int) recv(_sock, buf, sizeof(buf), 0);
+    if (n > 0) {
+      bytes_received += n;
+      BufferPipe::fromCounterparty(buf, n, MEM_MGMT_RESPONSIBLE_BEARER);
+      return 0;
+    }
+    else if ((0 == n) || ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))) {
+      // Orderly shutdown from the peer, or a real error.
+      disconnect();
+    }
+    else {
+      return 0;   // Spurious wakeup.
     }
   }
   else if (getVerbosity() > 1) {
     local_log.concat("Somehow we are trying to read a port that is not marked as open.\n");
   }
 
-  _thread_id = 0;
-
   flushLocalLog();
+  return -1;
+}
+
+
+/**
+* Accepts one waiting client, and advertises it to the system as a new transport.
+* The client's socket will be given to the reactor once the Kernel attaches it.
+*
+* @return 0 on success. Negative value on failure.
+*/
+int8_t ManuvrTCP::accept_connection() {
+  struct sockaddr_in cli_addr;
+  socklen_t clientlen = sizeof(cli_addr);
+  for (uint16_t i = 0; i < sizeof(cli_addr);  i++) {
+    *((uint8_t *) &cli_addr  + i) = 0;
+  }
+
+  int cli_sock = accept4(_sock, (struct sockaddr *) &cli_addr, &clientlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+  if (0 > cli_sock) {
+    if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (getVerbosity() > 2)) {
+      local_log.concat("Failed to accept client connection.\n");
+      flushLocalLog();
+    }
+    return -1;
+  }
+
+  ManuvrTCP* nu_connection = new ManuvrTCP(this, cli_sock, &cli_addr);
+  nu_connection->setPipeStrategy(getPipeStrategy());
+
+  ManuvrMsg* event = Kernel::returnEvent(MANUVR_MSG_SYS_ADVERTISE_SRVC);
+  event->addArg((EventReceiver*) nu_connection);
+  Kernel::staticRaiseEvent(event);
+
+  if (getVerbosity() > 4) {
+    local_log.concatf("TCP Client connected: %s\n", (char*) inet_ntoa(cli_addr.sin_addr));
+    flushLocalLog();
+  }
   return 0;
 }
 
@@ -354,9 +330,29 @@ bool ManuvrTCP::write_port(unsigned char* out, int out_len) {
   }
 
   if (connected()) {
-    int bytes_written = (int) write(getSockID(), out, out_len);
-    bytes_sent += bytes_written;
-    if (bytes_written == out_len) {
+    if (_send(out, out_len)) {
+      return true;
+    }
+    Kernel::log("Failed to send bytes to client");
+  }
+  return false;
+}
+
+
+/**
+* Same as above, but sends the buffer's fragments as they lie, rather than
+*   collapsing them into one contiguous string first.
+*
+* @param  out  The buffer containing the outbound data.
+* @return false on error, true on success.
+*/
+bool ManuvrTCP::write_port(StringBuilder* out) {
+  if (getSockID() == -1) {
+    return false;
+  }
+
+  if (connected()) {
+    if (_send(out)) {
       return true;
     }
     Kernel::log("Failed to send bytes to client");
@@ -397,6 +393,10 @@ int8_t ManuvrTCP::attached() {
     read_abort_event.enableSchedule(false);
     platform.kernel()->addSchedule(&read_abort_event);
     reset();
+    if (connected()) {
+      // We were connected before the Kernel knew about us. Start reading.
+      SocketReactor::add(this);
+    }
     return 1;
   }
   return 0;
@@ -413,6 +413,10 @@ void ManuvrTCP::printDebug(StringBuilder *temp) {
   temp->concatf("-- _addr           %s:%d\n",  _addr, _port_number);
   temp->concatf("-- _options        0x%08x\n", _options);
   temp->concatf("-- _sock           0x%08x\n", _sock);
+  if (listening()) {
+    temp->concatf("-- _connections    %d\n", _connections.size());
+    SocketReactor::printDebug(temp);
+  }
 }
 
 
@@ -47,6 +47,11 @@ This is basically only for linux until it is needed in a smaller space.
   // No supportage.
 #endif
 
+// How much do we try to read from the socket at once?
+#ifndef MANUVR_TCP_READ_SIZE
+  #define MANUVR_TCP_READ_SIZE  1024
+#endif
+
 
 // TODO: Might generalize UDP and websocket support into this. For now, we only deal in TCP.
 // If generalization takes place, we should probably have a pure interface class "ManuvrSocket"
@@ -72,6 +77,7 @@ class ManuvrTCP : public ManuvrSocket {
     int8_t reset();
 
     bool write_port(unsigned char* out, int out_len);
+    bool write_port(StringBuilder* out);
     int8_t read_port();
 
 
@@ -81,6 +87,8 @@ class ManuvrTCP : public ManuvrSocket {
 
   private:
     LinkedList<ManuvrTCP*> _connections;   // A list of client connections.
+
+    int8_t accept_connection();
 };
 
 #endif  // __MANUVR_TCP_SOCKET_H__
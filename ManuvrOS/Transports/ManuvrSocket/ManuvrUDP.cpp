@@ -24,8 +24,11 @@ This class implements a crude UDP connector.
 
 #if defined(MANUVR_SUPPORT_UDP)
 
-#include <DataStructures/StringBuilder.h>
+// ManuvrUDP.h brings in the platform first. StringBuilder's layout depends on it.
 #include "ManuvrUDP.h"
+#include "SocketReactor.h"
+#include <DataStructures/StringBuilder.h>
+#include <errno.h>
 
 
 /*******************************************************************************
@@ -40,64 +43,6 @@ This class implements a crude UDP connector.
 *******************************************************************************/
 
 
-/*******************************************************************************
-* .-. .----..----.    .-.     .--.  .-. .-..----.
-* | |{ {__  | {}  }   | |    / {} \ |  `| || {}  \
-* | |.-._} }| .-. \   | `--./  /\  \| |\  ||     /
-* `-'`----' `-' `-'   `----'`-'  `-'`-' `-'`----'
-*
-* Interrupt service routine support functions. Everything in this block
-*   executes under an ISR. Keep it brief...
-*******************************************************************************/
-
-#if defined(__BUILD_HAS_THREADS)
-
-  /*
-  * Since listening for connections on this transport involves blocking, we have a
-  *   thread dedicated to the task...
-  */
-  void* _udp_socket_listener_loop(void* active_xport) {
-    if (active_xport) {
-      sigset_t set;
-      sigemptyset(&set);
-      //sigaddset(&set, SIGIO);
-      sigaddset(&set, SIGQUIT);
-      sigaddset(&set, SIGHUP);
-      sigaddset(&set, SIGTERM);
-      sigaddset(&set, SIGVTALRM);
-      sigaddset(&set, SIGINT);
-      int s = pthread_sigmask(SIG_BLOCK, &set, nullptr);
-      ManuvrUDP* listening_inst = (ManuvrUDP*) active_xport;
-
-      if (0 == s) {
-        while (listening_inst->listening()) {
-          // Read data from UDP port. Blocks...
-          if (0 > listening_inst->read_port()) {
-            // Don't thrash the CPU for no reason...
-            sleep_millis(20);
-          }
-        }
-      }
-      else {
-        Kernel::log("Failed to thread the UDP listener loop.\n");
-      }
-
-      // Close the listener...
-      listening_inst->disconnect();
-    }
-    else {
-      Kernel::log("Tried to listen with a NULL transport.");
-    }
-
-    return nullptr;
-  }
-#else
-  // Threads are unsupported here.
-#endif
-
-
-
-
 /*******************************************************************************
 *   ___ _              ___      _ _              _      _
 *  / __| |__ _ ______ | _ ) ___(_) |___ _ _ _ __| |__ _| |_ ___
@@ -113,12 +58,8 @@ This class implements a crude UDP connector.
 * @param  addr  An IPv4 address in dotted quad notation.
 * @param  port  A 16-bit port number.
 */
-ManuvrUDP::ManuvrUDP(const char* addr, int port) : ManuvrSocket("ManuvrUDP", addr, port, 0) {
-  set_xport_state(MANUVR_XPORT_FLAG_HAS_MULTICAST | MANUVR_XPORT_FLAG_CONNECTIONLESS);
-  _bp_set_flag(BPIPE_FLAG_PIPE_PACKETIZED, true);
-
-  // Per RFC1122: Minimum reassembly buffer is 576 bytes of effective MTU.
-  _xport_mtu = 576;
+ManuvrUDP::ManuvrUDP(const char* addr, int port) : ManuvrSocket("ManuvrUDP", addr, port, 0), _pipes(this, MANUVR_UDP_MAX_PIPES) {
+  _udp_init();
 }
 
 
@@ -129,26 +70,58 @@ ManuvrUDP::ManuvrUDP(const char* addr, int port) : ManuvrSocket("ManuvrUDP", add
 * @param  port  A 16-bit port number.
 * @param  opts  An options mask to pass to the underlying socket implentation.
 */
-ManuvrUDP::ManuvrUDP(const char* addr, int port, uint32_t opts) : ManuvrSocket("ManuvrUDP", addr, port, opts) {
-  set_xport_state(MANUVR_XPORT_FLAG_HAS_MULTICAST | MANUVR_XPORT_FLAG_CONNECTIONLESS);
-  _bp_set_flag(BPIPE_FLAG_PIPE_PACKETIZED, true);
-
-  // Per RFC1122: Minimum reassembly buffer is 576 bytes of effective MTU.
-  _xport_mtu = 576;
+ManuvrUDP::ManuvrUDP(const char* addr, int port, uint32_t opts) : ManuvrSocket("ManuvrUDP", addr, port, opts), _pipes(this, MANUVR_UDP_MAX_PIPES) {
+  _udp_init();
 }
 
 
 /**
 * Destructor.
-* Clean up any outstanding exchanges.
-* The UDPPipe classes will be informed of our demise and take their own measures
-*   as appropriate.
+* Outstanding exchanges are cleaned up by _pipes, which owns every UDPPipe
+*   we ever handed out.
 */
 ManuvrUDP::~ManuvrUDP() {
-	std::map<uint16_t, UDPPipe*>::iterator it;
-	for (it = _open_replies.begin(); it != _open_replies.end(); it++) {
-    delete it->second;
-	}
+  platform.kernel()->removeSchedule(&read_abort_event);
+  #if defined(__MANUVR_LINUX)
+    if (_sock) {
+      SocketReactor::remove(this);   // Before the pools go away.
+    }
+    if (nullptr != _rx.pool) free(_rx.pool);
+    if (nullptr != _tx.pool) free(_tx.pool);
+    _rx.pool = nullptr;
+    _tx.pool = nullptr;
+    pthread_mutex_destroy(&_tx_lock);
+    pthread_mutex_destroy(&_pipe_lock);
+  #endif
+}
+
+
+/*
+* Everything the constructors have in common.
+*/
+void ManuvrUDP::_udp_init() {
+  set_xport_state(MANUVR_XPORT_FLAG_HAS_MULTICAST | MANUVR_XPORT_FLAG_CONNECTIONLESS);
+  setInterests(_xport_interests);
+  _bp_set_flag(BPIPE_FLAG_PIPE_PACKETIZED, true);
+
+  // Per RFC1122: Minimum reassembly buffer is 576 bytes of effective MTU.
+  _xport_mtu = 576;
+
+  _tx_flush.repurpose(MANUVR_MSG_XPORT_QUEUE_RDY, (EventReceiver*) this);
+  _tx_flush.incRefs();
+  _tx_flush.specific_target = (EventReceiver*) this;
+
+  #if defined(__MANUVR_LINUX)
+    _rx.pool = nullptr;
+    _tx.pool = nullptr;
+    _tx.count = 0;
+    pthread_mutex_init(&_tx_lock, nullptr);
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&_pipe_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+  #endif
 }
 
 
@@ -274,9 +247,19 @@ int8_t ManuvrUDP::listen() {
     return -1;
   }
 
+  if (_batch_init()) {
+    Kernel::log("Failed to allocate UDP batch buffers.\n");
+    disconnect();
+    return -1;
+  }
+
   //initialized(true);
-  createThread(&_thread_id, nullptr, _udp_socket_listener_loop, (void*) this);
   listening(true);
+  if (SocketReactor::add(this)) {
+    Kernel::log("Failed to hand the UDP server socket to the reactor.\n");
+    disconnect();
+    return -1;
+  }
   local_log.concatf("UDP Now listening at %s:%d.\n", _addr, _port_number);
 
   flushLocalLog();
@@ -285,84 +268,176 @@ int8_t ManuvrUDP::listen() {
 
 
 /**
-* Read data from UDP port.
+* Allocates the pools behind the RX and TX batches, and wires every header to
+*   its slot. Idempotent.
 *
-* NOTE: Blocks. So only call from within a thread.
-* TODO: ALL OF THIS RUNS IN A THREAD. IT IS NOT SAFE AS IT STANDS.
+* @return 0 on success. Negative value on failure.
+*/
+int8_t ManuvrUDP::_batch_init() {
+  if (nullptr != _rx.pool) {
+    return 0;
+  }
+  UDPBatch* batches[2] = { &_rx, &_tx };
+  for (int b = 0; b < 2; b++) {
+    UDPBatch* batch = batches[b];
+    batch->pool  = (uint8_t*) malloc(MANUVR_UDP_MMSG_BATCH * _xport_mtu);
+    batch->count = 0;
+    if (nullptr == batch->pool) {
+      return -1;
+    }
+    memset(batch->msgs,  0, sizeof(batch->msgs));
+    memset(batch->addrs, 0, sizeof(batch->addrs));
+    for (int i = 0; i < MANUVR_UDP_MMSG_BATCH; i++) {
+      batch->iov[i].iov_base = batch->pool + (i * _xport_mtu);
+      batch->iov[i].iov_len  = _xport_mtu;
+      batch->msgs[i].msg_hdr.msg_iov     = &batch->iov[i];
+      batch->msgs[i].msg_hdr.msg_iovlen  = 1;
+      batch->msgs[i].msg_hdr.msg_name    = &batch->addrs[i];
+      batch->msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    }
+  }
+  return 0;
+}
+
+
+/**
+* A client that writes without ever having listened needs a socket for its
+*   datagrams to leave from, and for replies to come back to. It isn't bound,
+*   so the network stack picks the port.
+*
+* @return 0 on success. Negative value on failure.
+*/
+int8_t ManuvrUDP::_open_socket() {
+  if (0 < _sock) {
+    return 0;
+  }
+  _sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (-1 == _sock) {
+    _sock = 0;
+    return -1;
+  }
+  if (_batch_init() || SocketReactor::add(this)) {
+    disconnect();
+    return -1;
+  }
+  return 0;
+}
+
+
+/**
+* Read data from UDP port. Called by the SocketReactor when a datagram is
+*   waiting. Never blocks.
+* Drains the socket a batch at a time, with one recvmmsg() per batch. A short
+*   batch means the socket is empty.
+*
+* NOTE: This runs on the reactor's thread, not the Kernel's.
 *
 * @return 0 on success. Negative value on failure.
 */
 int8_t ManuvrUDP::read_port() {
   int8_t return_value = -1;
-  unsigned char buf[_xport_mtu];
-  struct sockaddr_in cli_addr;
-  for (uint16_t i = 0; i < sizeof(cli_addr); i++) {
-    *((uint8_t *) &cli_addr  + i) = 0;   // Zero the sockaddr structure for use.
+  int n = 0;
+  if (nullptr == _rx.pool) {
+    return return_value;
   }
+  do {
+    for (int i = 0; i < MANUVR_UDP_MMSG_BATCH; i++) {
+      // The kernel writes these back. Reset them.
+      _rx.msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+      _rx.msgs[i].msg_hdr.msg_flags   = 0;
+    }
+    n = recvmmsg(getSockID(), _rx.msgs, MANUVR_UDP_MMSG_BATCH, MSG_DONTWAIT, nullptr);
+    if (0 < n) {
+      _rx_calls++;
+      _rx_datagrams += n;
+      for (int i = 0; i < n; i++) {
+        _proc_datagram(
+          _rx.pool + (i * _xport_mtu),
+          (int) _rx.msgs[i].msg_len,
+          _rx.addrs[i].sin_addr.s_addr,
+          ntohs(_rx.addrs[i].sin_port)
+        );
+      }
+      return_value = 0;
+    }
+  } while (MANUVR_UDP_MMSG_BATCH == n);
 
-  unsigned int clientlen = sizeof(cli_addr);
-  int n = recvfrom(getSockID(), buf, _xport_mtu, 0, (struct sockaddr*) &cli_addr, &clientlen);
-  if (-1 == n) {
+  if ((-1 == n) && (EAGAIN != errno) && (EWOULDBLOCK != errno)) {
     local_log.concat("Failed to read UDP packet.\n");
   }
-  else if (n > 0) {
-    // We received a packet. Send it further away.
-    bytes_received += n;   // Log the bytes.
-    if (getVerbosity() > 6) {
-      local_log.concatf("UDP read %d bytes from counterparty (%s).\n", n, (const char*) inet_ntoa(cli_addr.sin_addr));
-    }
-    UDPPipe* related_pipe = _open_replies[cli_addr.sin_port];
-    if (nullptr == related_pipe) {
-      // Non-existence. Create...
-      related_pipe = new UDPPipe(this, cli_addr.sin_addr.s_addr, cli_addr.sin_port);
-      if (_pipe_strategy) related_pipe->setPipeStrategy(_pipe_strategy);
-
-      if (MEM_MGMT_RESPONSIBLE_BEARER == ((BufferPipe*)related_pipe)->fromCounterparty(buf, n, MEM_MGMT_RESPONSIBLE_BEARER)) {
-        // The pipe copied the buffer. Success.
-        // Since we don't have a pipe, we create one and realize that there will
-        //   be nothing on the other side to take the buffer. So we only broadcast
-        //   a system-wide message if mem-mgmt responsibility for the buffer was
-        //   accepted by the bearer.
-        _open_replies[cli_addr.sin_port] = related_pipe;
-        ManuvrMsg* event = Kernel::returnEvent(MANUVR_MSG_XPORT_RECEIVE);
-        // Because we allocated the pipe, we must clean it up if it is not taken.
-        event->setOriginator((EventReceiver*) this);
-        //event->addArg(related_pipe);   // Add the newly-minted pipe.
-        // Convey the transport. This is optional, but helps downstream classes
-        //   make choices about binding to the BufferPipe.
-        //event->addArg((ManuvrXport*) this);
-        Kernel::staticRaiseEvent(event);
-      }
-      else {
-        if (getVerbosity() > 2) {
-          local_log.concat("UDPPipe failed to take the buffer. Dropping this created pipe:\n");
-          related_pipe->printDebug(&local_log);
-        }
-        delete related_pipe;
-      }
+  flushLocalLog();
+  return return_value;
+}
+
+
+/**
+* Sends a single received datagram further away.
+*
+* @param  buf   The datagram. Only good until we return.
+* @param  len   Its length.
+* @param  addr  The sender's IP as a network-order 32-bit unsigned.
+* @param  port  The sender's port as a native-order 16-bit unsigned.
+*/
+void ManuvrUDP::_proc_datagram(uint8_t* buf, int len, uint32_t addr, uint16_t port) {
+  if (0 >= len) {
+    return;
+  }
+  bytes_received += len;   // Log the bytes.
+  if (getVerbosity() > 6) {
+    struct in_addr _inet_addr;
+    _inet_addr.s_addr = addr;
+    local_log.concatf("UDP read %d bytes from counterparty (%s).\n", len, (const char*) inet_ntoa(_inet_addr));
+  }
+  bool created = false;
+  pthread_mutex_lock(&_pipe_lock);
+  UDPPipe* related_pipe = _pipes.open(addr, port, millis(), &created);
+  if (nullptr == related_pipe) {
+    // Every pipe we have is persistent. There is nowhere to put this.
+    if (getVerbosity() > 3) local_log.concat("No UDPPipe free for counterparty. Dropping datagram.\n");
+  }
+  else if (created) {
+    // The pipe is findable before it is handed the buffer, since its far
+    //   side may reply before the call returns.
+    if (_pipe_strategy) related_pipe->setPipeStrategy(_pipe_strategy);
+
+    if (MEM_MGMT_RESPONSIBLE_BEARER == ((BufferPipe*)related_pipe)->fromCounterparty(buf, len, MEM_MGMT_RESPONSIBLE_BEARER)) {
+      // The pipe copied the buffer. Success.
+      // Since we don't have a pipe, we create one and realize that there will
+      //   be nothing on the other side to take the buffer. So we only broadcast
+      //   a system-wide message if mem-mgmt responsibility for the buffer was
+      //   accepted by the bearer.
+      ManuvrMsg* event = Kernel::returnEvent(MANUVR_MSG_XPORT_RECEIVE);
+      // Because we allocated the pipe, we must clean it up if it is not taken.
+      event->setOriginator((EventReceiver*) this);
+      //event->addArg(related_pipe);   // Add the newly-minted pipe.
+      // Convey the transport. This is optional, but helps downstream classes
+      //   make choices about binding to the BufferPipe.
+      //event->addArg((ManuvrXport*) this);
+      Kernel::staticRaiseEvent(event);
     }
     else {
-      // We have a related pipe.
-      switch (((BufferPipe*)related_pipe)->fromCounterparty(buf, n, MEM_MGMT_RESPONSIBLE_BEARER)) {
-        case MEM_MGMT_RESPONSIBLE_BEARER:
-          // Success
-          break;
-        case MEM_MGMT_RESPONSIBLE_CREATOR:
-          if (getVerbosity() > 3) local_log.concat("UDPPipe took the buffer, but will probably fail (RESPONSIBLE_CREATOR).\n");
-        case MEM_MGMT_RESPONSIBLE_CALLER:
-        default:
-          break;
-      }
-
-      if (!related_pipe->persistAfterReply()) {
-        if (getVerbosity() > 3) local_log.concat("Attempting orderly cleanup of UDPPipe.\n");
-        delete related_pipe;
+      if (getVerbosity() > 2) {
+        local_log.concat("UDPPipe failed to take the buffer. Dropping this created pipe:\n");
+        related_pipe->printDebug(&local_log);
       }
+      _pipes.close(related_pipe);
     }
-    return_value = 0;
   }
-  flushLocalLog();
-  return return_value;
+  else {
+    // We have a related pipe. It stays open until it goes idle, or its slot
+    //   is needed for someone else.
+    switch (((BufferPipe*)related_pipe)->fromCounterparty(buf, len, MEM_MGMT_RESPONSIBLE_BEARER)) {
+      case MEM_MGMT_RESPONSIBLE_BEARER:
+        // Success
+        break;
+      case MEM_MGMT_RESPONSIBLE_CREATOR:
+        if (getVerbosity() > 3) local_log.concat("UDPPipe took the buffer, but will probably fail (RESPONSIBLE_CREATOR).\n");
+      case MEM_MGMT_RESPONSIBLE_CALLER:
+      default:
+        break;
+    }
+  }
+  pthread_mutex_unlock(&_pipe_lock);
 }
 
 
@@ -374,10 +449,9 @@ int8_t ManuvrUDP::read_port() {
 */
 int8_t ManuvrUDP::reset() {
   initialized(false);
-	std::map<uint16_t, UDPPipe*>::iterator it;
-	for (it = _open_replies.begin(); it != _open_replies.end(); it++) {
-    delete it->second;
-	}
+  pthread_mutex_lock(&_pipe_lock);
+  _pipes.clear();
+  pthread_mutex_unlock(&_pipe_lock);
 
   disconnect();
 
@@ -395,9 +469,14 @@ bool ManuvrUDP::write_port(unsigned char* out, int out_len) {
 
 
 /**
-* Does what it claims to do on linux.
+* Queues a datagram. Queued datagrams leave together, with one sendmmsg(), the
+*   next time the Kernel services _tx_flush, which is raised by the
+*   first datagram to be queued. A full queue is flushed right away.
+* A datagram larger than the MTU can't be queued. It goes out on its own, after
+*   whatever is already queued.
+* Replies come back to our own socket, and are read by the SocketReactor.
 *
-* @param  out     The buffer to send.
+* @param  out     The buffer to send. It is copied.
 * @param  out_len The size of the buffer.
 * @param  addr    The target IP as a network-order 32-bit unsigned.
 * @param  port    The target port as a native-order 16-bit unsigned.
@@ -405,47 +484,101 @@ bool ManuvrUDP::write_port(unsigned char* out, int out_len) {
 * @return false on error and true on success.
 */
 bool ManuvrUDP::write_datagram(unsigned char* out, int out_len, uint32_t addr, int port, uint32_t opts) {
-  struct sockaddr_in _tmp_sockaddr;
   bool return_value = false;
+  bool raise_flush  = false;
+  bool oversize     = (out_len > (int) _xport_mtu);
 
-  int _client_sock = socket(PF_INET, SOCK_DGRAM, 0);
-
-  _tmp_sockaddr.sin_family      = AF_INET;
-  _tmp_sockaddr.sin_port        = htons(port);
-  _tmp_sockaddr.sin_addr.s_addr = addr;
-  memset(_tmp_sockaddr.sin_zero, '\0', sizeof(_tmp_sockaddr.sin_zero));
+  if (0 != _open_socket()) {
+    if (getVerbosity() > 3) Kernel::log("Failed to write a UDP datagram. No socket.\n");
+    return false;
+  }
 
-  if (-1 != _client_sock) {
-    int result = sendto(_client_sock, out, out_len, 0, (const sockaddr*) &_tmp_sockaddr, sizeof(_tmp_sockaddr));
+  pthread_mutex_lock(&_tx_lock);
+  if ((MANUVR_UDP_MMSG_BATCH == _tx.count) || oversize) {
+    _flush_datagrams();
+  }
+  if (oversize) {
+    struct sockaddr_in _tmp_sockaddr;
+    memset(&_tmp_sockaddr, 0, sizeof(_tmp_sockaddr));
+    _tmp_sockaddr.sin_family      = AF_INET;
+    _tmp_sockaddr.sin_port        = htons(port);
+    _tmp_sockaddr.sin_addr.s_addr = addr;
+    int result = sendto(getSockID(), out, out_len, MSG_DONTWAIT, (const sockaddr*) &_tmp_sockaddr, sizeof(_tmp_sockaddr));
     if (-1 < result) {
       bytes_sent += result;
-
-      UDPPipe* related_pipe = _open_replies[_tmp_sockaddr.sin_port];
-      if (nullptr == related_pipe) {
-        // Non-existence. Create...
-        related_pipe = new UDPPipe(this, _tmp_sockaddr.sin_addr.s_addr, _tmp_sockaddr.sin_port);
-        _open_replies[_tmp_sockaddr.sin_port] = related_pipe;
-      }
-
-      // TODO: We must receive from the socket before we can send again...
-      char buffer[_xport_mtu];
-      buffer[0] = '\0';
-      int _rec_bytes = recvfrom(_client_sock, buffer, _xport_mtu, 0, nullptr, nullptr);
-      Kernel::log(buffer);
+      _tx_calls++;
+      _tx_datagrams++;
       return_value = true;
     }
     else {
-      if (getVerbosity() > 3) Kernel::log("Failed to write a UDP datagram because of sentto().\n");
+      _tx_dropped++;
+      if (getVerbosity() > 3) Kernel::log("Failed to write a UDP datagram because of sendto().\n");
     }
   }
   else {
-    if (getVerbosity() > 3) Kernel::log("Failed to write a UDP datagram. No client socket.\n");
+    int i = _tx.count++;
+    memcpy(_tx.iov[i].iov_base, out, out_len);
+    _tx.iov[i].iov_len           = out_len;
+    _tx.addrs[i].sin_family      = AF_INET;
+    _tx.addrs[i].sin_port        = htons(port);
+    _tx.addrs[i].sin_addr.s_addr = addr;
+    raise_flush = !_tx_flush_pending;
+    _tx_flush_pending = true;
+    return_value = true;
+  }
+  pthread_mutex_unlock(&_tx_lock);
+
+  if (raise_flush) {
+    int8_t raised = raiseEvent(&_tx_flush);
+    if ((0 != raised) && (-3 != raised)) {
+      // The Kernel refused the flush (-3 would mean it was already queued,
+      //   which is as good), and nothing else will send what we just queued.
+      //   So we send it now.
+      pthread_mutex_lock(&_tx_lock);
+      _tx_flush_pending = false;
+      _flush_datagrams();
+      pthread_mutex_unlock(&_tx_lock);
+    }
   }
 
+  if (return_value) {
+    // Replies will come back to whichever pipe speaks for this counterparty.
+    bool created = false;
+    pthread_mutex_lock(&_pipe_lock);
+    _pipes.open(addr, (uint16_t) port, millis(), &created);
+    pthread_mutex_unlock(&_pipe_lock);
+  }
   return return_value;
 }
 
 
+/**
+* Hands everything queued to the network stack, as few calls as it will take.
+*   Whatever it refuses is dropped, as UDP would have done further on anyway.
+* Must be called with _tx_lock held.
+*/
+void ManuvrUDP::_flush_datagrams() {
+  int sent = 0;
+  while (sent < _tx.count) {
+    int n = sendmmsg(getSockID(), &_tx.msgs[sent], _tx.count - sent, MSG_DONTWAIT);
+    if (0 >= n) {
+      if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (getVerbosity() > 3)) {
+        local_log.concat("Failed to write UDP datagrams because of sendmmsg().\n");
+      }
+      _tx_dropped += (_tx.count - sent);
+      break;
+    }
+    for (int i = sent; i < (sent + n); i++) {
+      bytes_sent += _tx.msgs[i].msg_len;
+    }
+    _tx_calls++;
+    _tx_datagrams += n;
+    sent += n;
+  }
+  _tx.count = 0;
+}
+
+
 /**
 * UDP pipes call this during their destructors to cause the
 *   issuing class to clean up references.
@@ -456,7 +589,9 @@ bool ManuvrUDP::write_datagram(unsigned char* out, int out_len, uint32_t addr, i
 * @return A declaration of memory-management responsibility.
 */
 int8_t ManuvrUDP::udpPipeDestroyCallback(UDPPipe* _dead_walking) {
-  _open_replies.erase(_dead_walking->getPort());
+  pthread_mutex_lock(&_pipe_lock);
+  _pipes.forget(_dead_walking);
+  pthread_mutex_unlock(&_pipe_lock);
   return 0;
 }
 
@@ -484,12 +619,11 @@ int8_t ManuvrUDP::attached() {
   if (EventReceiver::attached()) {
     // Because this is not a stream-oriented transport, the timeout value is used
     //   to periodically flush our connection cache.
-    read_abort_event.alterScheduleRecurrence(0);
-    read_abort_event.alterSchedulePeriod(300);
+    read_abort_event.alterScheduleRecurrence(-1);
+    read_abort_event.alterSchedulePeriod(MANUVR_UDP_PIPE_SWEEP_MS);
     read_abort_event.autoClear(false);
-    read_abort_event.enableSchedule(false);
-    read_abort_event.enableSchedule(false);
-    //platform.kernel()->addSchedule(&read_abort_event);
+    read_abort_event.enableSchedule(true);
+    platform.kernel()->addSchedule(&read_abort_event);
     listen();
     return 1;
   }
@@ -508,12 +642,14 @@ void ManuvrUDP::printDebug(StringBuilder* output) {
   output->concatf("-- _addr           %s:%d\n",  _addr, _port_number);
   output->concatf("-- _options        0x%08x\n", _options);
   output->concatf("-- _sock           0x%08x\n", _sock);
-
-  output->concatf("--\n-- _open_replies \n");
-  std::map<uint16_t, UDPPipe*>::iterator it;
-	for (it = _open_replies.begin(); it != _open_replies.end(); it++) {
-		it->second->printDebug(output);
-	}
+  output->concatf("-- RX              %u datagrams in %u calls (%.2f per call)\n", _rx_datagrams, _rx_calls, (_rx_calls ? ((double) _rx_datagrams / _rx_calls) : (double) 0));
+  output->concatf("-- TX              %u datagrams in %u calls (%.2f per call), %u dropped\n", _tx_datagrams, _tx_calls, (_tx_calls ? ((double) _tx_datagrams / _tx_calls) : (double) 0), _tx_dropped);
+  SocketReactor::printDebug(output);
+
+  output->concat("--\n");
+  pthread_mutex_lock(&_pipe_lock);
+  _pipes.printDebug(output);
+  pthread_mutex_unlock(&_pipe_lock);
   output->concat("\n");
 }
 
@@ -549,9 +685,10 @@ int8_t ManuvrUDP::callback_proc(ManuvrMsg* event) {
           case TCode::BUFFERPIPE:
             // The pipe was NOT taken. Clean it up.
             if (0 == event->getArgAs(&tmp_pipe)) {
-              // We rely on the UDPPipe to call us back to trigger a cleanup of
-              //   the entry in _open_replies.
-              delete (UDPPipe*) tmp_pipe;  // TODO: Any safer way?
+              // The pipe came from our pool. Give it back.
+              pthread_mutex_lock(&_pipe_lock);
+              _pipes.close((UDPPipe*) tmp_pipe);
+              pthread_mutex_unlock(&_pipe_lock);
             }
             break;
           case TCode::SYS_MANUVR_XPORT:
@@ -574,6 +711,26 @@ int8_t ManuvrUDP::notify(ManuvrMsg* active_event) {
   int8_t return_value = 0;
 
   switch (active_event->eventCode()) {
+    case MANUVR_MSG_XPORT_QUEUE_RDY:
+      if (&read_abort_event == active_event) {
+        // Periodic. Recycle pipes whose counterparties have gone quiet.
+        pthread_mutex_lock(&_pipe_lock);
+        int evicted = _pipes.evictIdle(millis(), MANUVR_UDP_PIPE_IDLE_MS);
+        pthread_mutex_unlock(&_pipe_lock);
+        if ((evicted > 0) && (getVerbosity() > 5)) {
+          local_log.concatf("%s recycled %d idle UDPPipes.\n", getReceiverName(), evicted);
+        }
+      }
+      else {
+        // Once per Kernel loop, at most. Everything queued since goes in one go.
+        pthread_mutex_lock(&_tx_lock);
+        _tx_flush_pending = false;
+        _flush_datagrams();
+        pthread_mutex_unlock(&_tx_lock);
+      }
+      return_value++;
+      break;
+
     case MANUVR_MSG_XPORT_DEBUG:
       printDebug(&local_log);
       return_value++;
@@ -75,8 +75,44 @@ This is basically only for linux until it is needed in a smaller space.
 
 #define MANUVR_UDP_FLAG_PERSIST       0x01  // Keep this pipe alive until explicit close.
 
+// How many datagrams may move in a single recvmmsg() or sendmmsg()?
+#ifndef MANUVR_UDP_MMSG_BATCH
+  #define MANUVR_UDP_MMSG_BATCH  32
+#endif
+
+// How many counterparties may we hold a UDPPipe for at once? Past this, the
+//   least-recently-used pipe is recycled.
+#ifndef MANUVR_UDP_MAX_PIPES
+  #define MANUVR_UDP_MAX_PIPES  64
+#endif
+
+// How long may a UDPPipe sit unused before it is recycled? Persistent pipes are exempt.
+#ifndef MANUVR_UDP_PIPE_IDLE_MS
+  #define MANUVR_UDP_PIPE_IDLE_MS  30000
+#endif
+
+// How often do we look for idle UDPPipes?
+#ifndef MANUVR_UDP_PIPE_SWEEP_MS
+  #define MANUVR_UDP_PIPE_SWEEP_MS  1000
+#endif
+
 class ManuvrUDP;
 
+#if defined(__MANUVR_LINUX)
+/*
+* One direction's worth of datagrams, for a single recvmmsg() or sendmmsg().
+*   The headers are wired to their slots of the pool once, when the pool is
+*   allocated. Each slot of the pool is one MTU.
+*/
+typedef struct udp_batch_t {
+  struct mmsghdr     msgs[MANUVR_UDP_MMSG_BATCH];
+  struct iovec       iov[MANUVR_UDP_MMSG_BATCH];
+  struct sockaddr_in addrs[MANUVR_UDP_MMSG_BATCH];
+  uint8_t*           pool;
+  int                count;   // How many slots are filled? Only used for TX.
+} UDPBatch;
+#endif
+
 /*
 * We use this to track packets and replies so that addressing information does
 *   not need to leave the class, thereby damaging the abstraction.
@@ -102,7 +138,8 @@ class UDPPipe : public BufferPipe {
       _udpflags = (en) ? (_udpflags | MANUVR_UDP_FLAG_PERSIST) : (_udpflags & ~(MANUVR_UDP_FLAG_PERSIST));
     };
 
-    inline uint16_t getPort() {   return _port;   };
+    inline uint16_t getPort() {      return _port;   };
+    inline uint32_t getAddress() {   return _ip;     };
 
 
   protected:
@@ -110,11 +147,84 @@ class UDPPipe : public BufferPipe {
 
 
   private:
+    friend class UDPPipeTable;
+
     ManuvrUDP*    _udp;
     uint32_t      _ip;
     uint16_t      _port;
     uint16_t      _udpflags;
+    int16_t       _slot = -1;     // Our place in a UDPPipeTable, if we came from one.
     StringBuilder _accumulator;   // Holds an incoming packet prior to setFar().
+
+    void _bind(ManuvrUDP*, uint32_t, uint16_t);
+    void _unbind();
+};
+
+
+/*
+* The UDPPipes of a ManuvrUDP, one per counterparty, keyed by (address, port).
+*
+* Pipes are allocated once, up front, and recycled. When every one of them is
+*   in use, opening another recycles the least-recently-used pipe that isn't
+*   persistent. Pipes that go unused for a while can also be recycled with
+*   evictIdle(). So memory is bounded no matter how many counterparties come
+*   and go.
+*
+* The index is open-addressed and linearly probed, a power of two in size, and
+*   at most half full. It holds pool slots, and removal shifts entries back
+*   rather than leaving tombstones. Recency is a doubly-linked list threaded
+*   through the pool slots. Every operation but evictIdle() is O(1).
+*
+* Nothing here locks.
+*/
+class UDPPipeTable {
+  public:
+    UDPPipeTable(ManuvrUDP*, int capacity);
+    ~UDPPipeTable();
+
+    UDPPipe* find(uint32_t addr, uint16_t port, uint32_t now);   // nullptr if not open.
+    UDPPipe* open(uint32_t addr, uint16_t port, uint32_t now, bool* created);
+    int8_t   close(UDPPipe*);          // Returns the pipe to the pool.
+    int8_t   forget(UDPPipe*);         // For a pipe being deleted by someone else.
+    int      evictIdle(uint32_t now, uint32_t idle_ms);
+    void     clear();
+
+    void printDebug(StringBuilder*);
+
+    inline int count() {      return _count;      };
+    inline int capacity() {   return _capacity;   };
+
+    /* Counters. */
+    uint32_t opened       = 0;   // Pipes handed to new counterparties.
+    uint32_t evicted_lru  = 0;   // Pipes recycled to make room.
+    uint32_t evicted_idle = 0;   // Pipes recycled for lack of use.
+
+
+  private:
+    ManuvrUDP* _udp;
+    UDPPipe**  _pipes;     // The pool. A null slot was deleted out from under us.
+    uint32_t*  _last;      // When each slot was last used.
+    int16_t*   _prev;      // Toward the most-recently-used end.
+    int16_t*   _next;      // Toward the least-recently-used end.
+    int16_t*   _free;      // A stack of unused slots.
+    int16_t*   _index;     // Open-addressed. -1 is empty.
+    uint32_t   _mask;      // For the index.
+    int        _capacity;
+    int        _count;
+    int        _free_count;
+    int16_t    _mru;       // The most-recently-used slot, or -1.
+    int16_t    _lru;       // The least-recently-used slot, or -1.
+
+    static inline uint32_t _hash(uint32_t addr, uint16_t port) {
+      uint32_t h = (addr ^ (((uint32_t) port) << 16) ^ port) * 2654435761u;
+      return (h ^ (h >> 15));
+    };
+
+    int  _probe(uint32_t addr, uint16_t port);   // Index position, or -1.
+    void _unindex(int pos);
+    void _unlink(int16_t slot);
+    void _link_mru(int16_t slot);
+    void _retire(int16_t slot);
 };
 
 
@@ -148,6 +258,12 @@ class ManuvrUDP : public ManuvrSocket {
       return write_datagram(out, out_len, inet_addr(addr), port, 0);
     };
 
+    /* How well are the syscalls being amortized? */
+    inline uint32_t rxCalls() {       return _rx_calls;       };
+    inline uint32_t rxDatagrams() {   return _rx_datagrams;   };
+    inline uint32_t txCalls() {       return _tx_calls;       };
+    inline uint32_t txDatagrams() {   return _tx_datagrams;   };
+
     /* Overrides from EventReceiver */
     int8_t notify(ManuvrMsg*);
     int8_t callback_proc(ManuvrMsg*);
@@ -163,8 +279,29 @@ class ManuvrUDP : public ManuvrSocket {
 
 
   private:
-    // We index our spawned UDPPipes by counterparty port number.
-    std::map<uint16_t, UDPPipe*> _open_replies;
+    UDPPipeTable _pipes;      // Our UDPPipes, by counterparty.
+    ManuvrMsg    _tx_flush;   // Raised by the first datagram queued for output.
+
+    uint32_t _rx_calls     = 0;   // recvmmsg() calls that returned datagrams.
+    uint32_t _rx_datagrams = 0;
+    uint32_t _tx_calls     = 0;   // sendmmsg() and sendto() calls that sent something.
+    uint32_t _tx_datagrams = 0;
+    uint32_t _tx_dropped   = 0;   // Datagrams the network stack wouldn't take.
+
+    #if defined(__MANUVR_LINUX)
+      UDPBatch        _rx;
+      UDPBatch        _tx;
+      bool            _tx_flush_pending = false;   // Is _tx_flush on its way?
+      pthread_mutex_t _tx_lock;
+      pthread_mutex_t _pipe_lock;   // Guards _pipes. Recursive, since pipes reply from inside a dispatch.
+
+      int8_t _batch_init();
+      void   _flush_datagrams();
+    #endif
+
+    void   _udp_init();
+    void   _proc_datagram(uint8_t* buf, int len, uint32_t addr, uint16_t port);
+    int8_t _open_socket();
 };
 
 
@@ -0,0 +1,243 @@
+/*
+File:   SocketReactor.cpp
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+The epoll reactor that drives ManuvrSocket i/o on linux.
+*/
+
+#if defined(MANUVR_SUPPORT_TCPSOCKET) | defined(MANUVR_SUPPORT_UDP)
+
+#include "ManuvrSocket.h"
+#include "SocketReactor.h"
+
+#include <Kernel.h>
+#include <Platform/Platform.h>
+
+#if defined(__MANUVR_LINUX)
+  #include <sys/epoll.h>
+  #include <signal.h>
+
+
+/*******************************************************************************
+*      _______.___________.    ___   .___________. __    ______     _______.
+*     /       |           |   /   \  |           ||  |  /      |   /       |
+*    |   (----`---|  |----`  /  ^  \ `---|  |----`|  | |  ,----'  |   (----`
+*     \   \       |  |      /  /_\  \    |  |     |  | |  |        \   \
+* .----)   |      |  |     /  _____  \   |  |     |  | |  `----.----)   |
+* |_______/       |__|    /__/     \__\  |__|     |__|  \______|_______/
+*
+* Static members and initializers should be located here.
+*******************************************************************************/
+int            SocketReactor::_epoll_fd   = -1;
+unsigned long  SocketReactor::_thread_id  = 0;
+ManuvrSocket** SocketReactor::_table      = nullptr;
+int            SocketReactor::_table_size = 0;
+int            SocketReactor::_count      = 0;
+uint32_t       SocketReactor::_waits      = 0;
+uint32_t       SocketReactor::_dispatches = 0;
+
+// Recursive, because a socket's read_port() may remove that same socket from
+//   the reactor (on hangup) while we are dispatching to it.
+#if defined (PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP)
+pthread_mutex_t SocketReactor::_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+#else
+pthread_mutex_t SocketReactor::_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER;
+#endif
+
+
+/**
+* The reactor thread. Waits on every registered socket at once, and dispatches
+*   readiness to the sockets in question.
+*/
+void* SocketReactor::_reactor_loop(void*) {
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGQUIT);
+  sigaddset(&set, SIGHUP);
+  sigaddset(&set, SIGTERM);
+  sigaddset(&set, SIGVTALRM);
+  sigaddset(&set, SIGINT);
+  if (0 != pthread_sigmask(SIG_BLOCK, &set, nullptr)) {
+    Kernel::log("SocketReactor failed to mask signals.\n");
+    return nullptr;
+  }
+
+  struct epoll_event events[SOCKET_REACTOR_EVENTS_PER_WAIT];
+  while (true) {
+    int n = epoll_wait(_epoll_fd, events, SOCKET_REACTOR_EVENTS_PER_WAIT, -1);
+    if (n <= 0) continue;   // Probably EINTR.
+    _waits++;
+    for (int i = 0; i < n; i++) {
+      int fd = events[i].data.fd;
+      pthread_mutex_lock(&_lock);
+      ManuvrSocket* sock = (fd < _table_size) ? _table[fd] : nullptr;
+      if (nullptr != sock) {
+        _dispatches++;
+        if (events[i].events & EPOLLOUT) {
+          sock->_flush_tx();
+        }
+        // The flush may have ended the socket. Check again.
+        if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && (_table[fd] == sock)) {
+          sock->read_port();
+        }
+      }
+      pthread_mutex_unlock(&_lock);
+    }
+  }
+  return nullptr;
+}
+
+
+/**
+* Creates the epoll instance and the thread that waits on it. Called lazily by
+*   the first socket to register.
+*
+* @return 0 on success, or -1 on failure.
+*/
+int8_t SocketReactor::_start() {
+  if (0 > _epoll_fd) {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (0 > _epoll_fd) {
+      Kernel::log("SocketReactor failed to create an epoll instance.\n");
+      return -1;
+    }
+    if (createThread(&_thread_id, nullptr, _reactor_loop, nullptr)) {
+      Kernel::log("SocketReactor failed to create its thread.\n");
+      close(_epoll_fd);
+      _epoll_fd = -1;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+
+/**
+* Makes the given socket non-blocking, and starts watching it for reads.
+*
+* @param  sock  The socket to service. Must already have an fd.
+* @return 0 on success, -1 on bad argument, -2 if already present, -3 on failure.
+*/
+int8_t SocketReactor::add(ManuvrSocket* sock) {
+  if ((nullptr == sock) || (0 >= sock->getSockID())) return -1;
+  int8_t return_value = -3;
+  int fd = sock->getSockID();
+  pthread_mutex_lock(&_lock);
+  if (0 == _start()) {
+    if ((fd < _table_size) && (nullptr != _table[fd])) {
+      return_value = -2;
+    }
+    else {
+      if (fd >= _table_size) {
+        // Grow the table to cover this fd.
+        int nu_size = (_table_size) ? _table_size : 64;
+        while (nu_size <= fd) nu_size <<= 1;
+        ManuvrSocket** nu_table = (ManuvrSocket**) realloc(_table, nu_size * sizeof(ManuvrSocket*));
+        if (nullptr != nu_table) {
+          for (int i = _table_size; i < nu_size; i++) nu_table[i] = nullptr;
+          _table      = nu_table;
+          _table_size = nu_size;
+        }
+      }
+      if (fd < _table_size) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        struct epoll_event ev;
+        ev.events  = EPOLLIN;
+        ev.data.u64 = 0;
+        ev.data.fd = fd;
+        if (0 == epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev)) {
+          _table[fd] = sock;
+          _count++;
+          return_value = 0;
+        }
+      }
+    }
+  }
+  pthread_mutex_unlock(&_lock);
+  return return_value;
+}
+
+
+/**
+* Stops watching the given socket. Once this returns, the reactor will not touch
+*   the socket again.
+*
+* @param  sock  The socket to forget.
+* @return 0 on success, or -1 if the socket wasn't present.
+*/
+int8_t SocketReactor::remove(ManuvrSocket* sock) {
+  if ((nullptr == sock) || (0 >= sock->getSockID())) return -1;
+  int8_t return_value = -1;
+  int fd = sock->getSockID();
+  pthread_mutex_lock(&_lock);
+  if ((fd < _table_size) && (_table[fd] == sock)) {
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    _table[fd] = nullptr;
+    _count--;
+    return_value = 0;
+  }
+  pthread_mutex_unlock(&_lock);
+  return return_value;
+}
+
+
+/**
+* Sockets with backed-up output call this to be told when they can write again.
+* This is often called from inside a dispatch, which is fine, since the lock is
+*   recursive. Taking it keeps us from modifying a socket that remove() is
+*   tearing down on another thread, or one that was never added.
+* Callers must not hold the socket's _tx_lock, since a dispatch takes our lock
+*   first, and then that one.
+*
+* @param  sock  The socket in question.
+* @param  en    True to watch for writability as well as reads.
+* @return 0 on success, or -1 on failure.
+*/
+int8_t SocketReactor::wantWrite(ManuvrSocket* sock, bool en) {
+  if ((nullptr == sock) || (0 >= sock->getSockID()) || (0 > _epoll_fd)) return -1;
+  struct epoll_event ev;
+  ev.events   = EPOLLIN | (en ? EPOLLOUT : 0);
+  ev.data.u64 = 0;
+  ev.data.fd  = sock->getSockID();
+  int8_t return_value = -1;
+  pthread_mutex_lock(&_lock);
+  if ((ev.data.fd < _table_size) && (_table[ev.data.fd] == sock)) {
+    return_value = (0 == epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, ev.data.fd, &ev)) ? 0 : -1;
+  }
+  pthread_mutex_unlock(&_lock);
+  return return_value;
+}
+
+
+/**
+* Debug support function.
+*
+* @param A pointer to a StringBuffer object to receive the output.
+*/
+void SocketReactor::printDebug(StringBuilder* output) {
+  output->concatf("-- SocketReactor     %s\n", (0 > _epoll_fd) ? "(not started)" : "");
+  output->concatf("--   sockets         %d\n", _count);
+  output->concatf("--   waits           %u\n", _waits);
+  output->concatf("--   dispatches      %u\n", _dispatches);
+}
+
+#else   //Unsupportedness
+#endif  // __LINUX
+
+#endif  // Socket support?
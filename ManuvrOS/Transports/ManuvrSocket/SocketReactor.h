@@ -0,0 +1,81 @@
+/*
+File:   SocketReactor.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+This is the one thread that services every ManuvrSocket in the system. Sockets
+  are non-blocking, and register their fds with an epoll instance. When a
+  socket becomes readable, the reactor calls its read_port(). When a socket
+  has outbound data that the network stack wouldn't take all at once, it asks
+  for write-readiness, and the reactor flushes it when there is room.
+
+Previously, every socket (and every listener) had its own thread doing blocking
+  reads. Now the thread count is fixed, no matter how many peers there are.
+
+Readiness events carry the fd, not the socket. The reactor looks the socket up
+  in its own table under lock, so that an event collected for a socket that has
+  since been removed is discarded rather than dispatched to a dead object.
+*/
+
+
+#ifndef __MANUVR_SOCKET_REACTOR_H__
+#define __MANUVR_SOCKET_REACTOR_H__
+
+#include <inttypes.h>
+
+#if defined(__MANUVR_LINUX)
+  #include <pthread.h>
+#endif
+
+// How many readiness events will we take from the kernel in one wait?
+#ifndef SOCKET_REACTOR_EVENTS_PER_WAIT
+  #define SOCKET_REACTOR_EVENTS_PER_WAIT  64
+#endif
+
+class ManuvrSocket;
+class StringBuilder;
+
+class SocketReactor {
+  public:
+    static int8_t add(ManuvrSocket*);               // Start servicing a socket.
+    static int8_t remove(ManuvrSocket*);            // Stop servicing a socket. Call before close().
+    static int8_t wantWrite(ManuvrSocket*, bool);   // Ask (or stop asking) for write-readiness.
+
+    static void printDebug(StringBuilder*);
+
+    inline static int sockets() {    return _count;   };
+
+
+  private:
+    static int            _epoll_fd;
+    static unsigned long  _thread_id;
+    static ManuvrSocket** _table;        // Indexed by fd.
+    static int            _table_size;
+    static int            _count;
+    static uint32_t       _waits;        // How many times did epoll_wait() return with work?
+    static uint32_t       _dispatches;   // How many readiness events did we act on?
+
+    #if defined(__MANUVR_LINUX)
+      static pthread_mutex_t _lock;      // Guards _table. Recursive.
+    #endif
+
+    static int8_t _start();
+    static void*  _reactor_loop(void*);
+};
+
+#endif  // __MANUVR_SOCKET_REACTOR_H__
@@ -22,6 +22,8 @@ limitations under the License.
 
 #if defined(MANUVR_SUPPORT_UDP)
 #include "ManuvrUDP.h"
+#include <stdlib.h>
+#include <string.h>
 
 /*******************************************************************************
 *      _______.___________.    ___   .___________. __    ______     _______.
@@ -195,4 +197,319 @@ int UDPPipe::takeAccumulator(StringBuilder* target) {
   return return_value;
 }
 
+
+/*
+* Readies a pooled pipe for a new counterparty.
+*/
+void UDPPipe::_bind(ManuvrUDP* udp, uint32_t ip, uint16_t port) {
+  _udp  = udp;
+  _ip   = ip;
+  _port = port;
+}
+
+
+/*
+* Ends a pooled pipe's conversation, as our destructor would have, but leaves
+*   the pipe to be used again. A far side that we spawned is torn down.
+*/
+void UDPPipe::_unbind() {
+  detachFar();
+  setPipeStrategy(nullptr);
+  _accumulator.clear();
+  _udpflags = 0;
+  _ip       = 0;
+  _port     = 0;
+}
+
+
+
+/*******************************************************************************
+* UDPPipeTable                                                                 *
+*******************************************************************************/
+
+/**
+* Constructor. Allocates every pipe the table will ever hold.
+*
+* @param  udp       The transport the pipes belong to. May be nullptr.
+* @param  capacity  How many pipes. Clamped to [1, 16384].
+*/
+UDPPipeTable::UDPPipeTable(ManuvrUDP* udp, int capacity) {
+  _capacity   = (capacity < 1) ? 1 : ((capacity > 16384) ? 16384 : capacity);
+  _udp        = udp;
+  _count      = 0;
+  _free_count = 0;
+  _mru        = -1;
+  _lru        = -1;
+  unsigned int idx_size = 2;
+  while (idx_size < (unsigned int) (_capacity * 2)) idx_size = idx_size << 1;
+  _mask  = idx_size - 1;
+  _index = (int16_t*) malloc(sizeof(int16_t) * idx_size);
+  _pipes = (UDPPipe**) malloc(sizeof(UDPPipe*) * _capacity);
+  _last  = (uint32_t*) malloc(sizeof(uint32_t) * _capacity);
+  _prev  = (int16_t*) malloc(sizeof(int16_t) * _capacity);
+  _next  = (int16_t*) malloc(sizeof(int16_t) * _capacity);
+  _free  = (int16_t*) malloc(sizeof(int16_t) * _capacity);
+  memset(_index, 0xFF, sizeof(int16_t) * idx_size);
+  for (int i = _capacity - 1; i >= 0; i--) {
+    _pipes[i] = new UDPPipe();
+    _pipes[i]->_slot = (int16_t) i;
+    _last[i] = 0;
+    _prev[i] = -1;
+    _next[i] = -1;
+    _free[_free_count++] = (int16_t) i;
+  }
+}
+
+
+UDPPipeTable::~UDPPipeTable() {
+  for (int i = 0; i < _capacity; i++) {
+    if (nullptr != _pipes[i]) {
+      _pipes[i]->_udp = nullptr;   // No callback into a transport that is going away.
+      delete _pipes[i];
+      _pipes[i] = nullptr;
+    }
+  }
+  free(_index);
+  free(_pipes);
+  free(_last);
+  free(_prev);
+  free(_next);
+  free(_free);
+}
+
+
+/**
+* Looks up the pipe for a counterparty, and marks it as used.
+*
+* @param  addr  The counterparty's IP as a network-order 32-bit unsigned.
+* @param  port  The counterparty's port as a native-order 16-bit unsigned.
+* @param  now   The time.
+* @return The pipe, or nullptr if there isn't one.
+*/
+UDPPipe* UDPPipeTable::find(uint32_t addr, uint16_t port, uint32_t now) {
+  int pos = _probe(addr, port);
+  if (0 > pos) {
+    return nullptr;
+  }
+  int16_t slot = _index[pos];
+  _last[slot] = now;
+  if (_mru != slot) {
+    _unlink(slot);
+    _link_mru(slot);
+  }
+  return _pipes[slot];
+}
+
+
+/**
+* Looks up the pipe for a counterparty, or hands it one from the pool. If the
+*   pool is empty, the least-recently-used pipe that isn't persistent is
+*   recycled for it.
+*
+* @param  addr     The counterparty's IP as a network-order 32-bit unsigned.
+* @param  port     The counterparty's port as a native-order 16-bit unsigned.
+* @param  now      The time.
+* @param  created  Set to true if the pipe is new to this counterparty.
+* @return The pipe, or nullptr if every pipe is persistent (or on OOM).
+*/
+UDPPipe* UDPPipeTable::open(uint32_t addr, uint16_t port, uint32_t now, bool* created) {
+  *created = false;
+  UDPPipe* return_value = find(addr, port, now);
+  if (nullptr != return_value) {
+    return return_value;
+  }
+  if (0 == _free_count) {
+    int16_t victim = _lru;
+    while ((-1 != victim) && _pipes[victim]->persistAfterReply()) {
+      victim = _prev[victim];
+    }
+    if (-1 == victim) {
+      return nullptr;
+    }
+    evicted_lru++;
+    _retire(victim);
+  }
+  int16_t slot = _free[--_free_count];
+  if (nullptr == _pipes[slot]) {
+    // Someone deleted the pipe that was here. Replace it.
+    _pipes[slot] = new UDPPipe();
+    if (nullptr == _pipes[slot]) {
+      _free_count++;
+      return nullptr;
+    }
+    _pipes[slot]->_slot = slot;
+  }
+  return_value = _pipes[slot];
+  return_value->_bind(_udp, addr, port);
+
+  uint32_t pos = _hash(addr, port) & _mask;
+  while (-1 != _index[pos]) pos = (pos + 1) & _mask;
+  _index[pos] = slot;
+  _last[slot] = now;
+  _link_mru(slot);
+  _count++;
+  opened++;
+  *created = true;
+  return return_value;
+}
+
+
+/**
+* Ends a conversation, and returns its pipe to the pool.
+*
+* @param  pipe  The pipe.
+* @return 0 on success, or -1 if the pipe isn't open in this table.
+*/
+int8_t UDPPipeTable::close(UDPPipe* pipe) {
+  if ((nullptr == pipe) || (0 > pipe->_slot) || (pipe->_slot >= _capacity) || (_pipes[pipe->_slot] != pipe)) {
+    return -1;
+  }
+  if (0 > _probe(pipe->_ip, pipe->_port)) {
+    return -1;   // Already in the pool.
+  }
+  _retire(pipe->_slot);
+  return 0;
+}
+
+
+/**
+* Called by a pooled pipe that is being deleted by someone other than us. Its
+*   slot is given a new pipe the next time it is needed.
+*
+* @param  pipe  The pipe.
+* @return 0 on success, or -1 if the pipe isn't ours.
+*/
+int8_t UDPPipeTable::forget(UDPPipe* pipe) {
+  if ((nullptr == pipe) || (0 > pipe->_slot) || (pipe->_slot >= _capacity) || (_pipes[pipe->_slot] != pipe)) {
+    return -1;
+  }
+  int16_t slot = pipe->_slot;
+  int pos = _probe(pipe->_ip, pipe->_port);
+  if (0 <= pos) {
+    _unindex(pos);
+    _unlink(slot);
+    _count--;
+    _free[_free_count++] = slot;
+  }
+  _pipes[slot] = nullptr;
+  return 0;
+}
+
+
+/**
+* Recycles every pipe that isn't persistent, and hasn't been used in a while.
+*   Walks from the least-recently-used end, and stops at the first pipe that
+*   is recent enough.
+*
+* @param  now      The time.
+* @param  idle_ms  How long a pipe may go unused.
+* @return How many pipes were recycled.
+*/
+int UDPPipeTable::evictIdle(uint32_t now, uint32_t idle_ms) {
+  int return_value = 0;
+  int16_t slot = _lru;
+  while ((-1 != slot) && ((now - _last[slot]) >= idle_ms)) {
+    int16_t toward_mru = _prev[slot];
+    if (!_pipes[slot]->persistAfterReply()) {
+      _retire(slot);
+      return_value++;
+    }
+    slot = toward_mru;
+  }
+  evicted_idle += return_value;
+  return return_value;
+}
+
+
+/**
+* Recycles every pipe, persistent or not.
+*/
+void UDPPipeTable::clear() {
+  while (-1 != _lru) {
+    _retire(_lru);
+  }
+}
+
+
+void UDPPipeTable::printDebug(StringBuilder* output) {
+  output->concatf("-- UDPPipes          %d of %d open (index of %u)\n", _count, _capacity, _mask + 1);
+  output->concatf("--   opened %u, recycled %u for room, %u for idleness\n", opened, evicted_lru, evicted_idle);
+  for (int16_t slot = _mru; -1 != slot; slot = _next[slot]) {
+    _pipes[slot]->printDebug(output);
+  }
+}
+
+
+/*
+* @return The index position that holds the given counterparty, or -1.
+*/
+int UDPPipeTable::_probe(uint32_t addr, uint16_t port) {
+  uint32_t pos = _hash(addr, port) & _mask;
+  while (-1 != _index[pos]) {
+    UDPPipe* p = _pipes[_index[pos]];
+    if ((p->_port == port) && (p->_ip == addr)) {
+      return (int) pos;
+    }
+    pos = (pos + 1) & _mask;
+  }
+  return -1;
+}
+
+
+/*
+* Empties an index position, and shifts back whatever followed it in the same
+*   run, so that every entry stays reachable from its home position.
+*/
+void UDPPipeTable::_unindex(int pos) {
+  uint32_t hole = (uint32_t) pos;
+  uint32_t i    = (hole + 1) & _mask;
+  while (-1 != _index[i]) {
+    UDPPipe* p = _pipes[_index[i]];
+    uint32_t home = _hash(p->_ip, p->_port) & _mask;
+    // Can the entry at i move to the hole? Only if its home isn't between them.
+    if (((i - home) & _mask) >= ((i - hole) & _mask)) {
+      _index[hole] = _index[i];
+      hole = i;
+    }
+    i = (i + 1) & _mask;
+  }
+  _index[hole] = -1;
+}
+
+
+void UDPPipeTable::_unlink(int16_t slot) {
+  if (-1 != _prev[slot]) _next[_prev[slot]] = _next[slot];
+  else                   _mru = _next[slot];
+  if (-1 != _next[slot]) _prev[_next[slot]] = _prev[slot];
+  else                   _lru = _prev[slot];
+  _prev[slot] = -1;
+  _next[slot] = -1;
+}
+
+
+void UDPPipeTable::_link_mru(int16_t slot) {
+  _prev[slot] = -1;
+  _next[slot] = _mru;
+  if (-1 != _mru) _prev[_mru] = slot;
+  _mru = slot;
+  if (-1 == _lru) _lru = slot;
+}
+
+
+/*
+* Takes an open slot out of the index and the recency list, ends its pipe's
+*   conversation, and returns it to the free stack.
+*/
+void UDPPipeTable::_retire(int16_t slot) {
+  UDPPipe* p = _pipes[slot];
+  int pos = _probe(p->_ip, p->_port);
+  if (0 <= pos) {
+    _unindex(pos);
+  }
+  _unlink(slot);
+  p->_unbind();
+  _count--;
+  _free[_free_count++] = slot;
+}
+
 #endif //MANUVR_SUPPORT_UDP
@@ -103,6 +103,26 @@ For debuggability, the transport has a special mode for acting as a debug
 #endif
 
 
+/*
+* Extending classes whose notify() handles nothing beyond what ours does can
+*   declare this as their interests.
+*/
+const uint16_t ManuvrXport::_xport_interests[] = {
+  MANUVR_MSG_XPORT_SEND,
+  MANUVR_MSG_XPORT_RECEIVE,
+  MANUVR_MSG_XPORT_QUEUE_RDY,
+  MANUVR_MSG_XPORT_RESERVED_0,
+  MANUVR_MSG_XPORT_RESERVED_1,
+  MANUVR_MSG_XPORT_INIT,
+  MANUVR_MSG_XPORT_RESET,
+  MANUVR_MSG_XPORT_ERROR,
+  MANUVR_MSG_XPORT_CB_QUEUE_RDY,
+  MANUVR_MSG_XPORT_IDENTITY,
+  MANUVR_MSG_XPORT_DEBUG,
+  MANUVR_MSG_UNDEFINED
+};
+
+
 /*******************************************************************************
 *   ___ _              ___      _ _              _      _
 *  / __| |__ _ ______ | _ ) ___(_) |___ _ _ _ __| |__ _| |_ ___
@@ -282,7 +302,7 @@ void ManuvrXport::connected(bool en) {
     if (_autoconnect_schedule) _autoconnect_schedule->enableSchedule(true);
   }
   #if defined (__MANUVR_FREERTOS) | defined (__MANUVR_LINUX)
-    if (0 == _thread_id) {
+    if ((0 == _thread_id) && !nonBlocking()) {
       // If we are in a threaded environment, we will want a thread if there isn't one already.
       if (createThread(&_thread_id, nullptr, xport_read_handler, (void*) this)) {
         Kernel::log("Failed to create transport read thread.\n");
@@ -47,7 +47,7 @@ This driver is designed to give Manuvr platform-abstracted transports.
 #define MANUVR_XPORT_FLAG_LISTENING        0x08000000  // We are listening for connections.
 #define MANUVR_XPORT_FLAG_RESERVED_1       0x04000000  //
 #define MANUVR_XPORT_FLAG_RESERVED_2       0x02000000  //
-#define MANUVR_XPORT_FLAG_RESERVED_0       0x01000000  //
+#define MANUVR_XPORT_FLAG_NON_BLOCKING     0x01000000  // Something else services our reads. Don't thread them.
 #define MANUVR_XPORT_FLAG_ALWAYS_CONNECTED 0x00800000  // Serial ports.
 #define MANUVR_XPORT_FLAG_CONNECTIONLESS   0x00400000  // This transport is "connectionless". See Note0 below.
 #define MANUVR_XPORT_FLAG_HAS_MULTICAST    0x00200000  // This transport supports multicast.
@@ -124,6 +124,9 @@ class ManuvrXport : public EventReceiver, public BufferPipe {
     inline void autoConnect(bool en) {   autoConnect(en, XPORT_DEFAULT_AUTOCONNECT_PERIOD);  };
     void autoConnect(bool en, uint32_t _ac_period);
 
+    /* Are reads driven by something other than a thread of our own? */
+    inline bool nonBlocking() {             return (_xport_flags & MANUVR_XPORT_FLAG_NON_BLOCKING);  };
+
     /* Members that deal with sessions. */
     inline bool streamOriented() {          return (_xport_flags & MANUVR_XPORT_FLAG_STREAM_ORIENTED);  };
 
@@ -144,6 +147,9 @@ class ManuvrXport : public EventReceiver, public BufferPipe {
 
 
   protected:
+    /* The codes that ManuvrXport::notify() handles. For the Kernel's dispatch index. */
+    static const uint16_t _xport_interests[];
+
     uint32_t _xport_mtu;      // The largest packet size we handle.
     uint32_t bytes_sent      = 0;
     uint32_t bytes_received  = 0;
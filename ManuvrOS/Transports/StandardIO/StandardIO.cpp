@@ -64,6 +64,7 @@ StandardIO::StandardIO() : ManuvrXport("StandardIO") {
   read_abort_event.specific_target = (EventReceiver*) this;
   read_abort_event.priority(5);
   _bp_set_flag(BPIPE_FLAG_PIPE_PACKETIZED, true);
+  setInterests(_xport_interests);
   _xport_mtu = 255;
 }
 
@@ -0,0 +1,249 @@
+/*
+File:   MQTTInflight.cpp
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "MQTTInflight.h"
+#include <DataStructures/StringBuilder.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+
+MQTTInflight::MQTTInflight() {
+  memset(_slots, 0, sizeof(_slots));
+  _recv_max = MQTT_MAX_INFLIGHT;
+  _next_id  = 0;
+  _count    = 0;
+}
+
+
+MQTTInflight::~MQTTInflight() {
+  for (int i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    if (nullptr != _slots[i].pkt) {
+      free(_slots[i].pkt);
+      _slots[i].pkt = nullptr;
+    }
+  }
+}
+
+
+/**
+* Forgets every open exchange. Buffers are kept.
+*/
+void MQTTInflight::clear() {
+  for (int i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    _release(&_slots[i]);
+  }
+}
+
+
+/**
+* @param  nu  The most exchanges to have open at once. Clamped to the window.
+*/
+void MQTTInflight::receiveMaximum(uint16_t nu) {
+  if (0 == nu) nu = 1;
+  _recv_max = (nu > MQTT_MAX_INFLIGHT) ? MQTT_MAX_INFLIGHT : nu;
+}
+
+
+/**
+* Ids advance by one, but any whose slot is busy is passed over. If every slot
+*   is busy, the id is handed out anyway, since SUBSCRIBE and UNSUBSCRIBE
+*   need one, but don't need a slot.
+*
+* @return A packet id.
+*/
+uint16_t MQTTInflight::nextPacketId() {
+  for (int i = 0; i < MQTT_MAX_INFLIGHT; i++) {
+    _next_id = (MAX_PACKET_ID == _next_id) ? 1 : _next_id + 1;
+    if (InflightState::FREE == _slot(_next_id)->state) {
+      break;
+    }
+  }
+  return _next_id;
+}
+
+
+/**
+* Opens an exchange for a PUBLISH that is about to be sent.
+*
+* @param  pid   The packet id it was serialized with.
+* @param  qos   1 or 2.
+* @param  pkt   The packet. It is copied.
+* @param  len   Its length.
+* @param  now   The time.
+* @return 0 on success, or -1 if the slot is busy, the packet is bogus, or OOM.
+*/
+int8_t MQTTInflight::track(uint16_t pid, uint8_t qos, const uint8_t* pkt, int len, uint32_t now) {
+  InflightSlot* s = _slot(pid);
+  if ((0 == pid) || (0 == qos) || (qos > 2) || (len < 4) || (InflightState::FREE != s->state)) {
+    return -1;
+  }
+  if (s->cap < len) {
+    uint8_t* nu = (uint8_t*) realloc(s->pkt, len);
+    if (nullptr == nu) {
+      return -1;
+    }
+    s->pkt = nu;
+    s->cap = (uint16_t) len;
+  }
+  memcpy(s->pkt, pkt, len);
+  s->len     = (uint16_t) len;
+  s->pid     = pid;
+  s->retries = 0;
+  s->sent_at = now;
+  s->state   = (1 == qos) ? InflightState::PUBACK_WAIT : InflightState::PUBREC_WAIT;
+  _count++;
+  return 0;
+}
+
+
+/**
+* QoS1 is done.
+*
+* @return 0 on success, or -1 if nothing was waiting on it.
+*/
+int8_t MQTTInflight::puback(uint16_t pid) {
+  InflightSlot* s = _open(pid, InflightState::PUBACK_WAIT);
+  if (nullptr == s) {
+    stray++;
+    return -1;
+  }
+  completed++;
+  _release(s);
+  return 0;
+}
+
+
+/**
+* QoS2 is half done. The slot's packet becomes the PUBREL, which the caller
+*   should now fetch with packet() and send. A repeated PUBREC means our
+*   PUBREL was lost, and it is answered the same way.
+*
+* @return 0 if a PUBREL should be sent, or -1 if nothing was waiting on it.
+*/
+int8_t MQTTInflight::pubrec(uint16_t pid, uint32_t now) {
+  InflightSlot* s = _open(pid, InflightState::PUBREC_WAIT);
+  if (nullptr != s) {
+    // The PUBLISH was at least a header, a length, a topic length, and an id.
+    s->pkt[0]  = 0x62;   // PUBREL, with its mandatory flags.
+    s->pkt[1]  = 0x02;
+    s->pkt[2]  = (uint8_t) (pid >> 8);
+    s->pkt[3]  = (uint8_t) (pid & 0xFF);
+    s->len     = 4;
+    s->retries = 0;
+    s->sent_at = now;
+    s->state   = InflightState::PUBCOMP_WAIT;
+    return 0;
+  }
+  if (nullptr != _open(pid, InflightState::PUBCOMP_WAIT)) {
+    return 0;
+  }
+  stray++;
+  return -1;
+}
+
+
+/**
+* QoS2 is done.
+*
+* @return 0 on success, or -1 if nothing was waiting on it.
+*/
+int8_t MQTTInflight::pubcomp(uint16_t pid) {
+  InflightSlot* s = _open(pid, InflightState::PUBCOMP_WAIT);
+  if (nullptr == s) {
+    stray++;
+    return -1;
+  }
+  completed++;
+  _release(s);
+  return 0;
+}
+
+
+/**
+* Collects the exchanges whose packets are due to be sent again, and marks
+*   them as sent. Exchanges that are out of retries are abandoned instead.
+*
+* @param  now   The time.
+* @param  pids  Filled with the ids to send again. Fetch each with packet().
+* @param  max   The most that pids can take. The rest wait for the next call.
+* @return How many ids were written.
+*/
+int MQTTInflight::expired(uint32_t now, uint16_t* pids, int max) {
+  int n = 0;
+  for (int i = 0; (i < MQTT_MAX_INFLIGHT) && (n < max) && (0 < _count); i++) {
+    InflightSlot* s = &_slots[i];
+    if ((InflightState::FREE != s->state) && ((now - s->sent_at) >= retry_ms)) {
+      if (s->retries >= max_retries) {
+        abandoned++;
+        _release(s);
+      }
+      else {
+        if (InflightState::PUBCOMP_WAIT != s->state) {
+          s->pkt[0] |= 0x08;   // DUP
+        }
+        s->retries++;
+        s->sent_at = now;
+        retransmits++;
+        pids[n++] = s->pid;
+      }
+    }
+  }
+  return n;
+}
+
+
+/**
+* @param  pid  The packet id.
+* @param  len  Set to the packet's length.
+* @return The packet as it should next be sent, or nullptr if pid isn't open.
+*/
+const uint8_t* MQTTInflight::packet(uint16_t pid, int* len) {
+  InflightSlot* s = _slot(pid);
+  if ((InflightState::FREE == s->state) || (pid != s->pid)) {
+    return nullptr;
+  }
+  *len = s->len;
+  return s->pkt;
+}
+
+
+void MQTTInflight::printDebug(StringBuilder* output) {
+  output->concatf("-- Inflight             %d of %u (window %d)\n", _count, _recv_max, MQTT_MAX_INFLIGHT);
+  output->concatf("-- Completed %u, retransmitted %u, abandoned %u, stray acks %u\n", completed, retransmits, abandoned, stray);
+}
+
+
+/*
+* The one and only lookup.
+*/
+InflightSlot* MQTTInflight::_open(uint16_t pid, InflightState state) {
+  InflightSlot* s = _slot(pid);
+  return ((state == s->state) && (pid == s->pid)) ? s : nullptr;
+}
+
+
+void MQTTInflight::_release(InflightSlot* s) {
+  if (InflightState::FREE != s->state) {
+    s->state = InflightState::FREE;
+    _count--;
+  }
+}
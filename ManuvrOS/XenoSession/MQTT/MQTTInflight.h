@@ -0,0 +1,139 @@
+/*
+File:   MQTTInflight.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+The window of outbound QoS1 and QoS2 PUBLISHes that the broker has yet to
+  finish acknowledging.
+
+The window is a fixed array of slots, a power of two in length, and a packet
+  id lives in slot (id & mask). Ids are handed out by the window itself, and
+  an id whose slot is busy is skipped. So ids in flight never collide, and an
+  ack of any kind is resolved with one index and one compare.
+
+The receive-maximum bounds how many exchanges may be open at once. It may be
+  set anywhere from 1 to the size of the window. Once it is reached, the
+  session should refuse new publishes until something is acknowledged.
+
+Each slot keeps the packet as it was last sent. A PUBLISH goes back out with
+  its DUP flag set, and once a PUBREC arrives, the slot's packet becomes the
+  PUBREL. Nothing here knows the time. The session asks expired() which
+  packets are due, at whatever rate it likes, and gives up on an exchange
+  after max_retries of them.
+
+Slot buffers are kept between uses, and only grow. A steady stream of
+  similarly-sized publishes therefore doesn't touch the heap.
+*/
+
+
+#ifndef __MANUVR_MQTT_INFLIGHT_H__
+#define __MANUVR_MQTT_INFLIGHT_H__
+
+#include <inttypes.h>
+
+class StringBuilder;
+
+#define MAX_PACKET_ID 65535
+
+#ifndef MQTT_MAX_INFLIGHT
+  // How many QoS>0 exchanges may be open at once? Must be a power of two.
+  #define MQTT_MAX_INFLIGHT 64
+#endif
+
+#ifndef MQTT_RETRY_MS
+  // How long to wait for an ack before sending the packet again.
+  #define MQTT_RETRY_MS 2000
+#endif
+
+#ifndef MQTT_MAX_RETRIES
+  // How many times to send a packet again before abandoning the exchange.
+  #define MQTT_MAX_RETRIES 4
+#endif
+
+#if (0 != (MQTT_MAX_INFLIGHT & (MQTT_MAX_INFLIGHT - 1)))
+  #error MQTT_MAX_INFLIGHT must be a power of two.
+#endif
+
+
+enum class InflightState : uint8_t {
+  FREE         = 0,
+  PUBACK_WAIT  = 1,   // QoS1. PUBLISH sent.
+  PUBREC_WAIT  = 2,   // QoS2. PUBLISH sent.
+  PUBCOMP_WAIT = 3    // QoS2. PUBREL sent.
+};
+
+
+typedef struct inflight_slot_t {
+  uint8_t*      pkt;       // The packet, as it was last sent.
+  uint16_t      len;       // Its length.
+  uint16_t      cap;       // The size of the buffer behind pkt.
+  uint16_t      pid;       // The packet id.
+  uint8_t       retries;   // How many times has it been sent again?
+  InflightState state;
+  uint32_t      sent_at;   // When it was last sent.
+} InflightSlot;
+
+
+class MQTTInflight {
+  public:
+    MQTTInflight();
+    ~MQTTInflight();
+
+    void     clear();           // Forget every open exchange.
+    uint16_t nextPacketId();    // Never 0. Skips ids whose slot is busy, if it can.
+
+    int8_t track(uint16_t pid, uint8_t qos, const uint8_t* pkt, int len, uint32_t now);
+    int8_t puback(uint16_t pid);
+    int8_t pubrec(uint16_t pid, uint32_t now);
+    int8_t pubcomp(uint16_t pid);
+
+    int            expired(uint32_t now, uint16_t* pids, int max);
+    const uint8_t* packet(uint16_t pid, int* len);
+
+    void receiveMaximum(uint16_t);
+    inline uint16_t receiveMaximum() {   return _recv_max;               };
+    inline int      count() {            return _count;                  };
+    inline bool     full() {             return (_count >= _recv_max);   };
+
+    void printDebug(StringBuilder*);
+
+    uint32_t retry_ms    = MQTT_RETRY_MS;
+    uint8_t  max_retries = MQTT_MAX_RETRIES;
+
+    /* Counters. */
+    uint32_t completed   = 0;   // Exchanges that ran to completion.
+    uint32_t retransmits = 0;   // Packets sent again.
+    uint32_t abandoned   = 0;   // Exchanges given up on.
+    uint32_t stray       = 0;   // Acks that matched nothing open.
+
+
+  private:
+    InflightSlot _slots[MQTT_MAX_INFLIGHT];
+    uint16_t     _recv_max;
+    uint16_t     _next_id;
+    int          _count;
+
+    inline InflightSlot* _slot(uint16_t pid) {
+      return &_slots[pid & (MQTT_MAX_INFLIGHT - 1)];
+    };
+
+    InflightSlot* _open(uint16_t pid, InflightState);
+    void _release(InflightSlot*);
+};
+
+#endif  // __MANUVR_MQTT_INFLIGHT_H__
@@ -65,7 +65,6 @@ MQTTOpts opts = {
 MQTTSession::MQTTSession(ManuvrXport* _xport) : XenoSession("MQTTSession", _xport) {
 	_ping_outstanding(false);
 	working   = NULL;
-	_next_packetid = 1;
 
   _ping_timer.repurpose(MANUVR_MSG_SESS_ORIGINATE_MSG, (EventReceiver*) this);
   _ping_timer.incRefs();
@@ -74,6 +73,15 @@ MQTTSession::MQTTSession(ManuvrXport* _xport) : XenoSession("MQTTSession", _xpor
   _ping_timer.alterSchedulePeriod(4000);
   _ping_timer.autoClear(false);
   _ping_timer.enableSchedule(false);
+
+  // Runs only while something is in flight.
+  _retry_timer.repurpose(MANUVR_MSG_SESS_SERVICE, (EventReceiver*) this);
+  _retry_timer.incRefs();
+  _retry_timer.specific_target = (EventReceiver*) this;
+  _retry_timer.alterScheduleRecurrence(-1);
+  _retry_timer.alterSchedulePeriod(MQTT_RETRY_MS / 2);
+  _retry_timer.autoClear(false);
+  _retry_timer.enableSchedule(false);
 }
 
 
@@ -83,6 +91,8 @@ MQTTSession::MQTTSession(ManuvrXport* _xport) : XenoSession("MQTTSession", _xpor
 MQTTSession::~MQTTSession() {
   _ping_timer.enableSchedule(false);
   platform.kernel()->removeSchedule(&_ping_timer);
+  _retry_timer.enableSchedule(false);
+  platform.kernel()->removeSchedule(&_retry_timer);
 
 	if (NULL != working) {
 		delete working;
@@ -119,12 +129,15 @@ int8_t MQTTSession::fromCounterparty(StringBuilder* buf, int8_t mm) {
 /****************************************************************************************************
 * Subscription management.                                                                          *
 ****************************************************************************************************/
+/**
+* @param  topic     The topic filter. May use '+' and '#'. Must outlive the subscription.
+* @param  runnable  The event to raise when a PUBLISH matches.
+* @return 0 on success, or -1 if the filter is malformed or already subscribed.
+*/
 int8_t MQTTSession::subscribe(const char* topic, ManuvrMsg* runnable) {
-  std::map<const char*, ManuvrMsg*>::iterator it = _subscriptions.find(topic);
-  if (_subscriptions.end() == it) {
-    // If the list doesn't already have the topic....
+  if (0 == _subscriptions.insert(topic, runnable)) {
+    // If the trie didn't already have the topic....
 		runnable->setOriginator((EventReceiver*)this);
-    _subscriptions[topic] = runnable;
 		return sendSub(topic, QOS1);   // TODO: make dynamic
   }
 	return -1;
@@ -132,41 +145,41 @@ int8_t MQTTSession::subscribe(const char* topic, ManuvrMsg* runnable) {
 
 
 int8_t MQTTSession::unsubscribe(const char* topic) {
-  std::map<const char*, ManuvrMsg*>::iterator it = _subscriptions.find(topic);
-  if (_subscriptions.end() != it) {
-    // TODO: We need to clean up the runnable. For now, we'll assume it is handled elsewhere.
-		// delete it->second;
-		_subscriptions.erase(topic);
-    return 0;
-  }
-	return -1;
+  // TODO: We need to clean up the runnable. For now, we'll assume it is handled elsewhere.
+	return (0 == _subscriptions.remove(topic)) ? 0 : -1;
 }
 
 
 int8_t MQTTSession::resubscribeAll() {
 	if (isEstablished()) {
-		std::map<const char*, ManuvrMsg*>::iterator it;
-  	for (it = _subscriptions.begin(); it != _subscriptions.end(); it++) {
-			if (!sendSub(it->first, QOS1)) {   // TODO: Make QoS dynmaic.
-				return -1;
-			}
-  	}
+		struct Resub { MQTTSession* sess; int failed; };
+		Resub ctx = { this, 0 };
+		_subscriptions.each(
+			[](const char* filter, ManuvrMsg* runnable, void* arg) {
+				Resub* c = (Resub*) arg;
+				if (!c->sess->sendSub(filter, QOS1)) {   // TODO: Make QoS dynmaic.
+					c->failed++;
+				}
+			},
+			&ctx
+		);
+		if (ctx.failed) {
+			return -1;
+		}
 	}
 	return 0;
 }
 
 int8_t MQTTSession::unsubscribeAll() {
 	if (isEstablished()) {
-		std::map<const char*, ManuvrMsg*>::iterator it;
-  	for (it = _subscriptions.begin(); it != _subscriptions.end(); it++) {
-			if (sendUnsub(it->first)) {
-				_subscriptions.erase(it->first);
-			}
-		}
+		_subscriptions.each(
+			[](const char* filter, ManuvrMsg* runnable, void* arg) {
+				((MQTTSession*) arg)->sendUnsub(filter);
+			},
+			this
+		);
   }
-	else {
-		_subscriptions.clear();
-	}
+	_subscriptions.clear();
 	return 0;
 }
 
@@ -361,6 +374,10 @@ bool MQTTSession::sendPublish(ManuvrMsg* _msg) {
 				break;
 			case QOS1:
 			case QOS2:
+				if (_inflight.full()) {
+					// The broker has as many of ours as we allow. It must ack some first.
+					return false;
+				}
 				_msg_id = getNextPacketId();
 				break;
 		}
@@ -380,6 +397,12 @@ bool MQTTSession::sendPublish(ManuvrMsg* _msg) {
 		);
 
     if (len > 0) {
+			if (QOS0 != _qos) {
+				if (0 != _inflight.track(_msg_id, _qos, buf, len, millis())) {
+					return false;
+				}
+				_retry_timer.enableSchedule(true);
+			}
       return sendPacket(buf, len);
     }
 	}
@@ -387,17 +410,82 @@ bool MQTTSession::sendPublish(ManuvrMsg* _msg) {
 }
 
 
+/*
+* Resolves PUBACK, PUBREC, and PUBCOMP against the inflight window. A PUBREC
+*   is answered with the PUBREL that the window now holds.
+*/
+int MQTTSession::proc_ack(MQTTMessage* nu) {
+	int return_value = -1;
+	if ((nullptr != nu->payload) && (2 <= nu->argumentBytes())) {
+		uint16_t pid = (*((uint8_t*) nu->payload) << 8) + *((uint8_t*) nu->payload + 1);
+		switch (nu->packetType()) {
+			case PUBACK:
+				return_value = _inflight.puback(pid);
+				break;
+			case PUBREC:
+				return_value = _inflight.pubrec(pid, millis());
+				if (0 == return_value) {
+					int len = 0;
+					const uint8_t* pkt = _inflight.packet(pid, &len);
+					if (!sendPacket((uint8_t*) pkt, len)) {
+						return_value = -1;
+					}
+				}
+				break;
+			case PUBCOMP:
+				return_value = _inflight.pubcomp(pid);
+				break;
+		}
+		if ((0 != return_value) && (getVerbosity() > 3)) {
+			local_log.concatf("%s: Nothing in flight matches ack 0x%02x for packet 0x%04x.\n", getReceiverName(), nu->packetType(), pid);
+		}
+	}
+	if (0 == _inflight.count()) {
+		_retry_timer.enableSchedule(false);
+	}
+	delete nu;
+	return return_value;
+}
+
+
+/*
+* Sends again whatever the broker has been sitting on for too long.
+*/
+void MQTTSession::retransmit() {
+	uint16_t pids[MQTT_MAX_INFLIGHT];
+	int n = _inflight.expired(millis(), pids, MQTT_MAX_INFLIGHT);
+	for (int i = 0; i < n; i++) {
+		int len = 0;
+		const uint8_t* pkt = _inflight.packet(pids[i], &len);
+		if (nullptr != pkt) {
+			sendPacket((uint8_t*) pkt, len);
+		}
+	}
+	if (0 == _inflight.count()) {
+		_retry_timer.enableSchedule(false);
+	}
+}
+
+
 /*
 */
 int MQTTSession::proc_publish(MQTTMessage* nu) {
 	int return_value = nu->decompose_publish();
 
 	if (return_value >= 0) {
-  	std::map<const char*, ManuvrMsg*>::iterator it = _subscriptions.find(nu->topic);
-		for (it = _subscriptions.begin(); it != _subscriptions.end(); it++) {
-			if (0 == strcmp((const char*) nu->topic, it->first)) {
+		ManuvrMsg* matches[MQTT_MAX_TOPIC_MATCHES];
+		int count = _subscriptions.match((const char*) nu->topic, matches, MQTT_MAX_TOPIC_MATCHES);
+		if (count > MQTT_MAX_TOPIC_MATCHES) {
+			if (getVerbosity() > 2) {
+				local_log.concatf("%s: %d subscriptions match %s. Only the first %d will hear of it.\n", getReceiverName(), count, nu->topic, MQTT_MAX_TOPIC_MATCHES);
+				Kernel::log(&local_log);
+			}
+			count = MQTT_MAX_TOPIC_MATCHES;
+		}
+		if (0 < count) {
+			for (int i = 0; i < count; i++) {
 				if (0 < nu->argumentBytes()) {
-					it->second->inflateArgumentsFromBuffer((uint8_t*) nu->payload, nu->argumentBytes());
+					matches[i]->inflateArgumentsFromBuffer((uint8_t*) nu->payload, nu->argumentBytes());
 					//StringBuilder* _hack = new StringBuilder((uint8_t*) nu->payload, nu->argumentBytes());
 					//_hack->concat('\0');  // Yuck... No native null-term.
 					//_hack->string();  // Condense.
@@ -405,13 +493,13 @@ int MQTTSession::proc_publish(MQTTMessage* nu) {
 				}
 				//nu->printDebug(&local_log);
 				//local_log.concat("\n\n");
-				//it->second->printDebug(&local_log);
+				//matches[i]->printDebug(&local_log);
 				//Kernel::log(&local_log);
 
-				raiseEvent(it->second);
-				delete nu;  // TODO: Yuck. Nasty. No. Bad.
-				return 0;
+				raiseEvent(matches[i]);
 			}
+			delete nu;  // TODO: Yuck. Nasty. No. Bad.
+			return 0;
 		}
 
 		if (getVerbosity() > 2) {
@@ -440,6 +528,9 @@ int MQTTSession::process_inbound() {
 						mark_session_state(XENOSESSION_STATE_ESTABLISHED);
 						if(0 == (*((uint8_t*)nu->payload) & 0x01)) {
 							// If we are in this block, it means we have a clean session.
+							// Nothing we had in flight will ever be acknowledged.
+							_inflight.clear();
+							_retry_timer.enableSchedule(false);
 							resubscribeAll();
 						}
 						_ping_timer.enableSchedule(true);
@@ -447,14 +538,17 @@ int MQTTSession::process_inbound() {
 					default:
 						mark_session_state(XENOSESSION_STATE_HUNGUP);
 						_ping_timer.enableSchedule(false);
+						_retry_timer.enableSchedule(false);
 						break;
 				}
 			}
 			delete nu;
 			return 1;
     case PUBACK:
-			// TODO: Mark outbound message as received.
-      break;
+    case PUBREC:
+    case PUBCOMP:
+			proc_ack(nu);
+			return 1;
     case SUBACK:
 			// TODO: Only NOW should we insert into the subscription queue.
       break;
@@ -462,8 +556,6 @@ int MQTTSession::process_inbound() {
 			proc_publish(nu);
       break;
 
-    case PUBCOMP:
-      break;
     case PINGRESP:
       _ping_outstanding(false);
       break;
@@ -498,6 +590,7 @@ int MQTTSession::process_inbound() {
 int8_t MQTTSession::attached() {
   if (EventReceiver::attached()) {
 		platform.kernel()->addSchedule(&_ping_timer);
+		platform.kernel()->addSchedule(&_retry_timer);
   	//if (owner->connected()) {
   	//  // Are we connected right now?
   	//  sendConnectPacket();
@@ -560,7 +653,11 @@ int8_t MQTTSession::notify(ManuvrMsg* active_event) {
       break;
 
     case MANUVR_MSG_SESS_SERVICE:
-      if (_pending_mqtt_messages.size() > 0) {
+      if (&_retry_timer == active_event) {
+        retransmit();
+        return_value++;
+      }
+      else if (_pending_mqtt_messages.size() > 0) {
 				process_inbound();
       	return_value++;
 			}
@@ -661,14 +758,16 @@ void MQTTSession::procDirectDebugInstruction(StringBuilder *input) {
 */
 void MQTTSession::printDebug(StringBuilder *output) {
   XenoSession::printDebug(output);
-  output->concatf("-- Next Packet ID       0x%08x\n", (uint32_t) _next_packetid);
   if (_ping_outstanding()) output->concat("-- EXPIRED PING\n");
-  output->concat("-- Subscribed topics\n");
-
-	std::map<const char*, ManuvrMsg*>::iterator it;
-  for (it = _subscriptions.begin(); it != _subscriptions.end(); it++) {
-    output->concatf("--\t%s\t~~~~> %s\n", it->first, it->second->getMsgDef()->debug_label);
-  }
+  _inflight.printDebug(output);
+  output->concatf("-- Subscribed topics (%d)\n", _subscriptions.size());
+
+	_subscriptions.each(
+		[](const char* filter, ManuvrMsg* runnable, void* arg) {
+			((StringBuilder*) arg)->concatf("--\t%s\t~~~~> %s\n", filter, runnable->getMsgDef()->debug_label);
+		},
+		output
+	);
 
 	if (NULL != working) {
 		output->concat("--\n-- Incomplete inbound message:\n");
@@ -25,10 +25,15 @@ This class originated from IBM's C-client demo code, but was re-written into
 #define __XENOSESSION_MQTT_H__
 
 #include "../XenoSession.h"
+#include "TopicTrie.h"
+#include "MQTTInflight.h"
 
 #include <paho.mqtt.embedded-c/MQTTPacket.h>
 
-#define MAX_PACKET_ID 65535
+#ifndef MQTT_MAX_TOPIC_MATCHES
+  // How many subscriptions may a single PUBLISH trigger?
+  #define MQTT_MAX_TOPIC_MATCHES 8
+#endif
 
 /*
 * These state flags are hosted by the EventReceiver. This may change in the future.
@@ -92,11 +97,15 @@ class MQTTSession : public XenoSession {
     int8_t sendEvent(ManuvrMsg*);
 
     /* Management of subscriptions... */
-    int8_t subscribe(const char*, ManuvrMsg*);  // Start getting broadcasts about a given message type.
+    int8_t subscribe(const char*, ManuvrMsg*);  // Start getting broadcasts about a given message type. Filters may use '+' and '#'.
     int8_t unsubscribe(const char*);                 // Stop getting broadcasts about a given message type.
     int8_t resubscribeAll();
     int8_t unsubscribeAll();
 
+    /* How many QoS>0 publishes may await acknowledgement at once? */
+    inline uint16_t receiveMaximum() {             return _inflight.receiveMaximum();   };
+    inline void     receiveMaximum(uint16_t x) {   _inflight.receiveMaximum(x);         };
+
     /* Override from BufferPipe. */
     virtual int8_t fromCounterparty(StringBuilder* buf, int8_t mm);
 
@@ -116,11 +125,12 @@ class MQTTSession : public XenoSession {
   private:
     MQTTMessage* working;
 
-    std::map<const char*, ManuvrMsg*> _subscriptions;   // Topics we are subscribed to, and the events they trigger.
+    TopicTrie<ManuvrMsg*> _subscriptions;   // Topic filters we are subscribed to, and the events they trigger.
     PriorityQueue<MQTTMessage*> _pending_mqtt_messages;      // Valid MQTT messages that have arrived.
+    MQTTInflight _inflight;   // Outbound publishes awaiting acknowledgement.
     ManuvrMsg _ping_timer;    // Periodic KA ping.
+    ManuvrMsg _retry_timer;   // Periodic sweep of _inflight for retransmission.
 
-    unsigned int _next_packetid;
     unsigned int command_timeout_ms;
 
     int8_t bin_stream_rx(unsigned char* buf, int len);            // Used to feed data to the session.
@@ -131,9 +141,7 @@ class MQTTSession : public XenoSession {
     inline bool sendPacket(uint8_t* buf, int len) {
       return (MEM_MGMT_RESPONSIBLE_BEARER == BufferPipe::toCounterparty(buf, len, MEM_MGMT_RESPONSIBLE_BEARER));
     };
-    inline int getNextPacketId() {
-      return _next_packetid = (_next_packetid == MAX_PACKET_ID) ? 1 : _next_packetid + 1;
-    };
+    inline int getNextPacketId() {   return _inflight.nextPacketId();   };
 
     bool sendSub(const char*, enum QoS);
     bool sendUnsub(const char*);
@@ -143,7 +151,9 @@ class MQTTSession : public XenoSession {
     bool sendPublish(ManuvrMsg*);
 
     int proc_publish(MQTTMessage*);
+    int proc_ack(MQTTMessage*);
     int process_inbound();
+    void retransmit();
 
 };
 
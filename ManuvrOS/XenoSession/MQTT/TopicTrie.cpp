@@ -0,0 +1,95 @@
+/*
+File:   TopicTrie.cpp
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+The topic-level pool that every TopicTrie shares.
+*/
+
+#include "TopicTrie.h"
+
+
+const char** TopicLevels::_table = nullptr;
+unsigned int TopicLevels::_mask  = 0;
+int          TopicLevels::_count = 0;
+
+
+/**
+* Looks up a level without interning it. Never allocates.
+*
+* @param  lvl  The level. Need not be terminated.
+* @param  len  Its length.
+* @return The interned copy, or nullptr if there isn't one.
+*/
+const char* TopicLevels::find(const char* lvl, int len) {
+  if (nullptr == _table) return nullptr;
+  unsigned int i = _hash(lvl, len) & _mask;
+  while (nullptr != _table[i]) {
+    if ((0 == strncmp(_table[i], lvl, len)) && ('\0' == _table[i][len])) {
+      return _table[i];
+    }
+    i = (i + 1) & _mask;
+  }
+  return nullptr;
+}
+
+
+/**
+* @param  lvl  The level. Need not be terminated.
+* @param  len  Its length.
+* @return The interned copy, or nullptr if we ran out of memory.
+*/
+const char* TopicLevels::intern(const char* lvl, int len) {
+  const char* existing = find(lvl, len);
+  if (nullptr != existing) return existing;
+  if ((nullptr == _table) || ((unsigned int) (_count + 1) > ((_mask + 1) >> 1))) {
+    if (0 != _grow()) return nullptr;
+  }
+  char* nu = (char*) malloc(len + 1);
+  if (nullptr == nu) return nullptr;
+  memcpy(nu, lvl, len);
+  nu[len] = '\0';
+  unsigned int i = _hash(lvl, len) & _mask;
+  while (nullptr != _table[i]) i = (i + 1) & _mask;
+  _table[i] = nu;
+  _count++;
+  return nu;
+}
+
+
+/*
+* Doubles the table. Interned strings don't move.
+*/
+int TopicLevels::_grow() {
+  unsigned int size = (nullptr == _table) ? 64 : ((_mask + 1) << 1);
+  const char** table = (const char**) calloc(size, sizeof(const char*));
+  if (nullptr == table) return -1;
+  if (nullptr != _table) {
+    for (unsigned int x = 0; x <= _mask; x++) {
+      if (nullptr != _table[x]) {
+        unsigned int i = _hash(_table[x], strlen(_table[x])) & (size - 1);
+        while (nullptr != table[i]) i = (i + 1) & (size - 1);
+        table[i] = _table[x];
+      }
+    }
+    free(_table);
+  }
+  _table = table;
+  _mask  = size - 1;
+  return 0;
+}
@@ -0,0 +1,440 @@
+/*
+File:   TopicTrie.h
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Template for a table of MQTT topic filters, split into a trie on '/'.
+
+Filters may use the MQTT wildcards: '+' stands for exactly one level, and '#'
+  (which must be the last level) stands for that level and everything below
+  it, including nothing at all. So "a/#" matches "a". Per the spec, topics
+  that begin with '$' are not matched by a wildcard in the first level.
+
+Topic levels are interned. Every distinct level string is stored once, in a
+  pool that all tries share, and nodes refer to it by pointer. So each node's
+  children are sorted by pointer, and a literal step down the trie is one hash
+  of the incoming level, followed by a binary search that compares pointers.
+  A level that was never interned can't be anyone's child, and ends the
+  literal path early. Matching a topic is therefore proportional to its depth
+  (times the wildcard branches taken), regardless of how many filters there
+  are. It never allocates.
+
+The pool only ever grows. It holds one copy of each level of each filter ever
+  inserted, which for a given application is a small and fixed set.
+
+Each node holds the filter string it was given (by pointer, not by copy), and
+  one value of type T. T must be something that survives assignment (native
+  types, pointers, and plain structs).
+*/
+
+
+#ifndef __MANUVR_TOPIC_TRIE_H__
+#define __MANUVR_TOPIC_TRIE_H__
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+* The level pool. Open-addressed, linearly probed, a power of two in size, and
+*   kept at most half full.
+*/
+class TopicLevels {
+  public:
+    static const char* find(const char* lvl, int len);     // nullptr if never interned.
+    static const char* intern(const char* lvl, int len);   // nullptr if OOM.
+    static inline int  count() {   return _count;   };
+
+
+  private:
+    static const char** _table;
+    static unsigned int _mask;
+    static int          _count;
+
+    static inline uint32_t _hash(const char* lvl, int len) {
+      uint32_t h = 2166136261u;   // FNV-1a
+      for (int i = 0; i < len; i++) {
+        h = (h ^ (uint8_t) lvl[i]) * 16777619u;
+      }
+      return h;
+    };
+
+    static int _grow();
+};
+
+
+template <class T> class TopicTrie {
+  public:
+    TopicTrie();
+    ~TopicTrie();
+
+    int  insert(const char* filter, T value);  // 0 on success, -1 if present, malformed, or OOM.
+    int  remove(const char* filter);           // 0 on success, -1 if absent.
+    bool find(const char* filter, T* value);   // Exact lookup of a filter, wildcards and all.
+    void clear();
+
+    /*
+    * Finds every filter that matches a published topic. Up to max of their
+    *   values are written to results. Returns how many matched in all, which
+    *   may be more than max.
+    */
+    int match(const char* topic, T* results, int max);
+
+    /* Calls the given function with every filter and its value. */
+    void each(void (*fxn)(const char* filter, T value, void* arg), void* arg);
+
+    inline int size() {   return _size;   };
+
+
+  private:
+    typedef struct Node {
+      const char*   lvl;          // Interned.
+      struct Node** kids;         // Literal children, sorted by lvl pointer.
+      struct Node*  plus;         // The '+' child.
+      struct Node*  hash;         // The '#' child. Never has children of its own.
+      const char*   filter;       // Non-null if a filter ends here.
+      T             value;
+      uint16_t      kid_count;
+    } Node;
+
+    Node _root;
+    int  _size;
+
+    static Node* _new_node(const char* lvl);
+    static void  _free_kids(Node*);
+    static int   _kid_idx(Node*, const char* lvl);
+    static Node* _kid(Node*, const char* lvl);
+    static Node* _add_kid(Node*, const char* lvl);
+    static int   _level(const char* str, const char** next);
+    static bool  _valid_filter(const char* filter);
+    static int   _match(Node*, const char* topic, bool first, T* results, int max, int found);
+    static bool  _remove(Node*, const char* filter, int* removed);
+    static void  _each(Node*, void (*fxn)(const char*, T, void*), void* arg);
+
+    Node* _walk(const char* filter, bool create);
+
+    static inline bool _empty(Node* n) {
+      return ((nullptr == n->filter) && (0 == n->kid_count) && (nullptr == n->plus) && (nullptr == n->hash));
+    };
+};
+
+
+template <class T> TopicTrie<T>::TopicTrie() {
+  memset(&_root, 0, sizeof(Node));
+  _size = 0;
+}
+
+
+template <class T> TopicTrie<T>::~TopicTrie() {
+  clear();
+}
+
+
+template <class T> void TopicTrie<T>::clear() {
+  _free_kids(&_root);
+  memset(&_root, 0, sizeof(Node));
+  _size = 0;
+}
+
+
+template <class T> typename TopicTrie<T>::Node* TopicTrie<T>::_new_node(const char* lvl) {
+  Node* n = (Node*) calloc(1, sizeof(Node));
+  if (nullptr != n) n->lvl = lvl;
+  return n;
+}
+
+
+template <class T> void TopicTrie<T>::_free_kids(Node* n) {
+  for (int i = 0; i < n->kid_count; i++) {
+    _free_kids(n->kids[i]);
+    free(n->kids[i]);
+  }
+  if (nullptr != n->kids) free(n->kids);
+  if (nullptr != n->plus) {
+    _free_kids(n->plus);
+    free(n->plus);
+  }
+  if (nullptr != n->hash) free(n->hash);
+  n->kids      = nullptr;
+  n->kid_count = 0;
+  n->plus      = nullptr;
+  n->hash      = nullptr;
+}
+
+
+/*
+* Index of the first child whose level is at or above the given pointer.
+*/
+template <class T> int TopicTrie<T>::_kid_idx(Node* n, const char* lvl) {
+  int lo = 0;
+  int hi = n->kid_count;
+  while (lo < hi) {
+    int mid = (lo + hi) >> 1;
+    if ((uintptr_t) n->kids[mid]->lvl < (uintptr_t) lvl) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+
+template <class T> typename TopicTrie<T>::Node* TopicTrie<T>::_kid(Node* n, const char* lvl) {
+  int i = _kid_idx(n, lvl);
+  return ((i < n->kid_count) && (lvl == n->kids[i]->lvl)) ? n->kids[i] : nullptr;
+}
+
+
+template <class T> typename TopicTrie<T>::Node* TopicTrie<T>::_add_kid(Node* n, const char* lvl) {
+  int i = _kid_idx(n, lvl);
+  if ((i < n->kid_count) && (lvl == n->kids[i]->lvl)) return n->kids[i];
+  if (0xFFFF == n->kid_count) return nullptr;
+  Node** kids = (Node**) realloc(n->kids, sizeof(Node*) * (n->kid_count + 1));
+  if (nullptr == kids) return nullptr;
+  n->kids = kids;
+  Node* nu = _new_node(lvl);
+  if (nullptr == nu) return nullptr;
+  memmove(&kids[i + 1], &kids[i], sizeof(Node*) * (n->kid_count - i));
+  kids[i] = nu;
+  n->kid_count++;
+  return nu;
+}
+
+
+/*
+* Measures the level at the start of the given string.
+*
+* @param  str   The topic or filter, at the start of a level.
+* @param  next  Set to the start of the next level, or nullptr if this was the last.
+* @return The length of the level.
+*/
+template <class T> int TopicTrie<T>::_level(const char* str, const char** next) {
+  int len = 0;
+  while (('\0' != str[len]) && ('/' != str[len])) len++;
+  *next = ('/' == str[len]) ? (str + len + 1) : nullptr;
+  return len;
+}
+
+
+/*
+* Checks that wildcards stand alone in their levels, and that '#' is last.
+*/
+template <class T> bool TopicTrie<T>::_valid_filter(const char* filter) {
+  if ((nullptr == filter) || ('\0' == *filter)) return false;
+  const char* lvl = filter;
+  while (nullptr != lvl) {
+    const char* next;
+    int len = _level(lvl, &next);
+    for (int i = 0; i < len; i++) {
+      if (('+' == lvl[i]) || ('#' == lvl[i])) {
+        if (1 != len) return false;
+        if (('#' == lvl[i]) && (nullptr != next)) return false;
+      }
+    }
+    lvl = next;
+  }
+  return true;
+}
+
+
+/*
+* Finds the node for a filter, optionally building the path to it.
+*
+* @return The node, or nullptr if it isn't there (or the filter is malformed,
+*   or we ran out of memory).
+*/
+template <class T> typename TopicTrie<T>::Node* TopicTrie<T>::_walk(const char* filter, bool create) {
+  if ((nullptr == filter) || ('\0' == *filter)) return nullptr;
+  Node* n = &_root;
+  const char* lvl = filter;
+  while (nullptr != lvl) {
+    const char* next;
+    int len = _level(lvl, &next);
+    if ((1 == len) && ('#' == *lvl)) {
+      if (nullptr != next) return nullptr;   // '#' must be last.
+      if ((nullptr == n->hash) && create) n->hash = _new_node(nullptr);
+      return n->hash;
+    }
+    if ((1 == len) && ('+' == *lvl)) {
+      if ((nullptr == n->plus) && create) n->plus = _new_node(nullptr);
+      n = n->plus;
+    }
+    else {
+      for (int i = 0; i < len; i++) {
+        if (('+' == lvl[i]) || ('#' == lvl[i])) return nullptr;   // Wildcards stand alone.
+      }
+      if (create) {
+        const char* interned = TopicLevels::intern(lvl, len);
+        n = (nullptr == interned) ? nullptr : _add_kid(n, interned);
+      }
+      else {
+        const char* interned = TopicLevels::find(lvl, len);
+        n = (nullptr == interned) ? nullptr : _kid(n, interned);
+      }
+    }
+    if (nullptr == n) return nullptr;
+    lvl = next;
+  }
+  return n;
+}
+
+
+/**
+* @param  filter  The topic filter. Must outlive its place in the trie.
+* @param  value   What to hand back when a topic matches it.
+* @return 0 on success, or -1 if the filter is already present, malformed, or we ran out of memory.
+*/
+template <class T> int TopicTrie<T>::insert(const char* filter, T value) {
+  if (!_valid_filter(filter)) return -1;
+  Node* n = _walk(filter, true);
+  if ((nullptr == n) || (nullptr != n->filter)) return -1;
+  n->filter = filter;
+  n->value  = value;
+  _size++;
+  return 0;
+}
+
+
+template <class T> bool TopicTrie<T>::find(const char* filter, T* value) {
+  Node* n = _walk(filter, false);
+  if ((nullptr == n) || (nullptr == n->filter)) return false;
+  *value = n->value;
+  return true;
+}
+
+
+/*
+* Removes the filter below the given node, and prunes whatever that leaves empty.
+*
+* @return true if the given node is now empty.
+*/
+template <class T> bool TopicTrie<T>::_remove(Node* n, const char* filter, int* removed) {
+  if (nullptr == filter) {
+    if (nullptr != n->filter) {
+      n->filter = nullptr;
+      (*removed)++;
+    }
+    return _empty(n);
+  }
+  const char* next;
+  int len = _level(filter, &next);
+  if ((1 == len) && ('#' == *filter)) {
+    if ((nullptr != n->hash) && (nullptr == next) && _remove(n->hash, nullptr, removed)) {
+      free(n->hash);
+      n->hash = nullptr;
+    }
+  }
+  else if ((1 == len) && ('+' == *filter)) {
+    if ((nullptr != n->plus) && _remove(n->plus, next, removed)) {
+      free(n->plus);
+      n->plus = nullptr;
+    }
+  }
+  else {
+    const char* interned = TopicLevels::find(filter, len);
+    if (nullptr != interned) {
+      int i = _kid_idx(n, interned);
+      if ((i < n->kid_count) && (interned == n->kids[i]->lvl) && _remove(n->kids[i], next, removed)) {
+        free(n->kids[i]);
+        n->kid_count--;
+        memmove(&n->kids[i], &n->kids[i + 1], sizeof(Node*) * (n->kid_count - i));
+        if (0 == n->kid_count) {
+          free(n->kids);
+          n->kids = nullptr;
+        }
+      }
+    }
+  }
+  return _empty(n);
+}
+
+
+/**
+* @param  filter  The topic filter, as it was inserted.
+* @return 0 on success, or -1 if it wasn't there.
+*/
+template <class T> int TopicTrie<T>::remove(const char* filter) {
+  if ((nullptr == filter) || ('\0' == *filter)) return -1;
+  int removed = 0;
+  _remove(&_root, filter, &removed);
+  _size -= removed;
+  return (0 < removed) ? 0 : -1;
+}
+
+
+template <class T> int TopicTrie<T>::_match(Node* n, const char* topic, bool first, T* results, int max, int found) {
+  const char* next;
+  int len = _level(topic, &next);
+  bool wild = !(first && ('$' == *topic));
+
+  // '#' covers this level and all below it.
+  if (wild && (nullptr != n->hash)) {
+    if (found < max) results[found] = n->hash->value;
+    found++;
+  }
+  const char* interned = TopicLevels::find(topic, len);
+  Node* lit = (nullptr == interned) ? nullptr : _kid(n, interned);
+  Node* kids[2] = { lit, (wild ? n->plus : nullptr) };
+  for (int i = 0; i < 2; i++) {
+    if (nullptr == kids[i]) continue;
+    if (nullptr != next) {
+      found = _match(kids[i], next, false, results, max, found);
+    }
+    else {
+      if (nullptr != kids[i]->filter) {
+        if (found < max) results[found] = kids[i]->value;
+        found++;
+      }
+      // "a/#" matches "a", too.
+      if (nullptr != kids[i]->hash) {
+        if (found < max) results[found] = kids[i]->hash->value;
+        found++;
+      }
+    }
+  }
+  return found;
+}
+
+
+/**
+* @param  topic    The topic of a PUBLISH. Wildcards aren't allowed in it.
+* @param  results  Where to write the values of matching filters.
+* @param  max      How many results there is room for.
+* @return How many filters matched, which may be more than max. 0 for a malformed topic.
+*/
+template <class T> int TopicTrie<T>::match(const char* topic, T* results, int max) {
+  if ((nullptr == topic) || ('\0' == *topic) || (0 != strpbrk(topic, "+#"))) return 0;
+  return _match(&_root, topic, true, results, max, 0);
+}
+
+
+template <class T> void TopicTrie<T>::_each(Node* n, void (*fxn)(const char*, T, void*), void* arg) {
+  if (nullptr != n->filter) fxn(n->filter, n->value, arg);
+  for (int i = 0; i < n->kid_count; i++) _each(n->kids[i], fxn, arg);
+  if (nullptr != n->plus) _each(n->plus, fxn, arg);
+  if (nullptr != n->hash) _each(n->hash, fxn, arg);
+}
+
+
+/**
+* The trie must not be changed by the given function.
+*/
+template <class T> void TopicTrie<T>::each(void (*fxn)(const char* filter, T value, void* arg), void* arg) {
+  if (nullptr != fxn) _each(&_root, fxn, arg);
+}
+
+#endif  // __MANUVR_TOPIC_TRIE_H__
@@ -142,6 +142,47 @@ int SCHEDULER_COMPARE_RESULTS() {
 
 
 
+/**
+* How much does a scheduler tick cost when nothing is due? The cost of a tick
+*   should track the number of schedules that fire, not the number that exist.
+* Informational only. No test.
+*/
+void bench_serviceSchedules() {
+  StringBuilder log("===< Scheduler tick benchmark >=================================\n");
+  const int counts[] = {10, 100, 1000, 10000};
+  const int TICKS    = 1000;
+  Kernel* kernel = platform.kernel();
+  platform.setIdleHook(nullptr);   // Otherwise we would be measuring sleep_millis().
+  log.concat("\t Schedules    us/tick (idle)    Lagged\n");
+  for (unsigned int c = 0; c < sizeof(counts) / sizeof(int); c++) {
+    int count = counts[c];
+    ManuvrMsg** scheds = new ManuvrMsg*[count];
+    for (int i = 0; i < count; i++) {
+      // Periods long enough that none of them fire during the run.
+      scheds[i] = kernel->createSchedule(100000 + (randomInt() % 10000), -1, false, sched_1_cb);
+      scheds[i]->delaySchedule();   // Enables without firing.
+    }
+
+    uint32_t lagged = Kernel::lagged_schedules;
+    unsigned long total = 0;
+    for (int t = 0; t < TICKS; t++) {
+      kernel->advanceScheduler(1);
+      unsigned long t0 = micros();
+      kernel->procIdleFlags();
+      total += micros() - t0;
+    }
+    log.concatf("\t %9d    %14.2f    %6u\n", count, (double) total / TICKS, (unsigned long) (Kernel::lagged_schedules - lagged));
+
+    for (int i = 0; i < count; i++) {
+      kernel->removeSchedule(scheds[i]);
+    }
+    delete[] scheds;
+  }
+  log.concat("=================================================================\n\n");
+  printf((const char*) log.string());
+}
+
+
 void printTestFailure(const char* test) {
   printf("\n");
   printf("*********************************************\n");
@@ -188,5 +229,7 @@ int main(int argc, char *argv[]) {
   }
   else printTestFailure("SCHEDULER_INIT_STATE");
 
+  bench_serviceSchedules();
+
   exit(exit_value);
 }
@@ -0,0 +1,388 @@
+/*
+File:   SocketTest.cpp
+Author: agent
+Date:   2026.10.18
+
+Copyright 2026 Manuvr, Inc
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+This program puts a ManuvrTCP listener under load from a swarm of loopback
+  clients. Every accepted connection gets an echo pipe. The swarm sends
+  a message on every connection, and checks that what comes back is what it
+  sent. We also check that the number of threads in the process does not grow
+  with the number of peers.
+Then a ManuvrUDP listener with an echo pipe is flooded from a loopback client,
+  and we report how many datagrams each syscall moved.
+This test must run on linux.
+*/
+
+#include <cstdio>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <fstream>
+#include <iostream>
+
+// Platform.h goes first, so that StringBuilder sees the same build options the
+//   library did. Its layout depends on them.
+#include <Platform/Platform.h>
+#include <DataStructures/StringBuilder.h>
+#include <Transports/ManuvrSocket/ManuvrTCP.h>
+#include <Transports/ManuvrSocket/ManuvrUDP.h>
+#include <Transports/ManuvrSocket/SocketReactor.h>
+
+#define SWARM_MSG_LEN   64
+#define SWARM_ROUNDS    20
+#define FLOOD_MSG_LEN   64
+#define FLOOD_BURST     256
+#define FLOOD_ROUNDS    400
+
+
+/*
+* A far-side pipe that sends everything back where it came from.
+*/
+class EchoPipe : public BufferPipe {
+  public:
+    EchoPipe(BufferPipe* near) : BufferPipe() {  setNear(near);  };
+
+    const char* pipeName() {  return "EchoPipe";  };
+
+    int8_t fromCounterparty(StringBuilder* buf, int8_t mm) {
+      if (haveNear()) {
+        return _near->toCounterparty(buf, mm);
+      }
+      return MEM_MGMT_RESPONSIBLE_CALLER;
+    };
+};
+
+BufferPipe* _echo_pipe_factory(BufferPipe* _n, BufferPipe* _f) {
+  return (BufferPipe*) new EchoPipe(_n);
+}
+
+
+/*
+* Globals.
+*/
+struct SwarmParams {
+  int           port;
+  int           clients;
+  int           rounds;
+  int           threads_loaded;   // Thread count with every client connected.
+  int           errors;
+  unsigned long usecs;            // Time spent in echo rounds.
+  volatile bool done;
+};
+
+
+/* Returns the number of threads in this process. */
+int thread_count() {
+  int ret = -1;
+  FILE* f = fopen("/proc/self/status", "r");
+  if (f) {
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+      if (0 == strncmp(line, "Threads:", 8)) {
+        ret = atoi(line + 8);
+        break;
+      }
+    }
+    fclose(f);
+  }
+  return ret;
+}
+
+
+/*
+* The client side. Blocking sockets, all in this one thread.
+*/
+void* swarm_thread(void* args) {
+  SwarmParams* p = (SwarmParams*) args;
+  int* socks = (int*) malloc(p->clients * sizeof(int));
+  int connected = 0;
+  uint8_t out[SWARM_MSG_LEN];
+  uint8_t in[SWARM_MSG_LEN];
+
+  struct sockaddr_in srv;
+  memset(&srv, 0, sizeof(srv));
+  srv.sin_family      = AF_INET;
+  srv.sin_addr.s_addr = inet_addr("127.0.0.1");
+  srv.sin_port        = htons(p->port);
+
+  for (int i = 0; i < p->clients; i++) {
+    socks[i] = socket(AF_INET, SOCK_STREAM, 0);
+    struct timeval tv = {5, 0};
+    setsockopt(socks[i], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    if (0 != connect(socks[i], (struct sockaddr*) &srv, sizeof(srv))) {
+      close(socks[i]);
+      p->errors++;
+      break;
+    }
+    connected++;
+  }
+
+  // The first round is a warm-up that waits for the Kernel to attach every
+  //   connection. Only the rest are timed.
+  unsigned long t0 = 0;
+  for (int r = 0; (r <= p->rounds) && (0 == p->errors); r++) {
+    if (1 == r) {
+      p->threads_loaded = thread_count();
+      t0 = micros();
+    }
+    for (int i = 0; i < connected; i++) {
+      for (int x = 0; x < SWARM_MSG_LEN; x++) out[x] = (uint8_t) (i + r + x);
+      if (SWARM_MSG_LEN != send(socks[i], out, SWARM_MSG_LEN, MSG_NOSIGNAL)) {
+        p->errors++;
+      }
+    }
+    for (int i = 0; i < connected; i++) {
+      int n = recv(socks[i], in, SWARM_MSG_LEN, MSG_WAITALL);
+      if (SWARM_MSG_LEN != n) {
+        p->errors++;
+        continue;
+      }
+      for (int x = 0; x < SWARM_MSG_LEN; x++) {
+        if (in[x] != (uint8_t) (i + r + x)) {
+          p->errors++;
+          break;
+        }
+      }
+    }
+  }
+  p->usecs = micros() - t0;
+
+  for (int i = 0; i < connected; i++) close(socks[i]);
+  free(socks);
+  p->done = true;
+  return nullptr;
+}
+
+
+/*
+* Runs one swarm against the given listener, and services the Kernel meanwhile.
+*/
+int run_swarm(ManuvrTCP* srv, int port, int clients, StringBuilder* log) {
+  SwarmParams p;
+  memset(&p, 0, sizeof(p));
+  p.port    = port;
+  p.clients = clients;
+  p.rounds  = SWARM_ROUNDS;
+
+  int threads_before = thread_count();
+  unsigned long swarm_thread_id = 0;
+  createThread(&swarm_thread_id, nullptr, swarm_thread, (void*) &p);
+  while (!p.done) {
+    platform.kernel()->procIdleFlags();
+  }
+  pthread_join(swarm_thread_id, nullptr);
+
+  unsigned int msgs = clients * p.rounds;
+  log->concatf("\t%10d  %10u  %10.0f  %10d  %10d\n",
+    clients,
+    msgs,
+    (p.usecs ? ((double) msgs * 1000000) / p.usecs : (double) 0),
+    threads_before,
+    p.threads_loaded
+  );
+  if (0 != p.errors) {
+    log->concatf("Swarm of %d saw %d errors.\n", clients, p.errors);
+    return -1;
+  }
+  // Only the swarm's own thread should be new.
+  if (p.threads_loaded > threads_before + 1) {
+    log->concatf("Thread count grew with the swarm (%d -> %d).\n", threads_before, p.threads_loaded);
+    return -1;
+  }
+  return 0;
+}
+
+
+/*
+* Several swarms of increasing size against one listener.
+*/
+int test_TCPSwarm() {
+  int return_value = -1;
+  StringBuilder log("===< TCP loopback swarm >===============================\n");
+  const int SWARM_SIZES[] = {1, 16, 256, 1024};
+  const uint8_t pipe_plan_echo[] = {1, 0};
+  int port = 40000 + (getpid() % 20000);
+
+  // Each client costs us two fds. Ask for what we need.
+  struct rlimit rl;
+  getrlimit(RLIMIT_NOFILE, &rl);
+  if (rl.rlim_cur < 4096) {
+    rl.rlim_cur = (rl.rlim_max < 4096) ? rl.rlim_max : 4096;
+    setrlimit(RLIMIT_NOFILE, &rl);
+  }
+
+  {
+    ManuvrTCP* srv = new ManuvrTCP("127.0.0.1", port);
+    srv->setPipeStrategy(pipe_plan_echo);
+    platform.kernel()->subscribe(srv);
+    if (0 != srv->listen()) {
+      log.concatf("Failed to listen on port %d.\n", port);
+      goto tcp_swarm_done;
+    }
+
+    log.concat("\t   Clients        Msgs    Echoes/s  Thr before  Thr loaded\n");
+    for (unsigned int i = 0; i < sizeof(SWARM_SIZES) / sizeof(int); i++) {
+      if ((SWARM_SIZES[i] * 2 + 64) > (int) rl.rlim_cur) {
+        log.concatf("\tSkipping a swarm of %d for lack of fds.\n", SWARM_SIZES[i]);
+        continue;
+      }
+      if (run_swarm(srv, port, SWARM_SIZES[i], &log)) {
+        goto tcp_swarm_done;
+      }
+    }
+    SocketReactor::printDebug(&log);
+    return_value = 0;
+  }
+
+tcp_swarm_done:
+  printf("%s\n\n", (const char*) log.string());
+  return return_value;
+}
+
+
+/*
+* The UDP client. Sends a burst, then collects the echoes of it, and checks
+*   them. Blocking socket, all in this one thread.
+*/
+void* flood_thread(void* args) {
+  SwarmParams* p = (SwarmParams*) args;
+  uint8_t out[FLOOD_MSG_LEN];
+  uint8_t in[FLOOD_MSG_LEN];
+
+  struct sockaddr_in srv;
+  memset(&srv, 0, sizeof(srv));
+  srv.sin_family      = AF_INET;
+  srv.sin_addr.s_addr = inet_addr("127.0.0.1");
+  srv.sin_port        = htons(p->port);
+
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  struct timeval tv = {2, 0};
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  int rcvbuf = FLOOD_BURST * 2048;
+  setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+  unsigned long t0 = micros();
+  for (int r = 0; (r < p->rounds) && (0 == p->errors); r++) {
+    for (int i = 0; i < FLOOD_BURST; i++) {
+      for (int x = 0; x < FLOOD_MSG_LEN; x++) out[x] = (uint8_t) (i + r + x);
+      if (FLOOD_MSG_LEN != sendto(sock, out, FLOOD_MSG_LEN, 0, (struct sockaddr*) &srv, sizeof(srv))) {
+        p->errors++;
+      }
+    }
+    for (int i = 0; i < FLOOD_BURST; i++) {
+      if (FLOOD_MSG_LEN != recv(sock, in, FLOOD_MSG_LEN, 0)) {
+        p->errors++;   // Lost, or timed out.
+        break;
+      }
+      if (in[1] != (uint8_t) (i + r + 1)) {
+        p->errors++;   // Out of order.
+        break;
+      }
+    }
+  }
+  p->usecs = micros() - t0;
+  close(sock);
+  p->done = true;
+  return nullptr;
+}
+
+
+/*
+* Floods a UDP echo listener, and reports datagrams per syscall in each direction.
+*/
+int test_UDPFlood() {
+  int return_value = -1;
+  StringBuilder log("===< UDP loopback flood >===============================\n");
+  const uint8_t pipe_plan_echo[] = {1, 0};
+  int port = 40000 + ((getpid() + 1) % 20000);
+  ManuvrUDP* srv = new ManuvrUDP("127.0.0.1", port);
+  srv->setPipeStrategy(pipe_plan_echo);
+  platform.kernel()->subscribe(srv);
+  if (!srv->listening() && (0 != srv->listen())) {
+    log.concatf("Failed to listen on port %d.\n", port);
+  }
+  else {
+    SwarmParams p;
+    memset(&p, 0, sizeof(p));
+    p.port   = port;
+    p.rounds = FLOOD_ROUNDS;
+
+    unsigned long flood_thread_id = 0;
+    createThread(&flood_thread_id, nullptr, flood_thread, (void*) &p);
+    while (!p.done) {
+      platform.kernel()->procIdleFlags();
+    }
+    pthread_join(flood_thread_id, nullptr);
+
+    unsigned int msgs = FLOOD_BURST * p.rounds;
+    log.concatf("\t%u datagrams echoed in %lu us (%.0f/s)\n", msgs, p.usecs, (p.usecs ? ((double) msgs * 1000000) / p.usecs : (double) 0));
+    log.concatf("\tRX: %u datagrams in %u recvmmsg() calls (%.2f per call)\n", srv->rxDatagrams(), srv->rxCalls(), (srv->rxCalls() ? (double) srv->rxDatagrams() / srv->rxCalls() : (double) 0));
+    log.concatf("\tTX: %u datagrams in %u sendmmsg() calls (%.2f per call)\n", srv->txDatagrams(), srv->txCalls(), (srv->txCalls() ? (double) srv->txDatagrams() / srv->txCalls() : (double) 0));
+    if (0 != p.errors) {
+      log.concatf("The flood saw %d errors.\n", p.errors);
+    }
+    else if ((msgs != srv->rxDatagrams()) || (msgs != srv->txDatagrams())) {
+      log.concat("The listener's counts don't match what was sent.\n");
+    }
+    else {
+      return_value = 0;
+    }
+  }
+  printf("%s\n\n", (const char*) log.string());
+  return return_value;
+}
+
+
+void printTestFailure(const char* test) {
+  printf("\n");
+  printf("*********************************************\n");
+  printf("* %s FAILED tests.\n", test);
+  printf("*********************************************\n");
+}
+
+
+/****************************************************************************************************
+* The main function.                                                                                *
+****************************************************************************************************/
+int main(int argc, char *argv[]) {
+  int exit_value = 1;   // Failure is the default result.
+
+  platform.platformPreInit();
+  platform.bootstrap();
+
+  if (0 != BufferPipe::registerPipe(1, _echo_pipe_factory)) {
+    printTestFailure("Echo pipe registration");
+  }
+  else if (0 == test_TCPSwarm()) {
+    if (0 == test_UDPFlood()) {
+      printf("**********************************\n");
+      printf("*  Socket tests all pass         *\n");
+      printf("**********************************\n");
+      exit_value = 0;
+    }
+    else printTestFailure("UDPFlood");
+  }
+  else printTestFailure("TCPSwarm");
+
+  exit(exit_value);
+}
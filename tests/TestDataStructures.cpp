@@ -31,19 +31,38 @@ This program runs tests on raw data-handling classes.
 #include <fstream>
 #include <iostream>
 
+// Platform.h goes first, so that StringBuilder sees the same build options the
+//   library did. Its layout depends on them.
+#include <Platform/Platform.h>
 #include <DataStructures/PriorityQueue.h>
+#include <DataStructures/RingBuffer.h>
 #include <DataStructures/Vector3.h>
 #include <DataStructures/Quaternion.h>
 #include <DataStructures/StringBuilder.h>
 #include <DataStructures/BufferPipe.h>
 #include <DataStructures/uuid.h>
+#include <ManuvrMsg/MsgQueue.h>
+#include <ManuvrMsg/MsgIngress.h>
+#include <ManuvrMsg/ScheduleHeap.h>
+#include <ManuvrMsg/SubscriberIndex.h>
+#include <ManuvrMsg/ListenerTable.h>
+#include <ManuvrMsg/LatencyHistogram.h>
+#include <Drivers/BusQueue/BusQueue.h>
+#if defined(MANUVR_BUS_SIM)
+  #include <Platform/Targets/Linux/BusSim.h>
+  #include <Platform/Peripherals/SPI/SPIAdapter.h>
+  #if defined(MANUVR_SUPPORT_I2C)
+    #include <Platform/Peripherals/I2C/I2CAdapter.h>
+  #endif
+#endif
 
-#include <Platform/Platform.h>
 #include <Drivers/Sensors/SensorWrapper.h>
 
 #include <XenoSession/XenoSession.h>
 #include <XenoSession/CoAP/CoAPSession.h>
 #include <XenoSession/MQTT/MQTTSession.h>
+#include <XenoSession/MQTT/TopicTrie.h>
+#include <XenoSession/MQTT/MQTTInflight.h>
 #include <XenoSession/Manuvr/ManuvrSession.h>
 #include <XenoSession/Console/ManuvrConsole.h>
 
@@ -53,6 +72,10 @@ This program runs tests on raw data-handling classes.
 #include <Transports/ManuvrSocket/ManuvrUDP.h>
 #include <Transports/ManuvrSocket/ManuvrTCP.h>
 #include <Transports/ManuvrXport.h>
+#if defined(MANUVR_GPS_PIPE)
+  #include <Transports/BufferPipes/ManuvrGPS/NMEAParser.h>
+  #include <Transports/BufferPipes/ManuvrGPS/ManuvrGPS.h>
+#endif
 
 #if defined(MANUVR_CBOR)
   #include <Types/cbor-cpp/cbor.h>
@@ -105,6 +128,225 @@ int test_StringBuilder(void) {
 }
 
 
+/**
+* Checks that the fragment export describes exactly what string() would have
+*   returned, and that culling across fragments doesn't collapse or corrupt.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_StringBuilder_iovec(void) {
+  int return_value = -1;
+  StringBuilder log("===< StringBuilder iovec >==============================\n");
+  const char* expected = "pre:Const header binary\0body42 tail";
+  const int expected_len = 35;
+  struct iovec vecs[16];
+  int count = 0;
+  int total = 0;
+  uint8_t flat[64];
+
+  StringBuilder frag;
+  frag.concat("Const header ");                  // Not copied.
+  frag.concat((uint8_t*) "binary\0body", 11);    // Copied, with an embedded NULL.
+  frag.concatf("%d", 42);
+  frag.prepend("pre:");
+  frag.concat(" tail");
+
+  count = frag.toIovec(vecs, 16);
+  for (int i = 0; i < count; i++) {
+    memcpy(flat + total, vecs[i].iov_base, vecs[i].iov_len);
+    total += vecs[i].iov_len;
+  }
+  log.concatf("\t Exported %d fragments totaling %d bytes.\n", count, total);
+  if ((count != frag.count()) || (total != expected_len) || (total != frag.length())) {
+    log.concat("\t Fragment export doesn't add up.\n");
+    goto sb_iovec_done;
+  }
+  if (0 != memcmp(flat, expected, expected_len)) {
+    log.concat("\t Fragment export doesn't match the content.\n");
+    goto sb_iovec_done;
+  }
+  if (2 != frag.toIovec(vecs, 2)) {
+    log.concat("\t Fragment export overran its limit.\n");
+    goto sb_iovec_done;
+  }
+
+  // Cull through the first fragment and part-way into the const one.
+  frag.cull(6);
+  if ((frag.length() != expected_len - 6) || (frag.count() != count - 1)) {
+    log.concat("\t cull() collapsed or lost fragments.\n");
+    goto sb_iovec_done;
+  }
+  // ...then to the middle of the embedded NULL fragment.
+  frag.cull(17);
+  count = frag.toIovec(vecs, 16);
+  total = 0;
+  for (int i = 0; i < count; i++) {
+    memcpy(flat + total, vecs[i].iov_base, vecs[i].iov_len);
+    total += vecs[i].iov_len;
+  }
+  if ((total != expected_len - 23) || (0 != memcmp(flat, expected + 23, total))) {
+    log.concat("\t cull() across fragments corrupted the content.\n");
+    goto sb_iovec_done;
+  }
+
+  // A collapsed string is the first fragment.
+  frag.string();
+  frag.concat("!");
+  if ((2 != frag.toIovec(vecs, 16)) || (vecs[0].iov_len != (size_t) total)) {
+    log.concat("\t The collapsed string was not exported first.\n");
+    goto sb_iovec_done;
+  }
+  frag.cull(3);
+  if (0 != memcmp(frag.string(), "dy42 tail!", 11)) {
+    log.concatf("\t cull() on a collapsed string gave \"%s\".\n", (char*) frag.string());
+    goto sb_iovec_done;
+  }
+  return_value = 0;
+
+sb_iovec_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/**
+* Tokens from split() and fragments from a handoff must stay as they are. Later
+*   appends get positions of their own, even when they land right after them.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_StringBuilder_tokens(void) {
+  int return_value = -1;
+  StringBuilder log("===< StringBuilder tokens >=============================\n");
+  StringBuilder tok("alpha beta");
+  StringBuilder donor("delta");
+
+  if (2 != tok.split(" ")) {
+    log.concat("\t split() miscounted.\n");
+    goto sb_tokens_done;
+  }
+  tok.concat("gamma");
+  tok.concatf("%d", 7);
+  if ((4 != tok.count()) || (0 != strcmp(tok.position(1), "beta")) || (0 != strcmp(tok.position(2), "gamma"))) {
+    log.concatf("\t Appends merged into a token. %d tokens.\n", tok.count());
+    goto sb_tokens_done;
+  }
+  if (!tok.drop_position(0) || (3 != tok.count()) || (0 != strcmp(tok.position(0), "beta"))) {
+    log.concat("\t drop_position() lost track of the tokens.\n");
+    goto sb_tokens_done;
+  }
+
+  tok.concatHandoff(&donor);
+  tok.concat("epsilon");
+  if ((5 != tok.count()) || (0 != strcmp(tok.position(3), "delta")) || (0 != strcmp(tok.position(4), "epsilon"))) {
+    log.concatf("\t An append merged into a handed-off fragment. %d tokens.\n", tok.count());
+    goto sb_tokens_done;
+  }
+  return_value = 0;
+
+sb_tokens_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/*
+* The two ways StringBuilder sees the most use: lines of log built up piecewise
+*   and then flattened, and packets assembled from a header, options, and a
+*   payload.
+*/
+void bench_StringBuilder() {
+  StringBuilder log("===< StringBuilder benchmark >==========================\n");
+  const int ROUNDS = 20000;
+  const int LINES  = 8;
+  uint8_t payload[1400];
+  unsigned long sum = 0;
+  for (unsigned int i = 0; i < sizeof(payload); i++) payload[i] = (uint8_t) i;
+
+  // Log lines: a literal, a few formatted fields, and a newline. Flattened and
+  //   thrown away, the way local_log is.
+  unsigned long t0 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    StringBuilder line;
+    for (int l = 0; l < LINES; l++) {
+      line.concat("-- Module ");
+      line.concatf("%s: state %d, %u bytes pending (0x%08x)", "I2CAdapter", l, r, (unsigned int) (r * l));
+      line.concat('\n');
+    }
+    sum += line.string()[0] + line.length();
+  }
+  unsigned long t1 = micros();
+
+  // Packets: a small header, options, and a payload. Then flattened for the
+  //   transport.
+  const int payloads[] = {16, 256, 1400};
+  unsigned long t_pkt[3];
+  for (unsigned int p = 0; p < sizeof(payloads) / sizeof(int); p++) {
+    unsigned long t2 = micros();
+    for (int r = 0; r < ROUNDS; r++) {
+      StringBuilder pkt;
+      pkt.concat(payload, 4);
+      pkt.concat(payload, 12);
+      pkt.concat(payload, payloads[p]);
+      sum += pkt.string()[0] + pkt.length();
+      pkt.cull(4);   // As a parser would, after taking the header.
+      sum += pkt.length();
+    }
+    t_pkt[p] = micros() - t2;
+  }
+
+  log.concatf("\t Log lines (%d per builder):  %8.0f ns/line\n", LINES, ((double) (t1 - t0) * 1000) / (ROUNDS * LINES));
+  for (unsigned int p = 0; p < sizeof(payloads) / sizeof(int); p++) {
+    log.concatf("\t Packet of %4d bytes:        %8.0f ns/packet\n", payloads[p], ((double) t_pkt[p] * 1000) / ROUNDS);
+  }
+  if (0 == sum) log.concat("\t (The optimizer was not fooled.)\n");
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+}
+
+
+/*
+* What collapsing a typical outbound packet costs, next to exporting its
+*   fragments for a gathering write.
+*/
+void bench_StringBuilder_iovec() {
+  StringBuilder log("===< StringBuilder iovec benchmark >====================\n");
+  const int payloads[] = {16, 256, 1400};
+  const int ROUNDS = 10000;
+  uint8_t payload[1400];
+  struct iovec vecs[8];
+  for (unsigned int i = 0; i < sizeof(payload); i++) payload[i] = (uint8_t) i;
+
+  log.concat("\t Payload    string() (us)    toIovec() (us)\n");
+  for (unsigned int p = 0; p < sizeof(payloads) / sizeof(int); p++) {
+    unsigned long t_collapse = 0;
+    unsigned long t_export   = 0;
+    for (int r = 0; r < ROUNDS; r++) {
+      // Shaped like what the session encoders build: a header, options, and a payload.
+      StringBuilder a;
+      StringBuilder b;
+      a.concat(payload, 4);
+      a.concat(payload, 12);
+      a.concat(payload, payloads[p]);
+      b.concat(payload, 4);
+      b.concat(payload, 12);
+      b.concat(payload, payloads[p]);
+
+      unsigned long t0 = micros();
+      a.string();
+      unsigned long t1 = micros();
+      b.toIovec(vecs, 8);
+      unsigned long t2 = micros();
+      t_collapse += t1 - t0;
+      t_export   += t2 - t1;
+    }
+    log.concatf("\t %7d    %13lu    %14lu\n", payloads[p], t_collapse, t_export);
+  }
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+}
+
+
 /**
  * [vector3_float_test description]
  * @param  x float
@@ -144,6 +386,594 @@ int test_PriorityQueue(void) {
   return 0;
 }
 
+
+#if defined(__BUILD_HAS_PTHREADS)
+#define RING_TEST_COUNT   200000
+
+/*
+* Feeds the ring a counting sequence, alternating single and bulk inserts.
+*/
+void* ring_producer(void* a) {
+  RingBuffer<uint32_t>* ring = (RingBuffer<uint32_t>*) a;
+  uint32_t next = 0;
+  uint32_t chunk[13];
+  while (next < RING_TEST_COUNT) {
+    if (next & 1) {
+      if (0 == ring->insert(next)) next++;
+      else yieldThread();
+    }
+    else {
+      unsigned int n = 0;
+      while ((n < 13) && (next + n < RING_TEST_COUNT)) {
+        chunk[n] = next + n;
+        n++;
+      }
+      unsigned int taken = ring->insert(chunk, n);
+      next += taken;
+      if (0 == taken) yieldThread();
+    }
+  }
+  return nullptr;
+}
+#endif  // __BUILD_HAS_PTHREADS
+
+/**
+* RingBuffer must round its capacity up, refuse elements when full, keep order
+*   across the wrap for single, bulk, and zero-copy access, and survive one
+*   producer thread racing one consumer.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_RingBuffer(void) {
+  StringBuilder log("===< RingBuffer >=======================================\n");
+  RingBuffer<uint32_t> ring(20);
+  uint32_t vals[40];
+  uint32_t* span  = nullptr;
+  unsigned int n  = 0;
+  uint32_t expect = 0;
+  int return_value = -1;
+
+  if (32 != ring.capacity()) {
+    log.concatf("Capacity should have been rounded to 32, but is %u.\n", ring.capacity());
+    goto ring_test_done;
+  }
+  for (uint32_t i = 0; i < 32; i++) {
+    if (0 != ring.insert(i)) {
+      log.concatf("Failed to insert element %u.\n", i);
+      goto ring_test_done;
+    }
+  }
+  if ((0 == ring.insert(99)) || (32 != ring.pending())) {
+    log.concat("A full ring took another element.\n");
+    goto ring_test_done;
+  }
+  for (uint32_t i = 0; i < 20; i++) {
+    if (i != ring.get()) {
+      log.concatf("Element %u came out of order.\n", i);
+      goto ring_test_done;
+    }
+  }
+  expect = 20;
+
+  // The read index is now at 20. Bulk inserts must wrap.
+  for (uint32_t i = 0; i < 40; i++) vals[i] = 32 + i;
+  if (20 != ring.insert(vals, 40)) {
+    log.concat("Bulk insert should have taken exactly the 20 free slots.\n");
+    goto ring_test_done;
+  }
+  if ((0 == ring.insert(vals, 5)) && (32 == ring.pending())) {
+    n = ring.get(vals, 40);
+  }
+  if (32 != n) {
+    log.concatf("Bulk get should have returned 32 elements, but returned %u.\n", n);
+    goto ring_test_done;
+  }
+  for (uint32_t i = 0; i < 32; i++) {
+    if (vals[i] != expect++) {
+      log.concatf("Bulk element %u came out as %u.\n", i, vals[i]);
+      goto ring_test_done;
+    }
+  }
+  if (ring.hasNext() || (-1 != ring.get(vals)) || (0 != ring.get(vals, 4))) {
+    log.concat("Ring should be empty.\n");
+    goto ring_test_done;
+  }
+
+  // Both indices sit at 20. The first span ends at the wrap.
+  span = ring.reserve(&n);
+  if ((nullptr == span) || (12 != n)) {
+    log.concatf("reserve() should have offered 12 slots, but offered %u.\n", n);
+    goto ring_test_done;
+  }
+  for (uint32_t i = 0; i < n; i++) span[i] = expect + i;
+  ring.commit(n);
+  span = ring.reserve(&n);
+  if ((nullptr == span) || (20 != n)) {
+    log.concatf("reserve() should have offered 20 slots after the wrap, but offered %u.\n", n);
+    goto ring_test_done;
+  }
+  for (uint32_t i = 0; i < n; i++) span[i] = expect + 12 + i;
+  ring.commit(n);
+  if (nullptr != ring.reserve(&n)) {
+    log.concat("reserve() offered space in a full ring.\n");
+    goto ring_test_done;
+  }
+  for (int pass = 0; pass < 2; pass++) {
+    span = ring.peek(&n);
+    if ((nullptr == span) || (n != (pass ? 20u : 12u))) {
+      log.concatf("peek() pass %d offered %u elements.\n", pass, n);
+      goto ring_test_done;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+      if (span[i] != expect++) {
+        log.concatf("peek() pass %d had %u at %u.\n", pass, span[i], i);
+        goto ring_test_done;
+      }
+    }
+    ring.consume(n);
+  }
+  if (nullptr != ring.peek(&n)) {
+    log.concat("peek() found something in an empty ring.\n");
+    goto ring_test_done;
+  }
+
+  #if defined(__BUILD_HAS_PTHREADS)
+  {
+    // The consumer drains with peek()/consume() and get(), in turns.
+    pthread_t thread;
+    ring.clear();
+    expect = 0;
+    unsigned long t0 = micros();
+    pthread_create(&thread, nullptr, ring_producer, &ring);
+    while (expect < RING_TEST_COUNT) {
+      uint32_t v = 0;
+      if (expect & 2) {
+        span = ring.peek(&n);
+        if (nullptr == span) {
+          yieldThread();
+          continue;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+          if (span[i] != expect + i) break;
+          v++;
+        }
+        if (v != n) {
+          log.concatf("SPSC: peek() found %u where %u belonged.\n", span[v], expect + v);
+          break;
+        }
+        ring.consume(n);
+        expect += n;
+      }
+      else if (0 == ring.get(&v)) {
+        if (v != expect) {
+          log.concatf("SPSC: get() found %u where %u belonged.\n", v, expect);
+          break;
+        }
+        expect++;
+      }
+      else {
+        yieldThread();
+      }
+    }
+    unsigned long t1 = micros();
+    pthread_join(thread, nullptr);
+    if (RING_TEST_COUNT != expect) goto ring_test_done;
+    if (ring.hasNext()) {
+      log.concat("SPSC: The ring had leftovers.\n");
+      goto ring_test_done;
+    }
+    log.concatf("SPSC: %d elements in %lu us.\n", RING_TEST_COUNT, t1 - t0);
+  }
+  #endif  // __BUILD_HAS_PTHREADS
+
+  log.concat("Test passes.\n");
+  return_value = 0;
+
+ring_test_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/*
+* A fixed-size record of the sort that transports and audio paths move.
+*/
+typedef struct {
+  uint8_t bytes[64];
+} RingBenchFrame;
+
+/*
+* Elements through the ring in batches that never fill it, one at a time and
+*   in bulk, for words and for 64-byte frames.
+* Informational only. No test.
+*/
+void bench_RingBuffer() {
+  StringBuilder log("===< RingBuffer benchmark >=============================\n");
+  const int ROUNDS = 100000;
+  const int BATCH  = 48;
+  uint32_t words[BATCH];
+  RingBenchFrame frames[BATCH];
+  RingBenchFrame frame;
+  unsigned long sum = 0;
+  unsigned int n    = 0;
+  RingBuffer<uint32_t> w_ring(64);
+  RingBuffer<RingBenchFrame> f_ring(64);
+  memset(frames, 1, sizeof(frames));
+  memset(&frame, 1, sizeof(frame));
+  for (int i = 0; i < BATCH; i++) words[i] = i;
+
+  unsigned long t0 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < BATCH; i++) w_ring.insert((uint32_t) (r + i));
+    for (int i = 0; i < BATCH; i++) sum += w_ring.get();
+  }
+  unsigned long t1 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    w_ring.insert(words, BATCH);
+    sum += w_ring.get(words, BATCH);
+  }
+  unsigned long t2 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < BATCH; i++) {
+      frame.bytes[0] = (uint8_t) i;
+      f_ring.insert(frame);
+    }
+    for (int i = 0; i < BATCH; i++) {
+      f_ring.get(&frame);
+      sum += frame.bytes[0];
+    }
+  }
+  unsigned long t3 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    f_ring.insert(frames, BATCH);
+    sum += f_ring.get(frames, BATCH);
+  }
+  unsigned long t4 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    // Filled and drained in place, as a transport's read() would.
+    unsigned int filled = 0;
+    while (filled < (unsigned int) BATCH) {
+      RingBenchFrame* span = f_ring.reserve(&n);
+      if (n > BATCH - filled) n = BATCH - filled;
+      for (unsigned int i = 0; i < n; i++) span[i].bytes[0] = (uint8_t) i;
+      f_ring.commit(n);
+      filled += n;
+    }
+    while (nullptr != f_ring.peek(&n)) {
+      sum += n;
+      f_ring.consume(n);
+    }
+  }
+  unsigned long t5 = micros();
+
+  const double ELEMENTS = (double) ROUNDS * BATCH * 2;   // In, and out.
+  log.concatf("\t %d rounds of %d elements in, then out.\n", ROUNDS, BATCH);
+  log.concatf("\t u32 one at a time:      %6.2f ns/element\n", ((double) (t1 - t0) * 1000) / ELEMENTS);
+  log.concatf("\t u32 in bulk:            %6.2f ns/element\n", ((double) (t2 - t1) * 1000) / ELEMENTS);
+  log.concatf("\t Frame one at a time:    %6.2f ns/element\n", ((double) (t3 - t2) * 1000) / ELEMENTS);
+  log.concatf("\t Frame in bulk:          %6.2f ns/element\n", ((double) (t4 - t3) * 1000) / ELEMENTS);
+  log.concatf("\t Frame reserve/peek:     %6.2f ns/element\n", ((double) (t5 - t4) * 1000) / ELEMENTS);
+  if (0 == sum) log.concat("\t (The optimizer was not fooled.)\n");
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+}
+
+/**
+* MsgQueue must order like the PriorityQueue it replaced in the Kernel:
+*   highest priority first, FIFO within a priority.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_MsgQueue(void) {
+  StringBuilder log("===< MsgQueue >=========================================\n");
+  const int TEST_COUNT = 12;
+  ManuvrMsg msgs[TEST_COUNT];
+  MsgQueue  queue;
+  int return_value = -1;
+
+  for (int i = 0; i < TEST_COUNT; i++) {
+    msgs[i].repurpose(MANUVR_MSG_SYS_REBOOT);
+    msgs[i].priority((i % 3) * 50);   // Priorities 0, 50, 100.
+    if (0 != queue.insert(&msgs[i])) {
+      log.concatf("Failed to insert Msg %d.\n", i);
+      goto msg_queue_test_done;
+    }
+  }
+  if (0 == queue.insert(&msgs[4])) {
+    log.concat("Queue accepted the same Msg twice.\n");
+    goto msg_queue_test_done;
+  }
+  if (!queue.remove(&msgs[5]) || queue.remove(&msgs[5]) || msgs[5].isEnqueued()) {
+    log.concat("remove() misbehaved.\n");
+    goto msg_queue_test_done;
+  }
+  if (TEST_COUNT - 1 != queue.size()) {
+    log.concatf("Queue size should be %d, but is %d.\n", TEST_COUNT - 1, queue.size());
+    goto msg_queue_test_done;
+  }
+  {
+    // Expected order: 2, 8, 11, 1, 4, 7, 10, 0, 3, 6, 9  (5 was removed)
+    const int expected[] = {2, 8, 11, 1, 4, 7, 10, 0, 3, 6, 9};
+    for (int i = 0; i < TEST_COUNT - 1; i++) {
+      ManuvrMsg* m = queue.dequeue();
+      if (m != &msgs[expected[i]]) {
+        log.concatf("Dequeue %d returned the wrong Msg.\n", i);
+        goto msg_queue_test_done;
+      }
+      if (m->isEnqueued()) {
+        log.concat("Dequeued Msg still thinks it is enqueued.\n");
+        goto msg_queue_test_done;
+      }
+    }
+  }
+  if (queue.hasNext() || (nullptr != queue.dequeue())) {
+    log.concat("Queue should be empty.\n");
+    goto msg_queue_test_done;
+  }
+  log.concat("Test passes.\n");
+  return_value = 0;
+
+msg_queue_test_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/**
+* Compares MsgQueue against the PriorityQueue<ManuvrMsg*> the Kernel used to use
+*   for its exec_queue. Each pass fills the queue to the given depth the way
+*   validate_insertion() does (idempotency check, then insert), and drains it.
+* Informational only. No test.
+*/
+void bench_MsgQueue() {
+  StringBuilder log("===< MsgQueue benchmark >===============================\n");
+  const int depths[] = {10, 100, 1000, 10000};
+  log.concat("\t Depth    PriorityQueue (us)    MsgQueue (us)\n");
+  for (unsigned int d = 0; d < sizeof(depths) / sizeof(int); d++) {
+    int depth = depths[d];
+    ManuvrMsg* msgs = new ManuvrMsg[depth];
+    for (int i = 0; i < depth; i++) {
+      msgs[i].repurpose(MANUVR_MSG_SYS_REBOOT);
+      msgs[i].priority(randomInt() % 4);
+    }
+
+    PriorityQueue<ManuvrMsg*> old_queue;
+    unsigned long t0 = micros();
+    for (int i = 0; i < depth; i++) {
+      if (!old_queue.contains(&msgs[i])) {
+        old_queue.insert(&msgs[i], msgs[i].priority());
+      }
+    }
+    while (old_queue.hasNext()) old_queue.dequeue();
+    unsigned long t1 = micros();
+
+    MsgQueue new_queue;
+    for (int i = 0; i < depth; i++) {
+      new_queue.insert(&msgs[i]);
+    }
+    while (new_queue.hasNext()) new_queue.dequeue();
+    unsigned long t2 = micros();
+
+    log.concatf("\t %5d    %18lu    %13lu\n", depth, t1 - t0, t2 - t1);
+    delete[] msgs;
+  }
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+}
+
+
+#if defined(__BUILD_HAS_PTHREADS)
+#define INGRESS_TEST_PRODUCERS      4
+#define INGRESS_TEST_PER_PRODUCER   25000
+
+struct IngressProducerArgs {
+  MsgIngress* ring;
+  ManuvrMsg*  msgs;       // This producer's slice of the Msg pool.
+  uint32_t    full_spins; // How often did we find the ring full?
+};
+
+void* ingress_producer(void* a) {
+  IngressProducerArgs* args = (IngressProducerArgs*) a;
+  for (int i = 0; i < INGRESS_TEST_PER_PRODUCER; i++) {
+    while (0 != args->ring->push(&args->msgs[i])) {
+      args->full_spins++;
+      yieldThread();
+    }
+  }
+  return nullptr;
+}
+#endif  // __BUILD_HAS_PTHREADS
+
+/**
+* Several producer threads hammer a single MsgIngress while this thread drains
+*   it. Every Msg must come out exactly once, and each producer's Msgs must come
+*   out in the order that producer pushed them.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_MsgIngress(void) {
+  StringBuilder log("===< MsgIngress >=======================================\n");
+  int return_value = -1;
+  #if defined(__BUILD_HAS_PTHREADS)
+  const int TOTAL = INGRESS_TEST_PRODUCERS * INGRESS_TEST_PER_PRODUCER;
+  ManuvrMsg* msgs  = new ManuvrMsg[TOTAL];
+  uint8_t*   seen  = (uint8_t*) calloc(TOTAL, 1);
+  int        last_idx[INGRESS_TEST_PRODUCERS];
+  pthread_t  threads[INGRESS_TEST_PRODUCERS];
+  IngressProducerArgs args[INGRESS_TEST_PRODUCERS];
+  MsgIngress ring;
+  int received = 0;
+  uint32_t full_spins = 0;
+
+  if (0 == ring.push(nullptr)) {
+    log.concat("Ingress accepted a NULL.\n");
+    goto msg_ingress_test_done;
+  }
+  if (nullptr != ring.pop()) {
+    log.concat("Empty ingress returned a Msg.\n");
+    goto msg_ingress_test_done;
+  }
+
+  {
+    unsigned long t0 = micros();
+    for (int p = 0; p < INGRESS_TEST_PRODUCERS; p++) {
+      last_idx[p]        = -1;
+      args[p].ring       = &ring;
+      args[p].msgs       = &msgs[p * INGRESS_TEST_PER_PRODUCER];
+      args[p].full_spins = 0;
+      pthread_create(&threads[p], nullptr, ingress_producer, &args[p]);
+    }
+
+    while (received < TOTAL) {
+      ManuvrMsg* m = ring.pop();
+      if (nullptr == m) {
+        yieldThread();   // Let the producers run if we are short on cores.
+        continue;
+      }
+      int idx = m - msgs;
+      if ((idx < 0) || (idx >= TOTAL)) {
+        log.concatf("Ingress produced a pointer that no one pushed (%p).\n", m);
+        break;
+      }
+      if (seen[idx]++) {
+        log.concatf("Msg %d came out twice.\n", idx);
+        break;
+      }
+      int p = idx / INGRESS_TEST_PER_PRODUCER;
+      if (idx < last_idx[p]) {
+        log.concatf("Producer %d was reordered (%d after %d).\n", p, idx, last_idx[p]);
+        break;
+      }
+      last_idx[p] = idx;
+      received++;
+    }
+    unsigned long t1 = micros();
+
+    for (int p = 0; p < INGRESS_TEST_PRODUCERS; p++) {
+      pthread_join(threads[p], nullptr);
+      full_spins += args[p].full_spins;
+    }
+
+    if (received == TOTAL) {
+      if (nullptr != ring.pop()) {
+        log.concat("Ingress produced more Msgs than were pushed.\n");
+        goto msg_ingress_test_done;
+      }
+      log.concatf(
+        "%d producers, %d Msgs in %lu us (%.0f Msgs/sec). Ring was full %u times.\n",
+        INGRESS_TEST_PRODUCERS, TOTAL, t1 - t0,
+        (double) TOTAL * 1000000 / (double) ((t1 - t0) ? (t1 - t0) : 1),
+        full_spins
+      );
+      log.concat("Test passes.\n");
+      return_value = 0;
+    }
+  }
+
+msg_ingress_test_done:
+  delete[] msgs;
+  free(seen);
+  #else
+  log.concat("No threads. Skipped.\n");
+  return_value = 0;
+  #endif  // __BUILD_HAS_PTHREADS
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/**
+* ScheduleHeap must hand back enabled schedules in deadline order, only once
+*   they are due, with fireNow() jumping the line, and never a disabled one.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_ScheduleHeap(void) {
+  StringBuilder log("===< ScheduleHeap >=====================================\n");
+  const int TEST_COUNT = 40;
+  ManuvrMsg    msgs[TEST_COUNT];
+  uint32_t     due[TEST_COUNT];
+  bool         fired[TEST_COUNT];
+  ScheduleHeap heap;
+  int return_value = -1;
+  uint32_t last_due = 0;
+  int fire_count = 0;
+  ManuvrMsg* m;
+
+  for (int i = 0; i < TEST_COUNT; i++) {
+    due[i]   = 1 + (randomInt() % 1000);
+    fired[i] = false;
+    msgs[i].delaySchedule(due[i]);   // Scheduler clock is zero. So this is absolute.
+    if (0 != heap.insert(&msgs[i])) {
+      log.concatf("Failed to insert schedule %d.\n", i);
+      goto sched_heap_test_done;
+    }
+  }
+  if ((0 == heap.insert(&msgs[3])) || (TEST_COUNT != heap.size())) {
+    log.concat("Heap accepted the same schedule twice.\n");
+    goto sched_heap_test_done;
+  }
+
+  // Disable two, remove one, and push one way out. These should never fire.
+  msgs[5].enableSchedule(false);
+  heap.update(&msgs[5]);
+  msgs[6].enableSchedule(false);
+  heap.update(&msgs[6]);
+  if (!heap.remove(&msgs[7]) || heap.remove(&msgs[7]) || heap.contains(&msgs[7])) {
+    log.concat("remove() misbehaved.\n");
+    goto sched_heap_test_done;
+  }
+  msgs[8].delaySchedule(5000);
+  heap.update(&msgs[8]);
+
+  // One that isn't due for a while is asked to fire now.
+  msgs[9].delaySchedule(2000);
+  msgs[9].fireNow();
+  heap.update(&msgs[9]);
+  if (heap.nextDue(0) != &msgs[9]) {
+    log.concat("fireNow() did not jump the line.\n");
+    goto sched_heap_test_done;
+  }
+  heap.remove(&msgs[9]);
+
+  for (uint32_t now = 0; now <= 1000; now++) {
+    while (nullptr != (m = heap.nextDue(now))) {
+      int idx = m - msgs;
+      if ((idx == 5) || (idx == 6) || (idx == 7) || (idx == 8) || (idx == 9)) {
+        log.concatf("Schedule %d should not have fired.\n", idx);
+        goto sched_heap_test_done;
+      }
+      if ((due[idx] > now) || (due[idx] < last_due) || fired[idx]) {
+        log.concatf("Schedule %d (due %u) fired out of order at %u.\n", idx, due[idx], now);
+        goto sched_heap_test_done;
+      }
+      last_due   = due[idx];
+      fired[idx] = true;
+      fire_count++;
+      heap.remove(m);
+    }
+  }
+  if ((TEST_COUNT - 5) != fire_count) {
+    log.concatf("%d schedules fired. Expected %d.\n", fire_count, TEST_COUNT - 5);
+    goto sched_heap_test_done;
+  }
+  if ((3 != heap.size()) || (nullptr != heap.nextDue(4999))) {
+    log.concat("Heap should hold only the two disabled schedules and the distant one.\n");
+    goto sched_heap_test_done;
+  }
+  if (heap.nextDue(5000) != &msgs[8]) {
+    log.concat("Distant schedule did not come due.\n");
+    goto sched_heap_test_done;
+  }
+  log.concat("Test passes.\n");
+  return_value = 0;
+
+sched_heap_test_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
 /*
 * These tests are meant to test the memory-management implications of
 *   the Argument class.
@@ -411,31 +1241,1808 @@ int test_Arguments_PODs() {
 }
 
 
-int test_Arguments() {
-  int return_value = test_Arguments_KVP();
-  if (0 == return_value) {
-    return_value = test_Arguments_InternalTypes();
-    if (0 == return_value) {
-      return_value = test_Arguments_PODs();
-      if (0 == return_value) {
-      #if defined(MANUVR_CBOR)
-        return_value = test_CBOR_Argument();
-        if (0 == return_value) {
-
-        }
-      #endif
-      }
+/**
+* Every compiled-in def must be found by its code, runtime defs must be found
+*   and replaceable, and unknown codes must resolve to the UNDEFINED def.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_MsgDefs() {
+  int return_value = -1;
+  StringBuilder log("===< Msg definitions >==================================\n");
+  const int RUNTIME_DEFS = 300;
+  MessageTypeDef* runtime_defs = (MessageTypeDef*) malloc(RUNTIME_DEFS * sizeof(MessageTypeDef));
+  MessageTypeDef  replacement;
+  MessageTypeDef  imposter;
+
+  for (int i = 0; i < ManuvrMsg::TOTAL_MSG_DEFS; i++) {
+    const MessageTypeDef* def = &ManuvrMsg::message_defs[i];
+    if (ManuvrMsg::lookupMsgDefByCode(def->msg_type_code) != def) {
+      log.concatf("\t Compiled-in def 0x%04x (%s) was not found.\n", def->msg_type_code, def->debug_label);
+      goto msg_defs_done;
     }
   }
-  return return_value;
-}
-
+  if (ManuvrMsg::lookupMsgDefByCode(0xF7FE) != &ManuvrMsg::message_defs[0]) {
+    log.concat("\t An unknown code did not resolve to the UNDEFINED def.\n");
+    goto msg_defs_done;
+  }
 
-int test_BufferPipe() {
+  // Enough runtime defs to force the table to grow a few times.
+  for (int i = 0; i < RUNTIME_DEFS; i++) {
+    runtime_defs[i].msg_type_code  = 0xE000 + (i * 7);
+    runtime_defs[i].msg_type_flags = 0;
+    runtime_defs[i].debug_label    = "RUNTIME_DEF";
+    runtime_defs[i].arg_modes      = ManuvrMsg::MSG_ARGS_NONE;
+  }
+  if (ManuvrMsg::registerMessages(runtime_defs, RUNTIME_DEFS)) {
+    log.concat("\t Failed to register runtime defs.\n");
+    goto msg_defs_done;
+  }
+  for (int i = 0; i < RUNTIME_DEFS; i++) {
+    if (ManuvrMsg::lookupMsgDefByCode(runtime_defs[i].msg_type_code) != &runtime_defs[i]) {
+      log.concatf("\t Runtime def 0x%04x was not found.\n", runtime_defs[i].msg_type_code);
+      goto msg_defs_done;
+    }
+  }
+  for (int i = 0; i < ManuvrMsg::TOTAL_MSG_DEFS; i++) {
+    const MessageTypeDef* def = &ManuvrMsg::message_defs[i];
+    if (ManuvrMsg::lookupMsgDefByCode(def->msg_type_code) != def) {
+      log.concatf("\t Compiled-in def 0x%04x was lost when the table grew.\n", def->msg_type_code);
+      goto msg_defs_done;
+    }
+  }
+
+  // Runtime defs can be replaced. Compiled-in defs can't.
+  replacement = runtime_defs[0];
+  imposter    = ManuvrMsg::message_defs[1];
+  ManuvrMsg::registerMessage(&replacement);
+  ManuvrMsg::registerMessage(&imposter);
+  if (ManuvrMsg::lookupMsgDefByCode(replacement.msg_type_code) != &replacement) {
+    log.concat("\t A runtime def was not replaced.\n");
+    goto msg_defs_done;
+  }
+  if (ManuvrMsg::lookupMsgDefByCode(imposter.msg_type_code) != &ManuvrMsg::message_defs[1]) {
+    log.concat("\t A compiled-in def was replaced.\n");
+    goto msg_defs_done;
+  }
+  log.concatf("\t %d compiled-in and %d runtime defs all resolve.\n", ManuvrMsg::TOTAL_MSG_DEFS, RUNTIME_DEFS);
+  return_value = 0;
+  // NOTE: The runtime defs stay registered, so we don't free them.
+
+msg_defs_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/*
+* Looks up every compiled-in code, the way it used to be done and the way it is
+*   done now.
+*/
+void bench_MsgDefs() {
+  StringBuilder log("===< Msg definition lookup benchmark >==================\n");
+  const int ROUNDS = 1000;
+  uintptr_t sum = 0;
+  unsigned long t0 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int c = 0; c < ManuvrMsg::TOTAL_MSG_DEFS; c++) {
+      uint16_t code = ManuvrMsg::message_defs[c].msg_type_code;
+      for (int i = 0; i < ManuvrMsg::TOTAL_MSG_DEFS; i++) {
+        if (ManuvrMsg::message_defs[i].msg_type_code == code) {
+          sum += (uintptr_t) &ManuvrMsg::message_defs[i];
+          break;
+        }
+      }
+    }
+  }
+  unsigned long t1 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int c = 0; c < ManuvrMsg::TOTAL_MSG_DEFS; c++) {
+      sum -= (uintptr_t) ManuvrMsg::lookupMsgDefByCode(ManuvrMsg::message_defs[c].msg_type_code);
+    }
+  }
+  unsigned long t2 = micros();
+  unsigned int lookups = ROUNDS * ManuvrMsg::TOTAL_MSG_DEFS;
+  log.concatf("\t %u lookups over %d codes.\n", lookups, ManuvrMsg::TOTAL_MSG_DEFS);
+  log.concatf("\t Linear scan: %8lu us   (%.1f ns/lookup)\n", t1 - t0, ((double) (t1 - t0) * 1000) / lookups);
+  log.concatf("\t Hash table:  %8lu us   (%.1f ns/lookup)\n", t2 - t1, ((double) (t2 - t1) * 1000) / lookups);
+  if (0 != sum) log.concat("\t The two methods disagreed.\n");
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+}
+
+
+/**
+* Checks the latency histogram's buckets and percentiles, and that the table
+*   files codes where they can be found again.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_LatencyHistogram() {
+  int return_value = -1;
+  StringBuilder log("===< Latency histogram >================================\n");
+  LatencyHistogram* hist  = new LatencyHistogram();
+  LatencyTable*     table = new LatencyTable();
+  uint32_t p50  = 0;
+  uint32_t p99  = 0;
+  uint32_t p999 = 0;
+
+  // Every value must land in a bucket whose ceiling covers it, within one part
+  //   in 2^LATENCY_SUB_BITS.
+  for (uint32_t v = 0; v < (1u << LATENCY_MAX_BITS); v = (v < 64) ? (v + 1) : (v + (v >> 4) + 1)) {
+    uint16_t b = LatencyHistogram::bucketOf(v);
+    uint32_t ceiling = LatencyHistogram::bucketCeiling(b);
+    if ((b >= LATENCY_BUCKETS) || (ceiling < v) || ((b < (LATENCY_BUCKETS - 1)) && ((ceiling - v) > (v >> LATENCY_SUB_BITS)))) {
+      log.concatf("\t %u went to bucket %u, whose ceiling is %u.\n", v, b, ceiling);
+      goto latency_hist_done;
+    }
+    if ((b > 0) && (LatencyHistogram::bucketCeiling(b - 1) >= v)) {
+      log.concatf("\t %u belongs in an earlier bucket than %u.\n", v, b);
+      goto latency_hist_done;
+    }
+  }
+  if ((LATENCY_BUCKETS - 1) != LatencyHistogram::bucketOf(0xFFFFFFFF)) {
+    log.concat("\t The largest durations didn't land in the last bucket.\n");
+    goto latency_hist_done;
+  }
+
+  // 1 through 10000, once each.
+  hist->clear();
+  for (uint32_t v = 1; v <= 10000; v++) hist->record(v);
+  p50  = hist->percentile(500);
+  p99  = hist->percentile(990);
+  p999 = hist->percentile(999);
+  log.concatf("\t 1..10000: p50 %u, p99 %u, p999 %u, worst %u\n", p50, p99, p999, hist->worst());
+  if ((10000 != hist->count()) || (10000 != hist->worst())) {
+    log.concat("\t Count or worst is wrong.\n");
+    goto latency_hist_done;
+  }
+  if ((p50 < 5000) || (p50 > (5000 + (5000 >> LATENCY_SUB_BITS))) || (p99 < 9900) || (p999 < 9990) || (p999 > 10000)) {
+    log.concat("\t Percentiles are out of tolerance.\n");
+    goto latency_hist_done;
+  }
+
+  // Ranks round up. With 100 samples, p99.9 must be the single outlier.
+  hist->clear();
+  for (uint32_t v = 0; v < 99; v++) hist->record(1);
+  hist->record(1000);
+  p99  = hist->percentile(990);
+  p999 = hist->percentile(999);
+  log.concatf("\t 99 x 1, 1 x 1000: p99 %u, p999 %u\n", p99, p999);
+  if ((1 != p99) || (1000 != p999) || (1 != hist->percentile(0))) {
+    log.concat("\t Percentile ranks are not rounded up.\n");
+    goto latency_hist_done;
+  }
+
+  // Codes must come back to the same profile, and a full table turns codes away.
+  {
+    LatencyProfile* first = table->lookup(0x0123);
+    if ((nullptr == first) || (first != table->lookup(0x0123)) || (0x0123 != first->code)) {
+      log.concat("\t A code didn't come back to its own profile.\n");
+      goto latency_hist_done;
+    }
+    int claimed = 1;
+    for (uint16_t c = 0x0400; c < (0x0400 + MANUVR_PROFILER_CODES + 4); c++) {
+      if (nullptr != table->lookup(c)) claimed++;
+    }
+    if ((table->capacity() != claimed) || (5 != table->turnedAway())) {
+      log.concatf("\t Claimed %d slots of %d, and turned %u away.\n", claimed, table->capacity(), table->turnedAway());
+      goto latency_hist_done;
+    }
+    if (first != table->lookup(0x0123)) {
+      log.concat("\t Filling the table moved a profile.\n");
+      goto latency_hist_done;
+    }
+  }
+
+  #if defined(MANUVR_EVENT_PROFILER)
+  // Now through the Kernel.
+  {
+    Kernel* kernel = platform.kernel();
+    const uint16_t CODE_P = 0xF7B0;
+    StringBuilder report;
+    ManuvrMsg::registerMessage(CODE_P, 0, "LATENCY_TEST", ManuvrMsg::MSG_ARGS_NONE, nullptr);
+    kernel->profiler(true);
+    for (int i = 0; i < 20; i++) Kernel::raiseEvent(CODE_P, nullptr);
+    for (int i = 0; i < 30; i++) kernel->procIdleFlags();
+    kernel->printProfiler(&report);
+    kernel->profiler(false);
+    if (nullptr == strstr((char*) report.string(), "LATENCY_TEST")) {
+      log.concat("\t The profiler didn't report our code.\n");
+      goto latency_hist_done;
+    }
+  }
+  #endif  // MANUVR_EVENT_PROFILER
+  return_value = 0;
+
+latency_hist_done:
+  delete hist;
+  delete table;
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/*
+* Compares the cost of recording into the latency table against the linear
+*   scan of TaskProfilerData that the Kernel used to do.
+*/
+void bench_LatencyHistogram() {
+  StringBuilder log("===< Latency histogram benchmark >======================\n");
+  const int ROUNDS = 2000;
+  const int CODES  = 24;
+  LatencyTable* table = new LatencyTable();
+  #if defined(MANUVR_EVENT_PROFILER)
+  unsigned long t0 = micros();
+  PriorityQueue<TaskProfilerData*> costs;
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int c = 0; c < CODES; c++) {
+      uint16_t code = 0x0300 + (uint16_t) c;
+      TaskProfilerData* item = nullptr;
+      for (int i = 0; (nullptr == item) && (i < costs.size()); i++) {
+        if (costs.get(i)->msg_code == code) item = costs.get(i);
+      }
+      if (nullptr == item) {
+        item = new TaskProfilerData();
+        item->msg_code = code;
+        costs.insert(item, 1);
+      }
+      else {
+        costs.incrementPriority(item);
+      }
+      item->executions++;
+      item->run_time_last   = (uint32_t) (r + c);
+      item->run_time_worst  = strict_max(item->run_time_last, item->run_time_worst);
+      item->run_time_total += item->run_time_last;
+    }
+  }
+  while (costs.hasNext()) delete costs.dequeue();
+  #endif  // MANUVR_EVENT_PROFILER
+  unsigned long t1 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int c = 0; c < CODES; c++) {
+      LatencyProfile* p = table->lookup(0x0300 + (uint16_t) c);
+      if (nullptr != p) p->run.record((uint32_t) (r + c));
+    }
+  }
+  unsigned long t2 = micros();
+  unsigned int records = ROUNDS * CODES;
+  log.concatf("\t %u records over %d codes.\n", records, CODES);
+  #if defined(MANUVR_EVENT_PROFILER)
+  log.concatf("\t Sorted list:    %8lu us   (%.1f ns/record)\n", t1 - t0, ((double) (t1 - t0) * 1000) / records);
+  #endif  // MANUVR_EVENT_PROFILER
+  log.concatf("\t Latency table:  %8lu us   (%.1f ns/record)\n", t2 - t1, ((double) (t2 - t1) * 1000) / records);
+  delete table;
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+}
+
+
+#if defined(__BUILD_HAS_PTHREADS)
+/* Leaves a few spans in its own ring. */
+void* trace_from_thread(void*) {
+  for (int i = 0; i < 10; i++) {
+    TraceSpan span(TraceCat::BUS, (uint16_t) i, "TraceThread", (uint16_t) i);
+  }
+  return nullptr;
+}
+#endif  // __BUILD_HAS_PTHREADS
+
+/**
+* Records spans from more than one thread, and checks what comes out as JSON.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_Tracer() {
+  int return_value = -1;
+  StringBuilder log("===< Tracer >===========================================\n");
+  StringBuilder json;
+  int expected = 0;
+  int count    = 0;
+
+  Tracer::clear();
+  Tracer::record(TracePhase::INSTANT, TraceCat::MSG, 1, "Ignored", 0);   // Not enabled yet.
+  Tracer::enabled(true);
+  {
+    TraceSpan outer(TraceCat::MSG, 0x1234, "TraceOuter", 3);
+    Tracer::record(TracePhase::INSTANT, TraceCat::SCHEDULE, 0x1234, "TraceInstant", 2);
+  }
+  expected = 3;
+  #if defined(__BUILD_HAS_PTHREADS)
+  {
+    pthread_t thread;
+    pthread_create(&thread, nullptr, trace_from_thread, nullptr);
+    pthread_join(thread, nullptr);
+    expected += 20;
+  }
+  #endif  // __BUILD_HAS_PTHREADS
+  Tracer::enabled(false);
+
+  count = Tracer::exportJSON(&json);
+  log.concatf("\t Exported %d records (%u bytes).\n", count, json.length());
+  if (count != expected) {
+    log.concatf("\t Expected %d records.\n", expected);
+    goto tracer_done;
+  }
+  {
+    const char* str = (const char*) json.string();
+    if ((0 != strncmp(str, "{\"traceEvents\":[", 16)) || (nullptr != strstr(str, "Ignored"))) {
+      log.concat("\t The JSON is malformed, or has a record it shouldn't.\n");
+      goto tracer_done;
+    }
+    if (nullptr == strstr(str, "\"name\":\"TraceOuter\",\"cat\":\"msg\",\"ph\":\"B\"")) {
+      log.concat("\t The outer span didn't begin.\n");
+      goto tracer_done;
+    }
+    if (nullptr == strstr(str, "\"name\":\"TraceInstant\",\"cat\":\"schedule\",\"ph\":\"i\",\"s\":\"t\"")) {
+      log.concat("\t The instant is missing.\n");
+      goto tracer_done;
+    }
+    #if defined(__BUILD_HAS_PTHREADS)
+    if (nullptr == strstr(str, "\"name\":\"TraceThread\",\"cat\":\"bus\",\"ph\":\"B\",\"ts\"")) {
+      log.concat("\t The other thread's spans are missing.\n");
+      goto tracer_done;
+    }
+    if (nullptr == strstr(str, "\"tid\":2")) {
+      log.concat("\t The other thread didn't get a ring of its own.\n");
+      goto tracer_done;
+    }
+    #endif  // __BUILD_HAS_PTHREADS
+  }
+
+  // A full ring keeps only the newest records.
+  Tracer::clear();
+  Tracer::enabled(true);
+  for (int i = 0; i < (MANUVR_TRACE_DEPTH + 10); i++) {
+    Tracer::record(TracePhase::INSTANT, TraceCat::MSG, (uint16_t) i, "TraceWrap", 0);
+  }
+  Tracer::enabled(false);
+  json.clear();
+  count = Tracer::exportJSON(&json);
+  if (MANUVR_TRACE_DEPTH != count) {
+    log.concatf("\t A full ring exported %d records. Expected %d.\n", count, MANUVR_TRACE_DEPTH);
+    goto tracer_done;
+  }
+  {
+    StringBuilder oldest;
+    oldest.concatf("\"code\":%d,", 10);
+    if (nullptr == strstr((const char*) json.string(), (const char*) oldest.string())) {
+      log.concat("\t The oldest surviving record is missing.\n");
+      goto tracer_done;
+    }
+  }
+
+  #if defined(MANUVR_TRACE)
+  // Now through the Kernel.
+  {
+    Kernel* kernel = platform.kernel();
+    const uint16_t CODE_T = 0xF7A0;
+    ManuvrMsg::registerMessage(CODE_T, 0, "TRACE_TEST", ManuvrMsg::MSG_ARGS_NONE, nullptr);
+    Tracer::clear();
+    Tracer::enabled(true);
+    Kernel::raiseEvent(CODE_T, nullptr);
+    for (int i = 0; i < 5; i++) kernel->procIdleFlags();
+    Tracer::enabled(false);
+    json.clear();
+    Tracer::exportJSON(&json);
+    if (nullptr == strstr((const char*) json.string(), "\"name\":\"TRACE_TEST\",\"cat\":\"msg\",\"ph\":\"B\"")) {
+      log.concat("\t The Kernel didn't trace our Msg.\n");
+      goto tracer_done;
+    }
+  }
+  #endif  // MANUVR_TRACE
+  return_value = 0;
+
+tracer_done:
+  Tracer::enabled(false);
+  Tracer::clear();
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/*
+* What does a span cost, with tracing on and off?
+*/
+void bench_Tracer() {
+  StringBuilder log("===< Tracer benchmark >=================================\n");
+  const int SPANS = 100000;
+  unsigned long t0 = micros();
+  for (int i = 0; i < SPANS; i++) {
+    TraceSpan span(TraceCat::MSG, (uint16_t) i, "TraceBench", 0);
+  }
+  unsigned long t1 = micros();
+  Tracer::enabled(true);
+  for (int i = 0; i < SPANS; i++) {
+    TraceSpan span(TraceCat::MSG, (uint16_t) i, "TraceBench", 0);
+  }
+  Tracer::enabled(false);
+  unsigned long t2 = micros();
+  Tracer::clear();
+  log.concatf("\t %d spans.\n", SPANS);
+  log.concatf("\t Disabled:  %8lu us   (%.1f ns/span)\n", t1 - t0, ((double) (t1 - t0) * 1000) / SPANS);
+  log.concatf("\t Enabled:   %8lu us   (%.1f ns/span)\n", t2 - t1, ((double) (t2 - t1) * 1000) / SPANS);
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+}
+
+
+/*
+* A subscriber that counts what it is told about.
+*/
+class CountingReceiver : public EventReceiver {
+  public:
+    int seen = 0;
+    CountingReceiver(const uint16_t* list) : EventReceiver("CountingReceiver") {
+      if (list) setInterests(list);
+    };
+    int8_t notify(ManuvrMsg* active_event) {
+      seen++;
+      return EventReceiver::notify(active_event);
+    };
+};
+
+/*
+* Checks that each code resolves to the expected list.
+*/
+int check_sub_list(SubscriberIndex* idx, uint16_t code, EventReceiver** expected, StringBuilder* log) {
+  EventReceiver** list = idx->lookup(code);
+  if (nullptr == list) {
+    log->concatf("\t No list for 0x%04x.\n", code);
+    return -1;
+  }
+  int i = 0;
+  while ((nullptr != expected[i]) && (list[i] == expected[i])) i++;
+  if ((nullptr != expected[i]) || (nullptr != list[i])) {
+    log->concatf("\t List for 0x%04x differs at position %d.\n", code, i);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+* Builds a subscriber index by hand and checks its lists. Then has the Kernel
+*   dispatch through it, and checks that each subscriber heard only what it
+*   asked for.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_SubscriberIndex() {
+  int return_value = -1;
+  StringBuilder log("===< Subscriber index >=================================\n");
+  const uint16_t CODE_X = 0xF7E0;
+  const uint16_t CODE_Y = 0xF7E1;
+  const uint16_t CODE_Z = 0xF7E2;   // Nobody declares this one.
+  static const uint16_t only_x[]   = {CODE_X, MANUVR_MSG_UNDEFINED};
+  static const uint16_t x_and_y[]  = {CODE_Y, CODE_X, CODE_X, MANUVR_MSG_UNDEFINED};
+  static const uint16_t nothing[]  = {MANUVR_MSG_UNDEFINED};
+  CountingReceiver all_of_it(nullptr);
+  CountingReceiver x_only(only_x);
+  CountingReceiver xy(x_and_y);
+  CountingReceiver deaf(nothing);
+  PriorityQueue<EventReceiver*> manifest;
+  SubscriberIndex idx;
+
+  manifest.insert(&deaf);
+  manifest.insert(&xy);
+  manifest.insert(&all_of_it);
+  manifest.insert(&x_only, 5);   // Priority should move it to the front.
+  if (0 != idx.rebuild(&manifest)) {
+    log.concat("\t Failed to build the index.\n");
+    goto sub_index_done;
+  }
+  {
+    EventReceiver* expect_x[]    = {&x_only, &xy, &all_of_it, nullptr};
+    EventReceiver* expect_y[]    = {&xy, &all_of_it, nullptr};
+    EventReceiver* expect_z[]    = {&all_of_it, nullptr};
+    EventReceiver* expect_boot[] = {&x_only, &deaf, &xy, &all_of_it, nullptr};
+    if (manifest.get(0) != &x_only) {
+      log.concat("\t The manifest isn't in the order this test expects.\n");
+      goto sub_index_done;
+    }
+    expect_boot[1] = manifest.get(1);
+    expect_boot[2] = manifest.get(2);
+    expect_boot[3] = manifest.get(3);
+    if (check_sub_list(&idx, CODE_X, expect_x, &log))  goto sub_index_done;
+    if (check_sub_list(&idx, CODE_Y, expect_y, &log))  goto sub_index_done;
+    if (check_sub_list(&idx, CODE_Z, expect_z, &log))  goto sub_index_done;
+    if (check_sub_list(&idx, MANUVR_MSG_SYS_BOOT_COMPLETED, expect_boot, &log))  goto sub_index_done;
+    if (2 != idx.codes()) {
+      log.concatf("\t Index has %d codes. Expected 2.\n", idx.codes());
+      goto sub_index_done;
+    }
+  }
+
+  // Now through the Kernel.
+  {
+    Kernel* kernel = platform.kernel();
+    ManuvrMsg::registerMessage(CODE_X, 0, "SUB_IDX_X", ManuvrMsg::MSG_ARGS_NONE, nullptr);
+    ManuvrMsg::registerMessage(CODE_Y, 0, "SUB_IDX_Y", ManuvrMsg::MSG_ARGS_NONE, nullptr);
+    ManuvrMsg::registerMessage(CODE_Z, 0, "SUB_IDX_Z", ManuvrMsg::MSG_ARGS_NONE, nullptr);
+    kernel->subscribe(&all_of_it);
+    kernel->subscribe(&x_only);
+    kernel->subscribe(&xy);
+    kernel->subscribe(&deaf);
+    all_of_it.seen = 0;
+    x_only.seen    = 0;
+    xy.seen        = 0;
+    deaf.seen      = 0;
+    Kernel::raiseEvent(CODE_X, nullptr);
+    Kernel::raiseEvent(CODE_Y, nullptr);
+    Kernel::raiseEvent(CODE_Z, nullptr);
+    for (int i = 0; i < 10; i++) kernel->procIdleFlags();
+    kernel->unsubscribe(&all_of_it);
+    kernel->unsubscribe(&x_only);
+    kernel->unsubscribe(&xy);
+    kernel->unsubscribe(&deaf);
+    log.concatf("\t Seen: catch-all %d, x %d, xy %d, deaf %d\n", all_of_it.seen, x_only.seen, xy.seen, deaf.seen);
+    if ((3 != all_of_it.seen) || (1 != x_only.seen) || (2 != xy.seen) || (0 != deaf.seen)) {
+      log.concat("\t The Kernel notified the wrong subscribers.\n");
+      goto sub_index_done;
+    }
+  }
+  return_value = 0;
+
+sub_index_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/*
+* Listeners for the listener table test. Each leaves its mark in the order it
+*   was called.
+*/
+StringBuilder _listener_marks;
+int _listener_a(ManuvrMsg* m) {  _listener_marks.concat("a");  return 1;  }
+int _listener_b(ManuvrMsg* m) {  _listener_marks.concat("b");  return 0;  }
+int _listener_c(ManuvrMsg* m) {  _listener_marks.concat("c");  return 1;  }
+int _listener_adder(ManuvrMsg* m) {
+  // Adds a listener to the very code being dispatched.
+  _listener_marks.concat("+");
+  platform.kernel()->on(m->eventCode(), _listener_c, 0);
+  return 0;
+}
+
+/**
+* Checks ordering and lookup in a ListenerTable, and that the Kernel survives a
+*   listener that adds a listener while it is being dispatched.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_ListenerTable() {
+  int return_value = -1;
+  StringBuilder log("===< Listener table >===================================\n");
+  const uint16_t CODE_L = 0xF7D0;
+  ListenerTable table;
+  listenerFxnPtr* fxns = nullptr;
+  listenerFxnPtr* held = nullptr;
+  int count = 0;
+
+  // Codes added out of order, with listeners interleaved across codes.
+  table.add(0x0300, _listener_a);
+  table.add(0x0100, _listener_b);
+  table.add(0x0300, _listener_c);
+  table.add(0x0200, _listener_a);
+  table.add(0x0100, _listener_a);
+  table.add(0x0300, _listener_b);
+  if ((3 != table.codes()) || (6 != table.listeners())) {
+    log.concatf("\t Table has %d listeners over %d codes. Expected 6 over 3.\n", table.listeners(), table.codes());
+    goto listener_table_done;
+  }
+  if (0 != table.lookup(0x0150, &fxns)) {
+    log.concat("\t A code with no listeners had some.\n");
+    goto listener_table_done;
+  }
+  count = table.lookup(0x0300, &fxns);
+  if ((3 != count) || (fxns[0] != _listener_a) || (fxns[1] != _listener_c) || (fxns[2] != _listener_b)) {
+    log.concat("\t Listeners for 0x0300 are wrong, or out of order.\n");
+    goto listener_table_done;
+  }
+  count = table.lookup(0x0100, &fxns);
+  if ((2 != count) || (fxns[0] != _listener_b) || (fxns[1] != _listener_a)) {
+    log.concat("\t Listeners for 0x0100 are wrong, or out of order.\n");
+    goto listener_table_done;
+  }
+
+  // A list we are holding must survive an add until we reap.
+  count = table.lookup(0x0200, &held);
+  table.add(0x0200, _listener_b);
+  table.add(0x0050, _listener_c);
+  if ((1 != count) || (held[0] != _listener_a)) {
+    log.concat("\t A held list changed under us.\n");
+    goto listener_table_done;
+  }
+  table.reap();
+  count = table.lookup(0x0200, &fxns);
+  if ((2 != count) || (fxns[0] != _listener_a) || (fxns[1] != _listener_b)) {
+    log.concat("\t Listeners for 0x0200 are wrong after growth.\n");
+    goto listener_table_done;
+  }
+
+  // Now through the Kernel.
+  {
+    Kernel* kernel = platform.kernel();
+    ManuvrMsg::registerMessage(CODE_L, 0, "LISTENER_TEST", ManuvrMsg::MSG_ARGS_NONE, nullptr);
+    kernel->before(CODE_L, _listener_a, 0);
+    kernel->on(CODE_L, _listener_adder, 0);
+    _listener_marks.clear();
+    Kernel::raiseEvent(CODE_L, nullptr);
+    Kernel::raiseEvent(CODE_L, nullptr);
+    for (int i = 0; i < 10; i++) kernel->procIdleFlags();
+    // The listener added during the first Msg should only be seen from the second.
+    log.concatf("\t Kernel called: %s\n", (char*) _listener_marks.string());
+    if (0 != strcmp((char*) _listener_marks.string(), "a+a+c")) {
+      log.concat("\t Expected \"a+a+c\".\n");
+      goto listener_table_done;
+    }
+  }
+  return_value = 0;
+
+listener_table_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/* Sets a bit for every value, so that a set of matches can be compared. */
+uint32_t topic_match_mask(TopicTrie<uint32_t>* trie, const char* topic, int* count) {
+  uint32_t results[16];
+  uint32_t mask = 0;
+  *count = trie->match(topic, results, 16);
+  for (int i = 0; (i < *count) && (i < 16); i++) mask |= results[i];
+  return mask;
+}
+
+/**
+* Checks filter validation, '+' and '#' semantics (including '$' topics), and
+*   that removal prunes what it should and nothing else.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_TopicTrie() {
+  int return_value = -1;
+  StringBuilder log("===< Topic trie >=======================================\n");
+  TopicTrie<uint32_t> trie;
+  const char* filters[] = { "a/b/c", "a/+/c", "a/#", "#", "+/b/+", "$SYS/x", "a/b", "a//c" };
+  const char* malformed[] = { "", "a/b#", "a/#/c", "a+/b", "a/+x" };
+  const char* topics[] = { "a/b/c", "a", "a/b", "$SYS/x", "zz/q", "a//c", "a/x/c/d" };
+  const uint32_t expected[] = {
+    0x01 | 0x02 | 0x04 | 0x08 | 0x10,   // a/b/c
+    0x04 | 0x08,                        // a
+    0x04 | 0x08 | 0x40,                 // a/b
+    0x20,                               // $SYS/x
+    0x08,                               // zz/q
+    0x02 | 0x04 | 0x08 | 0x80,          // a//c
+    0x04 | 0x08                         // a/x/c/d
+  };
+  uint32_t val   = 0;
+  int      count = 0;
+  int      seen  = 0;
+
+  for (int i = 0; i < 8; i++) {
+    if (0 != trie.insert(filters[i], (1 << i))) {
+      log.concatf("Failed to insert %s.\n", filters[i]);
+      goto topic_trie_done;
+    }
+  }
+  if ((0 == trie.insert("a/+/c", 0x100)) || (8 != trie.size())) {
+    log.concat("A filter went in twice.\n");
+    goto topic_trie_done;
+  }
+  for (int i = 0; i < 5; i++) {
+    if (0 == trie.insert(malformed[i], 0x100)) {
+      log.concatf("Malformed filter \"%s\" was accepted.\n", malformed[i]);
+      goto topic_trie_done;
+    }
+  }
+  if (!trie.find("a/+/c", &val) || (0x02 != val) || trie.find("a/+", &val)) {
+    log.concat("Exact lookup of filters is wrong.\n");
+    goto topic_trie_done;
+  }
+
+  for (int i = 0; i < 7; i++) {
+    uint32_t mask = topic_match_mask(&trie, topics[i], &count);
+    if (mask != expected[i]) {
+      log.concatf("%s matched 0x%02x, rather than 0x%02x.\n", topics[i], mask, expected[i]);
+      goto topic_trie_done;
+    }
+  }
+  if (0 != trie.match("a/+/c", &val, 1)) {
+    log.concat("A topic with a wildcard in it matched.\n");
+    goto topic_trie_done;
+  }
+  if (5 != trie.match("a/b/c", &val, 1)) {
+    log.concat("A short result array changed the match count.\n");
+    goto topic_trie_done;
+  }
+
+  if ((0 != trie.remove("a/+/c")) || (0 == trie.remove("a/+/c")) || (0 == trie.remove("a/+/d")) || (7 != trie.size())) {
+    log.concat("Removal didn't go as expected.\n");
+    goto topic_trie_done;
+  }
+  if ((0x01 | 0x04 | 0x08 | 0x10) != topic_match_mask(&trie, "a/b/c", &count)) {
+    log.concat("Removing a/+/c disturbed the other filters.\n");
+    goto topic_trie_done;
+  }
+  if ((0 != trie.remove("#")) || ((0x04 | 0x40) != topic_match_mask(&trie, "a/b", &count))) {
+    log.concat("Removing # went wrong.\n");
+    goto topic_trie_done;
+  }
+  trie.each([](const char* filter, uint32_t v, void* arg) { (*((int*) arg))++; }, &seen);
+  if (seen != trie.size()) {
+    log.concatf("each() visited %d filters, but there are %d.\n", seen, trie.size());
+    goto topic_trie_done;
+  }
+  trie.clear();
+  if ((0 != trie.size()) || (0 != trie.match("a/b/c", &val, 1))) {
+    log.concat("clear() left something behind.\n");
+    goto topic_trie_done;
+  }
+  log.concatf("Test passes. %d levels interned.\n", TopicLevels::count());
+  return_value = 0;
+
+topic_trie_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+/* Serializes a QoS>0 PUBLISH by hand, as the session would with paho. */
+int mqtt_stub_publish(uint8_t* buf, uint16_t pid, uint8_t qos) {
+  const uint8_t pub[] = { 0x00, 11, 0x00, 0x03, 't', '/', 'x', 0x00, 0x00, 'a', 'b', 'c', 'd' };
+  memcpy(buf, pub, sizeof(pub));
+  buf[0] = 0x30 | (qos << 1);
+  buf[7] = (uint8_t) (pid >> 8);
+  buf[8] = (uint8_t) (pid & 0xFF);
+  return sizeof(pub);
+}
+
+/*
+* A loopback broker stub. It takes packets as a client would send them, and
+*   answers all of them one round trip later. Every nth packet it is sent is
+*   lost on the way. QoS2 ids are held between PUBREC and PUBREL, so that a
+*   retransmitted PUBLISH is delivered only once.
+*/
+class LoopbackBroker {
+  public:
+    uint32_t drop_every = 0;
+    uint32_t received   = 0;
+    uint32_t dropped    = 0;
+    uint32_t delivered  = 0;
+    uint32_t dups       = 0;   // PUBLISHes that arrived with DUP set.
+
+    LoopbackBroker() {   memset(_held, 0, sizeof(_held));   };
+
+    void receive(const uint8_t* pkt, int len) {
+      received++;
+      if (((0 != drop_every) && (0 == (received % drop_every))) || (_reply_count >= REPLY_MAX)) {
+        dropped++;
+        return;
+      }
+      uint8_t type = pkt[0] >> 4;
+      uint16_t pid;
+      if (3 == type) {
+        uint8_t qos  = (pkt[0] >> 1) & 0x03;
+        uint16_t off = 4 + ((pkt[2] << 8) | pkt[3]);
+        pid = (pkt[off] << 8) | pkt[off + 1];
+        if (pkt[0] & 0x08) dups++;
+        if (1 == qos) {
+          delivered++;
+          _reply(4, pid);
+        }
+        else {
+          if (!_is_held(pid)) {
+            delivered++;
+            _held[pid >> 3] |= (1 << (pid & 7));
+          }
+          _reply(5, pid);
+        }
+      }
+      else if (6 == type) {
+        pid = (pkt[2] << 8) | pkt[3];
+        _held[pid >> 3] &= ~(1 << (pid & 7));
+        _reply(7, pid);
+      }
+    };
+
+    /* Plays the client's half of a round trip. */
+    void roundTrip(MQTTInflight* win, uint32_t now) {
+      int      n = _reply_count;
+      uint16_t replies[REPLY_MAX];
+      uint8_t  types[REPLY_MAX];
+      memcpy(replies, _replies, sizeof(uint16_t) * n);
+      memcpy(types, _types, n);
+      _reply_count = 0;   // Answers to anything sent from here go in the next round.
+      for (int i = 0; i < n; i++) {
+        uint16_t pid = replies[i];
+        switch (types[i]) {
+          case 4:  win->puback(pid);    break;
+          case 7:  win->pubcomp(pid);   break;
+          case 5:
+            if (0 == win->pubrec(pid, now)) {
+              int len = 0;
+              const uint8_t* rel = win->packet(pid, &len);
+              receive(rel, len);
+            }
+            break;
+        }
+      }
+    };
+
+
+  private:
+    static const int REPLY_MAX = MQTT_MAX_INFLIGHT * 4;
+    uint16_t _replies[REPLY_MAX];
+    uint8_t  _types[REPLY_MAX];
+    int      _reply_count = 0;
+    uint8_t  _held[8192];
+
+    inline bool _is_held(uint16_t pid) {   return (_held[pid >> 3] & (1 << (pid & 7)));   };
+    inline void _reply(uint8_t type, uint16_t pid) {
+      _types[_reply_count]     = type;
+      _replies[_reply_count++] = pid;
+    };
+};
+
+/**
+* Runs the inflight window against the loopback broker, with some packets lost.
+*   Checks that the receive-maximum holds, that every exchange completes
+*   exactly once, that only lost packets are sent again, and that a silent
+*   broker is eventually given up on.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_MQTTInflight() {
+  int return_value = -1;
+  StringBuilder log("===< MQTT inflight window >=============================\n");
+  const int      PUBS     = 2000;
+  const uint32_t RTT      = 10;
+  const uint16_t RECV_MAX = 32;
+  MQTTInflight*   win    = new MQTTInflight();
+  LoopbackBroker* broker = new LoopbackBroker();
+  uint8_t  buf[16];
+  uint16_t due[MQTT_MAX_INFLIGHT];
+  uint32_t now    = 0;
+  int      sent   = 0;
+  int      rounds = 0;
+  int      len    = 0;
+  uint16_t pid    = 0;
+  const uint8_t* pkt = nullptr;
+
+  win->receiveMaximum(0);
+  if (1 != win->receiveMaximum()) {
+    log.concat("A receive-maximum of zero wasn't clamped to one.\n");
+    goto inflight_done;
+  }
+  win->receiveMaximum(MQTT_MAX_INFLIGHT * 2);
+  if (MQTT_MAX_INFLIGHT != win->receiveMaximum()) {
+    log.concat("The receive-maximum wasn't clamped to the window.\n");
+    goto inflight_done;
+  }
+
+  // Ids must steer around a busy slot.
+  pid = win->nextPacketId();
+  len = mqtt_stub_publish(buf, pid, 1);
+  if ((0 == pid) || (0 != win->track(pid, 1, buf, len, now)) || (0 == win->track(pid, 1, buf, len, now))) {
+    log.concat("Failed to track the first publish, or tracked it twice.\n");
+    goto inflight_done;
+  }
+  for (int i = 0; i < MQTT_MAX_INFLIGHT * 3; i++) {
+    uint16_t nu = win->nextPacketId();
+    if ((0 == nu) || (nu == pid) || (0 == ((nu ^ pid) & (MQTT_MAX_INFLIGHT - 1)))) {
+      log.concatf("Id 0x%04x was handed out while 0x%04x holds its slot.\n", nu, pid);
+      goto inflight_done;
+    }
+  }
+  if ((0 == win->pubcomp(pid)) || (0 == win->puback(pid + 1)) || (0 != win->puback(pid)) || (0 == win->puback(pid))) {
+    log.concat("Acks were resolved against the wrong exchange.\n");
+    goto inflight_done;
+  }
+  if ((0 != win->count()) || (3 != win->stray) || (1 != win->completed)) {
+    log.concatf("After acks, %d in flight, %u stray, %u completed.\n", win->count(), win->stray, win->completed);
+    goto inflight_done;
+  }
+
+  // The DUP flag goes on retransmission, and a PUBREC turns the packet into a PUBREL.
+  pid = win->nextPacketId();
+  len = mqtt_stub_publish(buf, pid, 2);
+  win->track(pid, 2, buf, len, now);
+  if ((1 != win->expired(now + win->retry_ms, due, MQTT_MAX_INFLIGHT)) || (due[0] != pid)) {
+    log.concat("An expired publish wasn't offered for retransmission.\n");
+    goto inflight_done;
+  }
+  pkt = win->packet(pid, &len);
+  if ((nullptr == pkt) || (0x3C != pkt[0]) || (13 != len)) {
+    log.concat("A retransmitted PUBLISH lacks its DUP flag.\n");
+    goto inflight_done;
+  }
+  pkt = nullptr;
+  if ((0 != win->pubrec(pid, now)) || (0 != win->pubrec(pid, now)) || (nullptr == (pkt = win->packet(pid, &len)))) {
+    log.concat("A PUBREC went unanswered.\n");
+    goto inflight_done;
+  }
+  if ((4 != len) || (0x62 != pkt[0]) || (pid != ((pkt[2] << 8) | pkt[3])) || (0 != win->pubcomp(pid))) {
+    log.concat("The PUBREL was wrong.\n");
+    goto inflight_done;
+  }
+
+  // Pipelined against the broker. Every round trip, fill the window, take
+  //   the broker's answers, and send again whatever is overdue.
+  delete win;
+  win = new MQTTInflight();
+  win->receiveMaximum(RECV_MAX);
+  win->retry_ms = RTT * 3;
+  broker->drop_every = 17;
+  while (((sent < PUBS) || (0 < win->count())) && (rounds < PUBS)) {
+    while ((sent < PUBS) && !win->full()) {
+      uint8_t qos = (sent & 1) + 1;
+      pid = win->nextPacketId();
+      len = mqtt_stub_publish(buf, pid, qos);
+      if (0 != win->track(pid, qos, buf, len, now)) {
+        log.concatf("Failed to track publish %d with %d in flight.\n", sent, win->count());
+        goto inflight_done;
+      }
+      broker->receive(buf, len);
+      sent++;
+    }
+    if (win->count() > RECV_MAX) {
+      log.concatf("%d in flight, over the receive-maximum of %u.\n", win->count(), RECV_MAX);
+      goto inflight_done;
+    }
+    now += RTT;
+    rounds++;
+    broker->roundTrip(win, now);
+    int n = win->expired(now, due, MQTT_MAX_INFLIGHT);
+    for (int i = 0; i < n; i++) {
+      pkt = win->packet(due[i], &len);
+      broker->receive(pkt, len);
+    }
+  }
+  log.concatf("%d publishes in %d round trips (%.1f per RTT), %u lost, %u retransmitted.\n", PUBS, rounds, (double) PUBS / rounds, broker->dropped, win->retransmits);
+  if ((0 != win->count()) || (PUBS != (int) win->completed) || (PUBS != (int) broker->delivered)) {
+    log.concatf("%u completed, %u delivered, %d still in flight.\n", win->completed, broker->delivered, win->count());
+    goto inflight_done;
+  }
+  if ((0 == broker->dropped) || (broker->dropped != win->retransmits) || (0 == broker->dups) || (0 != win->abandoned)) {
+    log.concat("Retransmission didn't track loss.\n");
+    goto inflight_done;
+  }
+  if (rounds > (PUBS / (RECV_MAX / 4))) {
+    log.concat("The window isn't pipelining.\n");
+    goto inflight_done;
+  }
+
+  // A broker that hears nothing.
+  broker->drop_every = 1;
+  for (int i = 0; i < 3; i++) {
+    pid = win->nextPacketId();
+    len = mqtt_stub_publish(buf, pid, 1);
+    win->track(pid, 1, buf, len, now);
+  }
+  for (int i = 0; i <= win->max_retries; i++) {
+    now += win->retry_ms;
+    win->expired(now, due, MQTT_MAX_INFLIGHT);
+  }
+  if ((0 != win->count()) || (3 != win->abandoned) || ((broker->dropped + (3 * win->max_retries)) != win->retransmits)) {
+    log.concatf("A silent broker left %d in flight, %u abandoned.\n", win->count(), win->abandoned);
+    goto inflight_done;
+  }
+  log.concat("Test passes.\n");
+  return_value = 0;
+
+inflight_done:
+  win->printDebug(&log);
+  delete win;
+  delete broker;
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+/*
+* A broker stand-in records a stream of publishes from a fleet of devices, and
+*   it is replayed against a few thousand subscriptions. Most topics hit one
+*   literal filter and one wildcard. Some only hit a wildcard, and some hit
+*   nothing. The old way (a strcmp() against every filter) is timed on a slice
+*   of the same stream, for literal filters only.
+*/
+void bench_TopicTrie() {
+  StringBuilder log("===< Topic trie benchmark >=============================\n");
+  const int SITES   = 64;
+  const int DEVS    = 62;
+  const int FILTERS = (SITES * DEVS) + (SITES * 2);
+  const int PUBS    = 200000;
+  const int SLICE   = 10000;
+  const int TOPIC_LEN = 40;
+  TopicTrie<uint32_t> trie;
+  char* filter_pool = (char*) malloc(FILTERS * TOPIC_LEN);
+  char* stream      = (char*) malloc(PUBS * TOPIC_LEN);
+  int   f = 0;
+  for (int s = 0; s < SITES; s++) {
+    for (int d = 0; d < DEVS; d++) {
+      snprintf(&filter_pool[f * TOPIC_LEN], TOPIC_LEN, "site/%d/dev/%d/temp", s, d);
+      trie.insert(&filter_pool[f * TOPIC_LEN], f);
+      f++;
+    }
+    snprintf(&filter_pool[f * TOPIC_LEN], TOPIC_LEN, "site/%d/+/+/alarm", s);
+    trie.insert(&filter_pool[f * TOPIC_LEN], f);
+    f++;
+    snprintf(&filter_pool[f * TOPIC_LEN], TOPIC_LEN, "site/%d/dev/#", s);
+    trie.insert(&filter_pool[f * TOPIC_LEN], f);
+    f++;
+  }
+
+  // The broker's recording.
+  const char* kinds[] = { "temp", "temp", "temp", "alarm", "humidity" };
+  uint32_t lcg = 1;
+  for (int i = 0; i < PUBS; i++) {
+    lcg = (lcg * 1103515245u) + 12345u;
+    uint32_t r = lcg >> 8;
+    char* t = &stream[i * TOPIC_LEN];
+    if (0 == (r % 20)) {
+      snprintf(t, TOPIC_LEN, "fleet/%u/status", r % 500);
+    }
+    else {
+      snprintf(t, TOPIC_LEN, "site/%u/dev/%u/%s", (r >> 4) % SITES, (r >> 10) % DEVS, kinds[(r >> 16) % 5]);
+    }
+  }
+
+  uint32_t results[MQTT_MAX_TOPIC_MATCHES];
+  unsigned long matched = 0;
+  unsigned long t0 = micros();
+  for (int i = 0; i < PUBS; i++) {
+    matched += trie.match(&stream[i * TOPIC_LEN], results, MQTT_MAX_TOPIC_MATCHES);
+  }
+  unsigned long t1 = micros();
+  unsigned long linear_matched = 0;
+  for (int i = 0; i < SLICE; i++) {
+    for (int x = 0; x < FILTERS; x++) {
+      if (0 == strcmp(&stream[i * TOPIC_LEN], &filter_pool[x * TOPIC_LEN])) linear_matched++;
+    }
+  }
+  unsigned long t2 = micros();
+
+  log.concatf("\t %d filters (%d with wildcards), %d levels interned.\n", trie.size(), SITES * 2, TopicLevels::count());
+  log.concatf("\t Trie:   %d publishes in %8lu us  (%.0f publishes/sec, %.2f matches each)\n",
+    PUBS, t1 - t0, (double) PUBS * 1000000 / ((t1 - t0) ? (t1 - t0) : 1), (double) matched / PUBS);
+  log.concatf("\t Linear: %d publishes in %8lu us  (%.0f publishes/sec, literal filters only, %lu matched)\n",
+    SLICE, t2 - t1, (double) SLICE * 1000000 / ((t2 - t1) ? (t2 - t1) : 1), linear_matched);
+  trie.clear();
+  free(filter_pool);
+  free(stream);
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+}
+
+
+#if defined(__BUILD_HAS_PTHREADS)
+/*
+* A subscriber that lets the Kernel run it on workers. It checks that pinned
+*   instances see Msgs in order, from one thread, and that nobody runs on the
+*   wrong thread.
+*/
+class WorkerReceiver : public EventReceiver {
+  public:
+    uint32_t  seen       = 0;
+    uint32_t  disorders  = 0;
+    uint32_t  misplaced  = 0;
+    uint32_t  last_seq   = 0;
+    uint32_t  spin_us    = 0;
+    pthread_t main_thread;
+    pthread_t home;
+    bool      has_home   = false;
+
+    WorkerReceiver(const uint16_t* list, int8_t aff, uint32_t spin) : EventReceiver("WorkerReceiver") {
+      setInterests(list);
+      setAffinity(aff);
+      spin_us     = spin;
+      main_thread = pthread_self();
+    };
+
+    int8_t notify(ManuvrMsg* active_event) {
+      uint32_t  seq = 0;
+      pthread_t me  = pthread_self();
+      active_event->getArgAs(&seq);
+      if (MANUVR_ER_AFFINITY_KERNEL == affinity()) {
+        if (!pthread_equal(me, main_thread)) misplaced++;
+      }
+      else if (pthread_equal(me, main_thread)) {
+        // Only ANY receivers may be run by the kernel, and only when the workers are full.
+        if (MANUVR_ER_AFFINITY_ANY != affinity()) misplaced++;
+      }
+      if (affinity() >= 0) {
+        if (!has_home) {
+          home     = me;
+          has_home = true;
+        }
+        else if (!pthread_equal(me, home)) misplaced++;
+        if (seq <= last_seq) disorders++;
+        last_seq = seq;
+      }
+      if (spin_us) {
+        unsigned long t0 = micros();
+        while ((micros() - t0) < spin_us) {}
+      }
+      __atomic_add_fetch(&seen, 1, __ATOMIC_RELAXED);
+      return 1;
+    };
+};
+
+uint32_t  _worker_callbacks = 0;
+uint32_t  _worker_misplaced_callbacks = 0;
+pthread_t _worker_test_main;
+int _worker_listener(ManuvrMsg* m) {
+  _worker_callbacks++;
+  if (!pthread_equal(pthread_self(), _worker_test_main)) _worker_misplaced_callbacks++;
+  return 0;
+}
+
+/* Raises a numbered Msg. Numbering starts at 1. */
+void raise_numbered(uint16_t code, uint32_t seq) {
+  ManuvrMsg* m = Kernel::returnEvent(code);
+  m->addArg(seq);
+  Kernel::staticRaiseEvent(m);
+}
+#endif  // __BUILD_HAS_PTHREADS
+
+/**
+* Gives the Kernel workers, and checks that every receiver hears every Msg, on
+*   the thread it asked for, and that pinned receivers hear them in order.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_WorkerPool() {
+  int return_value = 0;
+  #if defined(__BUILD_HAS_PTHREADS)
+  return_value = -1;
+  StringBuilder log("===< Worker pool >======================================\n");
+  const uint16_t CODE_W = 0xF7C0;
+  const uint32_t MSGS   = 300;
+  static const uint16_t only_w[] = {CODE_W, MANUVR_MSG_UNDEFINED};
+  Kernel* kernel = platform.kernel();
+  WorkerReceiver pinned_0(only_w, 0, 0);
+  WorkerReceiver pinned_1(only_w, 1, 0);
+  WorkerReceiver anywhere_0(only_w, MANUVR_ER_AFFINITY_ANY, 0);
+  WorkerReceiver anywhere_1(only_w, MANUVR_ER_AFFINITY_ANY, 0);
+  WorkerReceiver kernel_only(only_w, MANUVR_ER_AFFINITY_KERNEL, 0);
+  WorkerReceiver* all[] = {&pinned_0, &pinned_1, &anywhere_0, &anywhere_1, &kernel_only};
+  unsigned long t0;
+
+  _worker_test_main = pthread_self();
+  ManuvrMsg::registerMessage(CODE_W, 0, "WORKER_TEST", ManuvrMsg::MSG_ARGS_NONE, nullptr);
+  kernel->on(CODE_W, _worker_listener, 0);
+  for (int i = 0; i < 5; i++) kernel->subscribe(all[i]);
+
+  if (0 != kernel->workers(3)) {
+    log.concat("\t Failed to start workers.\n");
+    goto worker_pool_done;
+  }
+  for (uint32_t i = 1; i <= MSGS; i++) {
+    raise_numbered(CODE_W, i);
+    if (0 == (i & 0x0F)) kernel->procIdleFlags();
+  }
+  t0 = millis();
+  while ((_worker_callbacks < MSGS) && ((millis() - t0) < 5000)) kernel->procIdleFlags();
+  kernel->workers(0);
+
+  for (int i = 0; i < 5; i++) {
+    kernel->unsubscribe(all[i]);
+    log.concatf("\t Receiver %d (affinity %d) saw %u, %u out of order, %u on the wrong thread.\n", i, all[i]->affinity(), all[i]->seen, all[i]->disorders, all[i]->misplaced);
+    if ((MSGS != all[i]->seen) || all[i]->disorders || all[i]->misplaced) {
+      log.concat("\t Receiver was mishandled.\n");
+      goto worker_pool_done;
+    }
+  }
+  if (pinned_0.has_home && pinned_1.has_home && pthread_equal(pinned_0.home, pinned_1.home)) {
+    log.concat("\t Both pinned receivers ran on the same worker.\n");
+    goto worker_pool_done;
+  }
+  log.concatf("\t Callbacks: %u (%u off the kernel thread)\n", _worker_callbacks, _worker_misplaced_callbacks);
+  if ((MSGS != _worker_callbacks) || _worker_misplaced_callbacks) {
+    log.concat("\t Msgs were not completed properly.\n");
+    goto worker_pool_done;
+  }
+  if (0 != kernel->workers()) {
+    log.concat("\t Workers didn't stop.\n");
+    goto worker_pool_done;
+  }
+  return_value = 0;
+
+worker_pool_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  #endif  // __BUILD_HAS_PTHREADS
+  return return_value;
+}
+
+
+/*
+* Runs the same batch of Msgs through the Kernel with more and more workers.
+*   Each notify() burns a fixed amount of time, standing in for real work.
+*/
+void bench_Workers() {
+  #if defined(__BUILD_HAS_PTHREADS)
+  StringBuilder log("===< Worker pool benchmark >============================\n");
+  const uint16_t CODE_B    = 0xF7C1;
+  const uint32_t MSGS      = 1000;
+  const uint32_t SPIN_US   = 20;
+  const int      RECEIVERS = 8;
+  static const uint16_t only_b[] = {CODE_B, MANUVR_MSG_UNDEFINED};
+  Kernel* kernel = platform.kernel();
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int  most = (cpus > MANUVR_MAX_WORKERS) ? MANUVR_MAX_WORKERS : ((cpus < 1) ? 1 : (int) cpus);
+  ManuvrMsg::registerMessage(CODE_B, 0, "WORKER_BENCH", ManuvrMsg::MSG_ARGS_NONE, nullptr);
+
+  log.concatf("\t %d receivers, %uus per notify(), %u Msgs, %ld CPUs.\n", RECEIVERS, SPIN_US, MSGS, cpus);
+  log.concat("\t Workers\t Safe (Msgs/s)\t Pinned (Msgs/s)\n");
+  for (int w = 0; w <= most; w = (0 == w) ? 1 : (w << 1)) {
+    float rate[2];
+    for (int mode = 0; mode < 2; mode++) {
+      WorkerReceiver* subs[RECEIVERS];
+      for (int i = 0; i < RECEIVERS; i++) {
+        subs[i] = new WorkerReceiver(only_b, (0 == mode) ? MANUVR_ER_AFFINITY_ANY : i, SPIN_US);
+        kernel->subscribe(subs[i]);
+      }
+      kernel->workers(w);
+      unsigned long t0 = micros();
+      for (uint32_t i = 1; i <= MSGS; i++) {
+        raise_numbered(CODE_B, i);
+        if (0 == (i & 0x0F)) kernel->procIdleFlags();
+      }
+      for (int i = 0; i < RECEIVERS; i++) {
+        while (__atomic_load_n(&subs[i]->seen, __ATOMIC_RELAXED) < MSGS) kernel->procIdleFlags();
+      }
+      kernel->workers(0);   // Waits for the tail.
+      unsigned long t1 = micros();
+      rate[mode] = (MSGS * 1000000.0f) / (float) (t1 - t0);
+      for (int i = 0; i < RECEIVERS; i++) {
+        kernel->unsubscribe(subs[i]);
+        delete subs[i];
+      }
+    }
+    log.concatf("\t %d\t\t %.0f\t\t %.0f\n", w, (double) rate[0], (double) rate[1]);
+  }
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  #endif  // __BUILD_HAS_PTHREADS
+}
+
+
+#define ARG_POOL_TEST_SLOTS    64
+#define ARG_POOL_TEST_THREADS  4
+#define ARG_POOL_TEST_ROUNDS   20000
+
+uint8_t  _test_arg_slab[ARG_POOL_TEST_SLOTS * ARGUMENT_POOL_SLOT_SIZE] __attribute__ ((aligned (8)));
+uint16_t _test_arg_links[ARG_POOL_TEST_SLOTS];
+
+#if defined(__BUILD_HAS_PTHREADS)
+/* Takes and returns Arguments as fast as it can, checking that nobody else has them. */
+void* arg_pool_churn(void* a) {
+  uintptr_t errors = 0;
+  uint32_t  me     = (uint32_t) (uintptr_t) a;
+  Argument* held[4];
+  for (int r = 0; r < ARG_POOL_TEST_ROUNDS; r++) {
+    for (int i = 0; i < 4; i++) held[i] = new Argument((uint32_t) (me + r + i + 1));   // Zero reads as absent.
+    for (int i = 0; i < 4; i++) {
+      uint32_t val = 0;
+      held[i]->getValueAs(&val);
+      if (val != (me + r + i + 1)) errors++;
+      delete held[i];
+    }
+  }
+  return (void*) errors;
+}
+#endif  // __BUILD_HAS_PTHREADS
+
+/**
+* Gives the Argument class a slab of its own, and checks that it is used, that
+*   overflow goes to the heap, and that the slab survives concurrent churn.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_Arguments_Pool() {
+  int return_value = -1;
+  StringBuilder log("===< Argument pool >====================================\n");
+  Argument* args[ARG_POOL_TEST_SLOTS + 1];
+  uint32_t hits0   = 0;
+  uint32_t misses0 = 0;
+  unsigned long t0 = 0;
+  unsigned long t1 = 0;
+
+  Argument::setPool(_test_arg_slab, _test_arg_links, ARG_POOL_TEST_SLOTS);
+  hits0   = Argument::poolHits();
+  misses0 = Argument::poolMisses();
+  for (int i = 0; i <= ARG_POOL_TEST_SLOTS; i++) {
+    args[i] = new Argument((int32_t) (i + 1));   // Zero reads as absent.
+  }
+  if ((ARG_POOL_TEST_SLOTS != Argument::poolInUse()) || (ARG_POOL_TEST_SLOTS != Argument::poolHits() - hits0) || (1 != Argument::poolMisses() - misses0)) {
+    log.concatf("\t Slab accounting is wrong after %d allocations: %u in use, %u hits, %u misses.\n", ARG_POOL_TEST_SLOTS + 1, Argument::poolInUse(), Argument::poolHits() - hits0, Argument::poolMisses() - misses0);
+    goto arg_pool_done;
+  }
+  if ((nullptr == args[0]->inlineValue(ARGUMENT_POOL_INLINE_BYTES)) || (nullptr != args[0]->inlineValue(ARGUMENT_POOL_INLINE_BYTES + 1))) {
+    log.concat("\t Slab Argument offered the wrong inline storage.\n");
+    goto arg_pool_done;
+  }
+  if (nullptr != args[ARG_POOL_TEST_SLOTS]->inlineValue(1)) {
+    log.concat("\t Heap Argument offered inline storage.\n");
+    goto arg_pool_done;
+  }
+  for (int i = 0; i <= ARG_POOL_TEST_SLOTS; i++) {
+    int32_t val = -1;
+    args[i]->getValueAs(&val);
+    if (val != i + 1) {
+      log.concatf("\t Argument %d holds %d.\n", i, val);
+      goto arg_pool_done;
+    }
+    delete args[i];
+  }
+  if (0 != Argument::poolInUse()) {
+    log.concatf("\t %u slots leaked.\n", Argument::poolInUse());
+    goto arg_pool_done;
+  }
+
+  #if defined(__BUILD_HAS_PTHREADS)
+  {
+    pthread_t threads[ARG_POOL_TEST_THREADS];
+    uintptr_t errors = 0;
+    hits0   = Argument::poolHits();
+    misses0 = Argument::poolMisses();
+    t0 = micros();
+    for (int i = 0; i < ARG_POOL_TEST_THREADS; i++) {
+      pthread_create(&threads[i], nullptr, arg_pool_churn, (void*) (uintptr_t) (i * 1000000));
+    }
+    for (int i = 0; i < ARG_POOL_TEST_THREADS; i++) {
+      void* ret = nullptr;
+      pthread_join(threads[i], &ret);
+      errors += (uintptr_t) ret;
+    }
+    t1 = micros();
+    log.concatf("\t %d threads churned %u Arguments in %lu us. %u hits, %u misses.\n",
+      ARG_POOL_TEST_THREADS,
+      ARG_POOL_TEST_THREADS * ARG_POOL_TEST_ROUNDS * 4,
+      t1 - t0,
+      Argument::poolHits() - hits0,
+      Argument::poolMisses() - misses0
+    );
+    if ((0 != errors) || (0 != Argument::poolInUse())) {
+      log.concatf("\t Concurrent churn saw %u errors and left %u slots in use.\n", (unsigned int) errors, Argument::poolInUse());
+      goto arg_pool_done;
+    }
+  }
+  #endif  // __BUILD_HAS_PTHREADS
+
+  // Strings inflated from a buffer should land in the slab with their value.
+  {
+    static const unsigned char arg_form[] = {(uint8_t) TCode::STR, (uint8_t) TCode::STR, 0, 0};
+    const uint8_t buf[] = "short\0This string is too long to fit inline.";
+    ManuvrMsg::registerMessage(0xF7F0, 0, "ARG_POOL_TEST", arg_form, nullptr);
+    ManuvrMsg msg(0xF7F0);
+    hits0 = Argument::poolHits();
+    if (2 != msg.inflateArgumentsFromBuffer((uint8_t*) buf, sizeof(buf))) {
+      log.concat("\t Failed to inflate strings.\n");
+      goto arg_pool_done;
+    }
+    const char* a = nullptr;
+    const char* b = nullptr;
+    msg.getArgAs(0, &a);
+    msg.getArgAs(1, &b);
+    if ((nullptr == a) || (nullptr == b) || strcmp(a, "short") || strcmp(b, "This string is too long to fit inline.")) {
+      log.concat("\t Inflated strings are wrong.\n");
+      goto arg_pool_done;
+    }
+    if ((2 != Argument::poolHits() - hits0) || (a != (const char*) msg.getArgs()->inlineValue(6))) {
+      log.concat("\t The short string was not stored inline.\n");
+      goto arg_pool_done;
+    }
+  }
+  if (0 != Argument::poolInUse()) {
+    log.concatf("\t %u slots leaked by a Msg.\n", Argument::poolInUse());
+    goto arg_pool_done;
+  }
+  return_value = 0;
+
+arg_pool_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+int test_Arguments() {
+  int return_value = test_Arguments_Pool();
+  if (0 == return_value) return_value = test_Arguments_KVP();
+  if (0 == return_value) {
+    return_value = test_Arguments_InternalTypes();
+    if (0 == return_value) {
+      return_value = test_Arguments_PODs();
+      if (0 == return_value) {
+      #if defined(MANUVR_CBOR)
+        return_value = test_CBOR_Argument();
+        if (0 == return_value) {
+
+        }
+      #endif
+      }
+    }
+  }
+  return return_value;
+}
+
+
+int test_BufferPipe() {
   StringBuilder log("===< BufferPipe >=======================================\n");
   log.concat("========================================================\n\n");
   printf((const char*) log.string());
-  return 0;
+  return 0;
+}
+
+
+/**
+* Drives a UDPPipeTable without a transport behind it. Counterparties that
+*   share a port must get their own pipes, a full pool must recycle the
+*   least-recently-used pipe that isn't persistent, idle pipes must be swept,
+*   and heavy churn must never grow the table or lose track of a pipe.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_UDPPipeTable() {
+  int return_value = 0;
+  #if defined(MANUVR_SUPPORT_UDP)
+  return_value = -1;
+  StringBuilder log("===< UDPPipeTable >=====================================\n");
+  const int CAP = 8;
+  UDPPipeTable table(nullptr, CAP);
+  UDPPipe* pipes[CAP];
+  UDPPipe* p     = nullptr;
+  bool created   = false;
+  uint32_t now   = 1000;
+  uint32_t peers[64];
+  int live       = 0;
+
+  // Same port, different hosts.
+  for (int i = 0; i < CAP; i++) {
+    pipes[i] = table.open(0x0A000001 + i, 5683, now++, &created);
+    if ((nullptr == pipes[i]) || !created) {
+      log.concatf("\t Failed to open pipe %d.\n", i);
+      goto udp_pipe_table_done;
+    }
+  }
+  for (int i = 0; i < CAP; i++) {
+    if ((table.find(0x0A000001 + i, 5683, now) != pipes[i]) || (pipes[i]->getAddress() != (uint32_t) (0x0A000001 + i))) {
+      log.concatf("\t Counterparty %d found the wrong pipe.\n", i);
+      goto udp_pipe_table_done;
+    }
+    for (int j = 0; j < i; j++) {
+      if (pipes[i] == pipes[j]) {
+        log.concatf("\t Counterparties %d and %d share a pipe.\n", i, j);
+        goto udp_pipe_table_done;
+      }
+    }
+  }
+  if ((nullptr != table.find(0x0A000001, 5684, now)) || (CAP != table.count())) {
+    log.concat("\t Found a counterparty that was never opened, or the count is off.\n");
+    goto udp_pipe_table_done;
+  }
+
+  // Touch everything but pipe 3, so that it is the LRU. Pipe 0 is persistent.
+  pipes[0]->persistAfterReply(true);
+  for (int i = 0; i < CAP; i++) {
+    if (3 != i) table.find(0x0A000001 + i, 5683, now++);
+  }
+  p = table.open(0x0B000001, 1234, now++, &created);
+  if ((p != pipes[3]) || !created || (1 != table.evicted_lru)) {
+    log.concat("\t The LRU pipe was not the one recycled.\n");
+    goto udp_pipe_table_done;
+  }
+  if ((nullptr != table.find(0x0A000004, 5683, now)) || (p != table.find(0x0B000001, 1234, now++))) {
+    log.concat("\t The recycled pipe is still findable by its old counterparty.\n");
+    goto udp_pipe_table_done;
+  }
+  // Now pipe 0 is the LRU, but persistent. Pipe 1 should go instead.
+  p = table.open(0x0B000002, 1234, now++, &created);
+  if ((p != pipes[1]) || (pipes[0] != table.find(0x0A000001, 5683, now))) {
+    log.concat("\t A persistent pipe was recycled.\n");
+    goto udp_pipe_table_done;
+  }
+
+  // Idle sweep. Everything but the two we touch goes, apart from pipe 0.
+  now += 10000;
+  table.find(0x0A000003, 5683, now);
+  table.find(0x0B000002, 1234, now);
+  if ((5 != table.evictIdle(now + 1, 5000)) || (3 != table.count())) {
+    log.concatf("\t Idle sweep left %d pipes. Expected 3.\n", table.count());
+    goto udp_pipe_table_done;
+  }
+  if (0 != table.close(pipes[0]) || (0 == table.close(pipes[0])) || (2 != table.count())) {
+    log.concat("\t close() misbehaved.\n");
+    goto udp_pipe_table_done;
+  }
+  pipes[0]->persistAfterReply(false);
+
+  // Churn. A random working set, bigger than the table.
+  for (int i = 0; i < 64; i++) peers[i] = randomInt();
+  for (int i = 0; i < 20000; i++) {
+    int x = randomInt() % 64;
+    p = table.open(peers[x], (uint16_t) x, now++, &created);
+    if ((nullptr == p) || (p->getAddress() != peers[x]) || (p->getPort() != (uint16_t) x)) {
+      log.concatf("\t Churn: open() gave back the wrong pipe on iteration %d.\n", i);
+      goto udp_pipe_table_done;
+    }
+    if (CAP < table.count()) {
+      log.concatf("\t Churn: the table grew to %d.\n", table.count());
+      goto udp_pipe_table_done;
+    }
+    if (0 == (i & 0x3F)) table.evictIdle(now, 4);
+  }
+  for (int i = 0; i < 64; i++) {
+    if (nullptr != table.find(peers[i], (uint16_t) i, now)) live++;
+  }
+  if (live != table.count()) {
+    log.concatf("\t Churn: %d pipes findable, but %d open.\n", live, table.count());
+    goto udp_pipe_table_done;
+  }
+  log.concatf("\t Churn: %u opened, %u recycled for room, %u for idleness.\n", table.opened, table.evicted_lru, table.evicted_idle);
+
+  // A pipe deleted out from under the table has its slot refilled. With no
+  //   transport to call back, we do what ManuvrUDP would have done.
+  p = table.find(peers[0], 0, now);
+  if (nullptr == p) p = table.open(peers[0], 0, now, &created);
+  table.forget(p);
+  delete p;
+  if (nullptr != table.find(peers[0], 0, now)) {
+    log.concat("\t A deleted pipe is still findable.\n");
+    goto udp_pipe_table_done;
+  }
+  table.clear();
+  for (int i = 0; i < CAP; i++) {
+    if (nullptr == table.open(0x0C000000 + i, 80, now, &created)) {
+      log.concat("\t The pool came up short after a deletion.\n");
+      goto udp_pipe_table_done;
+    }
+  }
+  return_value = 0;
+
+udp_pipe_table_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  #endif  // MANUVR_SUPPORT_UDP
+  return return_value;
+}
+
+
+#if defined(MANUVR_GPS_PIPE)
+/* Counts and keeps what an NMEAParser reports. */
+class NMEARecorder : public NMEAListener {
+  public:
+    int fixes      = 0;
+    int velocities = 0;
+    int sat_views  = 0;
+    GPSFix        fix;
+    GPSVelocity   vel;
+    GPSSatellites sats;
+
+    void nmeaFix(const GPSFix* f) {               fixes++;       memcpy(&fix,  f, sizeof(fix));   };
+    void nmeaVelocity(const GPSVelocity* v) {     velocities++;  memcpy(&vel,  v, sizeof(vel));   };
+    void nmeaSatellites(const GPSSatellites* s) { sat_views++;   memcpy(&sats, s, sizeof(sats));  };
+};
+
+/* Feeds a string one byte at a time, as a UART would. */
+int nmea_trickle(NMEAParser* parser, const char* str) {
+  int accepted = 0;
+  for (const char* c = str; *c; c++) accepted += parser->feed((const uint8_t*) c, 1);
+  return accepted;
+}
+
+/*
+* Loads the recorded log that the NMEA test and benchmark replay. It is looked
+*   for in the working directory, or in tests/ beneath it.
+*/
+uint8_t* nmea_load_log(int* len) {
+  const char* paths[] = {"nmea_10hz_gnss.log", "tests/nmea_10hz_gnss.log"};
+  for (int i = 0; i < 2; i++) {
+    FILE* fp = fopen(paths[i], "rb");
+    if (nullptr != fp) {
+      fseek(fp, 0, SEEK_END);
+      *len = (int) ftell(fp);
+      fseek(fp, 0, SEEK_SET);
+      uint8_t* buf = (uint8_t*) malloc(*len);
+      if ((nullptr != buf) && ((int) fread(buf, 1, *len, fp) != *len)) {
+        free(buf);
+        buf = nullptr;
+      }
+      fclose(fp);
+      return buf;
+    }
+  }
+  *len = 0;
+  return nullptr;
+}
+
+#if defined(__BUILD_HAS_PTHREADS)
+#define NMEA_LATCH_STORES  200000
+
+/* Stores fixes whose fields all follow from one count, so that a torn copy shows. */
+void* nmea_latch_writer(void* arg) {
+  GPSLatch<GPSFix>* latch = (GPSLatch<GPSFix>*) arg;
+  GPSFix f;
+  memset(&f, 0, sizeof(f));
+  for (int32_t n = 1; n <= NMEA_LATCH_STORES; n++) {
+    f.latitude  = n;
+    f.longitude = -n;
+    f.altitude  = n * 3;
+    f.time      = (uint32_t) n;
+    latch->store(&f);
+  }
+  return nullptr;
+}
+#endif  // __BUILD_HAS_PTHREADS
+#endif  // MANUVR_GPS_PIPE
+
+
+/**
+* Trickles known sentences through an NMEAParser, checks the fixed-point
+*   decoding of each field we care about, and that bad checksums, noise, cut-off
+*   sentences, and broken GSV groups are all refused without disturbing anything
+*   else. Checks that records cross threads whole. Then replays the recorded log
+*   and checks the totals.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_NMEAParser() {
+  int return_value = 0;
+  #if defined(MANUVR_GPS_PIPE)
+  return_value = -1;
+  StringBuilder log("===< NMEAParser >=======================================\n");
+  NMEARecorder rec;
+  NMEAParser parser(&rec);
+  uint8_t* replay = nullptr;
+  int replay_len  = 0;
+
+  if (1 != nmea_trickle(&parser, "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A\r\n")) {
+    log.concat("\t RMC was refused.\n");
+    goto nmea_parser_done;
+  }
+  if ((1 != rec.fixes) || (1 != rec.velocities) || !rec.fix.valid || (45319000 != rec.fix.time)) {
+    log.concatf("\t RMC: %d fixes, %d velocities, time %u.\n", rec.fixes, rec.velocities, rec.fix.time);
+    goto nmea_parser_done;
+  }
+  if ((481173000 != rec.fix.latitude) || (115166666 != rec.fix.longitude)) {
+    log.concatf("\t RMC position is (%d, %d).\n", rec.fix.latitude, rec.fix.longitude);
+    goto nmea_parser_done;
+  }
+  if ((23 != rec.fix.day) || (3 != rec.fix.month) || (1994 != rec.fix.year) || (11523 != rec.vel.speed) || (8440 != rec.vel.course)) {
+    log.concatf("\t RMC date is %u/%u/%u, speed %umm/s, course %u.\n", rec.fix.year, rec.fix.month, rec.fix.day, rec.vel.speed, rec.vel.course);
+    goto nmea_parser_done;
+  }
+
+  nmea_trickle(&parser, "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n");
+  if ((2 != rec.fixes) || (1 != rec.fix.quality) || (8 != rec.fix.satellites) || (90 != rec.fix.hdop) || (545400 != rec.fix.altitude)) {
+    log.concatf("\t GGA: quality %u, %u sats, hdop %u, altitude %d.\n", rec.fix.quality, rec.fix.satellites, rec.fix.hdop, rec.fix.altitude);
+    goto nmea_parser_done;
+  }
+  nmea_trickle(&parser, "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n");
+  if ((2 != rec.velocities) || (2829 != rec.vel.speed) || (5470 != rec.vel.course)) {
+    log.concatf("\t VTG: speed %umm/s, course %u.\n", rec.vel.speed, rec.vel.course);
+    goto nmea_parser_done;
+  }
+
+  // A GSV group is only reported whole.
+  nmea_trickle(&parser, "$GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75\r\n");
+  if (0 != rec.sat_views) {
+    log.concat("\t Half a GSV group was reported.\n");
+    goto nmea_parser_done;
+  }
+  nmea_trickle(&parser, "$GPGSV,2,2,08,15,15,070,,19,05,134,38,24,63,270,44,25,31,114,46*73\r\n");
+  if ((1 != rec.sat_views) || (8 != rec.sats.count) || (15 != rec.sats.sats[4].prn) || (0 != rec.sats.sats[4].snr) || (270 != rec.sats.sats[6].azimuth)) {
+    log.concatf("\t GSV: %d reports, %u sats.\n", rec.sat_views, rec.sats.count);
+    goto nmea_parser_done;
+  }
+  // The end of a group without its start.
+  nmea_trickle(&parser, "$GPGSV,2,2,08,15,15,070,,19,05,134,38,24,63,270,44,25,31,114,46*73\r\n");
+  nmea_trickle(&parser, "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n");
+  if ((1 != rec.sat_views) || (1 != parser.unhandled) || (7 != parser.sentences)) {
+    log.concatf("\t %d GSV reports, %u sentences, %u unhandled.\n", rec.sat_views, parser.sentences, parser.unhandled);
+    goto nmea_parser_done;
+  }
+
+  // Noise, a sentence cut off by another, and a bad checksum. Only the last is good.
+  nmea_trickle(&parser, "\xff\x7f\r\ngarbage$GPRMC,1235");
+  nmea_trickle(&parser, "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*49\r\n");
+  if (1 != nmea_trickle(&parser, "$GLGSV,1,1,02,65,40,083,46,66,17,308,41*61\r\n")) {
+    log.concat("\t Failed to recover from noise.\n");
+    goto nmea_parser_done;
+  }
+  if ((1 != parser.malformed) || (1 != parser.bad_checksum) || (2 != rec.velocities) || (2 != rec.sats.count)) {
+    log.concatf("\t Noise: %u malformed, %u bad checksums, %d velocities.\n", parser.malformed, parser.bad_checksum, rec.velocities);
+    goto nmea_parser_done;
+  }
+
+  #if defined(__BUILD_HAS_PTHREADS)
+  // Transports feed ManuvrGPS from their own threads. Copies out of its latches
+  //   must never be torn, nor go back in time.
+  {
+    GPSLatch<GPSFix> latch;
+    GPSFix    f;
+    pthread_t writer;
+    uint32_t last = 0;
+    int      torn = 0;
+    pthread_create(&writer, nullptr, nmea_latch_writer, (void*) &latch);
+    while (last < NMEA_LATCH_STORES) {
+      uint32_t seen = latch.load(&f);
+      if ((seen < last) || ((int32_t) seen != f.latitude) || (f.longitude != -f.latitude) || (f.altitude != (f.latitude * 3)) || (f.time != (uint32_t) f.latitude)) {
+        torn++;
+      }
+      last = seen;
+    }
+    pthread_join(writer, nullptr);
+    if (0 != torn) {
+      log.concatf("\t %d copies out of a GPSLatch were torn.\n", torn);
+      goto nmea_parser_done;
+    }
+  }
+  #endif  // __BUILD_HAS_PTHREADS
+
+  // The recorded log: 50 epochs of GN RMC, VTG, GGA, three GSAs, and GSVs for
+  //   three constellations. One sentence has a flipped bit, and one was cut off.
+  replay = nmea_load_log(&replay_len);
+  if (nullptr == replay) {
+    log.concat("\t nmea_10hz_gnss.log not found. Skipping the replay.\n");
+  }
+  else {
+    NMEARecorder rec_log;
+    NMEAParser p_log(&rec_log);
+    int accepted = p_log.feed(replay, replay_len);
+    free(replay);
+    p_log.printDebug(&log);
+    if ((648 != accepted) || (150 != p_log.unhandled) || (1 != p_log.bad_checksum) || (1 != p_log.malformed)) {
+      log.concatf("\t Replay accepted %d sentences.\n", accepted);
+      goto nmea_parser_done;
+    }
+    if ((100 != rec_log.fixes) || (100 != rec_log.velocities) || (148 != rec_log.sat_views) || (-1223321000 > rec_log.fix.longitude)) {
+      log.concatf("\t Replay: %d fixes, %d velocities, %d satellite views.\n", rec_log.fixes, rec_log.velocities, rec_log.sat_views);
+      goto nmea_parser_done;
+    }
+  }
+  return_value = 0;
+
+nmea_parser_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  #endif  // MANUVR_GPS_PIPE
+  return return_value;
+}
+
+
+/*
+* Replays the recorded log through an NMEAParser in UART-sized pieces, and
+*   reports what it costs.
+*/
+void bench_NMEAParser() {
+  #if defined(MANUVR_GPS_PIPE)
+  StringBuilder log("===< NMEAParser benchmark >=============================\n");
+  const int REPLAYS = 200;
+  const int CHUNK   = 64;
+  int len = 0;
+  uint8_t* replay = nmea_load_log(&len);
+  if (nullptr == replay) {
+    log.concat("\t nmea_10hz_gnss.log not found.\n");
+  }
+  else {
+    NMEARecorder rec;
+    NMEAParser parser(&rec);
+    unsigned long t0 = micros();
+    for (int r = 0; r < REPLAYS; r++) {
+      for (int i = 0; i < len; i += CHUNK) {
+        parser.feed(replay + i, ((len - i) < CHUNK) ? (len - i) : CHUNK);
+      }
+    }
+    unsigned long t1 = micros();
+    double us    = (double) ((t1 - t0) ? (t1 - t0) : 1);
+    double bytes = (double) len * REPLAYS;
+    log.concatf("\t %d bytes x %d in %lu us: %.1f ns/byte, %.0f sentences/s.\n", len, REPLAYS, t1 - t0, (us * 1000) / bytes, ((double) parser.sentences * 1000000) / us);
+    log.concatf("\t %d fixes, %d velocities, %d satellite views.\n", rec.fixes, rec.velocities, rec.sat_views);
+    // The log is 5 seconds long.
+    log.concatf("\t At the log's own rate, that is %.1f us of CPU per second.\n", (us / REPLAYS) / 5);
+    free(replay);
+  }
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  #endif  // MANUVR_GPS_PIPE
 }
 
 
@@ -525,6 +3132,754 @@ int test_UUID() {
   return 0;
 }
 
+/*
+* The least a BusOp can be. Nothing here touches hardware.
+*/
+class TestBusOp : public BusOp {
+  public:
+    uint32_t tag   = 0;   // Which producer, and in what order.
+    uint32_t owner = 0;   // Who holds this op right now? Zero for the pool.
+
+    XferFault begin() {   set_state(XferState::COMPLETE);   return XferFault::NONE;   };
+    void wipe() {         set_state(XferState::IDLE);   tag = 0;   };
+    void printDebug(StringBuilder* output) {   BusOp::printBusOp("TestOp", this, output);   };
+};
+
+/*
+* An adapter for a bus that finishes every op the moment it begins.
+*/
+class TestBusAdapter : public BusAdapter<TestBusOp> {
+  public:
+    TestBusOp pool[8];
+
+    TestBusAdapter() : BusAdapter(12) {   preallocated.init(pool, 8);   };
+
+    int8_t io_op_callahead(BusOp*) {   return 0;   };
+    int8_t io_op_callback(BusOp*) {    return 0;   };
+    int8_t queue_io_job(BusOp* op) {
+      if (0 != work_queue.insert((TestBusOp*) op, op->urgent())) {
+        _queue_floods++;
+        return -1;
+      }
+      return 0;
+    };
+
+    int8_t advance_work_queue() {
+      int8_t return_value = 0;
+      while (nullptr != (current_job = work_queue.dequeue())) {
+        current_job->begin();
+        _total_xfers++;
+        if (preallocated.owns(current_job)) {
+          return_op_to_pool(current_job);
+        }
+        else {
+          _heap_frees++;
+          delete current_job;
+        }
+        return_value++;
+      }
+      return return_value;
+    };
+
+    /* Exposing what the real adapters keep to themselves. */
+    inline TestBusOp* take() {                 return new_op();              };
+    inline BusWorkQueue<TestBusOp>* queue() {  return &work_queue;           };
+    inline uint16_t misses() {                 return _prealloc_misses;      };
+    inline uint16_t available() {              return preallocated.available();   };
+    inline void     report(StringBuilder* o) { printAdapter(o);              };
+
+  protected:
+    int8_t bus_init() {     return 0;   };
+    int8_t bus_deinit() {   return 0;   };
+};
+
+
+#if defined(__BUILD_HAS_PTHREADS)
+#define BUS_TEST_THREADS      3
+#define BUS_TEST_PER_THREAD   50000
+
+struct BusTestArgs {
+  BusOpPool<TestBusOp>*    pool;
+  BusWorkQueue<TestBusOp>* queue;
+  TestBusOp*               ops;      // This producer's own ops, for the queue test.
+  uint32_t                 id;
+  uint32_t                 errors;
+};
+
+/*
+* Takes and gives ops as fast as it can, checking that nobody else holds an op
+*   that it was just handed.
+*/
+void* bus_pool_churn(void* a) {
+  BusTestArgs* args = (BusTestArgs*) a;
+  for (int i = 0; i < BUS_TEST_PER_THREAD; i++) {
+    TestBusOp* op = args->pool->take();
+    if (nullptr == op) {
+      yieldThread();
+      continue;
+    }
+    uint32_t expected = 0;
+    if (!__atomic_compare_exchange_n(&op->owner, &expected, args->id, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      args->errors++;
+    }
+    __atomic_store_n(&op->owner, 0, __ATOMIC_RELEASE);
+    args->pool->give(op);
+  }
+  return nullptr;
+}
+
+/*
+* Queues its own ops, in order, tagged with where they came from.
+*/
+void* bus_queue_producer(void* a) {
+  BusTestArgs* args = (BusTestArgs*) a;
+  for (uint32_t i = 0; i < BUS_TEST_PER_THREAD; i++) {
+    TestBusOp* op = &args->ops[i];
+    op->tag = (args->id << 24) | i;
+    op->urgent(0 == (i % 7));
+    while (0 != args->queue->insert(op, op->urgent())) yieldThread();
+  }
+  return nullptr;
+}
+#endif  // __BUILD_HAS_PTHREADS
+
+
+/**
+* BusOpPool must hand out each op to one holder at a time, and refuse ops it
+*   doesn't own. BusWorkQueue must give urgent ops first, keep FIFO order within
+*   a lane, skip what was removed, and refuse work when a lane is full. The
+*   adapter must count its pool misses, and report its rate.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_BusQueue() {
+  StringBuilder log("===< BusQueue >=========================================\n");
+  TestBusAdapter adapter;
+  BusWorkQueue<TestBusOp>* q = adapter.queue();
+  TestBusOp  stray;
+  TestBusOp* ops[10];
+  int return_value = -1;
+
+  for (int i = 0; i < 10; i++) ops[i] = adapter.take();
+  if ((2 != adapter.misses()) || (0 != adapter.available())) {
+    log.concatf("Taking 10 ops from a pool of 8 should miss twice (missed %u).\n", adapter.misses());
+    goto bus_test_done;
+  }
+  for (int i = 0; i < 10; i++) {
+    for (int j = 0; j < i; j++) {
+      if (ops[i] == ops[j]) {
+        log.concatf("The pool handed out op %d twice.\n", j);
+        goto bus_test_done;
+      }
+    }
+  }
+
+  // Three normal, then two urgent. Urgent comes out first, and each lane in order.
+  for (int i = 0; i < 5; i++) {
+    ops[i]->tag = i;
+    ops[i]->urgent(i >= 3);
+    adapter.queue_io_job(ops[i]);
+  }
+  {
+    const uint32_t expected[] = {3, 4, 0, 1, 2};
+    for (int i = 0; i < 5; i++) {
+      if (q->get(i) != ops[expected[i]]) {
+        log.concatf("get(%d) should have been op %u.\n", i, expected[i]);
+        goto bus_test_done;
+      }
+    }
+  }
+  if (!q->remove(ops[4]) || !q->remove(ops[1]) || q->remove(ops[1]) || q->contains(ops[1]) || (3 != q->size())) {
+    log.concat("remove() misbehaved.\n");
+    goto bus_test_done;
+  }
+  {
+    const uint32_t expected[] = {3, 0, 2};
+    for (int i = 0; i < 3; i++) {
+      TestBusOp* op = q->dequeue();
+      if (op != ops[expected[i]]) {
+        log.concatf("Dequeue %d should have been op %u.\n", i, expected[i]);
+        goto bus_test_done;
+      }
+    }
+  }
+  if (q->hasNext() || (nullptr != q->dequeue())) {
+    log.concat("Queue should be empty.\n");
+    goto bus_test_done;
+  }
+  for (int i = 0; i < q->capacity(); i++) {
+    if (0 != q->insert(&stray, false)) {
+      log.concatf("Lane refused op %d of %d.\n", i, q->capacity());
+      goto bus_test_done;
+    }
+  }
+  if ((0 == q->insert(&stray, false)) || (0 != q->insert(&stray, true))) {
+    log.concat("A full lane took an op, or blocked the other lane.\n");
+    goto bus_test_done;
+  }
+  while (q->hasNext()) q->dequeue();
+
+  // All ten go through the adapter, and the pool gets its eight back.
+  for (int i = 0; i < 10; i++) {
+    ops[i]->urgent(false);
+    adapter.queue_io_job(ops[i]);
+  }
+  if ((10 != adapter.advance_work_queue()) || (8 != adapter.available())) {
+    log.concatf("The adapter should have finished 10 ops and have 8 on hand (has %u).\n", adapter.available());
+    goto bus_test_done;
+  }
+  {
+    StringBuilder report;
+    adapter.report(&report);
+    if ((nullptr == strstr((const char*) report.string(), "Xfers/sec")) || (nullptr == strstr((const char*) report.string(), "misses/frees     2/2"))) {
+      log.concat("printAdapter() should report the rate, and 2 misses and frees.\n");
+      report.printDebug(&log);
+      goto bus_test_done;
+    }
+  }
+
+  #if defined(__BUILD_HAS_PTHREADS)
+  {
+    BusTestArgs args[BUS_TEST_THREADS];
+    pthread_t   threads[BUS_TEST_THREADS];
+    BusOpPool<TestBusOp> pool;
+    TestBusOp few[4];
+    uint32_t errors = 0;
+    pool.init(few, 4);
+    for (int t = 0; t < BUS_TEST_THREADS; t++) {
+      args[t].pool   = &pool;
+      args[t].id     = t + 1;
+      args[t].errors = 0;
+      pthread_create(&threads[t], nullptr, bus_pool_churn, &args[t]);
+    }
+    for (int t = 0; t < BUS_TEST_THREADS; t++) {
+      pthread_join(threads[t], nullptr);
+      errors += args[t].errors;
+    }
+    if (errors || (4 != pool.available()) || pool.give(&stray)) {
+      log.concatf("Pool churn: %u ops were held twice, and %u of 4 came back.\n", errors, pool.available());
+      goto bus_test_done;
+    }
+  }
+  {
+    BusTestArgs args[BUS_TEST_THREADS];
+    pthread_t   threads[BUS_TEST_THREADS];
+    TestBusOp*  many = new TestBusOp[BUS_TEST_THREADS * BUS_TEST_PER_THREAD];
+    int32_t     last[2][BUS_TEST_THREADS];
+    int         received = 0;
+    for (int t = 0; t < BUS_TEST_THREADS; t++) {
+      last[0][t]    = -1;
+      last[1][t]    = -1;
+      args[t].queue = q;
+      args[t].ops   = &many[t * BUS_TEST_PER_THREAD];
+      args[t].id    = t;
+      pthread_create(&threads[t], nullptr, bus_queue_producer, &args[t]);
+    }
+    while (received < BUS_TEST_THREADS * BUS_TEST_PER_THREAD) {
+      TestBusOp* op = q->dequeue();
+      if (nullptr == op) {
+        yieldThread();
+        continue;
+      }
+      int t    = op->tag >> 24;
+      int seq  = op->tag & 0xFFFFFF;
+      int lane = op->urgent() ? 0 : 1;
+      if (seq <= last[lane][t]) {
+        log.concatf("Producer %d was reordered (%d after %d).\n", t, seq, last[lane][t]);
+        break;
+      }
+      last[lane][t] = seq;
+      received++;
+    }
+    for (int t = 0; t < BUS_TEST_THREADS; t++) pthread_join(threads[t], nullptr);
+    delete[] many;
+    if (received < BUS_TEST_THREADS * BUS_TEST_PER_THREAD) goto bus_test_done;
+    if (q->hasNext()) {
+      log.concat("The queue had leftovers.\n");
+      goto bus_test_done;
+    }
+    log.concatf("%d producers, %d ops, none lost or reordered.\n", BUS_TEST_THREADS, received);
+  }
+  #endif  // __BUILD_HAS_PTHREADS
+
+  log.concat("Test passes.\n");
+  return_value = 0;
+
+bus_test_done:
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  return return_value;
+}
+
+
+/*
+* The life of a bus op, minus the bus: take it from the pool, queue it, pull it
+*   back off the queue, and give it back. Once with the pair of PriorityQueues
+*   that BusAdapter used to keep, and once with its pool and ring.
+* Informational only. No test.
+*/
+void bench_BusQueue() {
+  StringBuilder log("===< BusQueue benchmark >===============================\n");
+  const int ROUNDS = 200000;
+  const int BURST  = 4;      // Ops in flight at once.
+  TestBusOp ops[8];
+  TestBusOp* held[BURST];
+
+  PriorityQueue<TestBusOp*> old_pool;
+  PriorityQueue<TestBusOp*> old_queue;
+  for (int i = 0; i < 8; i++) old_pool.insert(&ops[i]);
+  unsigned long t0 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < BURST; i++) old_queue.insert(old_pool.dequeue());
+    for (int i = 0; i < BURST; i++) {
+      held[i] = old_queue.dequeue();
+      held[i]->wipe();
+      old_pool.insert(held[i]);
+    }
+  }
+  unsigned long t1 = micros();
+
+  BusOpPool<TestBusOp> pool;
+  BusWorkQueue<TestBusOp> queue(12);
+  pool.init(ops, 8);
+  unsigned long t2 = micros();
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < BURST; i++) queue.insert(pool.take(), false);
+    for (int i = 0; i < BURST; i++) {
+      held[i] = queue.dequeue();
+      held[i]->wipe();
+      pool.give(held[i]);
+    }
+  }
+  unsigned long t3 = micros();
+
+  const double OPS = (double) ROUNDS * BURST;
+  log.concatf("\t %d ops, %d at a time.\n", ROUNDS * BURST, BURST);
+  log.concatf("\t PriorityQueue pair:  %8lu us  (%.0f ops/sec)\n", t1 - t0, (double) OPS * 1000000 / ((t1 - t0) ? (t1 - t0) : 1));
+  log.concatf("\t Pool and ring:       %8lu us  (%.0f ops/sec)\n", t3 - t2, (double) OPS * 1000000 / ((t3 - t2) ? (t3 - t2) : 1));
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+}
+
+
+#if defined(MANUVR_BUS_SIM) && defined(MANUVR_SUPPORT_I2C)
+/*
+* A driver for the simulated register files: eight 8-bit registers from 0x00.
+*/
+class SimRegisterDevice final : public I2CDeviceWithRegisters {
+  public:
+    uint32_t callbacks = 0;
+    uint32_t faults    = 0;
+
+    SimRegisterDevice(uint8_t addr, bool burst) : I2CDeviceWithRegisters(addr) {
+      multi_access_support = burst;
+      for (uint16_t i = 0; i < 8; i++) {
+        defineRegister(i, (uint8_t) 0, false, false, true);
+      }
+    };
+
+    int8_t io_op_callback(BusOp* _op) {
+      I2CBusOp* op = (I2CBusOp*) _op;
+      callbacks++;
+      if (op->hasFault()) faults++;
+      I2CDeviceWithRegisters::io_op_callback(op);
+      // Null the buffer so the bus adapter isn't tempted to free it.
+      op->buf     = nullptr;
+      op->buf_len = 0;
+      return 0;
+    };
+
+    inline int8_t read(uint8_t reg) {                 return readRegister(reg);               };
+    inline int8_t write(uint8_t reg, uint8_t val) {   return writeIndirect(reg, val, true);   };
+    inline int8_t flush() {                           return writeDirtyRegisters();           };
+    inline unsigned int value(uint8_t reg) {          return regValue(reg);                   };
+};
+
+
+/*
+* Runs the Kernel until the device has seen the given number of callbacks.
+*/
+bool bus_sim_settle(SimRegisterDevice* dev, uint32_t callbacks) {
+  Kernel* kernel = platform.kernel();
+  unsigned long t0 = millis();
+  while ((dev->callbacks < callbacks) && ((millis() - t0) < 2000)) {
+    kernel->procIdleFlags();
+  }
+  return (dev->callbacks >= callbacks);
+}
+#endif  // MANUVR_BUS_SIM && MANUVR_SUPPORT_I2C
+
+
+/**
+* Drives the real I2CAdapter, its queue, and I2CDeviceWithRegisters against
+*   simulated devices. Register syncs and writes must land, bursts must be one
+*   op, and ops for different devices must share transactions, in the order
+*   they were queued. A NAK inside a shared transaction must fail every op in
+*   it, and nothing that already reached a device may be sent again.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_BusSim() {
+  int return_value = 0;
+  #if defined(MANUVR_BUS_SIM) && defined(MANUVR_SUPPORT_I2C)
+  return_value = -1;
+  StringBuilder log("===< BusSim >===========================================\n");
+  Kernel* kernel = platform.kernel();
+  I2CAdapterOptions opts(0, 0, 0);
+  I2CAdapter adapter(&opts);
+  BusSimDevice sim_a(0, 0x40);
+  BusSimDevice sim_b(0, 0x41);
+  SimRegisterDevice dev_a(0x40, true);
+  SimRegisterDevice dev_b(0x41, false);
+
+  for (int i = 0; i < 8; i++) {
+    sim_a.regs[i] = 0x10 + i;
+    sim_b.regs[i] = 0x20 + i;
+  }
+  BusSim::attach(&sim_a);
+  BusSim::attach(&sim_b);
+  BusSim::resetCounters();
+  kernel->subscribe(&adapter);
+  ((EventReceiver*) &adapter)->attached();
+  adapter.addSlaveDevice(&dev_a);
+  adapter.addSlaveDevice(&dev_b);
+
+  dev_a.sync();
+  dev_b.sync();
+  if (!bus_sim_settle(&dev_a, 1) || !bus_sim_settle(&dev_b, 8)) {
+    log.concatf("Syncs never finished (%u and %u callbacks).\n", dev_a.callbacks, dev_b.callbacks);
+    goto bus_sim_done;
+  }
+  if (1 != dev_a.callbacks) {
+    log.concatf("Syncing eight contiguous registers took %u ops, rather than one burst.\n", dev_a.callbacks);
+    goto bus_sim_done;
+  }
+  for (int i = 0; i < 8; i++) {
+    if ((dev_a.value(i) != sim_a.regs[i]) || (dev_b.value(i) != sim_b.regs[i])) {
+      log.concatf("Register %d didn't sync (0x%02x and 0x%02x).\n", i, dev_a.value(i), dev_b.value(i));
+      goto bus_sim_done;
+    }
+  }
+
+  dev_a.write(3, 0x5A);
+  dev_a.write(4, 0xA5);
+  dev_a.flush();
+  if (!bus_sim_settle(&dev_a, 2) || (0x5A != sim_a.regs[3]) || (0xA5 != sim_a.regs[4])) {
+    log.concat("A burst write didn't land.\n");
+    goto bus_sim_done;
+  }
+
+  // Interleaved, so that each transaction can take one op for each device.
+  BusSim::resetCounters();
+  for (int i = 0; i < 4; i++) {
+    dev_a.read(i);
+    dev_b.read(i);
+  }
+  if (!bus_sim_settle(&dev_a, 6) || !bus_sim_settle(&dev_b, 12)) {
+    log.concat("Interleaved reads never finished.\n");
+    goto bus_sim_done;
+  }
+  if (BusSim::calls >= 8) {
+    log.concatf("8 ops for two devices took %u transactions.\n", BusSim::calls);
+    goto bus_sim_done;
+  }
+
+  // B goes away. Every transaction B is part of fails, A's ops and all.
+  sim_b.present = false;
+  for (int i = 0; i < 4; i++) {
+    dev_a.read(i);
+    dev_b.read(i);
+  }
+  if (!bus_sim_settle(&dev_a, 10) || !bus_sim_settle(&dev_b, 16)) {
+    log.concat("Reads against a missing device never finished.\n");
+    goto bus_sim_done;
+  }
+  if ((4 != dev_b.faults) || (dev_a.faults > 4)) {
+    log.concatf("Faults went to the wrong device (%u on A, %u on B).\n", dev_a.faults, dev_b.faults);
+    goto bus_sim_done;
+  }
+  if (adapter.failedXfers() != (dev_a.faults + dev_b.faults)) {
+    log.concatf("The adapter counted %u failures.\n", adapter.failedXfers());
+    goto bus_sim_done;
+  }
+
+  // Ops go out in queue order. The first read takes the idle bus alone, so
+  //   the other two share a transaction, with B's read first. Its NAK ends
+  //   the transaction before A's write is sent.
+  BusSim::resetCounters();
+  {
+    uint32_t a_cbs    = dev_a.callbacks;
+    uint32_t a_faults = dev_a.faults;
+    uint32_t b_cbs    = dev_b.callbacks;
+    uint8_t  prior    = sim_a.regs[6];
+    dev_a.read(5);
+    dev_b.read(5);
+    dev_a.write(6, 0x77);
+    dev_a.flush();
+    if (!bus_sim_settle(&dev_a, a_cbs + 2) || !bus_sim_settle(&dev_b, b_cbs + 1)) {
+      log.concat("The write behind a NAK never finished.\n");
+      goto bus_sim_done;
+    }
+    if ((0 != sim_a.rx_bytes) || (prior != sim_a.regs[6])) {
+      log.concat("A write queued behind B's read reached A ahead of it.\n");
+      goto bus_sim_done;
+    }
+    if ((a_faults + 1) != dev_a.faults) {
+      log.concatf("The write didn't share the failed transaction (%u faults).\n", dev_a.faults - a_faults);
+      goto bus_sim_done;
+    }
+  }
+
+  // A write that went out ahead of a NAK must not be sent again. This time,
+  //   the write is queued first, and B's read follows it.
+  BusSim::resetCounters();
+  {
+    uint32_t a_cbs    = dev_a.callbacks;
+    uint32_t a_faults = dev_a.faults;
+    uint32_t b_cbs    = dev_b.callbacks;
+    dev_a.read(5);
+    dev_a.write(6, 0x78);
+    dev_a.flush();
+    dev_b.read(5);
+    if (!bus_sim_settle(&dev_a, a_cbs + 2) || !bus_sim_settle(&dev_b, b_cbs + 1)) {
+      log.concat("The write ahead of a NAK never finished.\n");
+      goto bus_sim_done;
+    }
+    if (1 != sim_a.rx_bytes) {
+      log.concatf("A took %u writes for the 1 we sent.\n", sim_a.rx_bytes);
+      goto bus_sim_done;
+    }
+    if ((0x78 != sim_a.regs[6]) || ((a_faults + 1) != dev_a.faults)) {
+      log.concatf("The write didn't share the failed transaction (0x%02x, %u faults).\n", sim_a.regs[6], dev_a.faults - a_faults);
+      goto bus_sim_done;
+    }
+  }
+  return_value = 0;
+
+bus_sim_done:
+  sim_b.present = true;
+  kernel->unsubscribe(&adapter);
+  BusSim::detach(&sim_a);
+  BusSim::detach(&sim_b);
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  #endif  // MANUVR_BUS_SIM && MANUVR_SUPPORT_I2C
+  return return_value;
+}
+
+
+#if defined(MANUVR_BUS_SIM)
+/*
+* Stands in for an SPI driver. Counts what comes back.
+*/
+class SimSPIDevice : public BusOpCallback {
+  public:
+    uint32_t callbacks = 0;
+    uint32_t faults    = 0;
+
+    int8_t io_op_callahead(BusOp*) {  return 0;  };
+    int8_t io_op_callback(BusOp* op) {
+      callbacks++;
+      if (op->hasFault()) faults++;
+      return SPI_CALLBACK_NOMINAL;
+    };
+    int8_t queue_io_job(BusOp*) {     return -1;  };
+};
+
+
+/*
+* Queues one register access to a simulated SPI device.
+*/
+void spi_sim_access(SPIAdapter* adapter, SimSPIDevice* dev, uint8_t cs, BusOpcode opcode, uint8_t reg, uint8_t* buf, unsigned int len) {
+  SPIBusOp* op = adapter->new_op(opcode, dev);
+  op->setParams((BusOpcode::RX == opcode) ? (reg | BUSSIM_SPI_READ_FLAG) : reg);
+  op->setBuffer(buf, len);
+  op->setCSPin(cs);
+  adapter->queue_io_job(op);
+}
+
+
+/*
+* Runs the Kernel until the device has seen the given number of callbacks.
+*/
+bool spi_sim_settle(SimSPIDevice* dev, uint32_t callbacks) {
+  Kernel* kernel = platform.kernel();
+  unsigned long t0 = millis();
+  while ((dev->callbacks < callbacks) && ((millis() - t0) < 2000)) {
+    kernel->procIdleFlags();
+  }
+  return (dev->callbacks >= callbacks);
+}
+#endif  // MANUVR_BUS_SIM
+
+
+/**
+* Drives the real SPIAdapter and its spidev back end against simulated devices.
+*   Ops for one device that pile up behind a busy bus must share a single
+*   transaction with chip-select dropped between them, ops for different
+*   chip-selects must never share one, and a failed transaction must fail
+*   every op in it.
+* @return 0 on pass. Non-zero otherwise.
+*/
+int test_SPIBatch() {
+  int return_value = 0;
+  #if defined(MANUVR_BUS_SIM)
+  return_value = -1;
+  StringBuilder log("===< SPI batching >=====================================\n");
+  Kernel* kernel = platform.kernel();
+  SPIAdapter adapter(0, 0, 0, 0);
+  BusSimDevice sim_a(0, 0);
+  BusSimDevice sim_b(0, 1);
+  SimSPIDevice dev_a;
+  SimSPIDevice dev_b;
+  uint8_t wr[8][2];
+  uint8_t rd[8][2];
+
+  BusSim::attach(&sim_a);
+  BusSim::attach(&sim_b);
+  BusSim::resetCounters();
+  kernel->subscribe(&adapter);
+  ((EventReceiver*) &adapter)->attached();
+
+  // The first write finds the bus idle and goes alone. The rest queue behind it.
+  for (int i = 0; i < 8; i++) {
+    wr[i][0] = 0x30 + i;
+    wr[i][1] = 0x60 + i;
+    spi_sim_access(&adapter, &dev_a, 0, BusOpcode::TX, i * 2, wr[i], 2);
+  }
+  if (!spi_sim_settle(&dev_a, 8)) {
+    log.concatf("Writes never finished (%u callbacks).\n", dev_a.callbacks);
+    goto spi_batch_done;
+  }
+  for (int i = 0; i < 16; i++) {
+    if (sim_a.regs[i] != (((i & 1) ? 0x60 : 0x30) + (i >> 1))) {
+      log.concatf("Register %d holds 0x%02x.\n", i, sim_a.regs[i]);
+      goto spi_batch_done;
+    }
+  }
+  if (2 != BusSim::calls) {
+    log.concatf("8 writes to one device took %u transactions.\n", BusSim::calls);
+    goto spi_batch_done;
+  }
+  if (8 != sim_a.addressed) {
+    log.concatf("Chip-select wasn't dropped between ops (%u addressings).\n", sim_a.addressed);
+    goto spi_batch_done;
+  }
+
+  // Interleaved between chip-selects, so nothing can be batched.
+  BusSim::resetCounters();
+  for (int i = 0; i < 4; i++) {
+    spi_sim_access(&adapter, &dev_a, 0, BusOpcode::RX, i * 2, rd[i], 2);
+    spi_sim_access(&adapter, &dev_b, 1, BusOpcode::RX, 0, rd[i + 4], 2);
+  }
+  if (!spi_sim_settle(&dev_a, 12) || !spi_sim_settle(&dev_b, 4)) {
+    log.concat("Interleaved reads never finished.\n");
+    goto spi_batch_done;
+  }
+  if (8 != BusSim::calls) {
+    log.concatf("8 ops across two chip-selects took %u transactions.\n", BusSim::calls);
+    goto spi_batch_done;
+  }
+  for (int i = 0; i < 4; i++) {
+    if ((rd[i][0] != wr[i][0]) || (rd[i][1] != wr[i][1])) {
+      log.concatf("Read %d came back 0x%02x 0x%02x.\n", i, rd[i][0], rd[i][1]);
+      goto spi_batch_done;
+    }
+  }
+
+  // The second transaction fails, and takes the seven ops in it along.
+  BusSim::resetCounters();
+  BusSim::fault_every = 2;
+  for (int i = 0; i < 8; i++) {
+    spi_sim_access(&adapter, &dev_a, 0, BusOpcode::TX, i * 2, wr[i], 2);
+  }
+  if (!spi_sim_settle(&dev_a, 20)) {
+    log.concat("Faulted writes never finished.\n");
+    goto spi_batch_done;
+  }
+  if (7 != dev_a.faults) {
+    log.concatf("%u of 8 writes faulted, rather than 7.\n", dev_a.faults);
+    goto spi_batch_done;
+  }
+  return_value = 0;
+
+spi_batch_done:
+  BusSim::fault_every = 0;
+  kernel->unsubscribe(&adapter);
+  BusSim::detach(&sim_a);
+  BusSim::detach(&sim_b);
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  #endif  // MANUVR_BUS_SIM
+  return return_value;
+}
+
+
+/*
+* Register reads from four devices, through the whole stack, as fast as the
+*   Kernel will take them. Once on an ideal bus, once at the byte rate of
+*   400kHz I2C, and once with every 50th transaction failing.
+*/
+void bench_BusSim() {
+  #if defined(MANUVR_BUS_SIM) && defined(MANUVR_SUPPORT_I2C)
+  StringBuilder log("===< BusSim benchmark >=================================\n");
+  const int DEVS   = 4;
+  const int ROUNDS = 2000;
+  Kernel* kernel = platform.kernel();
+  I2CAdapterOptions opts(0, 0, 0);
+  I2CAdapter adapter(&opts);
+  BusSimDevice*      sims[DEVS];
+  SimRegisterDevice* devs[DEVS];
+  kernel->subscribe(&adapter);
+  ((EventReceiver*) &adapter)->attached();
+  for (int i = 0; i < DEVS; i++) {
+    sims[i] = new BusSimDevice(0, 0x48 + i);
+    devs[i] = new SimRegisterDevice(0x48 + i, false);
+    BusSim::attach(sims[i]);
+    adapter.addSlaveDevice(devs[i]);
+  }
+
+  const uint32_t latencies[] = {0, 22500, 0};
+  const uint32_t faulting[]  = {0, 0, 50};
+  const int      rounds[]    = {ROUNDS, ROUNDS / 10, ROUNDS};
+  for (int run = 0; run < 3; run++) {
+    BusSim::ns_per_byte = latencies[run];
+    BusSim::fault_every = faulting[run];
+    BusSim::resetCounters();
+    uint32_t xfers0  = adapter.totalXfers();
+    uint32_t failed0 = adapter.failedXfers();
+    int max_depth = 0;
+    unsigned long t0 = micros();
+    for (int r = 0; r < rounds[run]; r++) {
+      // Two registers from each device, then let the Kernel at them.
+      for (int d = 0; d < DEVS; d++) {
+        devs[d]->read(r & 7);
+        devs[d]->read((r + 1) & 7);
+      }
+      if (adapter.queueDepth() > max_depth) max_depth = adapter.queueDepth();
+      while (adapter.queueDepth() || adapter.currentJob()) kernel->procIdleFlags();
+    }
+    unsigned long t1 = micros();
+    uint32_t ops = adapter.totalXfers() - xfers0;
+    log.concatf("\t %5uns/byte, fault every %2u: %6u ops in %8lu us  (%.0f ops/sec)\n",
+      latencies[run], faulting[run], ops, t1 - t0, (double) ops * 1000000 / ((t1 - t0) ? (t1 - t0) : 1));
+    log.concatf("\t   %.2f ops per transaction, queue depth peaked at %d, %u ops failed (%u injected).\n",
+      (double) ops / (BusSim::calls ? BusSim::calls : 1), max_depth, adapter.failedXfers() - failed0, BusSim::faults);
+  }
+  BusSim::ns_per_byte = 0;
+  BusSim::fault_every = 0;
+  log.concatf("\t Adapter floods: %u\n", adapter.queueFloods());
+
+  kernel->unsubscribe(&adapter);
+  for (int i = 0; i < DEVS; i++) {
+    delete devs[i];
+    BusSim::detach(sims[i]);
+    delete sims[i];
+  }
+  log.concat("========================================================\n\n");
+  printf((const char*) log.string());
+  #endif  // MANUVR_BUS_SIM && MANUVR_SUPPORT_I2C
+}
+
+
 /**
 * Prints the sizes of various types. Informational only. No test.
 */
@@ -540,6 +3895,9 @@ void printTypeSizes() {
   output.concatf("\tBufferPipe            %u\n", sizeof(BufferPipe));
   output.concatf("\tLinkedList<void*>     %u\n", sizeof(LinkedList<void*>));
   output.concatf("\tPriorityQueue<void*>  %u\n", sizeof(PriorityQueue<void*>));
+  output.concatf("\tMsgQueue              %u\n", sizeof(MsgQueue));
+  output.concatf("\tMsgIngress            %u\n", sizeof(MsgIngress));
+  output.concatf("\tScheduleHeap          %u\n", sizeof(ScheduleHeap));
   output.concatf("\tArgument              %u\n", sizeof(Argument));
   output.concatf("\tUUID                  %u\n", sizeof(UUID));
   output.concatf("\tTaskProfilerData      %u\n", sizeof(TaskProfilerData));
@@ -595,27 +3953,53 @@ int main(int argc, char *argv[]) {
 
   platform.platformPreInit();   // Our test fixture needs random numbers.
 
-  if (0 == test_StringBuilder()) {
-    if (0 == test_PriorityQueue()) {
-      if (0 == vector3_float_test(0.7f, 0.8f, 0.01f)) {
-        if (0 == test_BufferPipe()) {
-          if (0 == test_Arguments()) {
-            if (0 == test_UUID()) {
-              printf("**********************************\n");
-              printf("*  DataStructure tests all pass  *\n");
-              printf("**********************************\n");
-              exit_value = 0;
-            }
-          }
-          else printTestFailure("Argument");
-        }
-        else printTestFailure("BufferPipe");
-      }
-      else printTestFailure("Vector3");
-    }
-    else printTestFailure("PriorityQueue");
+  if (0 != test_StringBuilder())                        printTestFailure("StringBuilder");
+  else if (0 != test_StringBuilder_iovec())             printTestFailure("StringBuilder iovec");
+  else if (0 != test_StringBuilder_tokens())            printTestFailure("StringBuilder tokens");
+  else if (0 != test_PriorityQueue())                   printTestFailure("PriorityQueue");
+  else if (0 != test_RingBuffer())                      printTestFailure("RingBuffer");
+  else if (0 != test_MsgQueue())                        printTestFailure("MsgQueue");
+  else if (0 != test_MsgIngress())                      printTestFailure("MsgIngress");
+  else if (0 != test_ScheduleHeap())                    printTestFailure("ScheduleHeap");
+  else if (0 != test_MsgDefs())                         printTestFailure("MsgDefs");
+  else if (0 != test_LatencyHistogram())                printTestFailure("LatencyHistogram");
+  else if (0 != test_Tracer())                          printTestFailure("Tracer");
+  else if (0 != test_SubscriberIndex())                 printTestFailure("SubscriberIndex");
+  else if (0 != test_ListenerTable())                   printTestFailure("ListenerTable");
+  else if (0 != test_TopicTrie())                       printTestFailure("TopicTrie");
+  else if (0 != test_MQTTInflight())                    printTestFailure("MQTT inflight");
+  else if (0 != test_WorkerPool())                      printTestFailure("WorkerPool");
+  else if (0 != vector3_float_test(0.7f, 0.8f, 0.01f))  printTestFailure("Vector3");
+  else if (0 != test_BusQueue())                        printTestFailure("BusQueue");
+  else if (0 != test_BufferPipe())                      printTestFailure("BufferPipe");
+  else if (0 != test_UDPPipeTable())                    printTestFailure("UDPPipeTable");
+  else if (0 != test_NMEAParser())                      printTestFailure("NMEAParser");
+  else if (0 != test_BusSim())                          printTestFailure("BusSim");
+  else if (0 != test_SPIBatch())                        printTestFailure("SPI batching");
+  else if (0 != test_Arguments())                       printTestFailure("Argument");
+  else if (0 != test_UUID())                            printTestFailure("UUID");
+  else {
+    printf("**********************************\n");
+    printf("*  DataStructure tests all pass  *\n");
+    printf("**********************************\n");
+    exit_value = 0;
+  }
+
+  if (0 == exit_value) {
+    // Numbers from a broken build would only mislead.
+    bench_MsgQueue();
+    bench_RingBuffer();
+    bench_StringBuilder();
+    bench_StringBuilder_iovec();
+    bench_MsgDefs();
+    bench_LatencyHistogram();
+    bench_Tracer();
+    bench_TopicTrie();
+    bench_Workers();
+    bench_BusQueue();
+    bench_BusSim();
+    bench_NMEAParser();
   }
-  else printTestFailure("StringBuilder");
 
   exit(exit_value);
 }